@@ -13,7 +13,25 @@
 #include <slope/slope_path.h>
 
 // Cross-validation
+#include <slope/approximate_cv.h>
 #include <slope/cv.h>
 
 // Proximal operator
 #include <slope/sorted_l1_norm.h>
+
+// Design matrices on disk
+#include <slope/column_block_matrix.h>
+#include <slope/mapped_matrix.h>
+
+// Compressed and partitioned design matrices
+#include <slope/deduplicated_matrix.h>
+#include <slope/partitioned_matrix.h>
+#include <slope/pattern_matrix.h>
+#include <slope/quantized_matrix.h>
+
+// Matrix-free designs
+#include <slope/interactions.h>
+#include <slope/linear_operator.h>
+
+// Ultrahigh-dimensional designs
+#include <slope/ultrahigh.h>
@@ -0,0 +1,282 @@
+/**
+ * @file
+ * @brief Approximate leave-one-out cross-validation for SLOPE models
+ *
+ * Estimates the leave-one-out prediction error of every fit along the
+ * regularization path from the path on the full data only, without refitting
+ * the model to the folds.
+ */
+
+#pragma once
+
+#include "cv.h"
+#include "slope.h"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <memory>
+
+namespace slope {
+
+namespace detail {
+
+/**
+ * @brief The design of the clusters of a fit
+ *
+ * Within the clusters and signs of a fit, SLOPE is a smooth problem in the
+ * cluster coefficients, whose design has one column for each nonzero cluster:
+ * the sum of the normalized columns of the cluster's features, times the
+ * signs of their coefficients.
+ *
+ * @tparam T Type of the design matrix
+ * @param x The design matrix, not normalized
+ * @param fit The fit that defines the clusters and signs
+ * @return An n x (k + 1) matrix with the designs of the k nonzero clusters,
+ *   and a column of ones if the fit has an intercept
+ */
+template<typename T>
+Eigen::MatrixXd
+clusterDesign(const T& x, const SlopeFit& fit)
+{
+  const auto& metadata = *fit.getMetadata();
+  const Eigen::VectorXd& x_centers = metadata.x_centers;
+  const Eigen::VectorXd& x_scales = metadata.x_scales;
+
+  Eigen::VectorXd beta = Eigen::MatrixXd(fit.getCoefs(false)).reshaped();
+
+  Clusters clusters = fit.getClusters();
+
+  if (clusters.size() == 0) {
+    // The clusters were not kept
+    clusters.update(beta);
+  }
+
+  std::vector<Eigen::Triplet<double>> triplets;
+  int k = 0;
+
+  for (IndexType c = 0; c < clusters.size(); ++c) {
+    if (clusters.coeff(c) == 0) {
+      continue;
+    }
+
+    for (auto it = clusters.cbegin(c); it != clusters.cend(c); ++it) {
+      const int j = *it;
+      const double scale = x_scales.size() > 0 ? x_scales(j) : 1.0;
+
+      triplets.emplace_back(j, k, sign(beta(j)) / scale);
+    }
+
+    k++;
+  }
+
+  Eigen::SparseMatrix<double> pattern(x.cols(), k);
+  pattern.setFromTriplets(triplets.begin(), triplets.end());
+
+  const int n_cols = k + static_cast<int>(metadata.has_intercept);
+
+  Eigen::MatrixXd x_reduced(x.rows(), n_cols);
+  x_reduced.leftCols(k) = x * pattern;
+
+  if (x_centers.size() > 0) {
+    Eigen::RowVectorXd shift = pattern.transpose() * x_centers;
+    x_reduced.leftCols(k).rowwise() -= shift;
+  }
+
+  if (metadata.has_intercept) {
+    x_reduced.col(k).setOnes();
+  }
+
+  return x_reduced;
+}
+
+/**
+ * @brief Approximate leave-one-out corrections of the linear predictors
+ *
+ * Takes one Newton step from the fit towards the fit without each
+ * observation, in the smooth problem within the clusters of the fit (see
+ * clusterDesign()), where the penalty is linear and does not contribute to
+ * the Hessian. With \f$H = X^T W X\f$, the linear predictor of observation i
+ * changes by
+ * \f[
+ *   \frac{a_i g_i - x_i^T H^{+} X^T g / n}{1 - a_i w_i},
+ *   \qquad a_i = x_i^T H^{+} x_i,
+ * \f]
+ * where \f$g_i\f$ and \f$w_i\f$ are the first and second derivatives of the
+ * loss of observation i with respect to its linear predictor. The second
+ * term in the numerator accounts for the loss being averaged over one
+ * observation less. For the quadratic loss, this is the exact leave-one-out
+ * prediction, as long as leaving the observation out does not change the
+ * clusters.
+ *
+ * @param x_reduced The design of the clusters, from clusterDesign()
+ * @param intercept Whether the last column of `x_reduced` is the intercept
+ * @param eta Linear predictor of the fit
+ * @param y Response
+ * @param loss The loss of the model, without observation weights
+ * @return An n x 2 matrix with the changes of the linear predictors in the
+ *   first column, and the parts of them that are due to the intercept in the
+ *   second
+ */
+Eigen::MatrixXd
+looCorrections(const Eigen::MatrixXd& x_reduced,
+               const bool intercept,
+               const Eigen::VectorXd& eta,
+               const Eigen::VectorXd& y,
+               const std::unique_ptr<Loss>& loss);
+
+} // namespace detail
+
+/**
+ * @brief Approximate leave-one-out cross-validation
+ *
+ * Estimates the cross-validation scores of all alphas along the path from the
+ * path on the full data alone (see detail::looCorrections()), which costs
+ * about as much as fitting one path, instead of one for each fold. The fits
+ * for positive gamma are scored by blending the approximations for the
+ * penalized and the relaxed fits, just like the fits themselves.
+ *
+ * The approximation assumes that leaving out a single observation does not
+ * change the clusters of a fit. It is exact for the quadratic loss when this
+ * holds, and is accurate when the number of nonzero clusters is small
+ * compared to the number of observations, but degrades as the fits approach
+ * interpolation of the data.
+ *
+ * @tparam T Type of design matrix (supports both dense and sparse matrices)
+ * @param model The SLOPE model to be cross-validated
+ * @param x The design matrix containing predictors
+ * @param y_in The response matrix
+ * @param config Configuration of the grid of hyperparameters and the metric.
+ *   The settings for the folds, as well as early stopping, do not apply.
+ * @return CvResult in the same format as crossValidate(), with a single row
+ *   of scores, which are the leave-one-out estimates, and zero standard
+ *   errors
+ *
+ * @throws std::invalid_argument For multinomial models, which are not
+ *   supported
+ */
+template<typename T>
+CvResult
+approximateCv(Slope model,
+              Eigen::EigenBase<T>& x,
+              const Eigen::MatrixXd& y_in,
+              const CvConfig& config = CvConfig())
+{
+  auto loss = setupLoss(model.getLossType());
+
+  Eigen::MatrixXd y = loss->preprocessResponse(y_in);
+
+  if (y.cols() > 1) {
+    throw std::invalid_argument(
+      "Approximate cross-validation requires a single-response loss");
+  }
+
+  auto hyperparams = config.default_hyperparams;
+
+  for (const auto& [key, values] : config.hyperparams) {
+    hyperparams[key] = values;
+  }
+
+  auto grid = detail::createGrid(hyperparams);
+  auto scorer = Score::create(config.metric);
+
+  CvResult cv_result;
+  cv_result.results.resize(grid.size());
+
+  // The grid points that share a value of q share a path
+  std::map<double, std::vector<int>> groups;
+
+  for (size_t g = 0; g < grid.size(); ++g) {
+    groups[grid[g].at("q")].emplace_back(g);
+  }
+
+  SlopePath previous;
+
+  for (const auto& [q, grid_points] : groups) {
+    Slope q_model = model;
+    q_model.setQ(q);
+
+    bool relax = false;
+
+    for (int g : grid_points) {
+      relax = relax || grid[g].at("gamma") > 0;
+    }
+
+    SlopePath path, relaxed_path;
+    SlopeFit relaxed;
+
+    // Approximate leave-one-out corrections of the penalized and relaxed
+    // fits, from detail::looCorrections()
+    std::vector<Eigen::MatrixXd> loo_fit, loo_relaxed;
+
+    auto approximate = [&](const SlopeFit& fit) {
+      path.addFit(fit);
+
+      Eigen::MatrixXd x_reduced = detail::clusterDesign(x.derived(), fit);
+      const bool intercept = fit.getMetadata()->has_intercept;
+
+      Eigen::VectorXd eta = fit.predict(x, "linear");
+      loo_fit.emplace_back(
+        detail::looCorrections(x_reduced, intercept, eta, y, loss));
+
+      if (relax) {
+        Eigen::VectorXd beta0, beta;
+
+        if (relaxed_path.size() > 0) {
+          beta0 = relaxed.getIntercepts(false);
+          beta = Eigen::MatrixXd(relaxed.getCoefs(false)).reshaped();
+        }
+
+        relaxed = q_model.relax(fit, x.derived(), y, 0.0, beta0, beta);
+        relaxed_path.addFit(relaxed);
+
+        eta = relaxed.predict(x, "linear");
+        loo_relaxed.emplace_back(
+          detail::looCorrections(x_reduced, intercept, eta, y, loss));
+      }
+
+      return true;
+    };
+
+    q_model.path(x, y, Eigen::VectorXd(), previous, approximate);
+
+    const int n_steps = path.size();
+
+    for (int g : grid_points) {
+      const double gamma = grid[g].at("gamma");
+
+      Eigen::MatrixXd eta =
+        gamma > 0 ? Slope::blendRelaxed(path, relaxed_path, gamma)
+                      .predict(x, "linear")
+                  : path.predict(x, "linear");
+
+      for (int i = 0; i < n_steps; ++i) {
+        if (gamma > 0) {
+          // Like the blend itself, the correction blends the coefficients
+          // but takes the intercept of the relaxed fit
+          const Eigen::MatrixXd& r = loo_relaxed[i];
+          const Eigen::MatrixXd& f = loo_fit[i];
+
+          eta.col(i) += r.col(1) + (1 - gamma) * (r.col(0) - r.col(1)) +
+                        gamma * (f.col(0) - f.col(1));
+        } else {
+          eta.col(i) += loo_fit[i].col(0);
+        }
+      }
+
+      GridResult& result = cv_result.results[g];
+
+      result.params = grid[g];
+      result.alphas = path.getAlpha();
+      result.score = scorer->evalPath(eta, y, loss).transpose();
+      result.mean_scores = result.score.row(0).transpose().array();
+      result.std_errors = Eigen::ArrayXd::Zero(n_steps);
+    }
+
+    previous = std::move(path);
+  }
+
+  detail::findBestParameters(cv_result, scorer);
+
+  return cv_result;
+}
+
+} // namespace slope
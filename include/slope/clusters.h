@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include "index_type.h"
 #include <Eigen/SparseCore>
 #include <vector>
 
@@ -40,7 +41,7 @@ public:
    * @param i The index of the cluster.
    * @return An iterator pointing to the beginning of the cluster.
    */
-  std::vector<int>::iterator begin(const int i);
+  std::vector<IndexType>::iterator begin(const IndexType i);
 
   /**
    * @brief Returns an iterator pointing to the end of the cluster with the
@@ -48,7 +49,7 @@ public:
    * @param i The index of the cluster.
    * @return An iterator pointing to the end of the cluster.
    */
-  std::vector<int>::iterator end(const int i);
+  std::vector<IndexType>::iterator end(const IndexType i);
 
   /**
    * @brief Returns a constant iterator pointing to the beginning of the cluster
@@ -56,7 +57,7 @@ public:
    * @param i The index of the cluster.
    * @return A constant iterator pointing to the beginning of the cluster.
    */
-  std::vector<int>::const_iterator cbegin(const int i) const;
+  std::vector<IndexType>::const_iterator cbegin(const IndexType i) const;
 
   /**
    * @brief Returns a constant iterator pointing to the end of the cluster with
@@ -64,41 +65,41 @@ public:
    * @param i The index of the cluster.
    * @return A constant iterator pointing to the end of the cluster.
    */
-  std::vector<int>::const_iterator cend(const int i) const;
+  std::vector<IndexType>::const_iterator cend(const IndexType i) const;
 
   /**
    * @brief Returns the size of the cluster with the given index.
    * @param i The index of the cluster.
    * @return The size of the cluster.
    */
-  int cluster_size(const int i) const;
+  IndexType cluster_size(const IndexType i) const;
 
   /**
    * @brief Returns the pointer of the cluster with the given index.
    * @param i The index of the cluster.
    * @return The pointer of the cluster.
    */
-  int pointer(const int i) const;
+  IndexType pointer(const IndexType i) const;
 
   /**
    * @brief Returns the number of clusters.
    * @return The number of clusters.
    */
-  int size() const;
+  IndexType size() const;
 
   /**
    * @brief Returns the coefficient of the cluster with the given index.
    * @param i The index of the cluster.
    * @return The coefficient of the cluster.
    */
-  double coeff(const int i) const;
+  double coeff(const IndexType i) const;
 
   /**
    * @brief Sets the coefficient of the cluster with the given index.
    * @param i The index of the cluster.
    * @param x The new coefficient value.
    */
-  void setCoeff(const int i, const double x);
+  void setCoeff(const IndexType i, const double x);
 
   /**
    * @brief Returns a vector containing the coefficients of all clusters.
@@ -110,13 +111,13 @@ public:
    * @brief Returns a vector containing the indices of all clusters.
    * @return A vector containing the indices.
    */
-  const std::vector<int>& indices() const;
+  const std::vector<IndexType>& indices() const;
 
   /**
    * @brief Returns a vector containing the pointers of all clusters.
    * @return A vector containing the pointers.
    */
-  const std::vector<int>& pointers() const;
+  const std::vector<IndexType>& pointers() const;
 
   /**
    * @brief Updates the cluster structure when an index is changed.
@@ -124,7 +125,9 @@ public:
    * @param new_index The new index.
    * @param c_new The new coefficient value.
    */
-  void update(const int old_index, const int new_index, const double c_new);
+  void update(const IndexType old_index,
+              const IndexType new_index,
+              const double c_new);
 
   /**
    * @brief Updates the cluster structure with the given beta vector.
@@ -136,28 +139,28 @@ public:
    * @brief Returns the clusters as a vector of vectors.
    * @return The clusters as a vector of vectors.
    */
-  std::vector<std::vector<int>> getClusters() const;
+  std::vector<std::vector<IndexType>> getClusters() const;
 
 private:
-  std::vector<double> c;  /**< The coefficients of the clusters. */
-  std::vector<int> c_ind; /**< The indices of the clusters. */
-  std::vector<int>
-    c_ptr; /**< Pointers to the start of each of the clusters' indices. */
-  int p;   /**< The number of features. */
+  std::vector<double> c;        /**< The coefficients of the clusters. */
+  std::vector<IndexType> c_ind; /**< The indices of the clusters. */
+  std::vector<IndexType>
+    c_ptr;     /**< Pointers to the start of each of the clusters' indices. */
+  IndexType p; /**< The number of features. */
 
   /**
    * @brief Reorders the cluster structure when an index is changed.
    * @param old_index The old index.
    * @param new_index The new index.
    */
-  void reorder(const int old_index, const int new_index);
+  void reorder(const IndexType old_index, const IndexType new_index);
 
   /**
    * @brief Merges two clusters into one.
    * @param old_index The index of the cluster to be merged.
    * @param new_index The index of the cluster to merge into.
    */
-  void merge(const int old_index, const int new_index);
+  void merge(const IndexType old_index, const IndexType new_index);
 };
 
 /**
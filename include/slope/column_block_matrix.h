@@ -0,0 +1,248 @@
+/**
+ * @file
+ * @brief Design matrices that are stored on disk as blocks of columns
+ */
+
+#pragma once
+
+#include "column_statistics.h"
+#include "jit_normalization.h"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace slope {
+class ColumnBlockMatrix;
+}
+
+namespace Eigen {
+namespace internal {
+
+/// Lets ColumnBlockMatrix pass as an Eigen::EigenBase, like Eigen's own
+/// matrix-free operators
+template<>
+struct traits<slope::ColumnBlockMatrix>
+  : public Eigen::internal::traits<Eigen::SparseMatrix<double>>
+{};
+
+} // namespace internal
+} // namespace Eigen
+
+namespace slope {
+
+/**
+ * @brief A dense design matrix that does not fit in memory, stored on disk as
+ * blocks of columns
+ *
+ * Each block is a dense matrix file in the format of MappedMatrix, and the
+ * blocks hold consecutive columns of the design (see writeColumnBlocks()).
+ * The matrix can be passed to Slope::path() like any other matrix, but only
+ * a few blocks are in memory at a time:
+ *
+ * - Passes over all columns, for the full gradient at the start of each
+ *   step and in the check for KKT violations, stream the blocks from disk,
+ *   reading the next block in the background while the current one is used.
+ * - The columns of the working set, which the screening rule keeps small,
+ *   are pinned in memory (see pin()), and the inner solver runs on them
+ *   alone.
+ *
+ * The normalization is computed from the column statistics that are stored
+ * with the blocks, so that x is never modified, and observation weights are
+ * not supported. A matrix should only be used by one fit at a time.
+ */
+class ColumnBlockMatrix : public Eigen::EigenBase<ColumnBlockMatrix>
+{
+public:
+  /// Element type
+  using Scalar = double;
+
+  /// Real element type
+  using RealScalar = double;
+
+  /// Index type
+  using StorageIndex = int;
+
+  enum
+  {
+    ColsAtCompileTime = Eigen::Dynamic,
+    MaxColsAtCompileTime = Eigen::Dynamic,
+    IsRowMajor = false
+  };
+
+  /**
+   * @brief Opens the blocks of a matrix
+   *
+   * Only the headers and column statistics of the blocks are read.
+   *
+   * @param files Paths to the files of the blocks, in the order of their
+   *   columns. All blocks must have the same number of rows.
+   * @throws std::runtime_error If a block cannot be read
+   * @throws std::invalid_argument If the blocks do not have the same number
+   *   of rows, or a block is sparse
+   */
+  explicit ColumnBlockMatrix(std::vector<std::string> files);
+
+  /// Number of rows
+  Eigen::Index rows() const { return n_rows; }
+
+  /// Number of columns
+  Eigen::Index cols() const { return block_starts.back(); }
+
+  /// Number of blocks
+  int numBlocks() const { return files.size(); }
+
+  /// Column statistics of the matrix, from those of the blocks
+  const ColumnStatistics& statistics() const { return x_stats; }
+
+  /**
+   * @brief Calls a function with blocks of the matrix that contain a set of
+   * columns
+   *
+   * If all of the columns are pinned, the function is only called with the
+   * pinned columns. Otherwise, the blocks that contain any of the columns are
+   * read from disk in order, each while the previous one is used.
+   *
+   * @param columns Sorted indices of the columns
+   * @param f Function that is called with a block and the indices of its
+   *   columns in the full matrix. The block may contain other columns than
+   *   those requested.
+   */
+  void forEachBlock(
+    const std::vector<int>& columns,
+    const std::function<void(const Eigen::MatrixXd&, const std::vector<int>&)>&
+      f) const;
+
+  /**
+   * @brief Keeps a set of columns in memory
+   *
+   * Columns that are already pinned are kept, the others are read from
+   * disk, and all other columns are released.
+   *
+   * @param columns Sorted indices of the columns
+   * @return The pinned columns, in the order of `columns`
+   */
+  const Eigen::MatrixXd& pin(const std::vector<int>& columns) const;
+
+  /// Indices of the pinned columns
+  const std::vector<int>& pinnedColumns() const { return pinned_columns; }
+
+private:
+  std::shared_ptr<const Eigen::MatrixXd> readBlock(const int b) const;
+
+  std::vector<std::string> files;
+  std::vector<int> block_starts;
+  Eigen::Index n_rows = 0;
+  ColumnStatistics x_stats;
+
+  mutable std::vector<int> pinned_columns;
+  mutable Eigen::MatrixXd pinned;
+};
+
+/**
+ * @brief Writes a dense matrix to disk as blocks of columns, for
+ * ColumnBlockMatrix
+ *
+ * @param prefix Prefix of the paths of the files, to which the index of the
+ *   block and `.bin` are appended
+ * @param x The matrix
+ * @param block_size Number of columns in each block, except possibly the
+ *   last one
+ * @return The paths of the files
+ */
+std::vector<std::string>
+writeColumnBlocks(const std::string& prefix,
+                  const Eigen::MatrixXd& x,
+                  const int block_size);
+
+/**
+ * @brief Computes the linear predictor from a matrix that is stored in
+ * blocks
+ *
+ * @see linearPredictor() for in-memory matrices, which this streams over the
+ * blocks that contain the active set
+ */
+Eigen::MatrixXd
+linearPredictor(const ColumnBlockMatrix& x,
+                const std::vector<IndexType>& active_set,
+                const Eigen::VectorXd& beta0,
+                const Eigen::VectorXd& beta,
+                const Eigen::VectorXd& x_centers,
+                const Eigen::VectorXd& x_scales,
+                const JitNormalization jit_normalization,
+                const bool intercept);
+
+/**
+ * @brief Computes the gradient from a matrix that is stored in blocks
+ *
+ * @see updateGradient() for in-memory matrices, which this streams over the
+ * blocks that contain the active set
+ */
+void
+updateGradient(Eigen::VectorXd& gradient,
+               const ColumnBlockMatrix& x,
+               const Eigen::MatrixXd& residual,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const Eigen::VectorXd& w,
+               const JitNormalization jit_normalization);
+
+/**
+ * @brief Offsets the gradient for a matrix that is stored in blocks
+ *
+ * @see offsetGradient() for in-memory matrices, which this streams over the
+ * blocks that contain the active set
+ */
+void
+offsetGradient(Eigen::VectorXd& gradient,
+               const ColumnBlockMatrix& x,
+               const Eigen::VectorXd& offset,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const JitNormalization jit_normalization,
+               const Eigen::VectorXd& w = Eigen::VectorXd());
+
+/**
+ * @brief Computes centers and scales of a matrix that is stored in blocks,
+ * from its column statistics
+ *
+ * The matrix is never modified, regardless of `modify_x`.
+ *
+ * @see normalize() for in-memory matrices
+ */
+JitNormalization
+normalize(ColumnBlockMatrix& x,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool modify_x);
+
+/**
+ * @brief Observation weights are not supported for matrices that are stored
+ * in blocks
+ *
+ * @throws std::invalid_argument Always
+ */
+JitNormalization
+normalize(ColumnBlockMatrix& x,
+          const Eigen::VectorXd& w,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool modify_x);
+
+/**
+ * @brief Checks a matrix that is stored in blocks for non-finite values,
+ * through its column means
+ */
+bool
+isFinite(const ColumnBlockMatrix& x);
+
+} // namespace slope
@@ -0,0 +1,425 @@
+/**
+ * @file
+ * @brief Running column statistics of a design matrix that grows by rows
+ */
+
+#pragma once
+
+#include "utils.h"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <cmath>
+#include <limits>
+#include <string>
+
+namespace slope {
+
+/**
+ * @brief Running statistics of the columns of a design matrix
+ *
+ * Keeps the number of rows, means, sums of squared deviations from the mean,
+ * absolute sums, minima, and maxima of every column, which is enough to
+ * compute all of the centers and scales supported by computeCenters() and
+ * computeScales(). Blocks of rows are merged into the statistics with the
+ * pairwise update of Chan et al., the block version of Welford's algorithm,
+ * so that the statistics of a matrix that grows by rows can be kept up to
+ * date without revisiting the rows that have already been seen.
+ *
+ * Rows can also be given non-negative frequency weights, in which case the
+ * statistics are those of the matrix in which each row is repeated as many
+ * times as its weight. In particular, 0/1 weights give the statistics of a
+ * subset of the rows.
+ */
+class ColumnStatistics
+{
+public:
+  /**
+   * @brief Constructs empty statistics for a matrix without columns
+   */
+  ColumnStatistics() = default;
+
+  /**
+   * @brief Constructs empty statistics
+   *
+   * @param p Number of columns
+   */
+  explicit ColumnStatistics(const int p);
+
+  /**
+   * @brief Constructs statistics from their moments, for instance from
+   * statistics that have been stored along with the matrix
+   *
+   * @param n Number of rows
+   * @param w_sum Total weight of the rows
+   * @param mean Column means
+   * @param m2 Column sums of squared deviations from the means
+   * @param abs_sum Column sums of absolute values
+   * @param min Column minima
+   * @param max Column maxima
+   */
+  ColumnStatistics(const int n,
+                   const double w_sum,
+                   Eigen::VectorXd mean,
+                   Eigen::VectorXd m2,
+                   Eigen::VectorXd abs_sum,
+                   Eigen::VectorXd min,
+                   Eigen::VectorXd max);
+
+  /**
+   * @brief Merges the rows `[row_begin, row_end)` of a dense matrix into the
+   * statistics
+   *
+   * @tparam T The type of the matrix
+   * @param x The matrix, which must have as many columns as the statistics
+   * @param row_begin First row to add
+   * @param row_end One past the last row to add
+   */
+  template<typename T>
+  void update(const Eigen::MatrixBase<T>& x,
+              const int row_begin,
+              const int row_end)
+  {
+    const int p = x.cols();
+    const int n_block = row_end - row_begin;
+
+    checkDimensions(p, n_block);
+
+    if (n_block == 0) {
+      return;
+    }
+
+    auto block = x.derived().middleRows(row_begin, n_block);
+
+    Eigen::VectorXd block_mean = block.colwise().mean().transpose();
+    Eigen::VectorXd block_m2(p);
+
+    for (int j = 0; j < p; ++j) {
+      block_m2(j) = (block.col(j).array() - block_mean(j)).square().sum();
+    }
+
+    merge(n_block,
+          n_block,
+          block_mean,
+          block_m2,
+          block.cwiseAbs().colwise().sum().transpose(),
+          block.colwise().minCoeff().transpose(),
+          block.colwise().maxCoeff().transpose());
+  }
+
+  /**
+   * @brief Merges the rows `[row_begin, row_end)` of a sparse matrix into the
+   * statistics
+   *
+   * @tparam T The type of the matrix
+   * @param x The matrix, which must have as many columns as the statistics
+   * @param row_begin First row to add
+   * @param row_end One past the last row to add
+   */
+  template<typename T>
+  void update(const Eigen::SparseMatrixBase<T>& x,
+              const int row_begin,
+              const int row_end)
+  {
+    const int p = x.cols();
+    const int n_block = row_end - row_begin;
+
+    checkDimensions(p, n_block);
+
+    if (n_block == 0) {
+      return;
+    }
+
+    Eigen::VectorXd block_mean(p);
+    Eigen::VectorXd block_m2(p);
+    Eigen::VectorXd block_abs_sum(p);
+    Eigen::VectorXd block_min(p);
+    Eigen::VectorXd block_max(p);
+
+    for (int j = 0; j < p; ++j) {
+      double sum = 0.0;
+      double abs_sum = 0.0;
+      double lo = std::numeric_limits<double>::infinity();
+      double hi = -std::numeric_limits<double>::infinity();
+      int nnz = 0;
+
+      forEachInRows(x, j, row_begin, row_end, [&](int, double value) {
+        sum += value;
+        abs_sum += std::abs(value);
+        lo = std::min(lo, value);
+        hi = std::max(hi, value);
+        nnz++;
+      });
+
+      if (nnz < n_block) {
+        lo = std::min(lo, 0.0);
+        hi = std::max(hi, 0.0);
+      }
+
+      const double mean = sum / n_block;
+      double sum_sq_diff = (n_block - nnz) * mean * mean;
+
+      forEachInRows(x, j, row_begin, row_end, [&](int, double value) {
+        sum_sq_diff += (value - mean) * (value - mean);
+      });
+
+      block_mean(j) = mean;
+      block_m2(j) = sum_sq_diff;
+      block_abs_sum(j) = abs_sum;
+      block_min(j) = lo;
+      block_max(j) = hi;
+    }
+
+    merge(n_block,
+          n_block,
+          block_mean,
+          block_m2,
+          block_abs_sum,
+          block_min,
+          block_max);
+  }
+
+  /**
+   * @brief Merges all rows of a dense matrix into the statistics, with
+   * frequency weights
+   *
+   * @tparam T The type of the matrix
+   * @param x The matrix, which must have as many columns as the statistics
+   * @param w Non-negative weights, one for each row of x
+   */
+  template<typename T>
+  void update(const Eigen::MatrixBase<T>& x, const Eigen::VectorXd& w)
+  {
+    const int p = x.cols();
+
+    checkDimensions(p, x.rows());
+    checkWeights(w, x.rows());
+
+    const double w_block = w.sum();
+
+    if (w_block == 0) {
+      n += x.rows();
+      return;
+    }
+
+    Eigen::VectorXd block_mean = x.transpose() * w / w_block;
+    Eigen::VectorXd block_m2(p);
+    Eigen::VectorXd block_min(p);
+    Eigen::VectorXd block_max(p);
+
+    const auto included = w.array() > 0;
+    const double inf = std::numeric_limits<double>::infinity();
+
+    for (int j = 0; j < p; ++j) {
+      block_m2(j) =
+        (w.array() * (x.col(j).array() - block_mean(j)).square()).sum();
+      block_min(j) = included.select(x.col(j).array(), inf).minCoeff();
+      block_max(j) = included.select(x.col(j).array(), -inf).maxCoeff();
+    }
+
+    merge(x.rows(),
+          w_block,
+          block_mean,
+          block_m2,
+          x.cwiseAbs().transpose() * w,
+          block_min,
+          block_max);
+  }
+
+  /**
+   * @brief Merges all rows of a sparse matrix into the statistics, with
+   * frequency weights
+   *
+   * @tparam T The type of the matrix
+   * @param x The matrix, which must have as many columns as the statistics
+   * @param w Non-negative weights, one for each row of x
+   */
+  template<typename T>
+  void update(const Eigen::SparseMatrixBase<T>& x, const Eigen::VectorXd& w)
+  {
+    const int n_block = x.rows();
+    const int p = x.cols();
+
+    checkDimensions(p, n_block);
+    checkWeights(w, n_block);
+
+    const double w_block = w.sum();
+
+    if (w_block == 0) {
+      n += n_block;
+      return;
+    }
+
+    const int n_included = (w.array() > 0).count();
+
+    Eigen::VectorXd block_mean(p);
+    Eigen::VectorXd block_m2(p);
+    Eigen::VectorXd block_abs_sum(p);
+    Eigen::VectorXd block_min(p);
+    Eigen::VectorXd block_max(p);
+
+    for (int j = 0; j < p; ++j) {
+      double sum = 0.0;
+      double abs_sum = 0.0;
+      double w_nnz = 0.0;
+      double lo = std::numeric_limits<double>::infinity();
+      double hi = -std::numeric_limits<double>::infinity();
+      int nnz_included = 0;
+
+      forEachInRows(x, j, 0, n_block, [&](int i, double value) {
+        sum += w(i) * value;
+        abs_sum += w(i) * std::abs(value);
+        w_nnz += w(i);
+
+        if (w(i) > 0) {
+          lo = std::min(lo, value);
+          hi = std::max(hi, value);
+          nnz_included++;
+        }
+      });
+
+      if (nnz_included < n_included) {
+        lo = std::min(lo, 0.0);
+        hi = std::max(hi, 0.0);
+      }
+
+      const double mean = sum / w_block;
+      double sum_sq_diff = (w_block - w_nnz) * mean * mean;
+
+      forEachInRows(x, j, 0, n_block, [&](int i, double value) {
+        sum_sq_diff += w(i) * (value - mean) * (value - mean);
+      });
+
+      block_mean(j) = mean;
+      block_m2(j) = sum_sq_diff;
+      block_abs_sum(j) = abs_sum;
+      block_min(j) = lo;
+      block_max(j) = hi;
+    }
+
+    merge(n_block,
+          w_block,
+          block_mean,
+          block_m2,
+          block_abs_sum,
+          block_min,
+          block_max);
+  }
+
+  /**
+   * @brief Merges all rows of a matrix into the statistics
+   *
+   * @tparam T The type of the matrix
+   * @param x The matrix
+   */
+  template<typename T>
+  void update(const T& x)
+  {
+    update(x, 0, x.rows());
+  }
+
+  /**
+   * @brief Removes rows from the statistics
+   *
+   * The reverse of merging the rows into the statistics, so that the
+   * statistics of a subset of the rows can be obtained from those of all
+   * rows at the cost of the removed rows only. The minima and maxima cannot
+   * be recovered this way, so that centers and scales that depend on them
+   * are unavailable afterwards (see hasExtrema()).
+   *
+   * @param block Statistics of the rows to remove, which must be a subset of
+   *   the rows in these statistics, with no more than the same weights
+   */
+  void remove(const ColumnStatistics& block);
+
+  /**
+   * @brief Removes the rows of a matrix from the statistics
+   *
+   * @tparam T The type of the matrix
+   * @param x The rows to remove, as a matrix with as many columns as the
+   *   statistics
+   * @see remove(const ColumnStatistics&)
+   */
+  template<typename T>
+  void remove(const T& x)
+  {
+    ColumnStatistics block(x.cols());
+    block.update(x);
+    remove(block);
+  }
+
+  /**
+   * @brief Computes column centers from the statistics
+   *
+   * @param x_centers Vector to store the centers in. For "manual" centering,
+   *   it must already hold the centers, which are validated.
+   * @param type Type of centering, as in computeCenters()
+   */
+  void centers(Eigen::VectorXd& x_centers, const std::string& type) const;
+
+  /**
+   * @brief Computes column scales from the statistics
+   *
+   * @param x_scales Vector to store the scales in. For "manual" scaling,
+   *   it must already hold the scales, which are validated.
+   * @param type Type of scaling, as in computeScales()
+   */
+  void scales(Eigen::VectorXd& x_scales, const std::string& type) const;
+
+  /// Number of rows seen so far
+  int rows() const { return n; }
+
+  /// Number of columns
+  int cols() const { return mean.size(); }
+
+  /// Column means
+  const Eigen::VectorXd& getMeans() const { return mean; }
+
+  /// Total weight of the rows seen so far, which is the number of rows
+  /// unless weights have been used
+  double weight() const { return w_sum; }
+
+  /// Column sums, weighted if weights have been used
+  Eigen::VectorXd getSums() const { return w_sum * mean; }
+
+  /// Column sums of squared deviations from the means
+  const Eigen::VectorXd& getM2() const { return m2; }
+
+  /// Column sums of absolute values
+  const Eigen::VectorXd& getAbsSums() const { return abs_sum; }
+
+  /// Column minima
+  const Eigen::VectorXd& getMinima() const { return min; }
+
+  /// Column maxima
+  const Eigen::VectorXd& getMaxima() const { return max; }
+
+  /// Whether the column minima and maxima are known, which they are not
+  /// after rows have been removed
+  bool hasExtrema() const { return has_extrema; }
+
+private:
+  void checkDimensions(const int p, const int n_block) const;
+
+  static void checkWeights(const Eigen::VectorXd& w, const int n_block);
+
+  void checkExtrema() const;
+
+  void merge(const int n_block,
+             const double w_block,
+             const Eigen::VectorXd& block_mean,
+             const Eigen::VectorXd& block_m2,
+             const Eigen::VectorXd& block_abs_sum,
+             const Eigen::VectorXd& block_min,
+             const Eigen::VectorXd& block_max);
+
+  int n = 0;
+  double w_sum = 0.0;
+  Eigen::VectorXd mean;
+  Eigen::VectorXd m2;
+  Eigen::VectorXd abs_sum;
+  Eigen::VectorXd min;
+  Eigen::VectorXd max;
+  bool has_extrema = true;
+};
+
+} // namespace slope
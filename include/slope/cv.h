@@ -14,12 +14,14 @@
 #include "folds.h"
 #include "score.h"
 #include "slope.h"
+#include "task_queue.h"
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <mutex>
 #include <vector>
 
-#ifdef _OPENMP
-#include <omp.h>
-#endif
-
 namespace slope {
 
 using slope::all;
@@ -34,7 +36,8 @@ struct GridResult
 {
   /// Matrix of evaluation scores indexed by (fold, alpha) where each row
   /// represents a fold and each column represents an alpha value
-  /// (regularization weight)
+  /// (regularization weight). Alphas that a fold skipped, because its path
+  /// stopped early, have NaN scores.
   Eigen::MatrixXd score;
 
   /// Map of hyperparameter names to their values for the configuration
@@ -43,7 +46,8 @@ struct GridResult
   /// Array of regularization parameters used in the regularization path
   Eigen::ArrayXd alphas;
 
-  /// Array of scores averaged across all folds for each alpha value
+  /// Array of scores averaged across all folds for each alpha value, NaN for
+  /// alphas that some fold skipped
   Eigen::ArrayXd mean_scores;
 
   /// Array of standard errors of the scores across folds for each alpha value,
@@ -100,9 +104,26 @@ struct CvConfig
   /// Seed for random number generator to ensure reproducibility (default: 42)
   uint64_t random_seed = 42;
 
-  /// Whether to copy the design matrix for each fold (default: true)
+  /// Whether to copy the design matrix for each fold (default: true). If
+  /// false, each fold is fit to the full design matrix, with zero weights for
+  /// the observations outside the training set.
   bool copy_x = true;
 
+  /// Whether to cut the alpha grid off once the mean test scores have
+  /// clearly passed their best values (default: false). The mean scores have
+  /// deteriorated at an alpha when, for every value of gamma, the mean score
+  /// there is worse than the best one at a larger alpha by more than the
+  /// standard error at the best one plus `early_stopping_margin` times the
+  /// best score. The grid is cut off after the first such alpha, which is
+  /// decided from the scores of all folds and so does not depend on the order
+  /// in which they are fit. The folds and the path on the full data stop as
+  /// soon as the cutoff is known, which saves the most when the folds are fit
+  /// in parallel.
+  bool early_stopping = false;
+
+  /// Margin for early stopping, relative to the best score (default: 0.05)
+  double early_stopping_margin = 0.05;
+
   /// Map of hyperparameter names to vectors of values to evaluate
   std::map<std::string, std::vector<double>> hyperparams;
 
@@ -124,98 +145,431 @@ createGrid(const std::map<std::string, std::vector<double>>& param_values);
 void
 findBestParameters(CvResult& cv_result, const std::unique_ptr<Score>& scorer);
 
-template<typename T>
-Eigen::ArrayXd
-fitToFold(Eigen::MatrixBase<T>& x,
-          const Eigen::MatrixXd& y,
-          const Folds& folds,
-          const std::unique_ptr<Loss>& loss,
-          const std::unique_ptr<Score>& scorer,
-          const Eigen::ArrayXd& alphas,
-          Slope& thread_model,
-          const int fold,
-          const int rep,
-          const double gamma = 0.0,
-          const bool copy_x = true)
+/**
+ * @brief Progress of the path on the full data, shared with the fold tasks
+ *
+ * The path on the full data decides how many steps of the alpha grid are
+ * used, which is only known once it has stopped. Fold paths trail it, so
+ * that they never fit steps that the full path does not reach. With early
+ * stopping, the grid may also be cut off before the full path stops, which
+ * stops the full path and the folds alike.
+ */
+class PathProgress
 {
-  Eigen::ArrayXd scores = Eigen::ArrayXd::Zero(alphas.size());
+public:
+  /// Records a step of the full path
+  void addStep()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    steps++;
+    changed.notify_all();
+  }
 
-  if (copy_x) {
-    thread_model.setModifyX(true);
+  /// Records that the full path has stopped
+  void finish()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+    changed.notify_all();
+  }
 
-    auto [x_train, y_train, x_test, y_test] = folds.split(x, y, fold, rep);
+  /// Cuts the grid off after its first `n_steps` steps
+  void cutOff(const int n_steps)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    cutoff = std::min(cutoff, n_steps);
+    changed.notify_all();
+  }
+
+  /// Whether the grid has been cut off before step `step`
+  bool isCutOff(const int step)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return step >= cutoff;
+  }
+
+  /// Waits until it is known whether step `step` is used and returns whether
+  /// it is
+  bool reaches(const int step)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&] { return done || step < steps || step >= cutoff; });
+
+    return step < steps && step < cutoff;
+  }
+
+  /// The number of steps of the grid that are used, once the full path has
+  /// stopped
+  int size()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::min(steps, cutoff);
+  }
+
+private:
+  std::mutex mutex;
+  std::condition_variable changed;
+  int steps = 0;
+  bool done = false;
+  int cutoff = std::numeric_limits<int>::max();
+};
+
+/**
+ * @brief The hyperparameter grid of cross-validation, grouped by q
+ *
+ * All grid points with the same q share the same path, since gamma only
+ * blends the relaxed and the penalized fits of that path (see
+ * Slope::blendRelaxed()).
+ */
+struct QGroup
+{
+  Slope model;                    ///< Model with this value of q
+  Eigen::ArrayXd alphas;          ///< Alpha grid
+  std::vector<int> grid_points;   ///< Indices of the grid points with this q
+  bool relax = false;             ///< Whether any of the grid points relaxes
+  PathProgress progress;          ///< Progress of the path on the full data
+  std::mutex mutex;               ///< Guards the scores, n_scored, and
+                                  ///< best_steps
+  std::vector<int> n_scored;      ///< Number of folds that have scored each
+                                  ///< step, with early stopping
+  std::vector<int> best_steps;    ///< Step with the best mean score among the
+                                  ///< steps scored by all folds, for each grid
+                                  ///< point, see hasDeteriorated()
+};
 
-    auto path = thread_model.path(x_train, y_train, alphas);
+/**
+ * @brief What the fold tasks of cross-validation share
+ */
+struct CvContext
+{
+  /// Constructs a context with empty groups and grid points
+  CvContext(const int n_groups, const int n_grid)
+    : groups(n_groups)
+    , gammas(n_grid)
+    , scores(n_grid)
+  {
+  }
 
-    if (gamma > 0) {
-      path = thread_model.relax(path, x_train, y_train, gamma);
+  std::vector<QGroup> groups;          ///< The grid, grouped by q, in order
+  std::vector<double> gammas;          ///< Value of gamma of each grid point
+  std::unique_ptr<Loss> loss;          ///< Loss, for the scorer
+  std::unique_ptr<Score> scorer;       ///< Scorer of the test sets
+  std::vector<Eigen::MatrixXd> scores; ///< Scores of each grid point, indexed
+                                       ///< by (fold, alpha), NaN if not fit
+  bool early_stopping = false;         ///< See CvConfig::early_stopping
+  double early_stopping_margin = 0.0;  ///< See CvConfig::early_stopping
+  bool downdate_stats = false;         ///< Whether the training sets are
+                                       ///< normalized from x_stats
+  ColumnStatistics x_stats;            ///< Column statistics of the full data
+};
+
+/**
+ * @brief Computes the centers and scales of a training set from the column
+ * statistics of the full data
+ *
+ * The statistics of the training set are those of the full data with the
+ * rows that are not in the training set, usually the test set, removed (see
+ * ColumnStatistics::remove()). This costs as much as one pass over the test
+ * set instead of one over the training set. Only valid if
+ * CvContext::downdate_stats is set.
+ *
+ * @param context Shared state of cross-validation
+ * @param x The full design matrix
+ * @param x_test The rows of x in the test set
+ * @param train_idx Indices of the rows of x in the training set
+ * @param test_idx Indices of the rows of x in the test set
+ * @param x_centers Set to the centers of the training set, unless the model
+ *   does not center
+ * @param x_scales Set to the scales of the training set, unless the model
+ *   does not scale
+ * @return false, and leaves the centers and scales alone, if a row appears
+ *   more than once in the training set, true otherwise
+ */
+template<typename T, typename U>
+bool
+trainingNormalization(const CvContext& context,
+                      const T& x,
+                      const U& x_test,
+                      const std::vector<int>& train_idx,
+                      const std::vector<int>& test_idx,
+                      Eigen::VectorXd& x_centers,
+                      Eigen::VectorXd& x_scales)
+{
+  std::vector<int> count(x.rows(), 0);
+
+  for (int i : train_idx) {
+    if (count[i]++ > 0) {
+      return false;
     }
+  }
 
-    for (int j = 0; j < path.size(); ++j) {
-      auto eta = path(j).predict(x_test, "linear");
-      scores(j) = scorer->eval(eta, y_test, loss);
+  std::vector<int> removed;
+
+  for (int i = 0; i < x.rows(); ++i) {
+    if (count[i] == 0) {
+      removed.emplace_back(i);
     }
+  }
+
+  std::vector<int> test_sorted = test_idx;
+  std::sort(test_sorted.begin(), test_sorted.end());
 
+  ColumnStatistics train_stats = context.x_stats;
+
+  if (test_sorted == removed) {
+    train_stats.remove(x_test);
   } else {
-    thread_model.setModifyX(false);
+    // User-defined folds that do not partition the rows
+    train_stats.remove(subset(x, removed));
+  }
 
-    auto train_idx = folds.getTrainingIndices(fold, rep);
-    auto test_idx = folds.getTestIndices(fold, rep);
+  const Slope& model = context.groups.front().model;
 
-    // Create views
-    auto x_train = x(train_idx, all);
-    auto x_test = x(test_idx, all);
+  normalize(train_stats,
+            x_centers,
+            x_scales,
+            model.getCenteringType(),
+            model.getScalingType());
 
-    Eigen::MatrixXd y_train = y(train_idx, all);
-    Eigen::MatrixXd y_test = y(test_idx, all);
+  return true;
+}
 
-    auto path = thread_model.path(x_train, y_train, alphas);
+/**
+ * @brief Whether the mean test scores have deteriorated past their best
+ *
+ * Must be called with the mutex of the group held, once every fold has
+ * scored step `step`, and for the steps in order. Updates the best steps of
+ * the group.
+ *
+ * @param context Shared state of cross-validation
+ * @param group The group of the grid points
+ * @param step The step that every fold has scored
+ * @return Whether, for every grid point of the group, the mean score at
+ *   `step` is worse than the best one by more than the standard error at the
+ *   best one plus a margin relative to it
+ */
+bool
+hasDeteriorated(const CvContext& context, QGroup& group, const int step);
+
+/**
+ * @brief Fits paths to the training set of a fold, one for each q, and
+ * scores them on the test set
+ *
+ * The paths are fit in the order of the groups, each warm started from the
+ * one before, which is close to it when the values of q are close. Each fit
+ * is relaxed at most once, and then blended for every value of gamma.
+ *
+ * Without early stopping, each path is predicted and scored for all its steps
+ * at once (see SlopePath::predict() and Score::evalPath()). With early
+ * stopping, the fits are scored as they are fit, and the last fold to score a
+ * step decides whether the grid is cut off after it (see hasDeteriorated()).
+ *
+ * @param context Shared state of cross-validation
+ * @param weights Observation weights for x_train, or an empty vector
+ * @param modify_x Whether x_train may be normalized in place
+ * @param x_centers Centers of the training set, used instead of the model's
+ *   centering if not empty (see trainingNormalization())
+ * @param x_scales Scales of the training set, used instead of the model's
+ *   scaling if not empty
+ * @param keep_going If not empty, called with the index of the group and the
+ *   number of steps fit so far after each step of a path, which is stopped if
+ *   it returns false
+ * @param eval Index of the fold and repeat, which is the row of the scores to
+ *   fill in
+ */
+template<typename T, typename U>
+void
+scoreFold(CvContext& context,
+          T& x_train,
+          const Eigen::MatrixXd& y_train,
+          const Eigen::VectorXd& weights,
+          U& x_test,
+          const Eigen::MatrixXd& y_test,
+          const bool modify_x,
+          const Eigen::VectorXd& x_centers,
+          const Eigen::VectorXd& x_scales,
+          const std::function<bool(int, int)>& keep_going,
+          const int eval)
+{
+  SlopePath previous;
 
-    if (gamma > 0) {
-      path = thread_model.relax(path, x_train, y_train, gamma);
+  for (int a = 0; a < static_cast<int>(context.groups.size()); ++a) {
+    QGroup& group = context.groups[a];
+
+    Slope thread_model = group.model;
+    thread_model.setModifyX(modify_x);
+
+    if (x_centers.size() > 0) {
+      thread_model.setCentering(x_centers);
     }
+    if (x_scales.size() > 0) {
+      thread_model.setScaling(x_scales);
+    }
+
+    SlopePath path;
+    SlopePath relaxed_path;
+    SlopeFit relaxed;
 
-    for (int j = 0; j < path.size(); ++j) {
-      auto eta = path(j).predict(x_test, "linear");
-      scores(j) = scorer->eval(eta, y_test, loss);
+    auto score = [&](const SlopeFit& fit) {
+      path.addFit(fit);
+
+      const int step = path.size() - 1;
+
+      if (group.relax) {
+        // Warm started from the relaxed fit of the previous step
+        Eigen::VectorXd beta0, beta;
+
+        if (step > 0) {
+          beta0 = relaxed.getIntercepts(false);
+          beta = Eigen::MatrixXd(relaxed.getCoefs(false)).reshaped();
+        }
+
+        relaxed =
+          thread_model.relax(fit, x_train, y_train, 0.0, beta0, beta, weights);
+        relaxed_path.addFit(relaxed);
+      }
+
+      if (!context.early_stopping) {
+        // Scored for the whole path at once, below
+        return !keep_going || keep_going(a, path.size());
+      }
+
+      std::vector<double> step_scores;
+
+      for (int g : group.grid_points) {
+        const double gamma = context.gammas[g];
+        auto eta = gamma > 0 ? Slope::blendRelaxed(fit, relaxed, gamma)
+                                 .predict(x_test, "linear")
+                             : fit.predict(x_test, "linear");
+
+        step_scores.emplace_back(
+          context.scorer->eval(eta, y_test, context.loss));
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(group.mutex);
+
+        for (size_t k = 0; k < group.grid_points.size(); ++k) {
+          context.scores[group.grid_points[k]](eval, step) = step_scores[k];
+        }
+
+        const int n_evals = context.scores[group.grid_points.front()].rows();
+
+        if (++group.n_scored[step] == n_evals &&
+            hasDeteriorated(context, group, step)) {
+          group.progress.cutOff(step + 1);
+        }
+      }
+
+      return !keep_going || keep_going(a, path.size());
+    };
+
+    thread_model.path(x_train, y_train, weights, previous, score, group.alphas);
+
+    if (!context.early_stopping && path.size() > 0) {
+      for (int g : group.grid_points) {
+        const double gamma = context.gammas[g];
+        auto eta = gamma > 0 ? Slope::blendRelaxed(path, relaxed_path, gamma)
+                                 .predict(x_test, "linear")
+                             : path.predict(x_test, "linear");
+
+        Eigen::VectorXd path_scores =
+          context.scorer->evalPath(eta, y_test, context.loss);
+
+        std::lock_guard<std::mutex> lock(group.mutex);
+        context.scores[g].row(eval).head(path.size()) = path_scores;
+      }
     }
-  }
 
-  return scores;
+    previous = std::move(path);
+  }
 }
 
+/**
+ * @brief Fits and scores a fold
+ *
+ * If `copy_x` is true, the training and test sets are copied out of x.
+ * Otherwise, the model is fit to the full design matrix, with unit weights
+ * for the training observations and zero weights for the rest, which gives
+ * the same path (including normalization) as fitting to the training rows
+ * only, and only the test rows are extracted, for prediction.
+ *
+ * In both cases, the centers and scales of the training set are derived from
+ * the statistics of the full data if possible (see trainingNormalization()).
+ *
+ * @see scoreFold()
+ */
 template<typename T>
-Eigen::ArrayXd
-fitToFold(Eigen::SparseMatrixBase<T>& x,
+void
+fitToFold(T& x,
           const Eigen::MatrixXd& y,
           const Folds& folds,
-          const std::unique_ptr<Loss>& loss,
-          const std::unique_ptr<Score>& scorer,
-          const Eigen::ArrayXd& alphas,
-          Slope& thread_model,
+          CvContext& context,
           const int fold,
           const int rep,
-          const double gamma = 0.0,
-          const bool copy_x = true)
+          const bool copy_x,
+          const std::function<bool(int, int)>& keep_going)
 {
-  thread_model.setModifyX(true);
+  const int eval = rep * folds.numFolds() + fold;
+
+  const auto train_idx = folds.getTrainingIndices(fold, rep);
+  const auto& test_idx = folds.getTestIndices(fold, rep);
+
+  Eigen::VectorXd x_centers, x_scales;
+
+  if (copy_x) {
+    auto [x_train, y_train, x_test, y_test] = folds.split(x, y, fold, rep);
+
+    if (context.downdate_stats) {
+      trainingNormalization(
+        context, x, x_test, train_idx, test_idx, x_centers, x_scales);
+    }
 
-  auto [x_train, y_train, x_test, y_test] = folds.split(x, y, fold, rep);
+    // Normalizing in place is only safe if x_train is used for a single path
+    // and no relaxed fits
+    const bool modify_x =
+      context.groups.size() == 1 && !context.groups.front().relax;
+
+    scoreFold(context,
+              x_train,
+              y_train,
+              Eigen::VectorXd(),
+              x_test,
+              y_test,
+              modify_x,
+              x_centers,
+              x_scales,
+              keep_going,
+              eval);
+
+    return;
+  }
 
-  auto path = thread_model.path(x_train, y_train, alphas);
+  Eigen::VectorXd train_mask = Eigen::VectorXd::Zero(x.rows());
 
-  if (gamma > 0) {
-    path = thread_model.relax(path, x_train, y_train, gamma);
+  for (int i : train_idx) {
+    train_mask(i) = 1.0;
   }
 
-  Eigen::ArrayXd scores = Eigen::ArrayXd::Zero(path.size());
+  auto x_test = subset(x, test_idx);
+  Eigen::MatrixXd y_test = y(test_idx, all);
 
-  for (int j = 0; j < path.size(); ++j) {
-    auto eta = path(j).predict(x_test, "linear");
-    scores(j) = scorer->eval(eta, y_test, loss);
+  if (context.downdate_stats) {
+    trainingNormalization(
+      context, x, x_test, train_idx, test_idx, x_centers, x_scales);
   }
 
-  return scores;
+  scoreFold(context,
+            x,
+            y,
+            train_mask,
+            x_test,
+            y_test,
+            false,
+            x_centers,
+            x_scales,
+            keep_going,
+            eval);
 }
 
 } // namespace detail
@@ -241,7 +595,10 @@ fitToFold(Eigen::SparseMatrixBase<T>& x,
  * 3. Computes the specified evaluation metric for each regularization parameter
  * 4. Averages results across folds to select optimal hyperparameters
  *
- * The function supports parallel processing with OpenMP when available.
+ * Within a fold, the paths for the values of q are fit in increasing order of
+ * q, each warm started from the one before, and relaxed at most once for all
+ * values of gamma. The folds and repeats are run in parallel from a single
+ * task queue (see TaskQueue), with OpenMP when available.
  */
 template<typename T>
 CvResult
@@ -257,7 +614,6 @@ crossValidate(Slope model,
   auto loss = setupLoss(model.getLossType());
 
   auto y = loss->preprocessResponse(y_in);
-  auto scorer = Score::create(config.metric);
 
   auto hyperparams = config.default_hyperparams;
 
@@ -275,93 +631,186 @@ crossValidate(Slope model,
       : Folds(n, config.n_folds, config.n_repeats, config.random_seed);
 
   int n_evals = folds.numEvals();
+  const int n_grid = grid.size();
+
+  // Group the grid points by q, in order of q, so that the path for one q
+  // can warm start the path for the next
+  std::vector<double> qs;
 
   for (const auto& params : grid) {
-    GridResult result;
-    result.params = params;
+    qs.emplace_back(params.at("q"));
+  }
 
-    double q = params.at("q");
-    double gamma = params.at("gamma");
+  std::sort(qs.begin(), qs.end());
+  qs.erase(std::unique(qs.begin(), qs.end()), qs.end());
 
-    model.setQ(q);
+  const int n_groups = qs.size();
 
-    auto initial_path = model.path(x, y);
+  detail::CvContext context(n_groups, n_grid);
 
-    result.alphas = initial_path.getAlpha();
-    int n_alpha = result.alphas.size();
+  context.loss = std::move(loss);
+  context.scorer = Score::create(config.metric);
+  context.early_stopping = config.early_stopping;
+  context.early_stopping_margin = config.early_stopping_margin;
 
-    assert((result.alphas > 0).all());
+  // The column statistics of the training sets are derived from those of the
+  // full data, unless the normalization depends on the minima or maxima,
+  // which cannot be derived this way, or is given
+  const std::string& centering_type = model.getCenteringType();
+  const std::string& scaling_type = model.getScalingType();
 
-    Eigen::MatrixXd scores = Eigen::MatrixXd::Zero(n_evals, n_alpha);
+  context.downdate_stats =
+    usesColumnStatistics(centering_type, scaling_type) &&
+    (centering_type == "mean" || centering_type == "none") &&
+    (scaling_type == "sd" || scaling_type == "l1" || scaling_type == "l2" ||
+     scaling_type == "none");
 
-#ifdef _OPENMP
-    Eigen::setNbThreads(1);
-#endif
+  if (context.downdate_stats) {
+    context.x_stats = ColumnStatistics(x.cols());
+    context.x_stats.update(x.derived());
+  }
 
-    // Thread-safety for exceptions
-    std::vector<std::string> thread_errors(n_evals);
-    bool had_exception = false;
+  auto& groups = context.groups;
+  auto& gammas = context.gammas;
+  auto& scores = context.scores;
 
-#ifdef _OPENMP
-    omp_set_max_active_levels(1);
-#pragma omp parallel for num_threads(Threads::get())                           \
-  shared(scores, thread_errors, had_exception)
-#endif
-    for (int i = 0; i < n_evals; ++i) {
-      try {
-        auto [rep, fold] = std::div(i, folds.numFolds());
-
-        Slope thread_model = model;
-
-        scores.row(i) = detail::fitToFold(x.derived(),
-                                          y,
-                                          folds,
-                                          loss,
-                                          scorer,
-                                          result.alphas,
-                                          thread_model,
-                                          fold,
-                                          rep,
-                                          gamma,
-                                          config.copy_x);
-
-      } catch (const std::exception& e) {
-        thread_errors[i] = e.what();
+  for (int a = 0; a < n_groups; ++a) {
+    groups[a].model = model;
+    groups[a].model.setQ(qs[a]);
+
+    // Only the alpha grid is needed to start fitting the folds. The path on
+    // the full data, which decides where the grid is cut off by the path
+    // stopping rules, is fit as one more task alongside the folds.
+    groups[a].alphas = groups[a].model.alphaGrid(x, y);
+    groups[a].n_scored.assign(groups[a].alphas.size(), 0);
+
+    assert((groups[a].alphas > 0).all());
+  }
+
+  std::vector<GridResult> results(n_grid);
+  std::vector<int> group_of(n_grid);
+
+  for (int g = 0; g < n_grid; ++g) {
+    const int a = std::lower_bound(qs.begin(), qs.end(), grid[g].at("q")) -
+                  qs.begin();
+
+    group_of[g] = a;
+    gammas[g] = grid[g].at("gamma");
+    groups[a].grid_points.emplace_back(g);
+    groups[a].best_steps.emplace_back(0);
+    groups[a].relax = groups[a].relax || gammas[g] > 0;
+
+    results[g].params = grid[g];
+    scores[g] = Eigen::MatrixXd::Constant(
+      n_evals,
+      groups[a].alphas.size(),
+      std::numeric_limits<double>::quiet_NaN());
+  }
+
+  // The folds, and the paths on the full data, share a single queue. The
+  // full-data paths go first, since fold paths trail them, and the folds
+  // follow in order of decreasing size of the training set.
+  const int n_tasks = n_evals + 1;
+  std::vector<double> costs(n_tasks);
+
+  costs[0] = std::numeric_limits<double>::infinity();
+
+  for (int i = 1; i < n_tasks; ++i) {
+    auto [rep, fold] = std::div(i - 1, folds.numFolds());
+    costs[i] = folds.getTrainingIndices(fold, rep).size();
+  }
+
+  ThreadSettingsGuard thread_settings;
+  TaskQueue queue(Threads::get());
+
+  // Thread-safety for exceptions
+  std::vector<std::string> thread_errors(n_tasks);
+  bool had_exception = false;
+
+  queue.run(TaskQueue::longestFirst(costs), [&](const int i) {
+    try {
+      if (i == 0) {
+        SlopePath previous;
+
+        for (auto& group : groups) {
+          Slope thread_model = group.model;
+          SlopePath path;
+
+          thread_model.path(x,
+                            y,
+                            Eigen::VectorXd(),
+                            previous,
+                            [&](const SlopeFit& fit) {
+                              queue.shareIdleThreads();
+                              path.addFit(fit);
+                              group.progress.addStep();
+                              return !group.progress.isCutOff(path.size());
+                            });
+
+          group.progress.finish();
+          previous = std::move(path);
+        }
+      } else {
+        auto [rep, fold] = std::div(i - 1, folds.numFolds());
+
+        auto keep_going = [&queue, &groups](int a, int steps) {
+          queue.shareIdleThreads();
+          return groups[a].progress.reaches(steps);
+        };
+
+        detail::fitToFold(
+          x.derived(), y, folds, context, fold, rep, config.copy_x, keep_going);
+      }
+    } catch (const std::exception& e) {
+      thread_errors[i] = e.what();
 #ifdef _OPENMP
 #pragma omp atomic write
 #endif
-        had_exception = true;
-      } catch (...) {
-        thread_errors[i] = "Unknown exception";
+      had_exception = true;
+    } catch (...) {
+      thread_errors[i] = "Unknown exception";
 #ifdef _OPENMP
 #pragma omp atomic write
 #endif
-        had_exception = true;
-      }
+      had_exception = true;
     }
 
-    if (had_exception) {
-      std::string error_message = "Exception(s) during cross-validation:\n";
-      for (int i = 0; i < n_evals; ++i) {
-        if (!thread_errors[i].empty()) {
-          error_message +=
-            "Fold " + std::to_string(i) + ": " + thread_errors[i] + "\n";
-        }
+    if (i == 0) {
+      // Also if the full paths failed, to release the waiting folds
+      for (auto& group : groups) {
+        group.progress.finish();
+      }
+    }
+  });
+
+  if (had_exception) {
+    std::string error_message = "Exception(s) during cross-validation:\n";
+    for (int i = 0; i < n_tasks; ++i) {
+      if (!thread_errors[i].empty()) {
+        std::string task =
+          i == 0 ? "Full data" : "Fold " + std::to_string(i - 1);
+        error_message += task + ": " + thread_errors[i] + "\n";
       }
-      throw std::runtime_error(error_message);
     }
+    throw std::runtime_error(error_message);
+  }
 
-    result.mean_scores = scores.colwise().mean();
-    result.std_errors = stdDevs(scores).array() / std::sqrt(n_evals);
-    result.score = std::move(scores);
-    cv_result.results.push_back(result);
+  for (int g = 0; g < n_grid; ++g) {
+    GridResult& result = results[g];
+    detail::QGroup& group = groups[group_of[g]];
+
+    const int n_alpha = group.progress.size();
+    result.alphas = group.alphas.head(n_alpha);
+    scores[g].conservativeResize(Eigen::NoChange, n_alpha);
+
+    result.mean_scores = scores[g].colwise().mean();
+    result.std_errors = stdDevs(scores[g]).array() / std::sqrt(n_evals);
+    result.score = std::move(scores[g]);
   }
 
-#ifdef _OPENMP
-  Eigen::setNbThreads(0);
-#endif
+  cv_result.results = std::move(results);
 
-  detail::findBestParameters(cv_result, scorer);
+  detail::findBestParameters(cv_result, context.scorer);
 
   return cv_result;
 }
@@ -0,0 +1,285 @@
+/**
+ * @file
+ * @brief Design matrices that store duplicated columns once
+ */
+
+#pragma once
+
+#include "clusters.h"
+#include "column_statistics.h"
+#include "jit_normalization.h"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace slope {
+class DeduplicatedMatrix;
+}
+
+namespace Eigen {
+namespace internal {
+
+/// Lets DeduplicatedMatrix pass as an Eigen::EigenBase, like Eigen's own
+/// matrix-free operators
+template<>
+struct traits<slope::DeduplicatedMatrix>
+  : public Eigen::internal::traits<Eigen::SparseMatrix<double>>
+{};
+
+} // namespace internal
+} // namespace Eigen
+
+namespace slope {
+
+/**
+ * @brief A design matrix in which copies of a column are stored once
+ *
+ * High-dimensional designs often contain columns that are duplicates of each
+ * other, up to sign, or that become duplicates once they are centered and
+ * scaled, such as a feature that is stored in two different units. This
+ * matrix finds every column \f$x_j\f$ that is an affine function
+ * \f[
+ *   x_j = a_j u_{r(j)} + b_j
+ * \f]
+ * of a column \f$u_{r(j)}\f$ that it has already seen, by hashing the
+ * centered and scaled columns and verifying the candidates, and stores only
+ * the distinct columns \f$u\f$ along with \f$r(j)\f$, \f$a_j\f$, and
+ * \f$b_j\f$. The kernels compute each product with a distinct column once
+ * and share it between all of its copies, and combine the coefficients of
+ * copies before touching the data, so the cost of a fit scales with the
+ * number of distinct columns rather than the number of columns.
+ *
+ * The fit has one coefficient per column, as for the full matrix, and it is
+ * the same fit. The duplicates are not merged into single coefficients with
+ * an adjusted lambda sequence: the penalty of m copies that share a value
+ * depends on the ranks that they take among the other coefficients, which
+ * depend on that value, so no fixed sequence for the merged problem gives
+ * the fit of the full one.
+ *
+ * The matrix can be passed to Slope::path() and SlopeFit::predict() like any
+ * other matrix. As with sparse matrices, it is normalized just-in-time.
+ */
+class DeduplicatedMatrix : public Eigen::EigenBase<DeduplicatedMatrix>
+{
+public:
+  /// Element type
+  using Scalar = double;
+
+  /// Real element type
+  using RealScalar = double;
+
+  /// Index type
+  using StorageIndex = int;
+
+  enum
+  {
+    ColsAtCompileTime = Eigen::Dynamic,
+    MaxColsAtCompileTime = Eigen::Dynamic,
+    IsRowMajor = false
+  };
+
+  /**
+   * @brief Finds the duplicated columns of a matrix
+   *
+   * A column is stored as a copy of an earlier one if its values are
+   * reproduced by the affine function of that column to within `tol` times
+   * its largest absolute value. With the default of zero, only columns that
+   * are reproduced exactly are collapsed, so that fits are the same as
+   * those on `x`; a small positive value also collapses columns that only
+   * match up to rounding, changing them by at most that much. Constant
+   * columns are never collapsed.
+   *
+   * @param x The matrix
+   * @param tol Relative tolerance for the values of a copy
+   * @throws std::invalid_argument If `tol` is negative
+   */
+  explicit DeduplicatedMatrix(const Eigen::MatrixXd& x, const double tol = 0);
+
+  /// Number of rows
+  Eigen::Index rows() const { return distinct.rows(); }
+
+  /// Number of columns
+  Eigen::Index cols() const { return column_map.size(); }
+
+  /// The distinct columns
+  const Eigen::MatrixXd& getDistinct() const { return distinct; }
+
+  /// For each column, the index of the distinct column that it is a copy of
+  const std::vector<int>& getColumnMap() const { return column_map; }
+
+  /// For each distinct column, the number of columns that are copies of it,
+  /// itself included
+  std::vector<int> getMultiplicities() const;
+
+  /// For each column, the factor of the distinct column in the copy
+  const Eigen::VectorXd& getFactors() const { return factors; }
+
+  /// For each column, the offset that is added to the copy
+  const Eigen::VectorXd& getOffsets() const { return offsets; }
+
+  /// Column statistics of the matrix
+  const ColumnStatistics& statistics() const { return x_stats; }
+
+  /**
+   * @brief A column of the matrix
+   *
+   * @param j Index of the column
+   */
+  Eigen::VectorXd col(const Eigen::Index j) const;
+
+  /**
+   * @brief Adds a linear combination of columns to a vector, summing the
+   * weights of the copies of each distinct column first
+   *
+   * @param terms Pairs of column indices and weights
+   * @param out The vector to add to
+   */
+  void addCombination(const std::vector<std::pair<int, double>>& terms,
+                      Eigen::Ref<Eigen::VectorXd> out) const;
+
+  /**
+   * @brief Computes column statistics of the matrix
+   *
+   * @param w Observation weights, or an empty vector for unit weights
+   */
+  ColumnStatistics computeStatistics(const Eigen::VectorXd& w) const;
+
+private:
+  Eigen::MatrixXd distinct;
+  std::vector<int> column_map;
+  Eigen::VectorXd factors;
+  Eigen::VectorXd offsets;
+  ColumnStatistics x_stats;
+};
+
+/**
+ * @brief Computes the linear predictor from a deduplicated matrix
+ *
+ * @see linearPredictor() for dense and sparse matrices
+ */
+Eigen::MatrixXd
+linearPredictor(const DeduplicatedMatrix& x,
+                const std::vector<IndexType>& active_set,
+                const Eigen::VectorXd& beta0,
+                const Eigen::VectorXd& beta,
+                const Eigen::VectorXd& x_centers,
+                const Eigen::VectorXd& x_scales,
+                const JitNormalization jit_normalization,
+                const bool intercept);
+
+/**
+ * @brief Computes the gradient from a deduplicated matrix
+ *
+ * @see updateGradient() for dense and sparse matrices
+ */
+void
+updateGradient(Eigen::VectorXd& gradient,
+               const DeduplicatedMatrix& x,
+               const Eigen::MatrixXd& residual,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const Eigen::VectorXd& w,
+               const JitNormalization jit_normalization);
+
+/**
+ * @brief Offsets the gradient for a deduplicated matrix
+ *
+ * @see offsetGradient() for dense and sparse matrices
+ */
+void
+offsetGradient(Eigen::VectorXd& gradient,
+               const DeduplicatedMatrix& x,
+               const Eigen::VectorXd& offset,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const JitNormalization jit_normalization,
+               const Eigen::VectorXd& w = Eigen::VectorXd());
+
+/**
+ * @brief Computes the gradient and Hessian of a coefficient for coordinate
+ * descent, from a deduplicated matrix
+ *
+ * @see computeGradientAndHessian() for dense and sparse matrices
+ */
+std::pair<double, double>
+computeGradientAndHessian(const DeduplicatedMatrix& x,
+                          const IndexType ind,
+                          const Eigen::MatrixXd& w,
+                          const Eigen::MatrixXd& residual,
+                          const Eigen::VectorXd& x_centers,
+                          const Eigen::VectorXd& x_scales,
+                          const double s,
+                          const JitNormalization jit_normalization,
+                          const int n);
+
+/**
+ * @brief Computes the gradient and Hessian of a cluster for coordinate
+ * descent, from a deduplicated matrix
+ *
+ * Copies of a distinct column in the cluster, which are typically all in
+ * the same cluster, cost as much as one column.
+ *
+ * @see computeClusterGradientAndHessian() for dense and sparse matrices
+ */
+std::pair<double, double>
+computeClusterGradientAndHessian(const DeduplicatedMatrix& x,
+                                 const IndexType c_ind,
+                                 const std::vector<int>& s,
+                                 const Clusters& clusters,
+                                 const Eigen::MatrixXd& w,
+                                 const Eigen::MatrixXd& residual,
+                                 const Eigen::VectorXd& x_centers,
+                                 const Eigen::VectorXd& x_scales,
+                                 const JitNormalization jit_normalization);
+
+/**
+ * @brief Multiplies a deduplicated matrix with a sparse matrix, for instance
+ * to predict from the coefficients of a fit
+ */
+Eigen::MatrixXd
+operator*(const DeduplicatedMatrix& x, const Eigen::SparseMatrix<double>& b);
+
+/**
+ * @brief Computes centers and scales of a deduplicated matrix from its
+ * column statistics
+ *
+ * The matrix is never modified, regardless of `modify_x`.
+ *
+ * @see normalize() for dense and sparse matrices
+ */
+JitNormalization
+normalize(DeduplicatedMatrix& x,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool modify_x);
+
+/**
+ * @brief Computes centers and scales of a deduplicated matrix with
+ * observation weights
+ *
+ * The matrix is never modified, regardless of `modify_x`.
+ *
+ * @see normalize() for dense and sparse matrices
+ */
+JitNormalization
+normalize(DeduplicatedMatrix& x,
+          const Eigen::VectorXd& w,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool modify_x);
+
+/**
+ * @brief Checks a deduplicated matrix for non-finite values
+ */
+bool
+isFinite(const DeduplicatedMatrix& x);
+
+} // namespace slope
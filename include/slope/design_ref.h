@@ -0,0 +1,158 @@
+/**
+ * @file
+ * @brief A reference to a design matrix of any of the supported types
+ */
+
+#pragma once
+
+#include "column_block_matrix.h"
+#include "deduplicated_matrix.h"
+#include "linear_operator.h"
+#include "partitioned_matrix.h"
+#include "pattern_matrix.h"
+#include "quantized_matrix.h"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <variant>
+
+namespace slope {
+
+/**
+ * @brief A non-owning reference to a design matrix
+ *
+ * The solver and screening rule are picked at runtime, but the kernels they
+ * run (linearPredictor(), updateGradient(), and so on) are overloaded on the
+ * type of the design matrix. The virtual functions of SolverBase and
+ * ScreeningRule therefore take a DesignRef, and each implementation calls
+ * visit() once to reach its templated implementation with the concrete type.
+ * A new type of design matrix needs its kernels, an entry in Variant, and
+ * its header included here, and is then supported by every solver and
+ * screening rule.
+ *
+ * Matrices that derive from LinearOperator are referred to as such. Other
+ * dense and sparse Eigen expressions, such as indexed views, are evaluated
+ * into a matrix that the reference owns.
+ */
+class DesignRef
+{
+public:
+  /// Pointers to the supported types of design matrices
+  using Variant = std::variant<const Eigen::MatrixXd*,
+                               const Eigen::SparseMatrix<double>*,
+                               const Eigen::Map<Eigen::MatrixXd>*,
+                               const Eigen::Map<Eigen::SparseMatrix<double>>*,
+                               const QuantizedMatrix<std::uint8_t>*,
+                               const QuantizedMatrix<std::uint16_t>*,
+                               const PatternMatrix*,
+                               const PartitionedMatrix*,
+                               const ColumnBlockMatrix*,
+                               const LinearOperator*,
+                               const DeduplicatedMatrix*>;
+
+  /**
+   * @brief Refers to a design matrix
+   *
+   * @tparam T Type of the matrix, which must be one of the types of Variant
+   *   or derive from LinearOperator
+   * @param x The matrix, which must outlive the reference
+   */
+  template<typename T,
+           std::enable_if_t<std::is_constructible_v<Variant, const T*>,
+                            int> = 0>
+  DesignRef(const T& x)
+    : x(&x)
+  {
+  }
+
+  /**
+   * @brief Refers to a copy of a dense Eigen expression
+   *
+   * @param x The expression, which is evaluated into an Eigen::MatrixXd
+   */
+  template<typename T,
+           std::enable_if_t<!std::is_constructible_v<Variant, const T*>,
+                            int> = 0>
+  DesignRef(const Eigen::MatrixBase<T>& x)
+    : owned(std::make_shared<Eigen::MatrixXd>(x))
+    , x(static_cast<const Eigen::MatrixXd*>(owned.get()))
+  {
+  }
+
+  /**
+   * @brief Refers to a copy of a sparse Eigen expression
+   *
+   * @param x The expression, which is evaluated into a
+   *   Eigen::SparseMatrix<double>
+   */
+  template<typename T,
+           std::enable_if_t<!std::is_constructible_v<Variant, const T*>,
+                            int> = 0>
+  DesignRef(const Eigen::SparseMatrixBase<T>& x)
+    : owned(std::make_shared<Eigen::SparseMatrix<double>>(x))
+    , x(static_cast<const Eigen::SparseMatrix<double>*>(owned.get()))
+  {
+  }
+
+  /**
+   * @brief Calls a function with the matrix, as its concrete type
+   *
+   * @param visitor A callable that accepts a const reference to each of the
+   *   types of Variant
+   * @return What `visitor` returns
+   */
+  template<typename Visitor>
+  decltype(auto) visit(Visitor&& visitor) const
+  {
+    return std::visit(
+      [&visitor](const auto* x) -> decltype(auto) { return visitor(*x); }, x);
+  }
+
+  /**
+   * @brief Calls a function with the matrix, as its concrete type, unless
+   * it is a ColumnBlockMatrix
+   *
+   * For the solvers, which only see the pinned columns of a
+   * ColumnBlockMatrix (see SolverBase::run()).
+   *
+   * @param visitor A callable that accepts a const reference to each of the
+   *   types of Variant except ColumnBlockMatrix
+   * @throws std::invalid_argument If the matrix is a ColumnBlockMatrix
+   */
+  template<typename Visitor>
+  void visitInMemory(Visitor&& visitor) const
+  {
+    visit([&visitor](const auto& x) {
+      using MatrixType = std::decay_t<decltype(x)>;
+
+      if constexpr (std::is_same_v<MatrixType, ColumnBlockMatrix>) {
+        throw std::invalid_argument(
+          "The columns of a ColumnBlockMatrix must be pinned first");
+      } else {
+        visitor(x);
+      }
+    });
+  }
+
+  /**
+   * @brief The matrix, if it is of type T
+   *
+   * @return A pointer to the matrix, or `nullptr` if it is of another type
+   */
+  template<typename T>
+  const T* getIf() const
+  {
+    auto* ptr = std::get_if<const T*>(&x);
+
+    return ptr ? *ptr : nullptr;
+  }
+
+private:
+  std::shared_ptr<const void> owned; ///< Evaluated expression, if any
+  Variant x;                         ///< The matrix
+};
+
+} // namespace slope
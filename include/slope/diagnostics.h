@@ -51,11 +51,11 @@ computeDual(const Eigen::VectorXd& beta,
             const bool intercept)
 {
   int n = x.rows();
-  int pm = beta.size();
+  IndexType pm = beta.size();
 
   Eigen::VectorXd gradient(pm);
 
-  std::vector<int> full_set(pm);
+  std::vector<IndexType> full_set(pm);
   std::iota(full_set.begin(), full_set.end(), 0);
 
   updateGradient(gradient,
@@ -75,9 +75,16 @@ computeDual(const Eigen::VectorXd& beta,
   // TODO: Can we avoid this copy? Maybe revert offset afterwards or,
   // alternatively, solve intercept until convergence and then no longer
   // need the offset at all.
+  const Eigen::VectorXd& w = loss->getWeights();
+
   if (intercept) {
     Eigen::VectorXd theta_mean = theta.colwise().mean();
-    theta.rowwise() -= theta_mean.transpose();
+
+    if (w.size() > 0) {
+      theta -= w * theta_mean.transpose();
+    } else {
+      theta.rowwise() -= theta_mean.transpose();
+    }
 
     offsetGradient(dual_gradient,
                    x,
@@ -85,14 +92,15 @@ computeDual(const Eigen::VectorXd& beta,
                    full_set,
                    x_centers,
                    x_scales,
-                   jit_normalization);
+                   jit_normalization,
+                   w);
   }
 
   // Common scaling operation
   double dual_norm = sl1_norm.dualNorm(dual_gradient, lambda);
   theta.array() /= std::max(1.0, dual_norm);
 
-  double dual = loss->dual(theta, y, Eigen::VectorXd::Ones(n));
+  double dual = loss->dual(theta, y, w);
 
   return dual;
 }
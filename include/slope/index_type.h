@@ -0,0 +1,42 @@
+/**
+ * @file
+ * @brief The integer type of coefficient indices
+ *
+ * Coefficients are indexed as `k * p + j` for feature j of response k, so
+ * multinomial problems with many features can have more coefficients than a
+ * 32-bit integer can index. Building with the CMake option
+ * `SLOPE_64BIT_INDEX`, which defines the macro of the same name for the
+ * library and everything that links to it, makes these indices 64-bit.
+ * Features, responses, and observations are still indexed with `int`.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+namespace slope {
+
+#ifdef SLOPE_64BIT_INDEX
+/// Integer type of coefficient indices, and of sets and clusters of them
+using IndexType = std::int64_t;
+#else
+/// Integer type of coefficient indices, and of sets and clusters of them
+using IndexType = int;
+#endif
+
+/**
+ * @brief Splits the index of a coefficient into its response and feature
+ *
+ * @param ind Index of the coefficient, `k * p + j` for feature j of
+ *   response k
+ * @param p Number of features
+ * @return The pair (k, j)
+ */
+inline std::pair<int, int>
+splitIndex(const IndexType ind, const int p)
+{
+  return { static_cast<int>(ind / p), static_cast<int>(ind % p) };
+}
+
+} // namespace slope
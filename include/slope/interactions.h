@@ -0,0 +1,191 @@
+/**
+ * @file
+ * @brief SLOPE with pairwise interactions that are formed on demand
+ *
+ * With q base features there are q(q - 1)/2 pairwise interactions, which
+ * for large q are far too many to store or even to compute gradients for.
+ * The functions here fit SLOPE to the base features and all of their
+ * interactions while only ever forming the interactions that may enter the
+ * model, which are found by a bound on their gradients that depends on the
+ * base features alone.
+ */
+
+#pragma once
+
+#include "linear_operator.h"
+#include "slope.h"
+#include "slope_path.h"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace slope {
+
+/**
+ * @brief A design of base features and some of their pairwise interactions
+ *
+ * The first columns are the base features, followed by one column for each
+ * pair (i, j), which is the elementwise product of base features i and j.
+ * The products are formed on the fly, one column at a time.
+ *
+ * The base features are referenced, not copied, and must outlive the
+ * matrix.
+ */
+class InteractionMatrix : public LinearOperator
+{
+public:
+  /**
+   * @brief Creates the design
+   *
+   * @param x The base features
+   * @param pairs The interactions to include, as pairs of base features
+   *   (i, j) with i < j
+   * @throws std::invalid_argument If a pair is not valid
+   */
+  InteractionMatrix(const Eigen::MatrixXd& x,
+                    std::vector<std::pair<int, int>> pairs);
+
+  Eigen::Index rows() const override { return x.rows(); }
+
+  Eigen::Index cols() const override { return x.cols() + pairs.size(); }
+
+  double colDot(const int j,
+                const Eigen::Ref<const Eigen::VectorXd>& v) const override;
+
+  void colAxpy(const int j,
+               const double a,
+               Eigen::Ref<Eigen::VectorXd> v) const override;
+
+  double colSquaredNorm(
+    const int j,
+    const Eigen::Ref<const Eigen::VectorXd>& w) const override;
+
+  double colSum(const int j) const override;
+
+  /// The base features
+  const Eigen::MatrixXd& getBase() const { return x; }
+
+  /// The interactions, in the order of their columns
+  const std::vector<std::pair<int, int>>& getPairs() const { return pairs; }
+
+private:
+  const Eigen::MatrixXd& x;
+  std::vector<std::pair<int, int>> pairs;
+};
+
+/**
+ * @brief Finds the interactions whose gradients may exceed a threshold
+ *
+ * By the Cauchy-Schwarz inequality, the interaction of base features i and j
+ * satisfies
+ * \f[
+ *   |(x_i \odot x_j)^T v| \leq \min(\lVert x_i \odot v \rVert_2
+ *   \lVert x_j \rVert_2, \lVert x_j \odot v \rVert_2 \lVert x_i \rVert_2),
+ * \f]
+ * a bound that is a product of statistics of the base features. With these
+ * sorted, the pairs whose bound reaches the threshold are enumerated without
+ * visiting the others, at a cost of \f$O(nq + q \log q)\f$ plus the number
+ * of pairs that are returned.
+ *
+ * @param x The base features
+ * @param v A vector with one element per row, typically a residual
+ * @param threshold The threshold for \f$|(x_i \odot x_j)^T v|\f$
+ * @return The pairs (i, j), with i < j, whose bound reaches the threshold,
+ *   which include all pairs whose value does
+ */
+std::vector<std::pair<int, int>>
+screenInteractions(const Eigen::MatrixXd& x,
+                   const Eigen::VectorXd& v,
+                   const double threshold);
+
+/**
+ * @brief A regularization path of a model with pairwise interactions
+ */
+class InteractionPath
+{
+public:
+  /**
+   * @brief Creates the path
+   *
+   * @param path_in The path that was fit to the design of base features and
+   *   selected interactions
+   * @param n_features_in Number of base features
+   * @param pairs_in The selected interactions, in the order of their columns
+   */
+  InteractionPath(SlopePath path_in,
+                  const int n_features_in,
+                  std::vector<std::pair<int, int>> pairs_in);
+
+  /// Number of fits along the path
+  size_t size() const { return path.size(); }
+
+  /// The path, as fit to the design of the base features followed by the
+  /// interactions in getPairs()
+  const SlopePath& getPath() const { return path; }
+
+  /// The interactions that were formed during fitting, in the order of their
+  /// columns in the design of getPath()
+  const std::vector<std::pair<int, int>>& getPairs() const { return pairs; }
+
+  /**
+   * @brief The coefficients of a fit, indexed by pairs of base features
+   *
+   * @param step The step along the path
+   * @return A q x q upper triangular sparse matrix with the coefficient of
+   *   base feature j at (j, j) and that of the interaction of features i and
+   *   j at (i, j), for i < j
+   */
+  Eigen::SparseMatrix<double> getCoefs(const size_t step) const;
+
+  /**
+   * @brief Predicts the response from base features
+   *
+   * @param x The base features
+   * @param step The step along the path
+   * @param type Type of prediction, "response" or "linear"
+   */
+  Eigen::MatrixXd predict(const Eigen::MatrixXd& x,
+                          const size_t step,
+                          const std::string& type = "response") const;
+
+private:
+  SlopePath path;
+  int n_features;
+  std::vector<std::pair<int, int>> pairs;
+};
+
+/**
+ * @brief Fits a SLOPE path to base features and all of their pairwise
+ * interactions
+ *
+ * The model is fit to a design of the base features and the interactions
+ * that have been screened in so far, with the lambda sequence of the full
+ * problem. After each fit, the KKT conditions of the full problem are
+ * checked against the interactions that screenInteractions() cannot rule
+ * out, and the path is refit with those that violate them, until there are
+ * no violations. Since interactions with gradients below the smallest lambda
+ * value can never be part of a violation, only the interactions whose bound
+ * reaches it are formed. The largest alpha of the path is that of the full
+ * problem, found the same way.
+ *
+ * The interactions are products of the base features as given, and the
+ * model is fit without normalization, so the base features should be
+ * standardized beforehand if needed.
+ *
+ * @param model The model, which sets the loss, lambda sequence, and the
+ *   other options of the path
+ * @param x The q base features
+ * @param y_in The response
+ * @return The path, with coefficients indexed by pairs of base features
+ * @throws std::invalid_argument If the model centers or scales the features,
+ *   for multi-response losses, or if the problem has more coefficients than
+ *   an `int` can index
+ */
+InteractionPath
+interactionPath(Slope model,
+                const Eigen::MatrixXd& x,
+                const Eigen::MatrixXd& y_in);
+
+} // namespace slope
@@ -0,0 +1,286 @@
+/**
+ * @file
+ * @brief Matrix-free design matrices, defined by their column operations
+ */
+
+#pragma once
+
+#include "clusters.h"
+#include "column_statistics.h"
+#include "jit_normalization.h"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace slope {
+class LinearOperator;
+}
+
+namespace Eigen {
+namespace internal {
+
+/// Lets LinearOperator pass as an Eigen::EigenBase, like Eigen's own
+/// matrix-free operators
+template<>
+struct traits<slope::LinearOperator>
+  : public Eigen::internal::traits<Eigen::SparseMatrix<double>>
+{};
+
+} // namespace internal
+} // namespace Eigen
+
+namespace slope {
+
+/**
+ * @brief Base class for design matrices that are defined by operations on
+ * their columns rather than by stored values
+ *
+ * The solvers only ever use the design matrix one column at a time, through
+ * the dot product of a column with a vector and the addition of a multiple
+ * of a column to a vector. A class that derives from this one and implements
+ * these two operations can therefore be passed to Slope::path() and
+ * SlopeFit::predict() in place of a matrix, which lets implicit designs, such
+ * as Kronecker products, pairwise interactions that are formed on the fly, or
+ * hashed features, be fit without ever storing them.
+ *
+ * The other operations have default implementations in terms of col(), which
+ * forms a column in a temporary vector, and may be overridden by classes
+ * that can do better. The operator is normalized just-in-time, and its
+ * methods are only called from one thread at a time.
+ *
+ * @code
+ * class Identity : public slope::LinearOperator
+ * {
+ * public:
+ *   explicit Identity(int n) : n(n) {}
+ *   Eigen::Index rows() const override { return n; }
+ *   Eigen::Index cols() const override { return n; }
+ *   double colDot(int j, const Eigen::Ref<const Eigen::VectorXd>& v)
+ *     const override { return v(j); }
+ *   void colAxpy(int j, double a, Eigen::Ref<Eigen::VectorXd> v)
+ *     const override { v(j) += a; }
+ *
+ * private:
+ *   int n;
+ * };
+ * @endcode
+ */
+class LinearOperator : public Eigen::EigenBase<LinearOperator>
+{
+public:
+  /// Element type
+  using Scalar = double;
+
+  /// Real element type
+  using RealScalar = double;
+
+  /// Index type
+  using StorageIndex = int;
+
+  enum
+  {
+    ColsAtCompileTime = Eigen::Dynamic,
+    MaxColsAtCompileTime = Eigen::Dynamic,
+    IsRowMajor = false
+  };
+
+  virtual ~LinearOperator() = default;
+
+  /// Number of rows
+  virtual Eigen::Index rows() const = 0;
+
+  /// Number of columns
+  virtual Eigen::Index cols() const = 0;
+
+  /**
+   * @brief Computes the dot product of a column with a vector
+   *
+   * @param j Index of the column
+   * @param v Vector with one element per row
+   * @return \f$x_j^T v\f$
+   */
+  virtual double colDot(const int j,
+                        const Eigen::Ref<const Eigen::VectorXd>& v) const = 0;
+
+  /**
+   * @brief Adds a multiple of a column to a vector
+   *
+   * @param j Index of the column
+   * @param a The multiplier
+   * @param v Vector with one element per row, which is set to
+   *   \f$v + a x_j\f$
+   */
+  virtual void colAxpy(const int j,
+                       const double a,
+                       Eigen::Ref<Eigen::VectorXd> v) const = 0;
+
+  /**
+   * @brief Computes the weighted squared norm of a column
+   *
+   * @param j Index of the column
+   * @param w Weights, one for each row
+   * @return \f$\sum_i w_i x_{ij}^2\f$
+   */
+  virtual double colSquaredNorm(
+    const int j,
+    const Eigen::Ref<const Eigen::VectorXd>& w) const;
+
+  /**
+   * @brief Computes the sum of a column
+   *
+   * @param j Index of the column
+   */
+  virtual double colSum(const int j) const;
+
+  /**
+   * @brief Computes column statistics of the operator, for normalization
+   *
+   * @param w Observation weights, or an empty vector for unit weights
+   */
+  virtual ColumnStatistics computeStatistics(const Eigen::VectorXd& w) const;
+
+  /// Whether all values of the operator are finite, which by default is
+  /// decided from its column statistics
+  virtual bool allFinite() const;
+
+  /**
+   * @brief A column of the operator, as a dense vector
+   *
+   * @param j Index of the column
+   */
+  Eigen::VectorXd col(const Eigen::Index j) const;
+
+  /// Column statistics of the operator, which are computed on first use
+  const ColumnStatistics& statistics() const;
+
+private:
+  mutable ColumnStatistics x_stats;
+  mutable bool has_stats = false;
+};
+
+/**
+ * @brief Computes the linear predictor from a linear operator
+ *
+ * @see linearPredictor() for dense and sparse matrices
+ */
+Eigen::MatrixXd
+linearPredictor(const LinearOperator& x,
+                const std::vector<IndexType>& active_set,
+                const Eigen::VectorXd& beta0,
+                const Eigen::VectorXd& beta,
+                const Eigen::VectorXd& x_centers,
+                const Eigen::VectorXd& x_scales,
+                const JitNormalization jit_normalization,
+                const bool intercept);
+
+/**
+ * @brief Computes the gradient from a linear operator
+ *
+ * @see updateGradient() for dense and sparse matrices
+ */
+void
+updateGradient(Eigen::VectorXd& gradient,
+               const LinearOperator& x,
+               const Eigen::MatrixXd& residual,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const Eigen::VectorXd& w,
+               const JitNormalization jit_normalization);
+
+/**
+ * @brief Offsets the gradient for a linear operator
+ *
+ * @see offsetGradient() for dense and sparse matrices
+ */
+void
+offsetGradient(Eigen::VectorXd& gradient,
+               const LinearOperator& x,
+               const Eigen::VectorXd& offset,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const JitNormalization jit_normalization,
+               const Eigen::VectorXd& w = Eigen::VectorXd());
+
+/**
+ * @brief Computes the gradient and Hessian of a coefficient for coordinate
+ * descent, from a linear operator
+ *
+ * @see computeGradientAndHessian() for dense and sparse matrices
+ */
+std::pair<double, double>
+computeGradientAndHessian(const LinearOperator& x,
+                          const IndexType ind,
+                          const Eigen::MatrixXd& w,
+                          const Eigen::MatrixXd& residual,
+                          const Eigen::VectorXd& x_centers,
+                          const Eigen::VectorXd& x_scales,
+                          const double s,
+                          const JitNormalization jit_normalization,
+                          const int n);
+
+/**
+ * @brief Computes the gradient and Hessian of a cluster for coordinate
+ * descent, from a linear operator
+ *
+ * @see computeClusterGradientAndHessian() for dense and sparse matrices
+ */
+std::pair<double, double>
+computeClusterGradientAndHessian(const LinearOperator& x,
+                                 const IndexType c_ind,
+                                 const std::vector<int>& s,
+                                 const Clusters& clusters,
+                                 const Eigen::MatrixXd& w,
+                                 const Eigen::MatrixXd& residual,
+                                 const Eigen::VectorXd& x_centers,
+                                 const Eigen::VectorXd& x_scales,
+                                 const JitNormalization jit_normalization);
+
+/**
+ * @brief Multiplies a linear operator with a sparse matrix, for instance to
+ * predict from the coefficients of a fit
+ */
+Eigen::MatrixXd
+operator*(const LinearOperator& x, const Eigen::SparseMatrix<double>& b);
+
+/**
+ * @brief Computes centers and scales of a linear operator from its column
+ * statistics
+ *
+ * @see normalize() for dense and sparse matrices
+ */
+JitNormalization
+normalize(LinearOperator& x,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool modify_x);
+
+/**
+ * @brief Computes centers and scales of a linear operator with observation
+ * weights
+ *
+ * @see normalize() for dense and sparse matrices
+ */
+JitNormalization
+normalize(LinearOperator& x,
+          const Eigen::VectorXd& w,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool modify_x);
+
+/**
+ * @brief Checks a linear operator for non-finite values
+ *
+ * @see LinearOperator::allFinite()
+ */
+bool
+isFinite(const LinearOperator& x);
+
+} // namespace slope
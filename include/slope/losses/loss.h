@@ -45,7 +45,8 @@ public:
    *
    * @param theta The estimated parameters.
    * @param y The true values.
-   * @param w Weights.
+   * @param w Observation weights, normalized to have mean one. An empty
+   *   vector means unit weights.
    * @return The dual value.
    */
   virtual double dual(const Eigen::MatrixXd& theta,
@@ -58,7 +59,8 @@ public:
    * This function calculates the generalized residual given the linear
    * predictor (eta) and the true values (y). The generalized residual is the
    * same as the gradient of the loss function with respect to the linear
-   * predictor (eta).
+   * predictor (eta), so each row is multiplied by the observation weight
+   * (see setWeights()).
    *
    * @param eta Linear predictor.
    * @param y Response.
@@ -84,7 +86,8 @@ public:
    * @brief Updates weights and working response
    *
    * This function updates the weights and working response of the
-   * quadratic expansion of the loss function.
+   * quadratic expansion of the loss function. The weights include the
+   * observation weights (see setWeights()).
    *
    * @param w Working weights.
    * @param z Working response.
@@ -156,6 +159,24 @@ public:
     return 2.0 * (loss(eta, y) - loss(link(y), y));
   }
 
+  /**
+   * @brief Sets observation weights
+   *
+   * The loss becomes the weighted average of the losses of the observations,
+   * and the residual, deviance, and working weights are weighted
+   * accordingly.
+   *
+   * @param w Non-negative weights, one for each observation, normalized to
+   *   have mean one. An empty vector (the default) means unit weights.
+   */
+  void setWeights(const Eigen::VectorXd& w) { weights = w; }
+
+  /**
+   * @brief Returns the observation weights
+   * @return The weights, or an empty vector for unit weights.
+   */
+  const Eigen::VectorXd& getWeights() const { return weights; }
+
 protected:
   /**
    * @brief Constructs an loss function with specified Lipschitz constant
@@ -169,6 +190,35 @@ protected:
   {
   }
 
+  /**
+   * @brief Averages per-observation values, weighted by observation weights
+   *
+   * Observations with zero weight are skipped entirely, so their values
+   * may be non-finite.
+   *
+   * @param values One value for each observation
+   * @param w Weights normalized to have mean one, or an empty vector for unit
+   *   weights
+   * @return The weighted mean
+   */
+  static double weightedMean(const Eigen::ArrayXd& values,
+                             const Eigen::VectorXd& w);
+
+  /**
+   * @brief Divides each row of a matrix by its observation weight
+   *
+   * Rows with zero weight are set to zero. This maps a dual variable of the
+   * weighted problem to the dual variable of each observation.
+   *
+   * @param theta The matrix
+   * @param w Weights, or an empty vector for unit weights
+   * @return The unweighted matrix
+   */
+  static Eigen::MatrixXd unweighted(const Eigen::MatrixXd& theta,
+                                    const Eigen::VectorXd& w);
+
+  Eigen::VectorXd weights; ///< Observation weights (empty for unit weights)
+
 private:
   const double lipschitz_constant;
 };
@@ -0,0 +1,164 @@
+/**
+ * @file
+ * @brief Memory-mapped design matrices on disk
+ *
+ * A binary format for dense and sparse design matrices, which can be mapped
+ * into memory instead of being read, so that fitting a model to a matrix
+ * stored on disk does not require a second copy of it in memory. The format
+ * also stores the column statistics of the matrix, which lets the model
+ * skip its pass over the matrix to compute the normalization.
+ *
+ * ## Format
+ *
+ * All integers and floating-point numbers are stored in the byte order of
+ * the machine that writes the file, and files are only read on machines with
+ * the same byte order. Each section starts at an offset that is a multiple
+ * of 64 bytes, with zeros in between.
+ *
+ * The file starts with a header of 64 bytes:
+ *
+ * | Offset | Type       | Content                                     |
+ * | ------ | ---------- | ------------------------------------------- |
+ * | 0      | `char[8]`  | Magic bytes `SLOPEMAT`                      |
+ * | 8      | `uint32_t` | Format version, currently 1                 |
+ * | 12     | `uint32_t` | Byte order mark `0x01020304`                |
+ * | 16     | `uint32_t` | Storage: 0 for dense, 1 for sparse          |
+ * | 20     | `uint32_t` | Bytes per sparse index: 4, 0 for dense      |
+ * | 24     | `int64_t`  | Number of rows, n                           |
+ * | 32     | `int64_t`  | Number of columns, p                        |
+ * | 40     | `int64_t`  | Number of stored values                     |
+ * | 48     |            | Reserved, zero                              |
+ *
+ * The header is followed by the column statistics, as five arrays of p
+ * `double`s: the means, the sums of squared deviations from the means, the
+ * sums of absolute values, the minima, and the maxima (see
+ * ColumnStatistics).
+ *
+ * Then comes the matrix. A dense matrix is stored as n * p `double`s in
+ * column-major order. A sparse matrix is stored in compressed sparse column
+ * format, as the p + 1 column offsets, the row indices of the stored values,
+ * and the stored values themselves. The indices are 32-bit integers, as for
+ * `Eigen::SparseMatrix<double>`, which is what the solvers accept, so a
+ * sparse matrix can have at most 2^31 - 1 stored values.
+ */
+
+#pragma once
+
+#include "column_statistics.h"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <cstdint>
+#include <string>
+
+namespace slope {
+
+/**
+ * @brief A design matrix that is mapped into memory from a file
+ *
+ * The file, in the format described in mapped_matrix.h, is mapped
+ * copy-on-write: the matrix can be modified, for instance by normalizing it
+ * in place, without affecting the file. Pages of the file are only read when
+ * they are first accessed, and the operating system is free to evict them
+ * again when they are not modified.
+ *
+ * The matrix is exposed as an Eigen::Map, which all functions that take
+ * Eigen matrices accept. Together with the stored column statistics, it can
+ * be passed to the version of Slope::path() that takes column statistics.
+ *
+ * @code
+ * slope::MappedMatrix mapped("x.bin");
+ * auto x = mapped.dense();
+ * auto path = model.path(x, y, mapped.statistics());
+ * @endcode
+ */
+class MappedMatrix
+{
+public:
+  /**
+   * @brief Maps a matrix from a file
+   *
+   * @param file Path to the file
+   * @throws std::runtime_error If the file cannot be opened or mapped, or is
+   *   not a valid matrix file, including if the column offsets or row indices
+   *   of a sparse matrix are out of range
+   */
+  explicit MappedMatrix(const std::string& file);
+
+  /// Unmaps the file
+  ~MappedMatrix();
+
+  MappedMatrix(const MappedMatrix&) = delete;
+  MappedMatrix& operator=(const MappedMatrix&) = delete;
+
+  /// Takes over the mapping of another matrix
+  MappedMatrix(MappedMatrix&& other) noexcept;
+
+  /// Takes over the mapping of another matrix
+  MappedMatrix& operator=(MappedMatrix&& other) noexcept;
+
+  /// Number of rows
+  Eigen::Index rows() const { return n_rows; }
+
+  /// Number of columns
+  Eigen::Index cols() const { return n_cols; }
+
+  /// Whether the matrix is stored in sparse format
+  bool isSparse() const { return index_bytes > 0; }
+
+  /// Bytes per index of a sparse matrix, or 0 for a dense matrix
+  int indexBytes() const { return index_bytes; }
+
+  /// Column statistics of the matrix
+  const ColumnStatistics& statistics() const { return x_stats; }
+
+  /**
+   * @brief The dense matrix
+   *
+   * @throws std::runtime_error If the matrix is sparse
+   */
+  Eigen::Map<Eigen::MatrixXd> dense();
+
+  /**
+   * @brief The sparse matrix
+   *
+   * @throws std::runtime_error If the matrix is dense
+   */
+  Eigen::Map<Eigen::SparseMatrix<double>> sparse();
+
+private:
+  void unmap() noexcept;
+
+  void checkSparseIndices(const std::string& file) const;
+
+  char* data = nullptr;
+  std::size_t size = 0;
+  Eigen::Index n_rows = 0;
+  Eigen::Index n_cols = 0;
+  std::int64_t nnz = 0;
+  int index_bytes = 0;
+  std::size_t matrix_offset = 0;
+  ColumnStatistics x_stats;
+};
+
+/**
+ * @brief Writes a dense matrix to a file in the format of MappedMatrix
+ *
+ * @param file Path to the file, which is overwritten
+ * @param x The matrix
+ * @throws std::runtime_error If the file cannot be written
+ */
+void
+writeMappedMatrix(const std::string& file, const Eigen::MatrixXd& x);
+
+/**
+ * @brief Writes a sparse matrix to a file in the format of MappedMatrix
+ *
+ * @param file Path to the file, which is overwritten
+ * @param x The matrix
+ * @throws std::runtime_error If the file cannot be written
+ */
+void
+writeMappedMatrix(const std::string& file,
+                  const Eigen::SparseMatrix<double>& x);
+
+} // namespace slope
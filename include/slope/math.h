@@ -12,6 +12,7 @@
 #include <Eigen/Core>
 #include <Eigen/SparseCore>
 #include <cassert>
+#include <cmath>
 #include <numeric>
 #include <vector>
 
@@ -152,7 +153,7 @@ softmax(const Eigen::MatrixXd& x);
 template<typename T>
 Eigen::MatrixXd
 linearPredictor(const T& x,
-                const std::vector<int>& active_set,
+                const std::vector<IndexType>& active_set,
                 const Eigen::VectorXd& beta0,
                 const Eigen::VectorXd& beta,
                 const Eigen::VectorXd& x_centers,
@@ -167,7 +168,8 @@ linearPredictor(const T& x,
   Eigen::MatrixXd eta = Eigen::MatrixXd::Zero(n, m);
 
 #ifdef _OPENMP
-  bool large_problem = active_set.size() > 100 && n * active_set.size() > 1e7;
+  bool large_problem = active_set.size() > 100 &&
+                       static_cast<double>(n) * active_set.size() > 1e7;
 #pragma omp parallel num_threads(Threads::get()) if (large_problem)
 #endif
   {
@@ -176,9 +178,9 @@ linearPredictor(const T& x,
 #ifdef _OPENMP
 #pragma omp for nowait
 #endif
-    for (int i = 0; i < static_cast<int>(active_set.size()); ++i) {
-      int ind = active_set[i];
-      auto [k, j] = std::div(ind, p);
+    for (IndexType i = 0; i < static_cast<IndexType>(active_set.size()); ++i) {
+      IndexType ind = active_set[i];
+      auto [k, j] = splitIndex(ind, p);
 
       switch (jit_normalization) {
         case JitNormalization::Both:
@@ -235,7 +237,7 @@ void
 updateGradient(Eigen::VectorXd& gradient,
                const T& x,
                const Eigen::MatrixXd& residual,
-               const std::vector<int>& active_set,
+               const std::vector<IndexType>& active_set,
                const Eigen::VectorXd& x_centers,
                const Eigen::VectorXd& x_scales,
                const Eigen::VectorXd& w,
@@ -245,14 +247,15 @@ updateGradient(Eigen::VectorXd& gradient,
   const int p = x.cols();
   const int m = residual.cols();
 
-  assert(gradient.size() == p * m &&
+  assert(gradient.size() == static_cast<Eigen::Index>(p) * m &&
          "Gradient matrix has incorrect dimensions");
 
   Eigen::MatrixXd weighted_residual(n, m);
   Eigen::ArrayXd wr_sums(m);
 
 #ifdef _OPENMP
-  bool large_problem = active_set.size() > 100 && n * active_set.size() > 1e5;
+  bool large_problem = active_set.size() > 100 &&
+                       static_cast<double>(n) * active_set.size() > 1e5;
 #pragma omp parallel for num_threads(Threads::get()) if (large_problem)
 #endif
   for (int k = 0; k < m; ++k) {
@@ -263,9 +266,9 @@ updateGradient(Eigen::VectorXd& gradient,
 #ifdef _OPENMP
 #pragma omp parallel for num_threads(Threads::get()) if (large_problem)
 #endif
-  for (int i = 0; i < static_cast<int>(active_set.size()); ++i) {
-    int ind = active_set[i];
-    auto [k, j] = std::div(ind, p);
+  for (IndexType i = 0; i < static_cast<IndexType>(active_set.size()); ++i) {
+    IndexType ind = active_set[i];
+    auto [k, j] = splitIndex(ind, p);
 
     switch (jit_normalization) {
       case JitNormalization::Both:
@@ -301,79 +304,189 @@ updateGradient(Eigen::VectorXd& gradient,
  * @param x_scales The vector of scale values for each column of x.
  * @param jit_normalization Type of JIT normalization
  * just-in-time.
+ * @param w Observation weights, normalized to have mean one, by which the
+ * offset is multiplied for each observation. An empty vector means unit
+ * weights.
  */
 template<typename T>
 void
 offsetGradient(Eigen::VectorXd& gradient,
                const T& x,
                const Eigen::VectorXd& offset,
-               const std::vector<int>& active_set,
+               const std::vector<IndexType>& active_set,
                const Eigen::VectorXd& x_centers,
                const Eigen::VectorXd& x_scales,
-               const JitNormalization jit_normalization)
+               const JitNormalization jit_normalization,
+               const Eigen::VectorXd& w = Eigen::VectorXd())
 {
   const int n = x.rows();
   const int p = x.cols();
 
   for (size_t i = 0; i < active_set.size(); ++i) {
-    int ind = active_set[i];
-    auto [k, j] = std::div(ind, p);
+    IndexType ind = active_set[i];
+    auto [k, j] = splitIndex(ind, p);
+
+    const double x_mean =
+      w.size() > 0 ? x.col(j).dot(w) / n : x.col(j).sum() / n;
 
     switch (jit_normalization) {
       case JitNormalization::Both:
-        gradient(ind) -=
-          offset(k) * (x.col(j).sum() / n - x_centers(j)) / x_scales(j);
+        gradient(ind) -= offset(k) * (x_mean - x_centers(j)) / x_scales(j);
         break;
       case JitNormalization::Center:
-        gradient(ind) -= offset(k) * (x.col(j).sum() / n - x_centers(j));
+        gradient(ind) -= offset(k) * (x_mean - x_centers(j));
         break;
       case JitNormalization::Scale:
-        gradient(ind) -= offset(k) * x.col(j).sum() / (n * x_scales(j));
+        gradient(ind) -= offset(k) * x_mean / x_scales(j);
         break;
       case JitNormalization::None:
-        gradient(ind) -= offset(k) * x.col(j).sum() / n;
+        gradient(ind) -= offset(k) * x_mean;
         break;
     }
   }
 }
 
 /**
- * @brief Computes the union of two sorted integer vectors
+ * Computes \f(X_{S}^T V\f) for a contiguous block of rows \f(S\f) of a
+ * dense matrix, without normalization.
+ *
+ * @tparam T The type of the input matrix.
+ * @param x The input matrix.
+ * @param v Matrix with one row for each row in the block.
+ * @param row_begin First row of the block.
+ * @return The p x m product.
+ */
+template<typename T>
+Eigen::MatrixXd
+rowBlockTransposeProduct(const Eigen::MatrixBase<T>& x,
+                         const Eigen::MatrixXd& v,
+                         const int row_begin)
+{
+  return x.derived().middleRows(row_begin, v.rows()).transpose() * v;
+}
+
+/**
+ * Computes \f(X_{S}^T V\f) for a contiguous block of rows \f(S\f) of a
+ * sparse matrix, without normalization.
+ *
+ * @tparam T The type of the input matrix.
+ * @param x The input matrix.
+ * @param v Matrix with one row for each row in the block.
+ * @param row_begin First row of the block.
+ * @return The p x m product.
+ */
+template<typename T>
+Eigen::MatrixXd
+rowBlockTransposeProduct(const Eigen::SparseMatrixBase<T>& x,
+                         const Eigen::MatrixXd& v,
+                         const int row_begin)
+{
+  const int p = x.cols();
+  const int m = v.cols();
+  const int row_end = row_begin + v.rows();
+
+  Eigen::MatrixXd out = Eigen::MatrixXd::Zero(p, m);
+
+  for (int j = 0; j < p; ++j) {
+    forEachInRows(x, j, row_begin, row_end, [&](int i, double value) {
+      out.row(j) += value * v.row(i - row_begin);
+    });
+  }
+
+  return out;
+}
+
+/**
+ * Computes \f(X_{S} B\f) for a contiguous block of rows \f(S\f) of a dense
+ * matrix, without normalization.
+ *
+ * @tparam T The type of the input matrix.
+ * @param x The input matrix.
+ * @param beta Sparse p x m matrix of coefficients.
+ * @param row_begin First row of the block.
+ * @param row_end One past the last row of the block.
+ * @return The product, with one row for each row in the block.
+ */
+template<typename T>
+Eigen::MatrixXd
+rowBlockProduct(const Eigen::MatrixBase<T>& x,
+                const Eigen::SparseMatrix<double>& beta,
+                const int row_begin,
+                const int row_end)
+{
+  return x.derived().middleRows(row_begin, row_end - row_begin) * beta;
+}
+
+/**
+ * Computes \f(X_{S} B\f) for a contiguous block of rows \f(S\f) of a
+ * sparse matrix, without normalization.
+ *
+ * @tparam T The type of the input matrix.
+ * @param x The input matrix.
+ * @param beta Sparse p x m matrix of coefficients.
+ * @param row_begin First row of the block.
+ * @param row_end One past the last row of the block.
+ * @return The product, with one row for each row in the block.
+ */
+template<typename T>
+Eigen::MatrixXd
+rowBlockProduct(const Eigen::SparseMatrixBase<T>& x,
+                const Eigen::SparseMatrix<double>& beta,
+                const int row_begin,
+                const int row_end)
+{
+  Eigen::MatrixXd out =
+    Eigen::MatrixXd::Zero(row_end - row_begin, beta.cols());
+
+  for (int k = 0; k < beta.outerSize(); ++k) {
+    for (Eigen::SparseMatrix<double>::InnerIterator b_it(beta, k); b_it;
+         ++b_it) {
+      forEachInRows(x, b_it.row(), row_begin, row_end, [&](int i, double v) {
+        out(i - row_begin, k) += v * b_it.value();
+      });
+    }
+  }
+
+  return out;
+}
+
+/**
+ * @brief Computes the union of two sorted index vectors
  *
- * @param a First sorted vector of integers
- * @param b Second sorted vector of integers
- * @return std::vector<int> Vector containing all elements that appear in either
- * a or b, without duplicates and in sorted order
+ * @param a First sorted vector of indices
+ * @param b Second sorted vector of indices
+ * @return std::vector<IndexType> Vector containing all elements that appear in
+ * either a or b, without duplicates and in sorted order
  */
-std::vector<int>
-setUnion(const std::vector<int>& a, const std::vector<int>& b);
+std::vector<IndexType>
+setUnion(const std::vector<IndexType>& a, const std::vector<IndexType>& b);
 
 /**
- * @brief Computes the set difference of two sorted integer vectors
+ * @brief Computes the set difference of two sorted index vectors
  *
- * @param a First sorted vector of integers (set to subtract from)
- * @param b Second sorted vector of integers (set to subtract)
- * @return std::vector<int> Vector containing elements in a that do not appear
- * in b, maintaining sorted order
+ * @param a First sorted vector of indices (set to subtract from)
+ * @param b Second sorted vector of indices (set to subtract)
+ * @return std::vector<IndexType> Vector containing elements in a that do not
+ * appear in b, maintaining sorted order
  *
  * Returns A \ B = {x ∈ A | x ∉ B}
  */
-std::vector<int>
-setDiff(const std::vector<int>& a, const std::vector<int>& b);
+std::vector<IndexType>
+setDiff(const std::vector<IndexType>& a, const std::vector<IndexType>& b);
 
 /**
  * @brief Returns the index of the maximum element in a container
  *
  * @tparam T Container type that supports iterators and std::max_element
  * @param x Container whose maximum element's index is to be found
- * @return int Zero-based index position of the maximum element
+ * @return IndexType Zero-based index position of the maximum element
  *
  * Uses std::max_element to find the iterator to the maximum element,
  * then converts to index position using std::distance.
  * For containers with multiple maximum elements, returns the first occurrence.
  */
 template<typename T>
-int
+IndexType
 whichMax(const T& x)
 {
   return std::distance(x.begin(), std::max_element(x.begin(), x.end()));
@@ -398,26 +511,36 @@ whichMin(const T& x)
 }
 
 /**
- * @brief Returns the index of the minimum element in a container
+ * @brief Returns the index of the best element in a container
  *
- * @tparam T Container type that supports iterators and std::min_element
- * @param x Container whose maximum element's index is to be found
+ * @tparam T Container type that supports indexing
+ * @param x Container whose best element's index is to be found
  * @param comp Comparator that returns true if the first argument is worse
  * than the second argument
- * @return int Zero-based index position of the maximum element
+ * @return int Zero-based index position of the best element, or -1 if there
+ * is none
  *
- * Uses std::max_element to find the iterator to the maximum element,
- * then converts to index position using std::distance.
- * For containers with multiple maximum elements, returns the first occurrence.
+ * NaN elements, such as scores of alphas that were skipped in
+ * cross-validation, are ignored. For containers with multiple best elements,
+ * returns the first occurrence.
  */
 template<typename T, typename Comparator>
 int
 whichBest(const T& x, const Comparator& comp)
 {
-  if (x.size() == 0)
-    return -1;
+  int best = -1;
+
+  for (int i = 0; i < static_cast<int>(x.size()); ++i) {
+    if (std::isnan(x(i))) {
+      continue;
+    }
+
+    if (best < 0 || comp(x(best), x(i))) {
+      best = i;
+    }
+  }
 
-  return std::distance(x.begin(), std::max_element(x.begin(), x.end(), comp));
+  return best;
 }
 
 /**
@@ -832,7 +955,7 @@ clusterGradient(Eigen::VectorXd& beta,
     s.reserve(cluster_size);
 
     for (auto c_it = clusters.cbegin(j); c_it != clusters.cend(j); ++c_it) {
-      int ind = *c_it;
+      IndexType ind = *c_it;
       double s_k = sign(beta(ind));
       s.emplace_back(s_k);
     }
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include "column_statistics.h"
 #include "jit_normalization.h"
 #include "math.h"
 #include <Eigen/SparseCore>
@@ -246,6 +247,132 @@ normalize(Eigen::SparseMatrixBase<T>& x,
   return jit_normalization;
 }
 
+/**
+ * Checks whether normalization needs column statistics of the data.
+ *
+ * @param centering_type A string specifying the centering type.
+ * @param scaling_type A string specifying the scaling type.
+ *
+ * @return false if the centers and scales are either given ("manual") or not
+ * used ("none"), true otherwise.
+ */
+bool
+usesColumnStatistics(const std::string& centering_type,
+                     const std::string& scaling_type);
+
+/**
+ * Computes centers and scales from running column statistics.
+ *
+ * This is the counterpart of the dense and sparse versions of normalize() for
+ * a design matrix that is only available through its column statistics, for
+ * instance because it grows by rows (see ColumnStatistics). The design is
+ * never modified, so normalization always happens just-in-time.
+ *
+ * @param x_stats Statistics of the columns of the design matrix.
+ * @param x_centers A vector that will hold the column centers.
+ * @param x_scales  A vector that will hold the column scaling factors.
+ * @param centering_type A string specifying the centering type.
+ * @param scaling_type A string specifying the scaling type.
+ *
+ * @return The type of just-in-time normalization to use.
+ */
+JitNormalization
+normalize(const ColumnStatistics& x_stats,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type);
+
+/**
+ * Normalize a dense matrix by centering and scaling, with centers and scales
+ * computed from observation weights.
+ *
+ * The weights are treated as frequency weights (see ColumnStatistics), so
+ * that 0/1 weights normalize with respect to the selected rows only. If
+ * modify_x is true, the normalization is applied directly to the input
+ * matrix, including the rows with zero weight.
+ *
+ * @param x The dense input matrix to be normalized.
+ * @param w Non-negative weights, one for each row of x.
+ * @param x_centers A vector that will hold the column centers.
+ * @param x_scales  A vector that will hold the column scaling factors.
+ * @param centering_type A string specifying the centering type.
+ * @param scaling_type A string specifying the scaling type.
+ * @param modify_x If true, modifies x in-place.
+ *
+ * @return The type of just-in-time normalization to use.
+ */
+template<typename T>
+JitNormalization
+normalize(Eigen::MatrixBase<T>& x,
+          const Eigen::VectorXd& w,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool modify_x)
+{
+  ColumnStatistics x_stats(x.cols());
+
+  if (usesColumnStatistics(centering_type, scaling_type)) {
+    x_stats.update(x, w);
+  }
+
+  JitNormalization jit_normalization = normalize(
+    x_stats, x_centers, x_scales, centering_type, scaling_type);
+
+  if (!modify_x || jit_normalization == JitNormalization::None) {
+    return jit_normalization;
+  }
+
+  bool center = centering_type != "none";
+  bool scale = scaling_type != "none";
+
+  for (int j = 0; j < x.cols(); ++j) {
+    if (center) {
+      x.col(j).array() -= x_centers(j);
+    }
+    if (scale) {
+      x.col(j).array() /= x_scales(j);
+    }
+  }
+
+  return JitNormalization::None;
+}
+
+/**
+ * Normalize a sparse matrix, with centers and scales computed from
+ * observation weights. Normalization always happens just-in-time.
+ *
+ * @param x The sparse input matrix to be normalized.
+ * @param w Non-negative weights, one for each row of x.
+ * @param x_centers A vector that will hold the column centers.
+ * @param x_scales  A vector that will hold the column scaling factors.
+ * @param centering_type A string specifying the centering type.
+ * @param scaling_type A string specifying the scaling type.
+ *
+ * @return The type of just-in-time normalization to use.
+ */
+template<typename T>
+JitNormalization
+normalize(Eigen::SparseMatrixBase<T>& x,
+          const Eigen::VectorXd& w,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool)
+{
+  ColumnStatistics x_stats(x.cols());
+
+  if (usesColumnStatistics(centering_type, scaling_type)) {
+    x_stats.update(x, w);
+  }
+
+  return normalize(
+    x_stats, x_centers, x_scales, centering_type, scaling_type);
+}
+
 /**
  * @brief Rescales the coefficients using the given parameters.
  *
@@ -273,4 +400,26 @@ rescaleCoefficients(const Eigen::VectorXd& beta0,
                     const Eigen::VectorXd& x_scales,
                     const bool intercept);
 
+/**
+ * Maps coefficients on the original scale of the design matrix to the scale
+ * of the normalized design matrix. This is the inverse of
+ * rescaleCoefficients().
+ *
+ * @param beta0 The intercepts on the original scale.
+ * @param beta The p x m matrix of coefficients on the original scale.
+ * @param x_centers The vector of center values.
+ * @param x_scales The vector of scale factors.
+ * @param intercept Should an intercept be fit?
+ * @return A tuple containing the intercepts and coefficients on the
+ * normalized scale.
+ *
+ * @see rescaleCoefficients()
+ */
+std::tuple<Eigen::VectorXd, Eigen::MatrixXd>
+normalizeCoefficients(const Eigen::VectorXd& beta0,
+                      const Eigen::MatrixXd& beta,
+                      const Eigen::VectorXd& x_centers,
+                      const Eigen::VectorXd& x_scales,
+                      const bool intercept);
+
 } // namespace slope
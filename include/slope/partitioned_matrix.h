@@ -0,0 +1,289 @@
+/**
+ * @file
+ * @brief Design matrices with both dense and sparse columns
+ */
+
+#pragma once
+
+#include "clusters.h"
+#include "column_statistics.h"
+#include "jit_normalization.h"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace slope {
+class PartitionedMatrix;
+}
+
+namespace Eigen {
+namespace internal {
+
+/// Lets PartitionedMatrix pass as an Eigen::EigenBase, like Eigen's own
+/// matrix-free operators
+template<>
+struct traits<slope::PartitionedMatrix>
+  : public Eigen::internal::traits<Eigen::SparseMatrix<double>>
+{};
+
+} // namespace internal
+} // namespace Eigen
+
+namespace slope {
+
+/**
+ * @brief A design matrix whose columns are split into a dense and a sparse
+ * part
+ *
+ * Feature sets often combine a few dense numeric columns with many sparse
+ * indicators, for which neither a dense matrix (which stores all the zeros)
+ * nor a sparse one (which is slow for the dense columns) is a good fit. This
+ * matrix stores the dense columns in a dense matrix and the others in a
+ * sparse matrix, and each kernel uses the part that holds the column it
+ * works on (see withColumn()).
+ *
+ * The matrix can be passed to Slope::path() and SlopeFit::predict() like any
+ * other matrix. As with sparse matrices, it is normalized just-in-time.
+ */
+class PartitionedMatrix : public Eigen::EigenBase<PartitionedMatrix>
+{
+public:
+  /// Element type
+  using Scalar = double;
+
+  /// Real element type
+  using RealScalar = double;
+
+  /// Index type
+  using StorageIndex = int;
+
+  enum
+  {
+    ColsAtCompileTime = Eigen::Dynamic,
+    MaxColsAtCompileTime = Eigen::Dynamic,
+    IsRowMajor = false
+  };
+
+  /**
+   * @brief Creates a matrix from its dense and sparse parts
+   *
+   * @param dense The dense columns, which come first
+   * @param sparse The sparse columns, which come after the dense ones
+   * @throws std::invalid_argument If the parts do not have the same number of
+   *   rows
+   */
+  PartitionedMatrix(Eigen::MatrixXd dense, Eigen::SparseMatrix<double> sparse);
+
+  /**
+   * @brief Splits a sparse matrix by the density of its columns
+   *
+   * @param x The matrix
+   * @param max_sparse_density Columns with a larger share of nonzero values
+   *   are stored as dense
+   */
+  explicit PartitionedMatrix(const Eigen::SparseMatrix<double>& x,
+                             const double max_sparse_density = 0.25);
+
+  /**
+   * @brief Splits a dense matrix by the density of its columns
+   *
+   * @param x The matrix
+   * @param max_sparse_density Columns with a larger share of nonzero values
+   *   are stored as dense
+   */
+  explicit PartitionedMatrix(const Eigen::MatrixXd& x,
+                             const double max_sparse_density = 0.25);
+
+  /// Number of rows
+  Eigen::Index rows() const { return dense.rows(); }
+
+  /// Number of columns
+  Eigen::Index cols() const { return is_dense.size(); }
+
+  /// The dense columns
+  const Eigen::MatrixXd& getDense() const { return dense; }
+
+  /// The sparse columns
+  const Eigen::SparseMatrix<double>& getSparse() const { return sparse; }
+
+  /// Indices of the dense columns in the full matrix
+  const std::vector<int>& getDenseColumns() const { return dense_columns; }
+
+  /// Indices of the sparse columns in the full matrix
+  const std::vector<int>& getSparseColumns() const { return sparse_columns; }
+
+  /// Column statistics of the matrix
+  const ColumnStatistics& statistics() const { return x_stats; }
+
+  /**
+   * @brief Calls a function with a column from the part that stores it
+   *
+   * @param j Index of the column
+   * @param f Generic function that is called with either a dense or a
+   *   sparse column expression
+   * @return The value returned by `f`
+   */
+  template<typename F>
+  decltype(auto) withColumn(const int j, F&& f) const
+  {
+    if (is_dense[j]) {
+      return f(dense.col(local_indices[j]));
+    } else {
+      return f(sparse.col(local_indices[j]));
+    }
+  }
+
+  /**
+   * @brief A column of the matrix, as a dense vector
+   *
+   * @param j Index of the column
+   */
+  Eigen::VectorXd col(const Eigen::Index j) const;
+
+  /**
+   * @brief Computes column statistics of the matrix
+   *
+   * @param w Observation weights, or an empty vector for unit weights
+   */
+  ColumnStatistics computeStatistics(const Eigen::VectorXd& w) const;
+
+private:
+  void setColumns(const std::vector<bool>& dense_mask);
+
+  Eigen::MatrixXd dense;
+  Eigen::SparseMatrix<double> sparse;
+  std::vector<bool> is_dense;
+  std::vector<int> local_indices;
+  std::vector<int> dense_columns;
+  std::vector<int> sparse_columns;
+  ColumnStatistics x_stats;
+};
+
+/**
+ * @brief Computes the linear predictor from a partitioned matrix
+ *
+ * @see linearPredictor() for dense and sparse matrices
+ */
+Eigen::MatrixXd
+linearPredictor(const PartitionedMatrix& x,
+                const std::vector<IndexType>& active_set,
+                const Eigen::VectorXd& beta0,
+                const Eigen::VectorXd& beta,
+                const Eigen::VectorXd& x_centers,
+                const Eigen::VectorXd& x_scales,
+                const JitNormalization jit_normalization,
+                const bool intercept);
+
+/**
+ * @brief Computes the gradient from a partitioned matrix
+ *
+ * @see updateGradient() for dense and sparse matrices
+ */
+void
+updateGradient(Eigen::VectorXd& gradient,
+               const PartitionedMatrix& x,
+               const Eigen::MatrixXd& residual,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const Eigen::VectorXd& w,
+               const JitNormalization jit_normalization);
+
+/**
+ * @brief Offsets the gradient for a partitioned matrix
+ *
+ * @see offsetGradient() for dense and sparse matrices
+ */
+void
+offsetGradient(Eigen::VectorXd& gradient,
+               const PartitionedMatrix& x,
+               const Eigen::VectorXd& offset,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const JitNormalization jit_normalization,
+               const Eigen::VectorXd& w = Eigen::VectorXd());
+
+/**
+ * @brief Computes the gradient and Hessian of a coefficient for coordinate
+ * descent, from a partitioned matrix
+ *
+ * @see computeGradientAndHessian() for dense and sparse matrices
+ */
+std::pair<double, double>
+computeGradientAndHessian(const PartitionedMatrix& x,
+                          const IndexType ind,
+                          const Eigen::MatrixXd& w,
+                          const Eigen::MatrixXd& residual,
+                          const Eigen::VectorXd& x_centers,
+                          const Eigen::VectorXd& x_scales,
+                          const double s,
+                          const JitNormalization jit_normalization,
+                          const int n);
+
+/**
+ * @brief Computes the gradient and Hessian of a cluster for coordinate
+ * descent, from a partitioned matrix
+ *
+ * @see computeClusterGradientAndHessian() for dense and sparse matrices
+ */
+std::pair<double, double>
+computeClusterGradientAndHessian(const PartitionedMatrix& x,
+                                 const IndexType c_ind,
+                                 const std::vector<int>& s,
+                                 const Clusters& clusters,
+                                 const Eigen::MatrixXd& w,
+                                 const Eigen::MatrixXd& residual,
+                                 const Eigen::VectorXd& x_centers,
+                                 const Eigen::VectorXd& x_scales,
+                                 const JitNormalization jit_normalization);
+
+/**
+ * @brief Multiplies a partitioned matrix with a sparse matrix, for instance
+ * to predict from the coefficients of a fit
+ */
+Eigen::MatrixXd
+operator*(const PartitionedMatrix& x, const Eigen::SparseMatrix<double>& b);
+
+/**
+ * @brief Computes centers and scales of a partitioned matrix from its column
+ * statistics
+ *
+ * The matrix is never modified, regardless of `modify_x`.
+ *
+ * @see normalize() for dense and sparse matrices
+ */
+JitNormalization
+normalize(PartitionedMatrix& x,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool modify_x);
+
+/**
+ * @brief Computes centers and scales of a partitioned matrix with
+ * observation weights
+ *
+ * The matrix is never modified, regardless of `modify_x`.
+ *
+ * @see normalize() for dense and sparse matrices
+ */
+JitNormalization
+normalize(PartitionedMatrix& x,
+          const Eigen::VectorXd& w,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool modify_x);
+
+/**
+ * @brief Checks a partitioned matrix for non-finite values
+ */
+bool
+isFinite(const PartitionedMatrix& x);
+
+} // namespace slope
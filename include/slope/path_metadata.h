@@ -0,0 +1,34 @@
+/**
+ * @file
+ * @brief Metadata shared by all fits along a SLOPE path
+ */
+
+#pragma once
+
+#include <Eigen/Core>
+#include <memory>
+#include <string>
+
+namespace slope {
+
+/**
+ * @brief Quantities that are constant along a regularization path
+ *
+ * Every fit along a path uses the same penalty weights and the same
+ * normalization of the design matrix, so these are stored once and shared
+ * (read-only) between all SlopeFit objects of a path, as well as the
+ * relaxed fits derived from them.
+ */
+struct PathMetadata
+{
+  Eigen::ArrayXd lambda;      ///< Regularization weights for sorted L1 norm
+  double null_deviance = 0.0; ///< Null (or intercept-only) model deviance
+  std::string centering_type; ///< Type of centering
+  std::string scaling_type;   ///< Type of scaling
+  std::string loss_type;      ///< Loss type
+  bool has_intercept = true;  ///< Whether the model has an intercept term
+  Eigen::VectorXd x_centers;  ///< Centers for the design matrix
+  Eigen::VectorXd x_scales;   ///< Scales for the design matrix
+};
+
+} // namespace slope
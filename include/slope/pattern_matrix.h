@@ -0,0 +1,271 @@
+/**
+ * @file
+ * @brief Sparse design matrices whose stored values are all one
+ */
+
+#pragma once
+
+#include "clusters.h"
+#include "column_statistics.h"
+#include "jit_normalization.h"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace slope {
+class PatternMatrix;
+}
+
+namespace Eigen {
+namespace internal {
+
+/// Lets PatternMatrix pass as an Eigen::EigenBase, like Eigen's own
+/// matrix-free operators
+template<>
+struct traits<slope::PatternMatrix>
+  : public Eigen::internal::traits<Eigen::SparseMatrix<double>>
+{};
+
+} // namespace internal
+} // namespace Eigen
+
+namespace slope {
+
+/**
+ * @brief A sparse matrix of zeros and ones, such as one-hot encoded or
+ * indicator features, stored by its pattern alone
+ *
+ * The matrix is stored in compressed sparse column format, but without the
+ * values, which are all one. This saves the memory of the values, and turns
+ * the products of the kernels into sums over the rows of each column:
+ * the gradient, for instance, is a sum of the weighted residuals at the rows
+ * of the ones.
+ *
+ * The matrix can be passed to Slope::path() and SlopeFit::predict() like any
+ * other matrix. Since it is sparse, it is normalized just-in-time, from
+ * statistics that follow from the number of ones in each column.
+ */
+class PatternMatrix : public Eigen::EigenBase<PatternMatrix>
+{
+public:
+  /// Element type
+  using Scalar = double;
+
+  /// Real element type
+  using RealScalar = double;
+
+  /// Index type
+  using StorageIndex = int;
+
+  enum
+  {
+    ColsAtCompileTime = Eigen::Dynamic,
+    MaxColsAtCompileTime = Eigen::Dynamic,
+    IsRowMajor = false
+  };
+
+  /**
+   * @brief Creates a matrix from the pattern of a sparse matrix
+   *
+   * Explicitly stored zeros are dropped.
+   *
+   * @param x The sparse matrix
+   * @throws std::invalid_argument If a stored value is neither zero nor one
+   */
+  explicit PatternMatrix(const Eigen::SparseMatrix<double>& x);
+
+  /**
+   * @brief Creates a matrix from its pattern in compressed sparse column
+   * format
+   *
+   * @param n Number of rows
+   * @param p Number of columns
+   * @param outer_starts The p + 1 offsets of the columns in `inner_indices`
+   * @param inner_indices The rows of the ones, column by column
+   * @throws std::invalid_argument If the pattern is not valid
+   */
+  PatternMatrix(const int n,
+                const int p,
+                std::vector<int> outer_starts,
+                std::vector<int> inner_indices);
+
+  /// Number of rows
+  Eigen::Index rows() const { return n_rows; }
+
+  /// Number of columns
+  Eigen::Index cols() const { return outer_starts.size() - 1; }
+
+  /// Number of ones
+  Eigen::Index nonZeros() const { return inner_indices.size(); }
+
+  /// Offsets of the columns in getInnerIndices()
+  const std::vector<int>& getOuterStarts() const { return outer_starts; }
+
+  /// Rows of the ones, column by column
+  const std::vector<int>& getInnerIndices() const { return inner_indices; }
+
+  /// Column statistics of the matrix
+  const ColumnStatistics& statistics() const { return x_stats; }
+
+  /**
+   * @brief Calls a function with the row of each one in a column
+   *
+   * @param j Index of the column
+   * @param f Function that is called with each row
+   */
+  template<typename F>
+  void forEachRow(const int j, F&& f) const
+  {
+    for (int i = outer_starts[j]; i < outer_starts[j + 1]; ++i) {
+      f(inner_indices[i]);
+    }
+  }
+
+  /**
+   * @brief A column of the matrix, as a sparse vector
+   *
+   * @param j Index of the column
+   */
+  Eigen::SparseVector<double> col(const Eigen::Index j) const;
+
+  /// The matrix, as a sparse matrix with values
+  Eigen::SparseMatrix<double> toSparse() const;
+
+private:
+  void computeStatistics();
+
+  int n_rows = 0;
+  std::vector<int> outer_starts;
+  std::vector<int> inner_indices;
+  ColumnStatistics x_stats;
+};
+
+/**
+ * @brief Computes the linear predictor from a pattern matrix
+ *
+ * @see linearPredictor() for dense and sparse matrices
+ */
+Eigen::MatrixXd
+linearPredictor(const PatternMatrix& x,
+                const std::vector<IndexType>& active_set,
+                const Eigen::VectorXd& beta0,
+                const Eigen::VectorXd& beta,
+                const Eigen::VectorXd& x_centers,
+                const Eigen::VectorXd& x_scales,
+                const JitNormalization jit_normalization,
+                const bool intercept);
+
+/**
+ * @brief Computes the gradient from a pattern matrix
+ *
+ * @see updateGradient() for dense and sparse matrices
+ */
+void
+updateGradient(Eigen::VectorXd& gradient,
+               const PatternMatrix& x,
+               const Eigen::MatrixXd& residual,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const Eigen::VectorXd& w,
+               const JitNormalization jit_normalization);
+
+/**
+ * @brief Offsets the gradient for a pattern matrix
+ *
+ * @see offsetGradient() for dense and sparse matrices
+ */
+void
+offsetGradient(Eigen::VectorXd& gradient,
+               const PatternMatrix& x,
+               const Eigen::VectorXd& offset,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const JitNormalization jit_normalization,
+               const Eigen::VectorXd& w = Eigen::VectorXd());
+
+/**
+ * @brief Computes the gradient and Hessian of a coefficient for coordinate
+ * descent, from a pattern matrix
+ *
+ * @see computeGradientAndHessian() for dense and sparse matrices
+ */
+std::pair<double, double>
+computeGradientAndHessian(const PatternMatrix& x,
+                          const IndexType ind,
+                          const Eigen::MatrixXd& w,
+                          const Eigen::MatrixXd& residual,
+                          const Eigen::VectorXd& x_centers,
+                          const Eigen::VectorXd& x_scales,
+                          const double s,
+                          const JitNormalization jit_normalization,
+                          const int n);
+
+/**
+ * @brief Computes the gradient and Hessian of a cluster for coordinate
+ * descent, from a pattern matrix
+ *
+ * @see computeClusterGradientAndHessian() for dense and sparse matrices
+ */
+std::pair<double, double>
+computeClusterGradientAndHessian(const PatternMatrix& x,
+                                 const IndexType c_ind,
+                                 const std::vector<int>& s,
+                                 const Clusters& clusters,
+                                 const Eigen::MatrixXd& w,
+                                 const Eigen::MatrixXd& residual,
+                                 const Eigen::VectorXd& x_centers,
+                                 const Eigen::VectorXd& x_scales,
+                                 const JitNormalization jit_normalization);
+
+/**
+ * @brief Multiplies a pattern matrix with a sparse matrix, for instance to
+ * predict from the coefficients of a fit
+ */
+Eigen::MatrixXd
+operator*(const PatternMatrix& x, const Eigen::SparseMatrix<double>& b);
+
+/**
+ * @brief Computes centers and scales of a pattern matrix from its column
+ * statistics
+ *
+ * The matrix is never modified, regardless of `modify_x`.
+ *
+ * @see normalize() for dense and sparse matrices
+ */
+JitNormalization
+normalize(PatternMatrix& x,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool modify_x);
+
+/**
+ * @brief Computes centers and scales of a pattern matrix with observation
+ * weights
+ *
+ * The matrix is never modified, regardless of `modify_x`.
+ *
+ * @see normalize() for dense and sparse matrices
+ */
+JitNormalization
+normalize(PatternMatrix& x,
+          const Eigen::VectorXd& w,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool modify_x);
+
+/**
+ * @brief Checks a pattern matrix for non-finite values, which it cannot
+ * contain
+ */
+bool
+isFinite(const PatternMatrix& x);
+
+} // namespace slope
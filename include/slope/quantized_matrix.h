@@ -0,0 +1,589 @@
+/**
+ * @file
+ * @brief Design matrices that are stored as 8- or 16-bit integer codes
+ */
+
+#pragma once
+
+#include "clusters.h"
+#include "column_statistics.h"
+#include "jit_normalization.h"
+#include "normalize.h"
+#include "threads.h"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace slope {
+template<typename Code>
+class QuantizedMatrix;
+}
+
+namespace Eigen {
+namespace internal {
+
+/// Lets QuantizedMatrix pass as an Eigen::EigenBase, like Eigen's own
+/// matrix-free operators
+template<typename Code>
+struct traits<slope::QuantizedMatrix<Code>>
+  : public Eigen::internal::traits<Eigen::SparseMatrix<double>>
+{};
+
+} // namespace internal
+} // namespace Eigen
+
+namespace slope {
+
+/**
+ * @brief A dense design matrix that is stored as unsigned integer codes, with
+ * an affine map back to the values for each column
+ *
+ * Element \f$(i, j)\f$ of the matrix is \f$a_j + b_j q_{ij}\f$, where
+ * \f$q_{ij}\f$ is the stored code, \f$a_j\f$ the offset and \f$b_j\f$ the
+ * step of column j. Counts and bucketed features are represented exactly,
+ * and other features are rounded to \f$2^8\f$ or \f$2^{16}\f$ evenly spaced
+ * levels between the minimum and maximum of their column. The matrix takes
+ * up one eighth (or one quarter) of the memory of a dense matrix of doubles,
+ * which is what bounds the speed of the gradient and linear predictor.
+ *
+ * The matrix can be passed to Slope::path() like any other matrix. Its
+ * kernels work on the codes directly: the affine map of each column is
+ * folded into the centers and scales of the just-in-time normalization (see
+ * foldQuantization()), so that the values are never formed. The fitted
+ * coefficients refer to the values, not the codes.
+ *
+ * @tparam Code Type of the codes, `std::uint8_t` or `std::uint16_t`
+ */
+template<typename Code>
+class QuantizedMatrix : public Eigen::EigenBase<QuantizedMatrix<Code>>
+{
+  static_assert(std::is_integral_v<Code> && std::is_unsigned_v<Code>,
+                "Codes must be unsigned integers");
+
+public:
+  /// Element type
+  using Scalar = double;
+
+  /// Real element type
+  using RealScalar = double;
+
+  /// Index type
+  using StorageIndex = int;
+
+  /// Matrix of codes
+  using Codes = Eigen::Matrix<Code, Eigen::Dynamic, Eigen::Dynamic>;
+
+  enum
+  {
+    ColsAtCompileTime = Eigen::Dynamic,
+    MaxColsAtCompileTime = Eigen::Dynamic,
+    IsRowMajor = false
+  };
+
+  /**
+   * @brief Quantizes a dense matrix
+   *
+   * Each column is rounded to the nearest of the evenly spaced levels
+   * between its minimum and maximum, so that the error of each element is at
+   * most half the step of its column. Columns with fewer distinct integer
+   * values than there are levels, such as counts, are stored exactly.
+   *
+   * @param x The matrix
+   * @throws std::invalid_argument If x contains non-finite values
+   */
+  explicit QuantizedMatrix(const Eigen::MatrixXd& x)
+    : codes(x.rows(), x.cols())
+    , offsets(x.cols())
+    , steps(x.cols())
+  {
+    if (!x.allFinite()) {
+      throw std::invalid_argument("x must not contain NA, NaN, or Inf values");
+    }
+
+    const double max_code = std::numeric_limits<Code>::max();
+
+    for (int j = 0; j < x.cols(); ++j) {
+      const double lo = x.rows() > 0 ? x.col(j).minCoeff() : 0.0;
+      const double hi = x.rows() > 0 ? x.col(j).maxCoeff() : 0.0;
+
+      const bool integral =
+        (x.col(j).array() == x.col(j).array().round()).all();
+
+      double step = (hi - lo) / max_code;
+
+      if (hi == lo || (integral && hi - lo <= max_code)) {
+        step = 1.0;
+      }
+
+      offsets(j) = lo;
+      steps(j) = step;
+      codes.col(j) = ((x.col(j).array() - lo) / step)
+                        .round()
+                        .min(max_code)
+                        .template cast<Code>()
+                        .matrix();
+    }
+
+    computeStatistics();
+  }
+
+  /**
+   * @brief Creates a matrix from its codes
+   *
+   * @param codes_in The codes
+   * @param offsets_in Offset of each column
+   * @param steps_in Step of each column
+   * @throws std::invalid_argument If the dimensions do not match, the
+   *   offsets are not finite, or the steps are not positive and finite
+   */
+  QuantizedMatrix(Codes codes_in,
+                  Eigen::VectorXd offsets_in,
+                  Eigen::VectorXd steps_in)
+    : codes(std::move(codes_in))
+    , offsets(std::move(offsets_in))
+    , steps(std::move(steps_in))
+  {
+    if (offsets.size() != codes.cols() || steps.size() != codes.cols()) {
+      throw std::invalid_argument(
+        "offsets and steps must have one element for each column of codes");
+    }
+
+    if (!offsets.allFinite()) {
+      throw std::invalid_argument("offsets must be finite");
+    }
+
+    if (!steps.allFinite() || (steps.array() <= 0).any()) {
+      throw std::invalid_argument("steps must be positive and finite");
+    }
+
+    computeStatistics();
+  }
+
+  /// Number of rows
+  Eigen::Index rows() const { return codes.rows(); }
+
+  /// Number of columns
+  Eigen::Index cols() const { return codes.cols(); }
+
+  /// The codes
+  const Codes& getCodes() const { return codes; }
+
+  /// Offset of each column
+  const Eigen::VectorXd& getOffsets() const { return offsets; }
+
+  /// Step of each column
+  const Eigen::VectorXd& getSteps() const { return steps; }
+
+  /// Column statistics of the values
+  const ColumnStatistics& statistics() const { return x_stats; }
+
+  /**
+   * @brief The values of a column, as an expression that is evaluated from
+   * the codes on the fly
+   *
+   * @param j Index of the column
+   */
+  auto col(const Eigen::Index j) const
+  {
+    return (codes.col(j).template cast<double>().array() * steps(j) +
+            offsets(j))
+      .matrix();
+  }
+
+  /// The values of the matrix, as a dense matrix
+  Eigen::MatrixXd dequantize() const
+  {
+    Eigen::MatrixXd x(rows(), cols());
+
+    for (int j = 0; j < cols(); ++j) {
+      x.col(j) = col(j);
+    }
+
+    return x;
+  }
+
+private:
+  void computeStatistics()
+  {
+    const int n = rows();
+    const int p = cols();
+
+    Eigen::VectorXd mean(p), m2(p), abs_sum(p), min(p), max(p);
+
+    for (int j = 0; j < p; ++j) {
+      const Eigen::VectorXd x_j = col(j);
+
+      mean(j) = n > 0 ? x_j.mean() : 0.0;
+      m2(j) = (x_j.array() - mean(j)).square().sum();
+      abs_sum(j) = x_j.cwiseAbs().sum();
+      min(j) = n > 0 ? x_j.minCoeff() : 0.0;
+      max(j) = n > 0 ? x_j.maxCoeff() : 0.0;
+    }
+
+    x_stats = ColumnStatistics(n,
+                               static_cast<double>(n),
+                               std::move(mean),
+                               std::move(m2),
+                               std::move(abs_sum),
+                               std::move(min),
+                               std::move(max));
+  }
+
+  Codes codes;
+  Eigen::VectorXd offsets;
+  Eigen::VectorXd steps;
+  ColumnStatistics x_stats;
+};
+
+/// A matrix with 8-bit codes
+using QuantizedMatrix8 = QuantizedMatrix<std::uint8_t>;
+
+/// A matrix with 16-bit codes
+using QuantizedMatrix16 = QuantizedMatrix<std::uint16_t>;
+
+/**
+ * @brief Folds the quantization of a column into its normalization
+ *
+ * With the values \f$a_j + b_j q_{ij}\f$ of column j, any just-in-time
+ * normalization \f$(x_{ij} - c_j) / s_j\f$ (where \f$c_j = 0\f$ or
+ * \f$s_j = 1\f$ if the column is not centered or scaled) equals
+ * \f$(q_{ij} - c'_j) / s'_j\f$, with \f$c'_j = (c_j - a_j) / b_j\f$ and
+ * \f$s'_j = s_j / b_j\f$, which the kernels apply to the codes directly.
+ *
+ * @param x The matrix
+ * @param j Index of the column
+ * @param x_centers Centers of the columns of the values
+ * @param x_scales Scales of the columns of the values
+ * @param jit_normalization Type of just-in-time normalization
+ * @return The center and scale of the codes
+ */
+template<typename Code>
+std::pair<double, double>
+foldQuantization(const QuantizedMatrix<Code>& x,
+                 const int j,
+                 const Eigen::VectorXd& x_centers,
+                 const Eigen::VectorXd& x_scales,
+                 const JitNormalization jit_normalization)
+{
+  const bool center = jit_normalization == JitNormalization::Both ||
+                      jit_normalization == JitNormalization::Center;
+  const bool scale = jit_normalization == JitNormalization::Both ||
+                     jit_normalization == JitNormalization::Scale;
+
+  const double a = x.getOffsets()(j);
+  const double b = x.getSteps()(j);
+
+  const double c = center ? x_centers(j) : 0.0;
+  const double s = scale ? x_scales(j) : 1.0;
+
+  return { (c - a) / b, s / b };
+}
+
+/**
+ * @brief Computes the linear predictor from a quantized matrix
+ *
+ * @see linearPredictor() for dense and sparse matrices
+ */
+template<typename Code>
+Eigen::MatrixXd
+linearPredictor(const QuantizedMatrix<Code>& x,
+                const std::vector<IndexType>& active_set,
+                const Eigen::VectorXd& beta0,
+                const Eigen::VectorXd& beta,
+                const Eigen::VectorXd& x_centers,
+                const Eigen::VectorXd& x_scales,
+                const JitNormalization jit_normalization,
+                const bool intercept)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+  const int m = beta0.size();
+
+  Eigen::MatrixXd eta = Eigen::MatrixXd::Zero(n, m);
+  Eigen::ArrayXd shift = Eigen::ArrayXd::Zero(m);
+
+  for (IndexType ind : active_set) {
+    auto [k, j] = splitIndex(ind, p);
+    auto [center, scale] =
+      foldQuantization(x, j, x_centers, x_scales, jit_normalization);
+
+    eta.col(k) +=
+      x.getCodes().col(j).template cast<double>() * (beta(ind) / scale);
+    shift(k) += beta(ind) * center / scale;
+  }
+
+  for (int k = 0; k < m; ++k) {
+    eta.col(k).array() -= shift(k) - (intercept ? beta0(k) : 0.0);
+  }
+
+  return eta;
+}
+
+/**
+ * @brief Computes the gradient from a quantized matrix
+ *
+ * @see updateGradient() for dense and sparse matrices
+ */
+template<typename Code>
+void
+updateGradient(Eigen::VectorXd& gradient,
+               const QuantizedMatrix<Code>& x,
+               const Eigen::MatrixXd& residual,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const Eigen::VectorXd& w,
+               const JitNormalization jit_normalization)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+
+  Eigen::MatrixXd weighted_residual = w.asDiagonal() * residual;
+  Eigen::VectorXd wr_sums = weighted_residual.colwise().sum();
+
+#ifdef _OPENMP
+  bool large_problem = active_set.size() > 100 &&
+                       static_cast<double>(n) * active_set.size() > 1e5;
+#pragma omp parallel for num_threads(Threads::get()) if (large_problem)
+#endif
+  for (IndexType i = 0; i < static_cast<IndexType>(active_set.size()); ++i) {
+    IndexType ind = active_set[i];
+    auto [k, j] = splitIndex(ind, p);
+    auto [center, scale] =
+      foldQuantization(x, j, x_centers, x_scales, jit_normalization);
+
+    gradient(ind) = (x.getCodes().col(j).template cast<double>().dot(
+                       weighted_residual.col(k)) -
+                     center * wr_sums(k)) /
+                    (scale * n);
+  }
+}
+
+/**
+ * @brief Offsets the gradient for a quantized matrix
+ *
+ * @see offsetGradient() for dense and sparse matrices
+ */
+template<typename Code>
+void
+offsetGradient(Eigen::VectorXd& gradient,
+               const QuantizedMatrix<Code>& x,
+               const Eigen::VectorXd& offset,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const JitNormalization jit_normalization,
+               const Eigen::VectorXd& w = Eigen::VectorXd())
+{
+  const int n = x.rows();
+  const int p = x.cols();
+
+  for (IndexType ind : active_set) {
+    auto [k, j] = splitIndex(ind, p);
+    auto [center, scale] =
+      foldQuantization(x, j, x_centers, x_scales, jit_normalization);
+
+    const double code_mean =
+      w.size() > 0 ? x.getCodes().col(j).template cast<double>().dot(w) / n
+                   : x.getCodes().col(j).template cast<double>().sum() / n;
+
+    gradient(ind) -= offset(k) * (code_mean - center) / scale;
+  }
+}
+
+/**
+ * @brief Computes the gradient and Hessian of a coefficient for coordinate
+ * descent, from a quantized matrix
+ *
+ * @see computeGradientAndHessian() for dense and sparse matrices
+ */
+template<typename Code>
+std::pair<double, double>
+computeGradientAndHessian(const QuantizedMatrix<Code>& x,
+                          const IndexType ind,
+                          const Eigen::MatrixXd& w,
+                          const Eigen::MatrixXd& residual,
+                          const Eigen::VectorXd& x_centers,
+                          const Eigen::VectorXd& x_scales,
+                          const double s,
+                          const JitNormalization jit_normalization,
+                          const int n)
+{
+  auto [k, j] = splitIndex(ind, static_cast<int>(x.cols()));
+  auto [center, scale] =
+    foldQuantization(x, j, x_centers, x_scales, jit_normalization);
+
+  const auto q = x.getCodes().col(j).template cast<double>();
+  const auto w_k = w.col(k);
+  const auto r_k = residual.col(k);
+
+  const double gradient =
+    s * (q.cwiseProduct(w_k).dot(r_k) - w_k.dot(r_k) * center) / (n * scale);
+  const double hessian = (q.cwiseAbs2().dot(w_k) - 2 * center * q.dot(w_k) +
+                          center * center * w_k.sum()) /
+                         (scale * scale * n);
+
+  return { gradient, hessian };
+}
+
+/**
+ * @brief Computes the gradient and Hessian of a cluster for coordinate
+ * descent, from a quantized matrix
+ *
+ * @see computeClusterGradientAndHessian() for dense and sparse matrices
+ */
+template<typename Code>
+std::pair<double, double>
+computeClusterGradientAndHessian(const QuantizedMatrix<Code>& x,
+                                 const IndexType c_ind,
+                                 const std::vector<int>& s,
+                                 const Clusters& clusters,
+                                 const Eigen::MatrixXd& w,
+                                 const Eigen::MatrixXd& residual,
+                                 const Eigen::VectorXd& x_centers,
+                                 const Eigen::VectorXd& x_scales,
+                                 const JitNormalization jit_normalization)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+  const int m = residual.cols();
+
+  Eigen::MatrixXd x_s = Eigen::MatrixXd::Zero(n, m);
+  Eigen::ArrayXd shift = Eigen::ArrayXd::Zero(m);
+
+  auto s_it = s.cbegin();
+  auto c_it = clusters.cbegin(c_ind);
+
+  for (; c_it != clusters.cend(c_ind); ++c_it, ++s_it) {
+    auto [k, j] = splitIndex(*c_it, p);
+    auto [center, scale] =
+      foldQuantization(x, j, x_centers, x_scales, jit_normalization);
+
+    x_s.col(k) += x.getCodes().col(j).template cast<double>() * (*s_it / scale);
+    shift(k) += center * *s_it / scale;
+  }
+
+  double hess = 0;
+  double grad = 0;
+
+  for (int k = 0; k < m; ++k) {
+    x_s.col(k).array() -= shift(k);
+
+    hess += x_s.col(k).cwiseAbs2().dot(w.col(k)) / n;
+    grad += x_s.col(k).cwiseProduct(w.col(k)).dot(residual.col(k)) / n;
+  }
+
+  return { hess, grad };
+}
+
+/**
+ * @brief Multiplies a quantized matrix with a sparse matrix, for instance to
+ * predict from the coefficients of a fit
+ */
+template<typename Code>
+Eigen::MatrixXd
+operator*(const QuantizedMatrix<Code>& x, const Eigen::SparseMatrix<double>& b)
+{
+  Eigen::MatrixXd out = Eigen::MatrixXd::Zero(x.rows(), b.cols());
+
+  for (int k = 0; k < b.outerSize(); ++k) {
+    for (Eigen::SparseMatrix<double>::InnerIterator it(b, k); it; ++it) {
+      out.col(k) += x.col(it.row()) * it.value();
+    }
+  }
+
+  return out;
+}
+
+/**
+ * @brief Computes centers and scales of a quantized matrix from its column
+ * statistics
+ *
+ * The matrix is never modified, regardless of `modify_x`.
+ *
+ * @see normalize() for dense and sparse matrices
+ */
+template<typename Code>
+JitNormalization
+normalize(QuantizedMatrix<Code>& x,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool)
+{
+  return normalize(
+    x.statistics(), x_centers, x_scales, centering_type, scaling_type);
+}
+
+/**
+ * @brief Computes centers and scales of a quantized matrix with observation
+ * weights
+ *
+ * The matrix is never modified, regardless of `modify_x`.
+ *
+ * @see normalize() for dense and sparse matrices
+ */
+template<typename Code>
+JitNormalization
+normalize(QuantizedMatrix<Code>& x,
+          const Eigen::VectorXd& w,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool)
+{
+  ColumnStatistics x_stats(x.cols());
+
+  if (usesColumnStatistics(centering_type, scaling_type)) {
+    // The statistics are computed one column at a time, to avoid forming
+    // the values of the whole matrix
+    const int p = x.cols();
+
+    Eigen::VectorXd mean(p), m2(p), abs_sum(p), min(p), max(p);
+    double w_sum = 0;
+
+    for (int j = 0; j < p; ++j) {
+      ColumnStatistics col_stats(1);
+      col_stats.update(Eigen::MatrixXd(x.col(j)), w);
+
+      w_sum = col_stats.weight();
+      mean(j) = col_stats.getMeans()(0);
+      m2(j) = col_stats.getM2()(0);
+      abs_sum(j) = col_stats.getAbsSums()(0);
+      min(j) = col_stats.getMinima()(0);
+      max(j) = col_stats.getMaxima()(0);
+    }
+
+    x_stats = ColumnStatistics(x.rows(),
+                               w_sum,
+                               std::move(mean),
+                               std::move(m2),
+                               std::move(abs_sum),
+                               std::move(min),
+                               std::move(max));
+  }
+
+  return normalize(
+    x_stats, x_centers, x_scales, centering_type, scaling_type);
+}
+
+/**
+ * @brief Checks a quantized matrix for non-finite values, which it cannot
+ * contain since its offsets and steps are finite
+ */
+template<typename Code>
+bool
+isFinite(const QuantizedMatrix<Code>&)
+{
+  return true;
+}
+
+} // namespace slope
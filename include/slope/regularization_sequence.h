@@ -5,8 +5,10 @@
 
 #pragma once
 
+#include "index_type.h"
 #include <Eigen/SparseCore>
 #include <string>
+#include <vector>
 
 namespace slope {
 
@@ -27,13 +29,56 @@ namespace slope {
  * order
  */
 Eigen::ArrayXd
-lambdaSequence(const int p,
+lambdaSequence(const IndexType p,
                const double q,
                const std::string& type,
                const int n = -1,
                const double theta1 = 1.0,
                const double theta2 = 1.0);
 
+/**
+ * Generates the first values of a sequence of regularization weights for the
+ * sorted L1 norm, for problems with too many features to form the whole
+ * sequence, such as those with interactions.
+ *
+ * @param length The number of values to generate, at most `p`
+ * @param p The number of features, as in lambdaSequence(), which may exceed
+ *   the range of `int` when slope::IndexType is 64-bit
+ * @param q The false discovery rate (FDR) level or quantile value (in (0, 1))
+ * @param type The type of sequence, as in lambdaSequence()
+ * @param n Number of observations (only used for gaussian type)
+ * @param theta1 First parameter for OSCAR weights (default: 1.0)
+ * @param theta2 Second parameter for OSCAR weights (default: 1.0)
+ * @return The first `length` values of lambdaSequence()
+ * @see lambdaSequence()
+ */
+Eigen::ArrayXd
+lambdaSequenceHead(const Eigen::Index length,
+                   const IndexType p,
+                   const double q,
+                   const std::string& type,
+                   const int n = -1,
+                   const double theta1 = 1.0,
+                   const double theta2 = 1.0);
+
+/**
+ * Computes a lower bound for the smallest value of a sequence of
+ * regularization weights for the sorted L1 norm, without generating the
+ * sequence. The bound is the smallest value itself for all types except
+ * "gaussian", whose values are those of "bh", inflated.
+ *
+ * @param q The false discovery rate (FDR) level or quantile value (in (0, 1))
+ * @param type The type of sequence, as in lambdaSequence()
+ * @param theta1 First parameter for OSCAR weights (default: 1.0)
+ * @return A value that is at most the smallest value of lambdaSequence(),
+ *   whatever its length
+ * @see lambdaSequence()
+ */
+double
+lambdaSequenceMin(const double q,
+                  const std::string& type,
+                  const double theta1 = 1.0);
+
 /**
  * Computes a sequence of regularization weights for the SLOPE path.
  *
@@ -50,4 +95,27 @@ regularizationPath(const Eigen::ArrayXd& alpha_in,
                    double alpha_min_ratio,
                    const double alpha_max);
 
+/**
+ * Matches the steps of a regularization path with those of a previously
+ * fitted path, for use as warm starts.
+ *
+ * If the two alpha sequences are proportional (which is the case for
+ * automatically generated sequences of the same length and ratio, as well as
+ * for identical sequences), steps are matched by position. Otherwise, each
+ * step is matched with the previous step that is closest to it on the log
+ * scale, provided that this step is closer than the solution the path would
+ * otherwise continue from.
+ *
+ * @param alpha Alpha sequence of the path to fit
+ * @param alpha_prev Alpha sequence of the previously fitted path
+ * @param alpha_max Value of alpha at which the model is completely sparse,
+ * which is where the path starts from
+ * @return A vector with one element per step in `alpha`, containing the index
+ * of the matching step in `alpha_prev`, or -1 if there is no good match.
+ */
+std::vector<int>
+alignPaths(const Eigen::ArrayXd& alpha,
+           const Eigen::ArrayXd& alpha_prev,
+           const double alpha_max);
+
 } // namespace slope
@@ -0,0 +1,194 @@
+/**
+ * @file
+ * @brief Compression of duplicated rows of the data into weighted unique rows
+ */
+
+#pragma once
+
+#include "utils.h"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace slope {
+
+/**
+ * @brief Data with duplicated rows collapsed into unique rows and counts
+ *
+ * Fitting a model to the unique rows, with the counts as observation weights
+ * (see the weighted version of Slope::path()), gives the same coefficients
+ * and deviances as fitting it to the original data.
+ *
+ * @tparam T The type of the design matrix
+ */
+template<typename T>
+struct CompressedRows
+{
+  T x;                      ///< Unique rows of the design matrix
+  Eigen::MatrixXd y;        ///< Response for the unique rows
+  Eigen::VectorXd counts;   ///< Number of occurrences of each unique row
+  std::vector<int> row_map; ///< Index of the unique row of each original row
+
+  /// Number of original rows per unique row
+  double compressionRatio() const
+  {
+    return static_cast<double>(row_map.size()) / x.rows();
+  }
+};
+
+namespace detail {
+
+/**
+ * @brief Combines a hash value into a running hash
+ */
+inline void
+hashCombine(std::size_t& seed, const std::size_t value)
+{
+  seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+}
+
+/**
+ * @brief Hashes a value of the data so that 0 and -0 hash equally
+ */
+inline std::size_t
+hashValue(const double value)
+{
+  return std::hash<double>{}(value == 0.0 ? 0.0 : value);
+}
+
+/**
+ * @brief Groups rows into unique rows
+ *
+ * @param hashes Hash of each row
+ * @param equal Returns whether two rows, with equal hashes, are equal
+ * @param unique_rows Index of the first occurrence of each unique row, in
+ *   order of appearance
+ * @param row_map Index into unique_rows of each row
+ * @param counts Number of occurrences of each unique row
+ */
+void
+groupRows(const std::vector<std::size_t>& hashes,
+          const std::function<bool(int, int)>& equal,
+          std::vector<int>& unique_rows,
+          std::vector<int>& row_map,
+          Eigen::VectorXd& counts);
+
+/**
+ * @brief Hashes the rows of the response
+ */
+std::vector<std::size_t>
+hashRows(const Eigen::MatrixXd& y);
+
+} // namespace detail
+
+/**
+ * @brief Collapses duplicated rows of a dense design matrix and response
+ *
+ * Two rows are duplicates if both their rows in the design matrix and in the
+ * response are exactly equal. Rows are hashed in a single pass over the data,
+ * and only rows with equal hashes are compared.
+ *
+ * @tparam T The type of the design matrix
+ * @param x The design matrix
+ * @param y The response, with the same number of rows as x
+ * @return The unique rows, in order of first appearance, and their counts
+ */
+template<typename T>
+CompressedRows<Eigen::MatrixXd>
+compressRows(const Eigen::MatrixBase<T>& x, const Eigen::MatrixXd& y)
+{
+  if (x.rows() != y.rows()) {
+    throw std::invalid_argument("x and y must have the same number of rows");
+  }
+
+  std::vector<std::size_t> hashes = detail::hashRows(y);
+
+  // Column-wise, to traverse x in storage order
+  for (int j = 0; j < x.cols(); ++j) {
+    for (int i = 0; i < x.rows(); ++i) {
+      detail::hashCombine(hashes[i], detail::hashValue(x(i, j)));
+    }
+  }
+
+  auto equal = [&x, &y](int a, int b) {
+    return x.row(a) == x.row(b) && y.row(a) == y.row(b);
+  };
+
+  CompressedRows<Eigen::MatrixXd> out;
+  std::vector<int> unique_rows;
+
+  detail::groupRows(hashes, equal, unique_rows, out.row_map, out.counts);
+
+  out.x = x.derived()(unique_rows, all);
+  out.y = y(unique_rows, all);
+
+  return out;
+}
+
+/**
+ * @brief Collapses duplicated rows of a sparse design matrix and response
+ *
+ * @tparam T The type of the design matrix
+ * @param x The design matrix
+ * @param y The response, with the same number of rows as x
+ * @return The unique rows, in order of first appearance, and their counts
+ *
+ * @see compressRows() for dense matrices. Explicitly stored zeros are treated
+ * as zeros.
+ */
+template<typename T>
+CompressedRows<Eigen::SparseMatrix<double>>
+compressRows(const Eigen::SparseMatrixBase<T>& x, const Eigen::MatrixXd& y)
+{
+  if (x.rows() != y.rows()) {
+    throw std::invalid_argument("x and y must have the same number of rows");
+  }
+
+  // Row-major copy, without explicit zeros, so that rows can be hashed and
+  // compared directly
+  Eigen::SparseMatrix<double, Eigen::RowMajor> x_rows = x.derived();
+  x_rows.prune([](int, int, double value) { return value != 0.0; });
+
+  using RowIterator =
+    Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator;
+
+  std::vector<std::size_t> hashes = detail::hashRows(y);
+
+  for (int i = 0; i < x_rows.rows(); ++i) {
+    for (RowIterator it(x_rows, i); it; ++it) {
+      detail::hashCombine(hashes[i], static_cast<std::size_t>(it.col()));
+      detail::hashCombine(hashes[i], detail::hashValue(it.value()));
+    }
+  }
+
+  auto equal = [&x_rows, &y](int a, int b) {
+    if (y.row(a) != y.row(b)) {
+      return false;
+    }
+
+    RowIterator it_a(x_rows, a);
+    RowIterator it_b(x_rows, b);
+
+    for (; it_a && it_b; ++it_a, ++it_b) {
+      if (it_a.col() != it_b.col() || it_a.value() != it_b.value()) {
+        return false;
+      }
+    }
+
+    return !it_a && !it_b;
+  };
+
+  CompressedRows<Eigen::SparseMatrix<double>> out;
+  std::vector<int> unique_rows;
+
+  detail::groupRows(hashes, equal, unique_rows, out.row_map, out.counts);
+
+  out.x = subset(Eigen::SparseMatrix<double>(x.derived()), unique_rows);
+  out.y = y(unique_rows, all);
+
+  return out;
+}
+
+} // namespace slope
@@ -85,6 +85,21 @@ public:
                       const Eigen::MatrixXd& y,
                       const std::unique_ptr<Loss>& loss) const = 0;
 
+  /**
+   * Evaluates the scoring metric for all the steps of a path at once.
+   * @param eta Matrix of model predictions for all steps, with the m columns
+   * of step `i` starting at column `i * m` (see SlopePath::predict())
+   * @param y Matrix of true responses, with m columns
+   * @param loss Loss function used in the model
+   * @return Vector with the score of each step
+   *
+   * The default implementation calls eval() for each step. Metrics that can
+   * share work between the steps override it.
+   */
+  virtual Eigen::VectorXd evalPath(const Eigen::MatrixXd& eta,
+                                   const Eigen::MatrixXd& y,
+                                   const std::unique_ptr<Loss>& loss) const;
+
   /**
    * Factory method to create specific Score implementations.
    * @param metric Name of the scoring metric to create
@@ -282,6 +297,15 @@ public:
   double eval(const Eigen::MatrixXd& eta,
               const Eigen::MatrixXd& y,
               const std::unique_ptr<Loss>& loss) const override;
+
+  /**
+   * Evaluates the deviance for all the steps of a path at once, computing
+   * the log-likelihood of the saturated model only once.
+   * @see Score::evalPath()
+   */
+  Eigen::VectorXd evalPath(const Eigen::MatrixXd& eta,
+                           const Eigen::MatrixXd& y,
+                           const std::unique_ptr<Loss>& loss) const override;
 };
 
 /**
@@ -314,6 +338,16 @@ public:
   double eval(const Eigen::MatrixXd& eta,
               const Eigen::MatrixXd& y,
               const std::unique_ptr<Loss>& loss) const override;
+
+  /**
+   * Evaluates the AUC-ROC score for all the steps of a path at once. For
+   * single-response models, the inverse link is applied to all the steps in
+   * one pass and the class counts of the labels are computed only once.
+   * @see Score::evalPath()
+   */
+  Eigen::VectorXd evalPath(const Eigen::MatrixXd& eta,
+                           const Eigen::MatrixXd& y,
+                           const std::unique_ptr<Loss>& loss) const override;
 };
 
 } // namespace slope
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "design_ref.h"
 #include "jit_normalization.h"
 #include <Eigen/SparseCore>
 #include <memory>
@@ -19,9 +20,10 @@ namespace slope {
  * @brief Identifies previously active variables
  *
  * @param beta Current coefficient matrix
- * @return std::vector<int> Indices of variables with non-zero coefficients
+ * @return std::vector<IndexType> Indices of variables with non-zero
+ * coefficients
  */
-std::vector<int>
+std::vector<IndexType>
 activeSet(const Eigen::VectorXd& beta);
 
 /**
@@ -30,9 +32,9 @@ activeSet(const Eigen::VectorXd& beta);
  * @param gradient_prev Gradient from previous solution
  * @param lambda Current lambda sequence
  * @param lambda_prev Previous lambda sequence
- * @return std::vector<int> Indices of variables in the strong set
+ * @return std::vector<IndexType> Indices of variables in the strong set
  */
-std::vector<int>
+std::vector<IndexType>
 strongSet(const Eigen::VectorXd& gradient_prev,
           const Eigen::ArrayXd& lambda,
           const Eigen::ArrayXd& lambda_prev);
@@ -60,8 +62,9 @@ public:
    * gradient
    * @return The initial working set
    */
-  virtual std::vector<int> initialize(const std::vector<int>& full_set,
-                                      int alpha_max_ind) = 0;
+  virtual std::vector<IndexType> initialize(
+    const std::vector<IndexType>& full_set,
+    IndexType alpha_max_ind) = 0;
 
   /**
    * @brief Screen for the next path step.
@@ -73,11 +76,12 @@ public:
    * @param full_set Full set of features
    * @return Working set for the current path step
    */
-  virtual std::vector<int> screen(Eigen::VectorXd& gradient,
-                                  const Eigen::ArrayXd& lambda_curr,
-                                  const Eigen::ArrayXd& lambda_prev,
-                                  const Eigen::VectorXd& beta,
-                                  const std::vector<int>& full_set) = 0;
+  virtual std::vector<IndexType> screen(
+    Eigen::VectorXd& gradient,
+    const Eigen::ArrayXd& lambda_curr,
+    const Eigen::ArrayXd& lambda_prev,
+    const Eigen::VectorXd& beta,
+    const std::vector<IndexType>& full_set) = 0;
 
   /**
    * @brief Check for KKT violations and update working set if necessary.
@@ -87,7 +91,7 @@ public:
    * @param lambda_curr Current lambda values
    * @param working_set Current working set (will be updated if violations
    * found)
-   * @param x Design matrix
+   * @param x Design matrix, of any of the types of DesignRef
    * @param residual Current residuals
    * @param x_centers Centers for normalization
    * @param x_scales Scales for normalization
@@ -98,91 +102,13 @@ public:
   virtual bool checkKktViolations(Eigen::VectorXd& gradient,
                                   const Eigen::VectorXd& beta,
                                   const Eigen::ArrayXd& lambda_curr,
-                                  std::vector<int>& working_set,
-                                  const Eigen::MatrixXd& x,
+                                  std::vector<IndexType>& working_set,
+                                  const DesignRef& x,
                                   const Eigen::MatrixXd& residual,
                                   const Eigen::VectorXd& x_centers,
                                   const Eigen::VectorXd& x_scales,
                                   JitNormalization jit_normalization,
-                                  const std::vector<int>& full_set) = 0;
-  /**
-   * @brief Check for KKT violations with sparse matrix input
-   * @param gradient The gradient vector
-   * @param beta Current beta coefficients
-   * @param lambda_curr Current lambda values
-   * @param working_set Current working set (will be updated if violations
-   * found)
-   * @param x Design matrix (sparse format)
-   * @param residual Current residuals
-   * @param x_centers Centers for normalization
-   * @param x_scales Scales for normalization
-   * @param jit_normalization Whether to use JIT normalization
-   * @param full_set Full set of features
-   * @return True if no violations found, false otherwise
-   */
-  virtual bool checkKktViolations(Eigen::VectorXd& gradient,
-                                  const Eigen::VectorXd& beta,
-                                  const Eigen::ArrayXd& lambda_curr,
-                                  std::vector<int>& working_set,
-                                  const Eigen::SparseMatrix<double>& x,
-                                  const Eigen::MatrixXd& residual,
-                                  const Eigen::VectorXd& x_centers,
-                                  const Eigen::VectorXd& x_scales,
-                                  JitNormalization jit_normalization,
-                                  const std::vector<int>& full_set) = 0;
-
-  /**
-   * @brief Check for KKT violations with sparse matrix input
-   * @param gradient The gradient vector
-   * @param beta Current beta coefficients
-   * @param lambda_curr Current lambda values
-   * @param working_set Current working set (will be updated if violations
-   * found)
-   * @param x Design matrix (sparse format)
-   * @param residual Current residuals
-   * @param x_centers Centers for normalization
-   * @param x_scales Scales for normalization
-   * @param jit_normalization Whether to use JIT normalization
-   * @param full_set Full set of features
-   * @return True if no violations found, false otherwise
-   */
-  virtual bool checkKktViolations(Eigen::VectorXd& gradient,
-                                  const Eigen::VectorXd& beta,
-                                  const Eigen::ArrayXd& lambda_curr,
-                                  std::vector<int>& working_set,
-                                  const Eigen::Map<Eigen::MatrixXd>& x,
-                                  const Eigen::MatrixXd& residual,
-                                  const Eigen::VectorXd& x_centers,
-                                  const Eigen::VectorXd& x_scales,
-                                  JitNormalization jit_normalization,
-                                  const std::vector<int>& full_set) = 0;
-
-  /**
-   * @brief Check for KKT violations with sparse matrix input
-   * @param gradient The gradient vector
-   * @param beta Current beta coefficients
-   * @param lambda_curr Current lambda values
-   * @param working_set Current working set (will be updated if violations
-   * found)
-   * @param x Design matrix (sparse format)
-   * @param residual Current residuals
-   * @param x_centers Centers for normalization
-   * @param x_scales Scales for normalization
-   * @param jit_normalization Whether to use JIT normalization
-   * @param full_set Full set of features
-   * @return True if no violations found, false otherwise
-   */
-  virtual bool checkKktViolations(
-    Eigen::VectorXd& gradient,
-    const Eigen::VectorXd& beta,
-    const Eigen::ArrayXd& lambda_curr,
-    std::vector<int>& working_set,
-    const Eigen::Map<Eigen::SparseMatrix<double>>& x,
-    const Eigen::MatrixXd& residual,
-    const Eigen::VectorXd& x_centers,
-    const Eigen::VectorXd& x_scales,
-    JitNormalization jit_normalization,
-    const std::vector<int>& full_set) = 0;
+                                  const std::vector<IndexType>& full_set) = 0;
 
   /**
    * @brief Get string representation of the screening rule
@@ -192,7 +118,7 @@ public:
 
 protected:
   /// Strong set of variables
-  std::vector<int> strong_set;
+  std::vector<IndexType> strong_set;
 };
 
 /**
@@ -202,58 +128,26 @@ protected:
 class NoScreening : public ScreeningRule
 {
 public:
-  std::vector<int> initialize(const std::vector<int>& full_set,
-                              int alpha_max_ind) override;
-
-  std::vector<int> screen(Eigen::VectorXd& gradient,
-                          const Eigen::ArrayXd& lambda_curr,
-                          const Eigen::ArrayXd& lambda_prev,
-                          const Eigen::VectorXd& beta,
-                          const std::vector<int>& full_set) override;
-
-  bool checkKktViolations(Eigen::VectorXd& gradient,
-                          const Eigen::VectorXd& beta,
-                          const Eigen::ArrayXd& lambda_curr,
-                          std::vector<int>& working_set,
-                          const Eigen::MatrixXd& x,
-                          const Eigen::MatrixXd& residual,
-                          const Eigen::VectorXd& x_centers,
-                          const Eigen::VectorXd& x_scales,
-                          JitNormalization jit_normalization,
-                          const std::vector<int>& full_set) override;
-
-  bool checkKktViolations(Eigen::VectorXd& gradient,
-                          const Eigen::VectorXd& beta,
-                          const Eigen::ArrayXd& lambda_curr,
-                          std::vector<int>& working_set,
-                          const Eigen::SparseMatrix<double>& x,
-                          const Eigen::MatrixXd& residual,
-                          const Eigen::VectorXd& x_centers,
-                          const Eigen::VectorXd& x_scales,
-                          JitNormalization jit_normalization,
-                          const std::vector<int>& full_set) override;
+  std::vector<IndexType> initialize(const std::vector<IndexType>& full_set,
+                                    IndexType alpha_max_ind) override;
 
-  bool checkKktViolations(Eigen::VectorXd& gradient,
-                          const Eigen::VectorXd& beta,
-                          const Eigen::ArrayXd& lambda_curr,
-                          std::vector<int>& working_set,
-                          const Eigen::Map<Eigen::MatrixXd>& x,
-                          const Eigen::MatrixXd& residual,
-                          const Eigen::VectorXd& x_centers,
-                          const Eigen::VectorXd& x_scales,
-                          JitNormalization jit_normalization,
-                          const std::vector<int>& full_set) override;
+  std::vector<IndexType> screen(
+    Eigen::VectorXd& gradient,
+    const Eigen::ArrayXd& lambda_curr,
+    const Eigen::ArrayXd& lambda_prev,
+    const Eigen::VectorXd& beta,
+    const std::vector<IndexType>& full_set) override;
 
   bool checkKktViolations(Eigen::VectorXd& gradient,
                           const Eigen::VectorXd& beta,
                           const Eigen::ArrayXd& lambda_curr,
-                          std::vector<int>& working_set,
-                          const Eigen::Map<Eigen::SparseMatrix<double>>& x,
+                          std::vector<IndexType>& working_set,
+                          const DesignRef& x,
                           const Eigen::MatrixXd& residual,
                           const Eigen::VectorXd& x_centers,
                           const Eigen::VectorXd& x_scales,
                           JitNormalization jit_normalization,
-                          const std::vector<int>& full_set) override;
+                          const std::vector<IndexType>& full_set) override;
 
   std::string toString() const override;
 };
@@ -265,58 +159,26 @@ public:
 class StrongScreening : public ScreeningRule
 {
 public:
-  std::vector<int> initialize(const std::vector<int>& full_set,
-                              int alpha_max_ind) override;
-
-  std::vector<int> screen(Eigen::VectorXd& gradient,
-                          const Eigen::ArrayXd& lambda_curr,
-                          const Eigen::ArrayXd& lambda_prev,
-                          const Eigen::VectorXd& beta,
-                          const std::vector<int>& full_set) override;
-
-  bool checkKktViolations(Eigen::VectorXd& gradient,
-                          const Eigen::VectorXd& beta,
-                          const Eigen::ArrayXd& lambda_curr,
-                          std::vector<int>& working_set,
-                          const Eigen::MatrixXd& x,
-                          const Eigen::MatrixXd& residual,
-                          const Eigen::VectorXd& x_centers,
-                          const Eigen::VectorXd& x_scales,
-                          JitNormalization jit_normalization,
-                          const std::vector<int>& full_set) override;
-
-  bool checkKktViolations(Eigen::VectorXd& gradient,
-                          const Eigen::VectorXd& beta,
-                          const Eigen::ArrayXd& lambda_curr,
-                          std::vector<int>& working_set,
-                          const Eigen::Map<Eigen::MatrixXd>& x,
-                          const Eigen::MatrixXd& residual,
-                          const Eigen::VectorXd& x_centers,
-                          const Eigen::VectorXd& x_scales,
-                          JitNormalization jit_normalization,
-                          const std::vector<int>& full_set) override;
+  std::vector<IndexType> initialize(const std::vector<IndexType>& full_set,
+                                    IndexType alpha_max_ind) override;
 
-  bool checkKktViolations(Eigen::VectorXd& gradient,
-                          const Eigen::VectorXd& beta,
-                          const Eigen::ArrayXd& lambda_curr,
-                          std::vector<int>& working_set,
-                          const Eigen::SparseMatrix<double>& x,
-                          const Eigen::MatrixXd& residual,
-                          const Eigen::VectorXd& x_centers,
-                          const Eigen::VectorXd& x_scales,
-                          JitNormalization jit_normalization,
-                          const std::vector<int>& full_set) override;
+  std::vector<IndexType> screen(
+    Eigen::VectorXd& gradient,
+    const Eigen::ArrayXd& lambda_curr,
+    const Eigen::ArrayXd& lambda_prev,
+    const Eigen::VectorXd& beta,
+    const std::vector<IndexType>& full_set) override;
 
   bool checkKktViolations(Eigen::VectorXd& gradient,
                           const Eigen::VectorXd& beta,
                           const Eigen::ArrayXd& lambda_curr,
-                          std::vector<int>& working_set,
-                          const Eigen::Map<Eigen::SparseMatrix<double>>& x,
+                          std::vector<IndexType>& working_set,
+                          const DesignRef& x,
                           const Eigen::MatrixXd& residual,
                           const Eigen::VectorXd& x_centers,
                           const Eigen::VectorXd& x_scales,
                           JitNormalization jit_normalization,
-                          const std::vector<int>& full_set) override;
+                          const std::vector<IndexType>& full_set) override;
 
   std::string toString() const override;
 
@@ -325,13 +187,13 @@ private:
   bool checkKktViolationsImpl(Eigen::VectorXd& gradient,
                               const Eigen::VectorXd& beta,
                               const Eigen::ArrayXd& lambda_curr,
-                              std::vector<int>& working_set,
+                              std::vector<IndexType>& working_set,
                               const MatrixType& x,
                               const Eigen::MatrixXd& residual,
                               const Eigen::VectorXd& x_centers,
                               const Eigen::VectorXd& x_scales,
                               JitNormalization jit_normalization,
-                              const std::vector<int>& full_set);
+                              const std::vector<IndexType>& full_set);
 };
 
 /**
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "clusters.h"
+#include "column_statistics.h"
 #include "constants.h"
 #include "diagnostics.h"
 #include "estimate_alpha.h"
@@ -22,12 +23,14 @@
 #include "solvers/setup_solver.h"
 #include "sorted_l1_norm.h"
 #include "timer.h"
+#include <Eigen/Cholesky>
 #include <Eigen/Core>
 #include <Eigen/SparseCore>
 #include <cassert>
 #include <memory>
 #include <numeric>
 #include <optional>
+#include <utility>
 
 /** @namespace slope
  *  @brief Namespace containing SLOPE regression implementation
@@ -184,6 +187,16 @@ public:
    */
   void setRelaxMaxInnerIterations(int max_it);
 
+  /**
+   * @brief Sets whether relaxing a path warm starts each fit from the
+   * relaxed solution at the previous step.
+   *
+   * @param relax_warm_starts If `true` (the default), the fits along the path
+   * are relaxed in sequence, each starting from the previous one. If `false`,
+   * they are relaxed independently and in parallel.
+   */
+  void setRelaxWarmStarts(const bool relax_warm_starts);
+
   /**
    * @brief Sets the maximum number of iterations.
    *
@@ -366,6 +379,46 @@ public:
    */
   const std::string& getLossType();
 
+  /**
+   * @brief Get the type of centering
+   * @return The centering type, "manual" if the centers have been given
+   * @see setCentering()
+   */
+  const std::string& getCenteringType() const;
+
+  /**
+   * @brief Get the type of scaling
+   * @return The scaling type, "manual" if the scales have been given
+   * @see setScaling()
+   */
+  const std::string& getScalingType() const;
+
+  /**
+   * @brief Get the type of lambda sequence
+   * @see setLambdaType()
+   */
+  const std::string& getLambdaType() const;
+
+  /**
+   * @brief Get the false discovery rate used for the lambda sequence
+   * @see setQ()
+   */
+  double getQ() const;
+
+  /**
+   * @brief Get the parameters of the OSCAR lambda sequence
+   * @return The pair (theta1, theta2)
+   * @see setOscarParameters()
+   */
+  std::pair<double, double> getOscarParameters() const;
+
+  /**
+   * @brief Get the ratio of the smallest to the largest alpha of the path
+   * @return The ratio, which is negative if it is chosen automatically
+   * @see setAlphaMinRatio()
+   */
+  double getAlphaMinRatio() const;
+
   /**
    * @brief Computes SLOPE regression solution path for multiple alpha and
    * lambda values
@@ -392,118 +445,1537 @@ public:
     Eigen::ArrayXd lambda = Eigen::ArrayXd::Zero(0),
     std::function<bool()> check_interrupt = defaultInterruptChecker)
   {
-    using Eigen::MatrixXd;
-    using Eigen::VectorXd;
+    SlopePath fits;
+
+    pathImpl(x.derived(),
+             y_in,
+             Eigen::VectorXd(),
+             std::move(alpha),
+             std::move(lambda),
+             check_interrupt,
+             PathSeed{},
+             [&fits](SlopeFit&& fit) {
+               fits.addFit(fit);
+               return true;
+             });
 
-    const int n = x.rows();
-    const int p = x.cols();
-
-    const int INTERRUPT_FREQ = 100;
-    bool interrupt = false;
+    return fits;
+  }
 
-    if (n != y_in.rows()) {
+  /**
+   * @brief Computes the SLOPE regression solution path, with the
+   * normalization computed from precomputed column statistics
+   *
+   * @tparam T Matrix type for feature input (supports dense or sparse matrices)
+   * @param x Feature matrix of size n x p
+   * @param y_in Response matrix of size n x m
+   * @param x_stats Statistics of the columns of x, for instance those stored
+   *   with a MappedMatrix
+   * @param alpha Sequence of mixing parameters for elastic net regularization
+   * @param lambda Sequence of regularization parameters (if empty, computed
+   * automatically)
+   * @param check_interrupt Optional lambda to check for user interrupt. It runs
+   *   periodically during the path fitting.
+   * @return SlopePath object containing full solution path and optimization
+   * metrics
+   *
+   * Gives the same path as the version without statistics, but computes the
+   * centers and scales from the statistics instead of from a pass over x,
+   * which is also used to check x for non-finite values. Instead, x is
+   * checked through its means. The design is never modified, regardless of
+   * setModifyX().
+   */
+  template<typename T>
+  SlopePath path(
+    Eigen::EigenBase<T>& x,
+    const Eigen::MatrixXd& y_in,
+    const ColumnStatistics& x_stats,
+    Eigen::ArrayXd alpha = Eigen::ArrayXd::Zero(0),
+    Eigen::ArrayXd lambda = Eigen::ArrayXd::Zero(0),
+    std::function<bool()> check_interrupt = defaultInterruptChecker)
+  {
+    if (x_stats.rows() != x.rows() || x_stats.cols() != x.cols() ||
+        x_stats.weight() != x.rows()) {
       throw std::invalid_argument(
-        "x and y_in must have the same number of rows");
+        "x_stats must be the unweighted statistics of all of x");
     }
 
-    if (!isFinite(x.derived())) {
+    if (!x_stats.getMeans().allFinite()) {
       throw std::invalid_argument("x must not contain NA, NaN, or Inf values");
     }
 
-    if (!y_in.array().isFinite().all()) {
-      throw std::invalid_argument("y must not contain NA, NaN, or Inf values");
-    }
-
-    auto jit_normalization = normalize(x.derived(),
-                                       this->x_centers,
-                                       this->x_scales,
-                                       this->centering_type,
-                                       this->scaling_type,
-                                       this->modify_x);
-
-    std::unique_ptr<Loss> loss = setupLoss(this->loss_type);
+    SlopePath fits;
+    PathSeed seed;
+    seed.x_stats = &x_stats;
+
+    pathImpl(x.derived(),
+             y_in,
+             Eigen::VectorXd(),
+             std::move(alpha),
+             std::move(lambda),
+             check_interrupt,
+             seed,
+             [&fits](SlopeFit&& fit) {
+               fits.addFit(fit);
+               return true;
+             });
 
-    MatrixXd y = loss->preprocessResponse(y_in);
+    return fits;
+  }
 
-    const int m = y.cols();
+  /**
+   * @brief Computes the SLOPE regression solution path, streaming each fit to
+   * a callback instead of storing it
+   *
+   * @tparam T Matrix type for feature input (supports dense or sparse matrices)
+   * @param x Feature matrix of size n x p
+   * @param y_in Response matrix of size n x m
+   * @param callback Consumer that is called with each fit as soon as it has
+   *   been computed. Returning `false` stops the path after the current step.
+   *   The fit is only valid for the duration of the call, so the consumer must
+   *   copy whatever it wants to keep.
+   * @param alpha Sequence of mixing parameters for elastic net regularization
+   * @param lambda Sequence of regularization parameters (if empty, computed
+   * automatically)
+   * @param check_interrupt Optional lambda to check for user interrupt. It runs
+   *   periodically during the path fitting.
+   *
+   * This is the same algorithm as path(), but nothing is retained between
+   * steps, so memory use does not grow with the length of the path.
+   */
+  template<typename T>
+  void path(Eigen::EigenBase<T>& x,
+            const Eigen::MatrixXd& y_in,
+            const std::function<bool(const SlopeFit&)>& callback,
+            Eigen::ArrayXd alpha = Eigen::ArrayXd::Zero(0),
+            Eigen::ArrayXd lambda = Eigen::ArrayXd::Zero(0),
+            std::function<bool()> check_interrupt = defaultInterruptChecker)
+  {
+    pathImpl(x.derived(),
+             y_in,
+             Eigen::VectorXd(),
+             std::move(alpha),
+             std::move(lambda),
+             check_interrupt,
+             PathSeed{},
+             [&callback](SlopeFit&& fit) { return callback(fit); });
+  }
 
-    std::vector<int> full_set(p * m);
-    std::iota(full_set.begin(), full_set.end(), 0);
+  /**
+   * @brief Computes the SLOPE regression solution path, warm starting from a
+   * previously fitted path
+   *
+   * @tparam T Matrix type for feature input (supports dense or sparse matrices)
+   * @param x Feature matrix of size n x p
+   * @param y_in Response matrix of size n x m
+   * @param warm_start Previously fitted path, for instance on an earlier
+   *   version of the data. It must have the same number of coefficients.
+   * @param alpha Sequence of mixing parameters for elastic net regularization
+   * @param lambda Sequence of regularization parameters (if empty, computed
+   * automatically)
+   * @param check_interrupt Optional lambda to check for user interrupt. It runs
+   *   periodically during the path fitting.
+   * @return SlopePath object containing full solution path and optimization
+   * metrics
+   *
+   * Each step of the path is matched with a step of the warm start (see
+   * alignPaths()): by position if the alpha sequences are proportional,
+   * which is the case when both are generated automatically with the same
+   * settings, and otherwise by the closest alpha. The solution at the
+   * matching step, mapped to the current normalization of `x`, then
+   * replaces the solution from the previous step as starting point, which
+   * also seeds the clusters and working set of that step.
+   */
+  template<typename T>
+  SlopePath path(
+    Eigen::EigenBase<T>& x,
+    const Eigen::MatrixXd& y_in,
+    const SlopePath& warm_start,
+    Eigen::ArrayXd alpha = Eigen::ArrayXd::Zero(0),
+    Eigen::ArrayXd lambda = Eigen::ArrayXd::Zero(0),
+    std::function<bool()> check_interrupt = defaultInterruptChecker)
+  {
+    SlopePath fits;
+    PathSeed seed;
+    seed.warm_start = &warm_start;
+
+    pathImpl(x.derived(),
+             y_in,
+             Eigen::VectorXd(),
+             std::move(alpha),
+             std::move(lambda),
+             check_interrupt,
+             seed,
+             [&fits](SlopeFit&& fit) {
+               fits.addFit(fit);
+               return true;
+             });
 
-    VectorXd beta0 = VectorXd::Zero(m);
-    VectorXd beta = VectorXd::Zero(p * m);
+    return fits;
+  }
 
-    MatrixXd eta = MatrixXd::Zero(n, m); // linear predictor
+  /**
+   * @brief Computes the SLOPE regression solution path with observation
+   * weights
+   *
+   * @tparam T Matrix type for feature input (supports dense or sparse matrices)
+   * @tparam W Vector type of the weights
+   * @param x Feature matrix of size n x p
+   * @param y_in Response matrix of size n x m
+   * @param weights Non-negative observation weights of length n, with a
+   *   positive sum
+   * @param alpha Sequence of mixing parameters for elastic net regularization
+   * @param lambda Sequence of regularization parameters (if empty, computed
+   * automatically)
+   * @param check_interrupt Optional lambda to check for user interrupt. It runs
+   *   periodically during the path fitting.
+   * @return SlopePath object containing full solution path and optimization
+   * metrics
+   *
+   * The loss is the weighted average of the losses of the observations, and
+   * the weights are frequency weights: integer weights give the same path as
+   * repeating each row as many times as its weight, and 0/1 weights give
+   * the path of the selected rows, including their normalization. The latter
+   * lets cross-validation fit folds without copying x.
+   *
+   * Non-integer weights, for instance from importance sampling, are
+   * supported too. Only their relative sizes matter for the objective, but
+   * their sum is used as the number of observations wherever the path
+   * depends on it: for the `"gaussian"` lambda sequence and for the default
+   * `alpha_min_ratio`.
+   */
+  template<typename T, typename W>
+  SlopePath path(
+    Eigen::EigenBase<T>& x,
+    const Eigen::MatrixXd& y_in,
+    const Eigen::MatrixBase<W>& weights,
+    Eigen::ArrayXd alpha = Eigen::ArrayXd::Zero(0),
+    Eigen::ArrayXd lambda = Eigen::ArrayXd::Zero(0),
+    std::function<bool()> check_interrupt = defaultInterruptChecker)
+  {
+    SlopePath fits;
+
+    pathImpl(x.derived(),
+             y_in,
+             weights,
+             std::move(alpha),
+             std::move(lambda),
+             check_interrupt,
+             PathSeed{},
+             [&fits](SlopeFit&& fit) {
+               fits.addFit(fit);
+               return true;
+             });
 
-    if (this->intercept) {
-      beta0 = loss->link(y.colwise().mean()).transpose();
-      eta.rowwise() = beta0.transpose();
-    }
+    return fits;
+  }
 
-    MatrixXd residual = loss->residual(eta, y);
-    VectorXd gradient(beta.size());
+  /**
+   * @brief Computes the SLOPE regression solution path with observation
+   * weights, streaming each fit to a callback instead of storing it
+   *
+   * @tparam T Matrix type for feature input (supports dense or sparse matrices)
+   * @tparam W Vector type of the weights
+   * @param x Feature matrix of size n x p
+   * @param y_in Response matrix of size n x m
+   * @param weights Non-negative observation weights of length n, with a
+   *   positive sum
+   * @param callback Consumer that is called with each fit, as in the
+   *   unweighted streaming version of path()
+   * @param alpha Sequence of mixing parameters for elastic net regularization
+   * @param lambda Sequence of regularization parameters (if empty, computed
+   * automatically)
+   * @param check_interrupt Optional lambda to check for user interrupt. It runs
+   *   periodically during the path fitting.
+   */
+  template<typename T, typename W>
+  void path(Eigen::EigenBase<T>& x,
+            const Eigen::MatrixXd& y_in,
+            const Eigen::MatrixBase<W>& weights,
+            const std::function<bool(const SlopeFit&)>& callback,
+            Eigen::ArrayXd alpha = Eigen::ArrayXd::Zero(0),
+            Eigen::ArrayXd lambda = Eigen::ArrayXd::Zero(0),
+            std::function<bool()> check_interrupt = defaultInterruptChecker)
+  {
+    pathImpl(x.derived(),
+             y_in,
+             weights,
+             std::move(alpha),
+             std::move(lambda),
+             check_interrupt,
+             PathSeed{},
+             [&callback](SlopeFit&& fit) { return callback(fit); });
+  }
 
-    // Path data
-    bool user_alpha = alpha.size() > 0;
-    bool user_lambda = lambda.size() > 0;
+  /**
+   * @brief Computes the SLOPE regression solution path with observation
+   * weights, warm starting from a previously fitted path and streaming each
+   * fit to a callback
+   *
+   * @tparam T Matrix type for feature input (supports dense or sparse matrices)
+   * @tparam W Vector type of the weights
+   * @param x Feature matrix of size n x p
+   * @param y_in Response matrix of size n x m
+   * @param weights Observation weights, as in the weighted version of path(),
+   *   or an empty vector for unit weights
+   * @param warm_start Previously fitted path, as in the warm-started version
+   *   of path(). It may be empty.
+   * @param callback Consumer that is called with each fit, as in the
+   *   unweighted streaming version of path()
+   * @param alpha Sequence of mixing parameters for elastic net regularization
+   * @param lambda Sequence of regularization parameters (if empty, computed
+   * automatically)
+   * @param check_interrupt Optional lambda to check for user interrupt. It runs
+   *   periodically during the path fitting.
+   */
+  template<typename T, typename W>
+  void path(Eigen::EigenBase<T>& x,
+            const Eigen::MatrixXd& y_in,
+            const Eigen::MatrixBase<W>& weights,
+            const SlopePath& warm_start,
+            const std::function<bool(const SlopeFit&)>& callback,
+            Eigen::ArrayXd alpha = Eigen::ArrayXd::Zero(0),
+            Eigen::ArrayXd lambda = Eigen::ArrayXd::Zero(0),
+            std::function<bool()> check_interrupt = defaultInterruptChecker)
+  {
+    PathSeed seed;
+    seed.warm_start = &warm_start;
+
+    pathImpl(x.derived(),
+             y_in,
+             weights,
+             std::move(alpha),
+             std::move(lambda),
+             check_interrupt,
+             seed,
+             [&callback](SlopeFit&& fit) { return callback(fit); });
+  }
 
-    if (!user_lambda) {
-      lambda = lambdaSequence(
-        p * m, this->q, this->lambda_type, n, this->theta1, this->theta2);
-    } else {
-      if (lambda.size() != beta.size()) {
-        throw std::invalid_argument(
-          "lambda must be the same length as the number of coefficients");
-      }
-      if (lambda.minCoeff() < 0) {
-        throw std::invalid_argument("lambda must be non-negative");
-      }
-      if (!lambda.isFinite().all()) {
-        throw std::invalid_argument("lambda must be finite");
-      }
-      // Check that lambda is in decreasing order
-      for (int i = 1; i < lambda.size(); ++i) {
-        if (lambda(i) > lambda(i - 1)) {
-          throw std::invalid_argument(
-            "lambda must be in decreasing order");
-        }
-      }
-    }
+  /**
+   * @brief Computes the sequence of alpha values of the path, without fitting
+   * it
+   *
+   * @tparam T Matrix type for feature input (supports dense or sparse matrices)
+   * @param x Feature matrix of size n x p
+   * @param y_in Response matrix of size n x m
+   * @return The alpha values that path() uses when none are supplied
+   *
+   * This only requires the gradient at the null model, from which the
+   * largest alpha, at which all coefficients are zero, follows. Note that
+   * path() may stop before the end of the sequence, since its stopping rules
+   * depend on the fits along the path.
+   */
+  template<typename T>
+  Eigen::ArrayXd alphaGrid(Eigen::EigenBase<T>& x, const Eigen::MatrixXd& y_in)
+  {
+    NullModel null_model = nullModel(
+      x.derived(), y_in, Eigen::VectorXd(), Eigen::ArrayXd(), PathSeed{});
 
-    // Setup the regularization sequence and path
     SortedL1Norm sl1_norm;
+    double alpha_max =
+      sl1_norm.dualNorm(null_model.gradient, null_model.lambda);
 
-    // TODO: Make this part of the slope class
-    auto solver = setupSolver(this->solver_type,
-                              this->loss_type,
-                              jit_normalization,
-                              this->intercept,
-                              this->update_clusters,
-                              this->cd_iterations,
-                              this->cd_type,
-                              this->random_seed);
+    return alphaSequence(Eigen::ArrayXd(),
+                         alpha_max,
+                         null_model.n_eff,
+                         null_model.gradient.size());
+  }
 
-    updateGradient(gradient,
-                   x.derived(),
-                   residual,
-                   full_set,
-                   this->x_centers,
-                   this->x_scales,
-                   Eigen::VectorXd::Ones(n),
-                   jit_normalization);
+  /**
+   * @brief Fits a single SLOPE regression model for given alpha and lambda
+   * values
+   *
+   * @tparam T Matrix type for feature input (supports dense or sparse matrices)
+   * @param x Feature matrix of size n x p
+   * @param y_in Response matrix of size n x m
+   * @param alpha Mixing parameter for elastic net regularization
+   * @param lambda Vector of regularization parameters (if empty, computed
+   * automatically)
+   * @param check_interrupt Optional lambda to check for user interrupt. It runs
+   *  periodically during the fitting.
+   * @return SlopeFit Object containing fitted model and optimization metrics
+   *
+   * Fits a single SLOPE model with specified regularization parameters,
+   * returning coefficients and optimization details in a SlopeFit object.
+   */
+  template<typename T>
+  SlopeFit fit(
+    Eigen::EigenBase<T>& x,
+    const Eigen::MatrixXd& y_in,
+    const double alpha = 1.0,
+    Eigen::ArrayXd lambda = Eigen::ArrayXd::Zero(0),
+    std::function<bool()> check_interrupt = defaultInterruptChecker)
+  {
+    Eigen::ArrayXd alpha_arr(1);
+    alpha_arr(0) = alpha;
+    SlopePath res = path(x, y_in, alpha_arr, lambda, check_interrupt);
 
-    int alpha_max_ind = whichMax(gradient.cwiseAbs());
-    double alpha_max = sl1_norm.dualNorm(gradient, lambda);
+    return { res(0) };
+  };
 
-    if (alpha_type == "path" ||
-        (alpha_type == "estimate" && alpha_estimate != 1)) {
-      if (alpha_min_ratio < 0) {
-        alpha_min_ratio = n > gradient.size() ? 1e-4 : 1e-2;
-      }
+  /**
+   * @brief Fits a single SLOPE regression model with observation weights
+   *
+   * @tparam T Matrix type for feature input (supports dense or sparse matrices)
+   * @tparam W Vector type of the weights
+   * @param x Feature matrix of size n x p
+   * @param y_in Response matrix of size n x m
+   * @param weights Non-negative observation weights of length n, with a
+   *   positive sum. See the weighted version of path().
+   * @param alpha Mixing parameter for elastic net regularization
+   * @param lambda Vector of regularization parameters (if empty, computed
+   * automatically)
+   * @param check_interrupt Optional lambda to check for user interrupt. It runs
+   *  periodically during the fitting.
+   * @return SlopeFit Object containing fitted model and optimization metrics
+   */
+  template<typename T, typename W>
+  SlopeFit fit(
+    Eigen::EigenBase<T>& x,
+    const Eigen::MatrixXd& y_in,
+    const Eigen::MatrixBase<W>& weights,
+    const double alpha = 1.0,
+    Eigen::ArrayXd lambda = Eigen::ArrayXd::Zero(0),
+    std::function<bool()> check_interrupt = defaultInterruptChecker)
+  {
+    Eigen::ArrayXd alpha_arr(1);
+    alpha_arr(0) = alpha;
+    SlopePath res = path(x, y_in, weights, alpha_arr, lambda, check_interrupt);
 
-      alpha =
-        regularizationPath(alpha, path_length, alpha_min_ratio, alpha_max);
-      path_length = alpha.size();
+    return { res(0) };
+  };
+
+  /**
+   * @brief Fits a single SLOPE regression model, warm starting from a
+   * previous fit
+   *
+   * @tparam T Matrix type for feature input (supports dense or sparse matrices)
+   * @param x Feature matrix of size n x p
+   * @param y_in Response matrix of size n x m
+   * @param warm_start Previous fit, for instance on an earlier version of the
+   *   data. It must have the same number of coefficients.
+   * @param alpha Mixing parameter for elastic net regularization. Defaults to
+   *   the alpha of `warm_start`.
+   * @param lambda Vector of regularization parameters (if empty, computed
+   * automatically)
+   * @param check_interrupt Optional lambda to check for user interrupt. It runs
+   *  periodically during the fitting.
+   * @return SlopeFit Object containing fitted model and optimization metrics
+   */
+  template<typename T>
+  SlopeFit fit(
+    Eigen::EigenBase<T>& x,
+    const Eigen::MatrixXd& y_in,
+    const SlopeFit& warm_start,
+    const std::optional<double> alpha = std::nullopt,
+    Eigen::ArrayXd lambda = Eigen::ArrayXd::Zero(0),
+    std::function<bool()> check_interrupt = defaultInterruptChecker)
+  {
+    Eigen::ArrayXd alpha_arr(1);
+    alpha_arr(0) = alpha.value_or(warm_start.getAlpha());
+
+    SlopePath res = path(
+      x, y_in, SlopePath({ warm_start }), alpha_arr, lambda, check_interrupt);
+
+    return { res(0) };
+  };
+
+  /**
+   * @brief Updates a fit after new rows have been appended to the data
+   *
+   * @tparam T Matrix type for feature input (supports dense or sparse matrices)
+   * @param x Feature matrix of size n x p, consisting of the rows passed to
+   *   the previous call, in the same order, followed by the new rows
+   * @param y_in Response matrix of size n x m, arranged in the same way
+   * @param alpha Mixing parameter for elastic net regularization. Defaults to
+   *   the alpha of the previous fit, or 1 for the first fit.
+   * @param lambda Vector of regularization parameters (if empty, computed
+   * automatically)
+   * @param check_interrupt Optional lambda to check for user interrupt. It runs
+   *  periodically during the fitting.
+   * @return SlopeFit Object containing fitted model and optimization metrics
+   *
+   * The model keeps running column statistics of `x` (see ColumnStatistics),
+   * the cross products of `x` with the response and with the residual, and
+   * the linear predictor of the most recent fit. On each call, only the rows
+   * that have not been seen before are read to update these, after which the
+   * model is re-solved starting from the previous solution. Rows that have
+   * already been seen are only revisited by the solver itself, in particular
+   * by the final check of the optimality conditions.
+   *
+   * The first call is equivalent to fit(). Call resetPartialFit() before
+   * fitting to unrelated data or after changing the settings of the model.
+   *
+   * @note The normalization is computed from the running statistics, so
+   *   setModifyX() is not supported.
+   */
+  template<typename T>
+  SlopeFit partialFit(
+    Eigen::EigenBase<T>& x,
+    const Eigen::MatrixXd& y_in,
+    const std::optional<double> alpha = std::nullopt,
+    Eigen::ArrayXd lambda = Eigen::ArrayXd::Zero(0),
+    std::function<bool()> check_interrupt = defaultInterruptChecker)
+  {
+    using Eigen::MatrixXd;
+    using Eigen::VectorXd;
+
+    PartialFitState& state = this->partial_fit_state;
+
+    const int n = x.rows();
+    const int p = x.cols();
+    const int n_old = state.x_stats.rows();
+    const int n_new = n - n_old;
+
+    if (this->modify_x) {
+      throw std::invalid_argument("partialFit() does not support modify_x");
+    }
+
+    if (n != y_in.rows()) {
+      throw std::invalid_argument(
+        "x and y_in must have the same number of rows");
+    }
+
+    if (n_old > 0 && p != state.x_stats.cols()) {
+      throw std::invalid_argument(
+        "x must have the same number of columns as in previous calls");
+    }
+
+    if (n_new < 0) {
+      throw std::invalid_argument(
+        "x must contain the rows from previous calls to partialFit()");
+    }
+
+    ColumnStatistics x_stats = n_old > 0 ? state.x_stats : ColumnStatistics(p);
+    x_stats.update(x.derived(), n_old, n);
+
+    if (!x_stats.getMeans().allFinite()) {
+      throw std::invalid_argument("x must not contain NA, NaN, or Inf values");
+    }
+
+    std::unique_ptr<Loss> loss = setupLoss(this->loss_type);
+
+    MatrixXd y = loss->preprocessResponse(y_in);
+
+    const int m = y.cols();
+
+    if (n_old > 0 && m != state.xty.cols()) {
+      throw std::invalid_argument(
+        "y_in must have the same number of columns as in previous calls");
+    }
+
+    Eigen::VectorXd x_centers_new = this->x_centers;
+    Eigen::VectorXd x_scales_new = this->x_scales;
+    auto jit_normalization = normalize(x_stats,
+                                       x_centers_new,
+                                       x_scales_new,
+                                       this->centering_type,
+                                       this->scaling_type);
+
+    MatrixXd xty =
+      rowBlockTransposeProduct(x.derived(), y.bottomRows(n_new), n_old);
+
+    if (n_old > 0) {
+      xty += state.xty;
+    }
+
+    PathSeed seed;
+    seed.x_stats = &x_stats;
+
+    // The gradient at the null model only depends on x through its column
+    // sums and the cross product with y
+    VectorXd beta0_null = VectorXd::Zero(m);
+
+    if (this->intercept) {
+      beta0_null = loss->link(y.colwise().mean()).transpose();
+    }
+
+    MatrixXd mu_null = loss->inverseLink(beta0_null.transpose());
+    VectorXd residual_sums_null =
+      n * mu_null.transpose() - y.colwise().sum().transpose();
+
+    seed.null_gradient =
+      crossProductToGradient(x_stats.getSums() * mu_null - xty,
+                             residual_sums_null,
+                             n,
+                             x_centers_new,
+                             x_scales_new,
+                             jit_normalization);
+
+    SlopePath warm_start;
+    Eigen::ArrayXd alpha_arr(1);
+    alpha_arr(0) = alpha.value_or(1.0);
+
+    if (n_old > 0) {
+      const SlopeFit& fit_prev = *state.fit;
+
+      Eigen::SparseMatrix<double> beta_prev = fit_prev.getCoefs();
+
+      MatrixXd eta(n, m);
+      eta.topRows(n_old) = state.eta;
+      eta.bottomRows(n_new) =
+        rowBlockProduct(x.derived(), beta_prev, n_old, n);
+
+      if (this->intercept) {
+        eta.bottomRows(n_new).rowwise() +=
+          fit_prev.getIntercepts().transpose();
+      }
+
+      MatrixXd residual = loss->residual(eta, y);
+      MatrixXd residual_new = residual.bottomRows(n_new);
+      MatrixXd xtr_new =
+        rowBlockTransposeProduct(x.derived(), residual_new, n_old);
+      MatrixXd xtr = state.xtr + xtr_new;
+
+      seed.gradient =
+        crossProductToGradient(xtr,
+                               residual.colwise().sum().transpose(),
+                               n,
+                               x_centers_new,
+                               x_scales_new,
+                               jit_normalization);
+      seed.eta = std::move(eta);
+
+      warm_start.addFit(fit_prev);
+      seed.warm_start = &warm_start;
+
+      alpha_arr(0) = alpha.value_or(fit_prev.getAlpha());
+    }
+
+    std::optional<SlopeFit> fit_new;
+    PathState final_state;
+
+    pathImpl(
+      x.derived(),
+      y_in,
+      Eigen::VectorXd(),
+      alpha_arr,
+      std::move(lambda),
+      check_interrupt,
+      seed,
+      [&fit_new](SlopeFit&& fit) {
+        fit_new = std::move(fit);
+        return true;
+      },
+      &final_state);
+
+    if (!fit_new) {
+      throw std::runtime_error("partialFit() was interrupted");
+    }
+
+    MatrixXd residual = loss->residual(final_state.eta, y);
+
+    if (!final_state.full_gradient) {
+      std::vector<IndexType> full_set(static_cast<IndexType>(p) * m);
+      std::iota(full_set.begin(), full_set.end(), 0);
+
+      updateGradient(final_state.gradient,
+                     x.derived(),
+                     residual,
+                     full_set,
+                     this->x_centers,
+                     this->x_scales,
+                     Eigen::VectorXd::Ones(n),
+                     jit_normalization);
+    }
+
+    state.xtr = gradientToCrossProduct(final_state.gradient,
+                                       residual.colwise().sum().transpose(),
+                                       n,
+                                       this->x_centers,
+                                       this->x_scales,
+                                       jit_normalization);
+    state.xty = std::move(xty);
+    state.eta = std::move(final_state.eta);
+    state.x_stats = std::move(x_stats);
+    state.fit = fit_new;
+
+    return *fit_new;
+  }
+
+  /**
+   * @brief Discards the state kept by partialFit(), so that the next call
+   * starts from scratch
+   */
+  void resetPartialFit();
+
+  /**
+   * @brief Estimates the regularization parameter alpha for SLOPE regression
+   *
+   * This function implements an algorithm to estimate an appropriate
+   * regularization parameter (alpha) for SLOPE, which is a generalization of
+   * the lasso. When n >= p + 30, it directly estimates alpha from OLS
+   * residuals. Otherwise, it uses an iterative procedure that alternates
+   * between estimating alpha and fitting the SLOPE model.
+   *
+   * The iterative procedure works by:
+   * 1. Starting with an empty set of selected variables
+   * 2. Estimating alpha based on the selected variables
+   * 3. Fitting a SLOPE model with that alpha
+   * 4. Updating the selected variables based on non-zero coefficients
+   * 5. Repeating until convergence or maximum iterations reached
+   *
+   * @tparam MatrixType The type of matrix used to store the design matrix
+   * @param x Design matrix with n observations and p predictors
+   * @param y Response matrix
+   * @param check_interrupt Optional lambda to check for user interrupt
+   * @return A SlopePath object containing the fitted model with estimated alpha
+   * @throws std::runtime_error If maximum iterations reached or if too many
+   * variables selected
+   */
+  template<typename T>
+  SlopePath estimateAlpha(
+    Eigen::EigenBase<T>& x,
+    Eigen::MatrixXd& y,
+    std::function<bool()> check_interrupt = defaultInterruptChecker)
+  {
+    int n = x.rows();
+    int p = x.cols();
+
+    // Create a copy with alpha type set to path to avoid recursion
+    Slope model_copy = *this;
+    model_copy.setAlphaType("path");
+
+    std::vector<int> selected;
+    Eigen::ArrayXd alpha(1);
+    SlopePath result;
+
+    // Estimate the noise level, if possible
+    if (n >= p + 30) {
+      alpha(0) = estimateNoise(x, y, this->intercept) / n;
+      this->alpha_estimate = alpha(0);
+      result =
+        model_copy.path(x, y, alpha, Eigen::ArrayXd::Zero(0), check_interrupt);
+    } else {
+      for (int it = 0; it < this->alpha_est_maxit; ++it) {
+        T x_selected = subsetCols(x.derived(), selected);
+
+        std::vector<int> selected_prev = selected;
+        selected.clear();
+
+        alpha(0) = estimateNoise(x_selected, y, this->intercept) / n;
+        this->alpha_estimate = alpha(0);
+
+        result = model_copy.path(
+          x, y, alpha, Eigen::ArrayXd::Zero(0), check_interrupt);
+        auto coefs = result.getCoefs().back();
+
+        for (typename Eigen::SparseMatrix<double>::InnerIterator it(coefs, 0);
+             it;
+             ++it) {
+          selected.emplace_back(it.row());
+        }
+
+        if (selected == selected_prev) {
+          return result;
+        }
+
+        if (static_cast<int>(selected.size()) >= n + this->intercept) {
+          throw std::runtime_error(
+            "selected >= n - 1 variables, cannot estimate variance");
+        }
+      }
+
+      slope::WarningLogger::addWarning(
+        slope::WarningCode::MAXIT_REACHED,
+        "Maximum iterations reached in alpha estimation");
+    }
+
+    return result;
+  }
+
+  /**
+   * @brief Relaxes a fitted SLOPE model
+   *
+   * @tparam T Matrix type for feature input (supports dense or sparse matrices)
+   * @param fit Previously fitted SLOPE model containing coefficient estimates
+   * @param x Feature matrix of size n x p
+   * @param y_in Response vector of size n
+   * @param gamma Relaxation parameter, proportion of SLOPE-penalized fit. Must
+   * be between 0 and 1. Default is 0.0 which means fully relaxed.
+   * @param beta0 Warm start intercept values (optional)
+   * @param beta Warm start coefficient values (optional). These are projected
+   * onto the clusters and signs of `fit`, which define the relaxed problem.
+   * @param weights Observation weights (optional), as in the weighted version
+   * of path()
+   * @return SlopeFit Object containing the relaxed model with unpenalized
+   * coefficients
+   */
+  template<typename T>
+  SlopeFit relax(const SlopeFit& fit,
+                 T& x,
+                 const Eigen::VectorXd& y_in,
+                 const double gamma = 0.0,
+                 Eigen::VectorXd beta0 = Eigen::VectorXd(0),
+                 Eigen::VectorXd beta = Eigen::VectorXd(0),
+                 const Eigen::VectorXd& weights = Eigen::VectorXd())
+  {
+    const Eigen::VectorXd w = normalizedWeights(weights, x.rows());
+
+    auto jit_normalization = normalizeWeighted(x, weights);
+
+    Eigen::MatrixXd y = setupLoss(this->loss_type)->preprocessResponse(y_in);
+
+    return relaxImpl(fit, x, y, w, gamma, beta0, beta, jit_normalization);
+  }
+
+  /**
+   * @brief Relaxes a fitted SLOPE path
+   *
+   * @tparam T Matrix type for feature input (supports dense or sparse matrices)
+   * @param path Previously fitted SLOPE path
+   * @param x Feature matrix of size n x p
+   * @param y_in Response vector of size n
+   * @param gamma Relaxation parameter, proportion of SLOPE-penalized fit. Must
+   * be between 0 and 1. Default is 0.0 which means fully relaxed.
+   * @param weights Observation weights (optional), as in the weighted version
+   * of path()
+   * @return SlopePath Object containing the relaxed model with unpenalized
+   * coefficients
+   *
+   * The design matrix is normalized once for the whole path. If warm starts
+   * are enabled (see setRelaxWarmStarts()), each fit is started from the
+   * relaxed solution of the previous step, projected onto the clusters of the
+   * current step. Otherwise, the fits are independent and run in parallel.
+   */
+  template<typename T>
+  SlopePath relax(const SlopePath& path,
+                  T& x,
+                  const Eigen::VectorXd& y_in,
+                  const double gamma = 0.0,
+                  const Eigen::VectorXd& weights = Eigen::VectorXd())
+  {
+    const Eigen::VectorXd w = normalizedWeights(weights, x.rows());
+
+    auto jit_normalization = normalizeWeighted(x, weights);
+
+    Eigen::MatrixXd y = setupLoss(this->loss_type)->preprocessResponse(y_in);
+
+    const int n_fits = path.size();
+    std::vector<SlopeFit> relaxed_fits(n_fits);
+
+    if (this->relax_warm_starts) {
+      Eigen::VectorXd beta0, beta;
+
+      for (int i = 0; i < n_fits; ++i) {
+        relaxed_fits[i] =
+          relaxImpl(path(i), x, y, w, gamma, beta0, beta, jit_normalization);
+      }
+    } else {
+      std::vector<std::string> thread_errors(n_fits);
+      bool had_exception = false;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(Threads::get())                           \
+  shared(relaxed_fits, thread_errors, had_exception)
+#endif
+      for (int i = 0; i < n_fits; ++i) {
+        try {
+          Eigen::VectorXd beta0, beta;
+          relaxed_fits[i] =
+            relaxImpl(path(i), x, y, w, gamma, beta0, beta, jit_normalization);
+        } catch (const std::exception& e) {
+          thread_errors[i] = e.what();
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+          had_exception = true;
+        }
+      }
+
+      if (had_exception) {
+        std::string error_message = "Exception(s) during relaxation:\n";
+        for (int i = 0; i < n_fits; ++i) {
+          if (!thread_errors[i].empty()) {
+            error_message +=
+              "Step " + std::to_string(i) + ": " + thread_errors[i] + "\n";
+          }
+        }
+        throw std::runtime_error(error_message);
+      }
+    }
+
+    SlopePath fits;
+
+    for (const auto& relaxed_fit : relaxed_fits) {
+      fits.addFit(relaxed_fit);
+    }
+
+    return fits;
+  }
+
+  /**
+   * @brief Blends a fully relaxed path with the path it was relaxed from
+   *
+   * @param path Fitted SLOPE path
+   * @param relaxed The fully relaxed path, from relax() with `gamma = 0`
+   * @param gamma Relaxation parameter, as in relax()
+   * @return The same path as relax() returns for this gamma
+   *
+   * The relaxed fits do not depend on gamma, which only blends their
+   * coefficients with those of the penalized fits, so a path can be relaxed
+   * once and then blended for any number of values of gamma.
+   */
+  static SlopePath blendRelaxed(const SlopePath& path,
+                                const SlopePath& relaxed,
+                                const double gamma);
+
+  /**
+   * @brief Blends a fully relaxed fit with the fit it was relaxed from
+   *
+   * @see blendRelaxed() for paths
+   */
+  static SlopeFit blendRelaxed(const SlopeFit& fit,
+                               const SlopeFit& relaxed,
+                               const double gamma);
+
+private:
+  /**
+   * @brief Validates observation weights and normalizes them to have mean one
+   *
+   * @param weights The weights, or an empty vector for unit weights
+   * @param n The number of observations
+   * @return The normalized weights, or an empty vector for unit weights
+   */
+  static Eigen::VectorXd normalizedWeights(const Eigen::VectorXd& weights,
+                                           const int n)
+  {
+    if (weights.size() == 0) {
+      return weights;
+    }
+
+    validateWeights(weights, n);
+
+    return weights * (n / weights.sum());
+  }
+
+  /**
+   * @brief Normalizes the design matrix with the current settings, with
+   * centers and scales computed from observation weights unless these are
+   * empty
+   */
+  template<typename T>
+  JitNormalization normalizeWeighted(T& x, const Eigen::VectorXd& weights)
+  {
+    if (weights.size() == 0) {
+      return normalize(
+        x, x_centers, x_scales, centering_type, scaling_type, modify_x);
+    }
+
+    return normalize(
+      x, weights, x_centers, x_scales, centering_type, scaling_type, modify_x);
+  }
+
+  /**
+   * @brief Quantities from earlier fits that pathImpl() can start from
+   * instead of computing them from scratch
+   *
+   * Empty matrices mean that the quantity is computed as usual.
+   */
+  struct PathSeed
+  {
+    /// Path to warm start from, or `nullptr` to start every step from the
+    /// solution of the previous step
+    const SlopePath* warm_start = nullptr;
+
+    /// Statistics of the columns of x, used for normalization instead of a
+    /// pass over x. The caller is responsible for checking that x is finite.
+    const ColumnStatistics* x_stats = nullptr;
+
+    /// Gradient at the null model
+    Eigen::VectorXd null_gradient;
+
+    /// Linear predictor at the warm start of the first step
+    Eigen::MatrixXd eta;
+
+    /// Gradient, for all coefficients, at the warm start of the first step
+    Eigen::VectorXd gradient;
+  };
+
+  /**
+   * @brief State of the solver at the end of pathImpl()
+   */
+  struct PathState
+  {
+    Eigen::MatrixXd eta;        ///< Linear predictor
+    Eigen::VectorXd gradient;   ///< Gradient
+    bool full_gradient = false; ///< Whether the gradient is up to date for
+                                ///< all coefficients or only the working set
+  };
+
+  /**
+   * @brief State kept between calls to partialFit()
+   */
+  struct PartialFitState
+  {
+    ColumnStatistics x_stats;    ///< Statistics of the rows seen so far
+    Eigen::MatrixXd xty;         ///< Cross product of x and the response
+    Eigen::MatrixXd xtr;         ///< Cross product of x and the residual
+    Eigen::MatrixXd eta;         ///< Linear predictor
+    std::optional<SlopeFit> fit; ///< Most recent fit
+  };
+
+  /**
+   * @brief Computes the gradient from the cross product of the (unnormalized)
+   * design matrix and the residual
+   */
+  static Eigen::VectorXd crossProductToGradient(
+    const Eigen::MatrixXd& xtr,
+    const Eigen::VectorXd& residual_sums,
+    const int n,
+    const Eigen::VectorXd& x_centers,
+    const Eigen::VectorXd& x_scales,
+    const JitNormalization jit_normalization)
+  {
+    Eigen::MatrixXd gradient = xtr;
+
+    if (jit_normalization == JitNormalization::Both ||
+        jit_normalization == JitNormalization::Center) {
+      gradient -= x_centers * residual_sums.transpose();
+    }
+    if (jit_normalization == JitNormalization::Both ||
+        jit_normalization == JitNormalization::Scale) {
+      gradient = x_scales.cwiseInverse().asDiagonal() * gradient;
+    }
+
+    return gradient.reshaped() / n;
+  }
+
+  /**
+   * @brief Inverse of crossProductToGradient()
+   */
+  static Eigen::MatrixXd gradientToCrossProduct(
+    const Eigen::VectorXd& gradient,
+    const Eigen::VectorXd& residual_sums,
+    const int n,
+    const Eigen::VectorXd& x_centers,
+    const Eigen::VectorXd& x_scales,
+    const JitNormalization jit_normalization)
+  {
+    const int m = residual_sums.size();
+
+    Eigen::MatrixXd xtr = gradient.reshaped(gradient.size() / m, m) * n;
+
+    if (jit_normalization == JitNormalization::Both ||
+        jit_normalization == JitNormalization::Scale) {
+      xtr = x_scales.asDiagonal() * xtr;
+    }
+    if (jit_normalization == JitNormalization::Both ||
+        jit_normalization == JitNormalization::Center) {
+      xtr += x_centers * residual_sums.transpose();
+    }
+
+    return xtr;
+  }
+
+  /**
+   * @brief Solves the relaxed problem for a quadratic loss directly
+   *
+   * With the clusters and signs fixed, the relaxed problem is an ordinary
+   * least squares problem in the cluster coefficients, with one collapsed
+   * column for each non-zero cluster. Its normal equations are solved with an
+   * LDLT (square-root free Cholesky) decomposition.
+   *
+   * @return `false` if the problem is (numerically) singular, in which case
+   *   nothing is modified.
+   */
+  template<typename T>
+  bool relaxedLeastSquares(Eigen::VectorXd& beta0,
+                           Eigen::VectorXd& beta,
+                           Clusters& clusters,
+                           const T& x,
+                           const Eigen::MatrixXd& y,
+                           const Eigen::VectorXd& w,
+                           const JitNormalization jit_normalization)
+  {
+    using Eigen::MatrixXd;
+    using Eigen::VectorXd;
+
+    const int n = x.rows();
+    const bool weighted = w.size() > 0;
+
+    std::vector<IndexType> active_clusters;
+
+    for (IndexType j = 0; j < clusters.size(); ++j) {
+      if (clusters.coeff(j) != 0) {
+        active_clusters.emplace_back(j);
+      }
+    }
+
+    const int k = active_clusters.size();
+
+    const int n_included = weighted ? (w.array() > 0).count() : n;
+
+    if (k + static_cast<int>(this->intercept) > n_included) {
+      return false;
+    }
+
+    MatrixXd z = MatrixXd::Zero(n, k);
+
+    for (int a = 0; a < k; ++a) {
+      IndexType c_ind = active_clusters[a];
+      double shift = 0;
+
+      for (auto c_it = clusters.cbegin(c_ind); c_it != clusters.cend(c_ind);
+           ++c_it) {
+        int j = *c_it;
+        double s_j = sign(beta(j));
+
+        switch (jit_normalization) {
+          case JitNormalization::Both:
+            z.col(a) += x.col(j) * (s_j / x_scales(j));
+            shift += s_j * x_centers(j) / x_scales(j);
+            break;
+          case JitNormalization::Center:
+            z.col(a) += x.col(j) * s_j;
+            shift += s_j * x_centers(j);
+            break;
+          case JitNormalization::Scale:
+            z.col(a) += x.col(j) * (s_j / x_scales(j));
+            break;
+          case JitNormalization::None:
+            z.col(a) += x.col(j) * s_j;
+            break;
+        }
+      }
+
+      z.col(a).array() -= shift;
+    }
+
+    VectorXd y_vec = y.col(0);
+    VectorXd z_means = VectorXd::Zero(k);
+    double y_mean = 0;
+
+    if (this->intercept) {
+      z_means = weighted ? VectorXd(z.transpose() * w / w.sum())
+                         : VectorXd(z.colwise().mean());
+      y_mean = weighted ? y_vec.dot(w) / w.sum() : y_vec.mean();
+      z.rowwise() -= z_means.transpose();
+      y_vec.array() -= y_mean;
+    }
+
+    if (weighted) {
+      // Solve the weighted problem as an unweighted one in sqrt(w) * z
+      VectorXd w_sqrt = w.cwiseSqrt();
+      z = w_sqrt.asDiagonal() * z;
+      y_vec = y_vec.cwiseProduct(w_sqrt);
+    }
+
+    Eigen::LDLT<MatrixXd> ldlt(z.transpose() * z);
+
+    if (ldlt.info() != Eigen::Success || k == 0) {
+      return false;
+    }
+
+    const VectorXd d = ldlt.vectorD();
+
+    if (d.minCoeff() <= constants::EPSILON * d.maxCoeff()) {
+      return false;
+    }
+
+    VectorXd c = ldlt.solve(z.transpose() * y_vec);
+
+    if (!c.allFinite()) {
+      return false;
+    }
+
+    for (int a = 0; a < k; ++a) {
+      IndexType c_ind = active_clusters[a];
+
+      for (auto c_it = clusters.cbegin(c_ind); c_it != clusters.cend(c_ind);
+           ++c_it) {
+        beta(*c_it) = c(a) * sign(beta(*c_it));
+      }
+
+      clusters.setCoeff(c_ind, std::abs(c(a)));
+    }
+
+    if (this->intercept) {
+      beta0(0) = y_mean - z_means.dot(c);
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief Relaxes a single fit, for a design matrix that has already been
+   * normalized
+   *
+   * @param y The preprocessed response
+   * @param weights Observation weights, normalized to have mean one, or an
+   *   empty vector for unit weights
+   * @param beta0 On input, warm start intercepts (or empty). On output, the
+   *   relaxed intercepts.
+   * @param beta On input, warm start coefficients (or empty), which are
+   *   projected onto the clusters and signs of `fit`. On output, the relaxed
+   *   coefficients before blending with the penalized fit.
+   */
+  template<typename T>
+  SlopeFit relaxImpl(const SlopeFit& fit,
+                     T& x,
+                     const Eigen::MatrixXd& y,
+                     const Eigen::VectorXd& weights,
+                     const double gamma,
+                     Eigen::VectorXd& beta0,
+                     Eigen::VectorXd& beta,
+                     const JitNormalization jit_normalization)
+  {
+    using Eigen::MatrixXd;
+    using Eigen::VectorXd;
+
+    int n = x.rows();
+    int p = x.cols();
+    int m = y.cols();
+
+    Timer timer;
+
+    std::vector<double> primals, duals, time;
+    timer.start();
+
+    std::unique_ptr<Loss> loss = setupLoss(this->loss_type);
+    loss->setWeights(weights);
+
+    // The clusters and signs of the penalized fit define the relaxed problem
+    VectorXd beta_fit = MatrixXd(fit.getCoefs(false)).reshaped();
+    slope::Clusters clusters(beta_fit);
+
+    VectorXd beta_warm = std::move(beta);
+    beta = beta_fit;
+
+    if (beta_warm.size() == beta.size()) {
+      for (IndexType j = 0; j < clusters.size(); ++j) {
+        if (clusters.coeff(j) == 0) {
+          continue;
+        }
+
+        double c = 0;
+        for (auto c_it = clusters.cbegin(j); c_it != clusters.cend(j);
+             ++c_it) {
+          c += beta_warm(*c_it) * sign(beta_fit(*c_it));
+        }
+        c /= clusters.cluster_size(j);
+
+        if (c != 0) {
+          for (auto c_it = clusters.cbegin(j); c_it != clusters.cend(j);
+               ++c_it) {
+            beta(*c_it) = c * sign(beta_fit(*c_it));
+          }
+          clusters.setCoeff(j, std::abs(c));
+        }
+      }
+    }
+
+    if (beta0.size() != m) {
+      beta0 = fit.getIntercepts(false);
+    }
+
+    int passes = 0;
+
+    MatrixXd eta;
+
+    if (this->loss_type == "quadratic" &&
+        relaxedLeastSquares(
+          beta0, beta, clusters, x, y, weights, jit_normalization)) {
+      passes = 1;
+
+      eta = linearPredictor(x,
+                            activeSet(beta),
+                            beta0,
+                            beta,
+                            x_centers,
+                            x_scales,
+                            jit_normalization,
+                            intercept);
+
+      if (collect_diagnostics) {
+        primals.push_back(loss->loss(eta, y));
+        duals.push_back(0.0);
+        time.push_back(timer.elapsed());
+      }
+    } else {
+      bool update_clusters = false;
+
+      Eigen::ArrayXd lambda_cumsum_relax =
+        Eigen::ArrayXd::Zero(static_cast<Eigen::Index>(p) * m + 1);
+
+      eta = linearPredictor(x,
+                            activeSet(beta),
+                            beta0,
+                            beta,
+                            x_centers,
+                            x_scales,
+                            jit_normalization,
+                            intercept);
+      MatrixXd residual(n, m);
+      MatrixXd working_residual(n, m);
+
+      MatrixXd w = MatrixXd::Ones(n, m);
+      MatrixXd w_ones = MatrixXd::Ones(n, m);
+      MatrixXd z = y;
+
+      std::mt19937 rng;
+
+      if (random_seed.has_value()) {
+        rng.seed(*random_seed);
+      } else {
+        rng.seed(std::random_device{}());
+      }
+
+      for (int irls_it = 0; irls_it < max_it_outer_relax; irls_it++) {
+        residual = loss->residual(eta, y);
+
+        if (collect_diagnostics) {
+          primals.push_back(loss->loss(eta, y));
+          duals.push_back(0.0);
+          time.push_back(timer.elapsed());
+        }
+
+        Eigen::VectorXd cluster_gradient = clusterGradient(beta,
+                                                           residual,
+                                                           clusters,
+                                                           x,
+                                                           w_ones,
+                                                           x_centers,
+                                                           x_scales,
+                                                           jit_normalization);
+
+        double norm_grad = cluster_gradient.lpNorm<Eigen::Infinity>();
+
+        if (norm_grad < tol_relax) {
+          break;
+        }
+
+        loss->updateWeightsAndWorkingResponse(w, z, eta, y);
+        working_residual = eta - z;
+
+        for (int inner_it = 0; inner_it < max_it_inner_relax; ++inner_it) {
+          passes++;
+
+          double max_abs_gradient = coordinateDescent(beta0,
+                                                      beta,
+                                                      working_residual,
+                                                      clusters,
+                                                      lambda_cumsum_relax,
+                                                      x,
+                                                      w,
+                                                      x_centers,
+                                                      x_scales,
+                                                      intercept,
+                                                      jit_normalization,
+                                                      update_clusters,
+                                                      rng,
+                                                      cd_type);
+
+          if (max_abs_gradient < tol_relax) {
+            break;
+          }
+        }
+
+        eta = working_residual + z;
+
+        if (irls_it == max_it_outer_relax) {
+          WarningLogger::addWarning(
+            WarningCode::MAXIT_REACHED,
+            "Maximum number of IRLS iterations reached.");
+        }
+      }
+    }
+
+    double dev = loss->deviance(eta, y);
+
+    VectorXd beta_out = beta;
+
+    if (gamma > 0) {
+      beta_out = (1 - gamma) * beta + gamma * beta_fit;
+    }
+
+    SlopeFit fit_out{ beta0,
+                      beta_out.reshaped(p, m).sparseView(),
+                      clusters,
+                      fit.getAlpha(),
+                      dev,
+                      primals,
+                      duals,
+                      time,
+                      passes,
+                      fit.getMetadata() };
+
+    return fit_out;
+  }
+
+  /**
+   * @brief The intercept-only model at the start of the path, and the
+   * quantities that the path is set up from
+   */
+  struct NullModel
+  {
+    /// Loss, with observation weights normalized to have mean one
+    std::unique_ptr<Loss> loss;
+
+    /// Type of just-in-time normalization of x
+    JitNormalization jit_normalization = JitNormalization::None;
+
+    /// Preprocessed response
+    Eigen::MatrixXd y;
+
+    /// Effective number of observations, which is the sum of the weights
+    double n_eff = 0;
+
+    /// Regularization weights, validated or generated
+    Eigen::ArrayXd lambda;
+
+    /// Intercepts
+    Eigen::VectorXd beta0;
+
+    /// Linear predictor
+    Eigen::MatrixXd eta;
+
+    /// Gradient for all coefficients
+    Eigen::VectorXd gradient;
+  };
+
+  /**
+   * @brief Validates the data, normalizes x, and fits the null model
+   *
+   * @param lambda Regularization weights. If empty, they are generated.
+   * @param seed Only `x_stats` and `null_gradient` are used.
+   */
+  template<typename T>
+  NullModel nullModel(T& x,
+                      const Eigen::MatrixXd& y_in,
+                      const Eigen::VectorXd& weights,
+                      Eigen::ArrayXd lambda,
+                      const PathSeed& seed)
+  {
+    using Eigen::MatrixXd;
+    using Eigen::VectorXd;
+
+    const int n = x.rows();
+    const int p = x.cols();
+
+    if (n != y_in.rows()) {
+      throw std::invalid_argument(
+        "x and y_in must have the same number of rows");
+    }
+
+    if (!seed.x_stats && !isFinite(x)) {
+      throw std::invalid_argument("x must not contain NA, NaN, or Inf values");
+    }
+
+    if (!y_in.array().isFinite().all()) {
+      throw std::invalid_argument("y must not contain NA, NaN, or Inf values");
+    }
+
+    const bool weighted = weights.size() > 0;
+
+    NullModel out;
+
+    out.loss = setupLoss(this->loss_type);
+    out.loss->setWeights(normalizedWeights(weights, n));
+
+    const VectorXd& w = out.loss->getWeights();
+
+    // The effective number of observations, which is what the weights
+    // correspond to if they are frequencies
+    out.n_eff = weighted ? weights.sum() : n;
+
+    out.jit_normalization = seed.x_stats ? normalize(*seed.x_stats,
+                                                     this->x_centers,
+                                                     this->x_scales,
+                                                     this->centering_type,
+                                                     this->scaling_type)
+                                         : normalizeWeighted(x, weights);
+
+    out.y = out.loss->preprocessResponse(y_in);
+
+    const int m = out.y.cols();
+    const IndexType pm = static_cast<IndexType>(p) * m;
+
+    out.beta0 = VectorXd::Zero(m);
+    out.eta = MatrixXd::Zero(n, m);
+
+    if (this->intercept) {
+      VectorXd y_mean = weighted ? VectorXd(out.y.transpose() * w / n)
+                                 : VectorXd(out.y.colwise().mean());
+      out.beta0 = out.loss->link(y_mean.transpose()).transpose();
+      out.eta.rowwise() = out.beta0.transpose();
+    }
+
+    if (lambda.size() == 0) {
+      lambda = lambdaSequence(pm,
+                              this->q,
+                              this->lambda_type,
+                              static_cast<int>(std::round(out.n_eff)),
+                              this->theta1,
+                              this->theta2);
+    } else {
+      if (lambda.size() != pm) {
+        throw std::invalid_argument(
+          "lambda must be the same length as the number of coefficients");
+      }
+      if (lambda.minCoeff() < 0) {
+        throw std::invalid_argument("lambda must be non-negative");
+      }
+      if (!lambda.isFinite().all()) {
+        throw std::invalid_argument("lambda must be finite");
+      }
+      // Check that lambda is in decreasing order
+      for (int i = 1; i < lambda.size(); ++i) {
+        if (lambda(i) > lambda(i - 1)) {
+          throw std::invalid_argument(
+            "lambda must be in decreasing order");
+        }
+      }
+    }
+
+    out.lambda = std::move(lambda);
+
+    if (seed.null_gradient.size() > 0) {
+      out.gradient = seed.null_gradient;
+    } else {
+      std::vector<IndexType> full_set(pm);
+      std::iota(full_set.begin(), full_set.end(), 0);
+
+      out.gradient.resize(pm);
+
+      updateGradient(out.gradient,
+                     x,
+                     out.loss->residual(out.eta, out.y),
+                     full_set,
+                     this->x_centers,
+                     this->x_scales,
+                     Eigen::VectorXd::Ones(n),
+                     out.jit_normalization);
+    }
+
+    return out;
+  }
+
+  /**
+   * @brief Sets up the sequence of alpha values of the path
+   *
+   * @param alpha User-supplied sequence, which is validated, or an empty
+   *   array to generate the sequence from `alpha_max`
+   * @param alpha_max The smallest alpha at which all coefficients are zero
+   * @param n_eff Effective number of observations
+   * @param n_coefs Number of coefficients
+   */
+  Eigen::ArrayXd alphaSequence(const Eigen::ArrayXd& alpha,
+                               const double alpha_max,
+                               const double n_eff,
+                               const Eigen::Index n_coefs)
+  {
+    if (alpha_type == "path" ||
+        (alpha_type == "estimate" && alpha_estimate != 1)) {
+      if (alpha_min_ratio < 0) {
+        alpha_min_ratio = n_eff > n_coefs ? 1e-4 : 1e-2;
+      }
+
+      Eigen::ArrayXd out =
+        regularizationPath(alpha, path_length, alpha_min_ratio, alpha_max);
+      path_length = out.size();
+
+      return out;
     } else if (alpha_type == "estimate" && alpha_estimate == -1) {
       if (loss_type != "quadratic") {
         throw std::invalid_argument("Automatic alpha estimation is only "
@@ -511,21 +1983,126 @@ public:
       }
     }
 
+    return alpha;
+  }
+
+  /**
+   * @brief Implementation of the path algorithm
+   *
+   * @tparam T Matrix type for feature input
+   * @tparam Consumer Callable with signature `bool(SlopeFit&&)`, which is
+   *   handed each fit along the path and returns `false` to stop early.
+   * @param seed Warm start and precomputed quantities to start from
+   * @param final_state If not `nullptr`, receives the state of the solver
+   *   after the last step.
+   */
+  template<typename T, typename Consumer>
+  void pathImpl(T& x,
+                const Eigen::MatrixXd& y_in,
+                const Eigen::VectorXd& weights,
+                Eigen::ArrayXd alpha,
+                Eigen::ArrayXd lambda,
+                const std::function<bool()>& check_interrupt,
+                const PathSeed& seed,
+                Consumer&& consume,
+                PathState* final_state = nullptr)
+  {
+    using Eigen::MatrixXd;
+    using Eigen::VectorXd;
+
+    const SlopePath* warm_start = seed.warm_start;
+
+    const int n = x.rows();
+    const int p = x.cols();
+
+    const int INTERRUPT_FREQ = 100;
+    bool interrupt = false;
+
+    const bool weighted = weights.size() > 0;
+    const bool user_alpha = alpha.size() > 0;
+
+    NullModel null_model =
+      nullModel(x, y_in, weights, std::move(lambda), seed);
+
+    std::unique_ptr<Loss> loss = std::move(null_model.loss);
+    const VectorXd& w = loss->getWeights();
+    const double n_eff = null_model.n_eff;
+    const JitNormalization jit_normalization = null_model.jit_normalization;
+
+    MatrixXd y = std::move(null_model.y);
+    lambda = std::move(null_model.lambda);
+
+    const int m = y.cols();
+    const IndexType pm = static_cast<IndexType>(p) * m;
+
+    std::vector<IndexType> full_set(pm);
+    std::iota(full_set.begin(), full_set.end(), 0);
+
+    VectorXd beta0 = std::move(null_model.beta0);
+    VectorXd beta = VectorXd::Zero(pm);
+
+    MatrixXd eta = std::move(null_model.eta); // linear predictor
+    MatrixXd residual = loss->residual(eta, y);
+    VectorXd gradient = std::move(null_model.gradient);
+
+    // Setup the regularization sequence and path
+    SortedL1Norm sl1_norm;
+
+    // TODO: Make this part of the slope class
+    auto solver = setupSolver(this->solver_type,
+                              this->loss_type,
+                              jit_normalization,
+                              this->intercept,
+                              this->update_clusters,
+                              this->cd_iterations,
+                              this->cd_type,
+                              this->random_seed);
+
+    IndexType alpha_max_ind = whichMax(gradient.cwiseAbs());
+    double alpha_max = sl1_norm.dualNorm(gradient, lambda);
+
+    alpha = alphaSequence(alpha, alpha_max, n_eff, gradient.size());
+
     // Screening setup
     std::unique_ptr<ScreeningRule> screening_rule =
       createScreeningRule(this->screening_type);
-    std::vector<int> working_set =
+    std::vector<IndexType> working_set =
       screening_rule->initialize(full_set, alpha_max_ind);
 
     // Path variables
     double null_deviance = loss->deviance(eta, y);
     double dev_prev = null_deviance;
 
-    Timer timer;
+    Timer timer;
+
+    double alpha_prev = std::max(alpha_max, alpha(0));
+
+    std::vector<int> warm_steps;
+    Eigen::ArrayXd warm_alpha;
+
+    if (warm_start && warm_start->size() > 0) {
+      auto warm_coefs = warm_start->getCoefView(0);
+
+      if (warm_coefs.rows() != p || warm_coefs.cols() != m) {
+        throw std::invalid_argument(
+          "warm start must have the same number of coefficients as the model");
+      }
+
+      warm_alpha = warm_start->getAlpha();
+      warm_steps = alignPaths(alpha, warm_alpha, alpha_max);
+    }
 
-    double alpha_prev = std::max(alpha_max, alpha(0));
+    auto metadata =
+      std::make_shared<const PathMetadata>(PathMetadata{ lambda,
+                                                         null_deviance,
+                                                         this->centering_type,
+                                                         this->scaling_type,
+                                                         this->loss_type,
+                                                         this->intercept,
+                                                         this->x_centers,
+                                                         this->x_scales });
 
-    std::vector<SlopeFit> fits;
+    bool full_gradient = false;
 
     // Regularization path loop
     for (int path_step = 0; path_step < this->path_length; ++path_step) {
@@ -546,6 +2123,49 @@ public:
 
       assert(alpha_curr <= alpha_prev && "Alpha must be decreasing");
 
+      bool seeded = false;
+
+      if (!warm_steps.empty() && warm_steps[path_step] >= 0) {
+        int k = warm_steps[path_step];
+        const PathMetadata& warm_metadata = *warm_start->getMetadata();
+
+        auto [beta0_orig, beta_orig] =
+          rescaleCoefficients(warm_start->getInterceptMatrix().col(k),
+                              warm_start->getCoefView(k),
+                              warm_metadata.x_centers,
+                              warm_metadata.x_scales,
+                              warm_metadata.has_intercept);
+        auto [beta0_warm, beta_warm] = normalizeCoefficients(beta0_orig,
+                                                             beta_orig,
+                                                             this->x_centers,
+                                                             this->x_scales,
+                                                             this->intercept);
+        if (this->intercept) {
+          beta0 = beta0_warm;
+        }
+        beta = beta_warm.reshaped();
+
+        seeded = path_step == 0 && seed.eta.size() > 0;
+
+        if (seeded) {
+          eta = seed.eta;
+        } else {
+          eta = linearPredictor(x,
+                                activeSet(beta),
+                                beta0,
+                                beta,
+                                this->x_centers,
+                                this->x_scales,
+                                jit_normalization,
+                                this->intercept);
+        }
+        residual = loss->residual(eta, y);
+
+        // The screening rule treats the warm start as the solution at the
+        // previous step
+        alpha_prev = std::max(alpha_curr, warm_alpha(k));
+      }
+
       Eigen::ArrayXd lambda_curr = alpha_curr * lambda;
       Eigen::ArrayXd lambda_prev = alpha_prev * lambda;
 
@@ -555,14 +2175,20 @@ public:
       // Update gradient for the full set
       // TODO: Only update for non-working set since gradient is updated before
       // the convergence check in the inner loop for the working set
-      updateGradient(gradient,
-                     x.derived(),
-                     residual,
-                     full_set,
-                     x_centers,
-                     x_scales,
-                     Eigen::VectorXd::Ones(x.rows()),
-                     jit_normalization);
+      if (seeded && seed.gradient.size() > 0) {
+        gradient = seed.gradient;
+      } else {
+        updateGradient(gradient,
+                       x,
+                       residual,
+                       full_set,
+                       x_centers,
+                       x_scales,
+                       Eigen::VectorXd::Ones(x.rows()),
+                       jit_normalization);
+      }
+
+      full_gradient = false;
 
       working_set = screening_rule->screen(
         gradient, lambda_curr, lambda_prev, beta, full_set);
@@ -573,7 +2199,7 @@ public:
         // Compute primal, dual, and gap
         residual = loss->residual(eta, y);
         updateGradient(gradient,
-                       x.derived(),
+                       x,
                        residual,
                        working_set,
                        this->x_centers,
@@ -595,15 +2221,23 @@ public:
         // need the offset at all.
         if (this->intercept) {
           VectorXd theta_mean = theta.colwise().mean();
-          theta.rowwise() -= theta_mean.transpose();
+
+          // With weights, the residual is zero for observations with zero
+          // weight, and so must the dual be
+          if (weighted) {
+            theta -= w * theta_mean.transpose();
+          } else {
+            theta.rowwise() -= theta_mean.transpose();
+          }
 
           offsetGradient(dual_gradient,
-                         x.derived(),
+                         x,
                          theta_mean,
                          working_set,
                          this->x_centers,
                          this->x_scales,
-                         jit_normalization);
+                         jit_normalization,
+                         w);
         }
 
         // Common scaling operation
@@ -611,7 +2245,7 @@ public:
           dual_gradient(working_set), lambda_curr.head(working_set.size()));
         theta.array() /= std::max(1.0, dual_norm);
 
-        double dual = loss->dual(theta, y, Eigen::VectorXd::Ones(n));
+        double dual = loss->dual(theta, y, w);
 
         if (collect_diagnostics) {
           timer.pause();
@@ -620,7 +2254,7 @@ public:
                                          loss,
                                          sl1_norm,
                                          lambda_curr,
-                                         x.derived(),
+                                         x,
                                          y,
                                          this->x_centers,
                                          this->x_scales,
@@ -645,13 +2279,14 @@ public:
                                                beta,
                                                lambda_curr,
                                                working_set,
-                                               x.derived(),
+                                               x,
                                                residual,
                                                this->x_centers,
                                                this->x_scales,
                                                jit_normalization,
                                                full_set);
           if (no_violations) {
+            full_gradient = true;
             break;
           } else {
             it = 0; // Restart if there are KKT violations
@@ -680,7 +2315,7 @@ public:
                     sl1_norm,
                     gradient,
                     working_set,
-                    x.derived(),
+                    x,
                     this->x_centers,
                     this->x_scales,
                     y);
@@ -709,367 +2344,43 @@ public:
 
       SlopeFit fit{ beta0,
                     beta.reshaped(p, m).sparseView(),
-                    clusters,
+                    std::move(clusters),
                     alpha_curr,
-                    lambda,
                     dev,
-                    null_deviance,
-                    primals,
-                    duals,
-                    time,
+                    std::move(primals),
+                    std::move(duals),
+                    std::move(time),
                     total_it,
-                    this->centering_type,
-                    this->scaling_type,
-                    this->intercept,
-                    this->x_centers,
-                    this->x_scales };
+                    metadata };
 
-      fits.emplace_back(std::move(fit));
+      bool keep_going = consume(std::move(fit));
 
-      if (interrupt) {
+      if (interrupt || !keep_going) {
         break;
       }
 
       if (!user_alpha) {
         int n_unique = unique(beta.cwiseAbs()).size();
+        int n_clusters_max = static_cast<int>(std::round(n_eff)) + 1;
         if (dev_ratio > dev_ratio_tol || dev_change < dev_change_tol ||
-            n_unique >= this->max_clusters.value_or(n + 1)) {
-          break;
-        }
-      }
-    }
-
-    return fits;
-  }
-
-  /**
-   * @brief Fits a single SLOPE regression model for given alpha and lambda
-   * values
-   *
-   * @tparam T Matrix type for feature input (supports dense or sparse matrices)
-   * @param x Feature matrix of size n x p
-   * @param y_in Response matrix of size n x m
-   * @param alpha Mixing parameter for elastic net regularization
-   * @param lambda Vector of regularization parameters (if empty, computed
-   * automatically)
-   * @param check_interrupt Optional lambda to check for user interrupt. It runs
-   *  periodically during the fitting.
-   * @return SlopeFit Object containing fitted model and optimization metrics
-   *
-   * Fits a single SLOPE model with specified regularization parameters,
-   * returning coefficients and optimization details in a SlopeFit object.
-   */
-  template<typename T>
-  SlopeFit fit(
-    Eigen::EigenBase<T>& x,
-    const Eigen::MatrixXd& y_in,
-    const double alpha = 1.0,
-    Eigen::ArrayXd lambda = Eigen::ArrayXd::Zero(0),
-    std::function<bool()> check_interrupt = defaultInterruptChecker)
-  {
-    Eigen::ArrayXd alpha_arr(1);
-    alpha_arr(0) = alpha;
-    SlopePath res = path(x, y_in, alpha_arr, lambda, check_interrupt);
-
-    return { res(0) };
-  };
-
-  /**
-   * @brief Estimates the regularization parameter alpha for SLOPE regression
-   *
-   * This function implements an algorithm to estimate an appropriate
-   * regularization parameter (alpha) for SLOPE, which is a generalization of
-   * the lasso. When n >= p + 30, it directly estimates alpha from OLS
-   * residuals. Otherwise, it uses an iterative procedure that alternates
-   * between estimating alpha and fitting the SLOPE model.
-   *
-   * The iterative procedure works by:
-   * 1. Starting with an empty set of selected variables
-   * 2. Estimating alpha based on the selected variables
-   * 3. Fitting a SLOPE model with that alpha
-   * 4. Updating the selected variables based on non-zero coefficients
-   * 5. Repeating until convergence or maximum iterations reached
-   *
-   * @tparam MatrixType The type of matrix used to store the design matrix
-   * @param x Design matrix with n observations and p predictors
-   * @param y Response matrix
-   * @param check_interrupt Optional lambda to check for user interrupt
-   * @return A SlopePath object containing the fitted model with estimated alpha
-   * @throws std::runtime_error If maximum iterations reached or if too many
-   * variables selected
-   */
-  template<typename T>
-  SlopePath estimateAlpha(
-    Eigen::EigenBase<T>& x,
-    Eigen::MatrixXd& y,
-    std::function<bool()> check_interrupt = defaultInterruptChecker)
-  {
-    int n = x.rows();
-    int p = x.cols();
-
-    // Create a copy with alpha type set to path to avoid recursion
-    Slope model_copy = *this;
-    model_copy.setAlphaType("path");
-
-    std::vector<int> selected;
-    Eigen::ArrayXd alpha(1);
-    SlopePath result;
-
-    // Estimate the noise level, if possible
-    if (n >= p + 30) {
-      alpha(0) = estimateNoise(x, y, this->intercept) / n;
-      this->alpha_estimate = alpha(0);
-      result =
-        model_copy.path(x, y, alpha, Eigen::ArrayXd::Zero(0), check_interrupt);
-    } else {
-      for (int it = 0; it < this->alpha_est_maxit; ++it) {
-        T x_selected = subsetCols(x.derived(), selected);
-
-        std::vector<int> selected_prev = selected;
-        selected.clear();
-
-        alpha(0) = estimateNoise(x_selected, y, this->intercept) / n;
-        this->alpha_estimate = alpha(0);
-
-        result = model_copy.path(
-          x, y, alpha, Eigen::ArrayXd::Zero(0), check_interrupt);
-        auto coefs = result.getCoefs().back();
-
-        for (typename Eigen::SparseMatrix<double>::InnerIterator it(coefs, 0);
-             it;
-             ++it) {
-          selected.emplace_back(it.row());
-        }
-
-        if (selected == selected_prev) {
-          return result;
-        }
-
-        if (static_cast<int>(selected.size()) >= n + this->intercept) {
-          throw std::runtime_error(
-            "selected >= n - 1 variables, cannot estimate variance");
-        }
-      }
-
-      slope::WarningLogger::addWarning(
-        slope::WarningCode::MAXIT_REACHED,
-        "Maximum iterations reached in alpha estimation");
-    }
-
-    return result;
-  }
-
-  /**
-   * @brief Relaxes a fitted SLOPE model
-   *
-   * @tparam T Matrix type for feature input (supports dense or sparse matrices)
-   * @param fit Previously fitted SLOPE model containing coefficient estimates
-   * @param x Feature matrix of size n x p
-   * @param y_in Response vector of size n
-   * @param gamma Relaxation parameter, proportion of SLOPE-penalized fit. Must
-   * be between 0 and 1. Default is 0.0 which means fully relaxed.
-   * @param beta0 Warm start intercept values (optional)
-   * @param beta Warm start coefficient values (optional)
-   * @return SlopeFit Object containing the relaxed model with unpenalized
-   * coefficients
-   */
-  template<typename T>
-  SlopeFit relax(const SlopeFit& fit,
-                 T& x,
-                 const Eigen::VectorXd& y_in,
-                 const double gamma = 0.0,
-                 Eigen::VectorXd beta0 = Eigen::VectorXd(0),
-                 Eigen::VectorXd beta = Eigen::VectorXd(0))
-  {
-    using Eigen::MatrixXd;
-    using Eigen::VectorXd;
-
-    int n = x.rows();
-    int p = x.cols();
-
-    if (beta0.size() == 0) {
-      beta0 = fit.getIntercepts(false);
-    }
-
-    if (beta.size() == 0) {
-      beta = fit.getCoefs(false);
-    }
-
-    double alpha = fit.getAlpha();
-
-    Timer timer;
-
-    std::vector<double> primals, duals, time;
-    timer.start();
-
-    auto jit_normalization =
-      normalize(x, x_centers, x_scales, centering_type, scaling_type, modify_x);
-
-    bool update_clusters = false;
-
-    std::unique_ptr<Loss> loss = setupLoss(this->loss_type);
-
-    MatrixXd y = loss->preprocessResponse(y_in);
-
-    int m = y.cols();
-
-    Eigen::ArrayXd lambda_cumsum_relax = Eigen::ArrayXd::Zero(p * m + 1);
-
-    auto working_set = activeSet(beta);
-
-    Eigen::MatrixXd eta = linearPredictor(x,
-                                          working_set,
-                                          beta0,
-                                          beta,
-                                          x_centers,
-                                          x_scales,
-                                          jit_normalization,
-                                          intercept);
-    VectorXd gradient = VectorXd::Zero(p * m);
-    MatrixXd residual(n, m);
-    MatrixXd working_residual(n, m);
-
-    MatrixXd w = MatrixXd::Ones(n, m);
-    MatrixXd w_ones = MatrixXd::Ones(n, m);
-    MatrixXd z = y;
-
-    slope::Clusters clusters(beta);
-
-    std::mt19937 rng;
-
-    if (random_seed.has_value()) {
-      rng.seed(*random_seed);
-    } else {
-      rng.seed(std::random_device{}());
-    }
-
-    int passes = 0;
-
-    for (int irls_it = 0; irls_it < max_it_outer_relax; irls_it++) {
-      residual = loss->residual(eta, y);
-
-      if (collect_diagnostics) {
-        primals.push_back(loss->loss(eta, y));
-        duals.push_back(0.0);
-        time.push_back(timer.elapsed());
-      }
-
-      Eigen::VectorXd cluster_gradient = clusterGradient(beta,
-                                                         residual,
-                                                         clusters,
-                                                         x,
-                                                         w_ones,
-                                                         x_centers,
-                                                         x_scales,
-                                                         jit_normalization);
-
-      double norm_grad = cluster_gradient.lpNorm<Eigen::Infinity>();
-
-      if (norm_grad < tol_relax) {
-        break;
-      }
-
-      loss->updateWeightsAndWorkingResponse(w, z, eta, y);
-      working_residual = eta - z;
-
-      for (int inner_it = 0; inner_it < max_it_inner_relax; ++inner_it) {
-        passes++;
-
-        double max_abs_gradient = coordinateDescent(beta0,
-                                                    beta,
-                                                    working_residual,
-                                                    clusters,
-                                                    lambda_cumsum_relax,
-                                                    x,
-                                                    w,
-                                                    x_centers,
-                                                    x_scales,
-                                                    intercept,
-                                                    jit_normalization,
-                                                    update_clusters,
-                                                    rng,
-                                                    cd_type);
-
-        if (max_abs_gradient < tol_relax) {
+            n_unique >= this->max_clusters.value_or(n_clusters_max)) {
           break;
         }
       }
-
-      eta = working_residual + z;
-
-      if (irls_it == max_it_outer_relax) {
-        WarningLogger::addWarning(WarningCode::MAXIT_REACHED,
-                                  "Maximum number of IRLS iterations reached.");
-      }
-    }
-
-    double dev = loss->deviance(eta, y);
-
-    if (gamma > 0) {
-      Eigen::VectorXd old_coefs = fit.getCoefs(false);
-      Eigen::VectorXd old_intercept = fit.getIntercepts(false);
-      beta = (1 - gamma) * beta + gamma * old_coefs;
     }
 
-    SlopeFit fit_out{ beta0,
-                      beta.reshaped(p, m).sparseView(),
-                      clusters,
-                      alpha,
-                      fit.getLambda(),
-                      dev,
-                      fit.getNullDeviance(),
-                      primals,
-                      duals,
-                      time,
-                      passes,
-                      centering_type,
-                      scaling_type,
-                      intercept,
-                      x_centers,
-                      x_scales };
-
-    return fit_out;
-  }
-
-  /**
-   * @brief Relaxes a fitted SLOPE path
-   *
-   * @tparam T Matrix type for feature input (supports dense or sparse matrices)
-   * @param path Previously fitted SLOPE path
-   * @param x Feature matrix of size n x p
-   * @param y Response vector of size n
-   * @param gamma Relaxation parameter, proportion of SLOPE-penalized fit. Must
-   * be between 0 and 1. Default is 0.0 which means fully relaxed.
-   * @return SlopePath Object containing the relaxed model with unpenalized
-   * coefficients
-   */
-  template<typename T>
-  SlopePath relax(const SlopePath& path,
-                  T& x,
-                  const Eigen::VectorXd& y,
-                  const double gamma = 0.0)
-  {
-    std::vector<SlopeFit> fits;
-
-    for (size_t i = 0; i < path.size(); i++) {
-      // TODO: Reinstate warm starts. Need to be careful about
-      // the warm started values though since they have to
-      // agree with the cluster or we will run into trouble.
-      // We can probably fix this by using the signs
-      // of the cluster object rather than the betas though.
-      auto relaxed_fit = relax(path(i), x, y, gamma);
-
-      fits.emplace_back(relaxed_fit);
+    if (final_state) {
+      final_state->eta = std::move(eta);
+      final_state->gradient = std::move(gradient);
+      final_state->full_gradient = full_gradient;
     }
-
-    return fits;
   }
 
-private:
   // Parameters
   bool collect_diagnostics = false;
   bool intercept = true;
   bool modify_x = false;
+  bool relax_warm_starts = true;
   bool return_clusters = true;
   bool update_clusters = true;
   double alpha_min_ratio = -1;
@@ -1102,6 +2413,7 @@ private:
   // Data
   Eigen::VectorXd x_centers;
   Eigen::VectorXd x_scales;
+  PartialFitState partial_fit_state;
 };
 
 } // namespace slope
@@ -8,6 +8,7 @@
 #include "clusters.h"
 #include "losses/setup_loss.h"
 #include "normalize.h"
+#include "path_metadata.h"
 #include "utils.h"
 #include <Eigen/Dense>
 #include <Eigen/SparseCore>
@@ -30,21 +31,15 @@ private:
   Eigen::SparseMatrix<double> coefs; ///< Sparse matrix of fitted coefficients
   Clusters clusters;                 ///< Clusters
   double alpha;                      ///< Scaling of lambda sequence
-  Eigen::ArrayXd lambda; ///< Regularization weights for the sorted L1 norm
-  double deviance;       ///< Final model deviance
-  double null_deviance;  ///< Null (or intercept-only) model deviance
+  double deviance;                   ///< Final model deviance
   std::vector<double>
     primals; ///< History of primal objective values during optimization
   std::vector<double>
     duals; ///< History of dual objective values during optimization
   std::vector<double> time; ///< Time points during optimization
   int passes; ///< Number of passes through the data during optimization
-  std::string centering_type; ///< Type of centering
-  std::string scaling_type;   ///< Type of scaling
-  std::string loss_type;      ///< Loss type
-  bool has_intercept;         ///< Indicates if the model has an intercept term
-  Eigen::VectorXd x_centers;  ///< Centers for the design matrix
-  Eigen::VectorXd x_scales;   ///< Scales for the design matrix
+  std::shared_ptr<const PathMetadata> metadata =
+    std::make_shared<const PathMetadata>(); ///< Metadata shared along the path
 
 public:
   SlopeFit() = default;
@@ -90,18 +85,59 @@ public:
     , coefs{ coefs }
     , clusters{ clusters }
     , alpha{ alpha }
-    , lambda{ lambda }
     , deviance{ deviance }
-    , null_deviance{ null_deviance }
     , primals{ primals }
     , duals{ duals }
     , time{ time }
     , passes{ passes }
-    , centering_type{ centering_type }
-    , scaling_type{ scaling_type }
-    , has_intercept{ has_intercept }
-    , x_centers{ x_centers }
-    , x_scales{ x_scales }
+    , metadata{ std::make_shared<const PathMetadata>(
+        PathMetadata{ lambda,
+                      null_deviance,
+                      centering_type,
+                      scaling_type,
+                      "",
+                      has_intercept,
+                      x_centers,
+                      x_scales }) }
+  {
+  }
+
+  /**
+   * @brief Construct a new Slope Fit object that shares its metadata with
+   * other fits along the same path
+   *
+   * @param intercepts Vector of intercept terms
+   * @param coefs Matrix of fitted coefficients
+   * @param clusters Clusters of coefficients
+   * @param alpha Mixing parameter between L1 and SLOPE norms
+   * @param deviance Final model deviance
+   * @param primals History of primal objectives
+   * @param duals History of dual objectives
+   * @param time Vector of optimization timestamps
+   * @param passes Number of optimization passes
+   * @param metadata Penalty weights, normalization, and other quantities that
+   * are constant along the path
+   */
+  SlopeFit(Eigen::VectorXd intercepts,
+           Eigen::SparseMatrix<double> coefs,
+           Clusters clusters,
+           const double alpha,
+           const double deviance,
+           std::vector<double> primals,
+           std::vector<double> duals,
+           std::vector<double> time,
+           const int passes,
+           std::shared_ptr<const PathMetadata> metadata)
+    : intercepts{ std::move(intercepts) }
+    , coefs{ std::move(coefs) }
+    , clusters{ std::move(clusters) }
+    , alpha{ alpha }
+    , deviance{ deviance }
+    , primals{ std::move(primals) }
+    , duals{ std::move(duals) }
+    , time{ std::move(time) }
+    , passes{ passes }
+    , metadata{ std::move(metadata) }
   {
   }
 
@@ -116,9 +152,9 @@ public:
     if (original_scale) {
       auto [beta0_out, beta_out] = rescaleCoefficients(intercepts,
                                                        coefs,
-                                                       this->x_centers,
-                                                       this->x_scales,
-                                                       this->has_intercept);
+                                                       metadata->x_centers,
+                                                       metadata->x_scales,
+                                                       metadata->has_intercept);
       return beta0_out;
     }
 
@@ -136,15 +172,23 @@ public:
       // TODO: Scale coefficients independently of intercepts
       auto [beta0_out, beta_out] = rescaleCoefficients(intercepts,
                                                        coefs,
-                                                       this->x_centers,
-                                                       this->x_scales,
-                                                       this->has_intercept);
+                                                       metadata->x_centers,
+                                                       metadata->x_scales,
+                                                       metadata->has_intercept);
       return beta_out.sparseView();
     }
 
     return coefs;
   }
 
+  /**
+   * @brief Gets the metadata that is shared with the other fits of the path
+   */
+  const std::shared_ptr<const PathMetadata>& getMetadata() const
+  {
+    return metadata;
+  }
+
   /**
    * @brief Gets the clusters
    */
@@ -153,7 +197,7 @@ public:
   /**
    * @brief Gets the lambda (regularization) parameter used
    */
-  const Eigen::ArrayXd& getLambda() const { return lambda; }
+  const Eigen::ArrayXd& getLambda() const { return metadata->lambda; }
 
   /**
    * @brief Gets the alpha (mixing) parameter used
@@ -168,12 +212,12 @@ public:
   /**
    * @brief Gets the model's loss type
    */
-  const std::string& getLossType() const { return loss_type; }
+  const std::string& getLossType() const { return metadata->loss_type; }
 
   /**
    * @brief Gets the null model deviance
    */
-  double getNullDeviance() const { return null_deviance; }
+  double getNullDeviance() const { return metadata->null_deviance; }
 
   /**
    * @brief Gets the sequence of primal objective values during optimization
@@ -201,7 +245,10 @@ public:
    * @return double The deviance ratio, a measure of model fit (higher is
    * better)
    */
-  double getDevianceRatio() const { return 1.0 - deviance / null_deviance; }
+  double getDevianceRatio() const
+  {
+    return 1.0 - deviance / metadata->null_deviance;
+  }
 
   /**
    * @brief Calculate the duality gaps during optimization
@@ -223,7 +270,7 @@ public:
    *
    * @return bool True if model has intercept, false otherwise
    */
-  bool hasIntercept() const { return has_intercept; }
+  bool hasIntercept() const { return metadata->has_intercept; }
 
   /**
    * @brief Predict the response for a given input matrix
@@ -241,7 +288,7 @@ public:
 
     Eigen::MatrixXd eta = x.derived() * getCoefs();
 
-    if (has_intercept) {
+    if (metadata->has_intercept) {
       eta.rowwise() += getIntercepts().transpose();
     }
 
@@ -250,7 +297,7 @@ public:
     }
 
     // Return predictions
-    std::unique_ptr<Loss> loss = setupLoss(this->loss_type);
+    std::unique_ptr<Loss> loss = setupLoss(metadata->loss_type);
 
     return loss->predict(eta);
   }
@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include "index_type.h"
 #include "slope_fit.h"
 #include <Eigen/Dense>
 #include <Eigen/SparseCore>
@@ -17,21 +18,44 @@
 
 namespace slope {
 
+/// Sparse matrix type of the coefficients of a path, with slope::IndexType
+/// indices so that a path can hold more nonzero coefficients than `int` can
+/// count
+using PathCoefMatrix = Eigen::SparseMatrix<double, Eigen::ColMajor, IndexType>;
+
 /**
  * @class SlopePath
  * @brief Container class for SLOPE regression solution paths
  *
- * Stores a path of SlopeFit objects and provides convenience access to:
+ * Stores a path of SLOPE solutions and provides convenience access to:
  * - Model coefficients (intercepts and sparse coefficient matrices)
  * - Regularization parameters (alpha and lambda sequences)
  * - Model fit statistics (deviance, null deviance)
  * - Optimization metrics (primal/dual objectives, computation time, iteration
  * counts)
+ *
+ * The coefficients of all steps are stored (on the normalized scale) in a
+ * single column-compressed matrix with p rows and m columns per step, and
+ * the penalty weights and normalization are shared between the steps
+ * through PathMetadata, so that long paths on wide data stay compact.
  */
 class SlopePath
 {
 private:
-  std::vector<SlopeFit> fits;
+  std::shared_ptr<const PathMetadata> metadata;
+  int p = 0;
+  int m = 0;
+  std::vector<IndexType> coef_outer = { 0 };
+  std::vector<IndexType> coef_inner;
+  std::vector<double> coef_values;
+  std::vector<double> intercepts;
+  std::vector<Clusters> clusters;
+  std::vector<double> alphas;
+  std::vector<double> deviances;
+  std::vector<std::vector<double>> primals;
+  std::vector<std::vector<double>> duals;
+  std::vector<std::vector<double>> time;
+  std::vector<int> passes;
 
 public:
   /**
@@ -43,11 +67,60 @@ public:
    * @brief Constructs a SlopePath object containing SLOPE regression solution
    * path data
    *
-   * @param fits Vector of SlopeFit objects for each solution in the path
+   * @param fits Vector of SlopeFit objects for each solution in the path. The
+   * fits are assumed to belong to the same path, so that the metadata of the
+   * first fit applies to all of them.
    */
   SlopePath(const std::vector<SlopeFit>& fits)
-    : fits{ fits }
   {
+    for (const auto& fit : fits) {
+      addFit(fit);
+    }
+  }
+
+  /**
+   * @brief Appends a fit to the end of the path
+   *
+   * @param fit The fit to append. Its coefficients are copied into the
+   * compressed path storage and its metadata is shared, not copied.
+   */
+  void addFit(const SlopeFit& fit)
+  {
+    Eigen::SparseMatrix<double> coefs = fit.getCoefs(false);
+    coefs.makeCompressed();
+
+    if (alphas.empty()) {
+      metadata = fit.getMetadata();
+      p = coefs.rows();
+      m = coefs.cols();
+    }
+
+    assert(coefs.rows() == p && coefs.cols() == m);
+
+    const int* outer = coefs.outerIndexPtr();
+    const IndexType offset = coef_values.size();
+
+    coef_inner.insert(coef_inner.end(),
+                      coefs.innerIndexPtr(),
+                      coefs.innerIndexPtr() + coefs.nonZeros());
+    coef_values.insert(coef_values.end(),
+                       coefs.valuePtr(),
+                       coefs.valuePtr() + coefs.nonZeros());
+
+    for (int k = 0; k < m; ++k) {
+      coef_outer.emplace_back(offset + outer[k + 1]);
+    }
+
+    const Eigen::VectorXd& beta0 = fit.getIntercepts(false);
+    intercepts.insert(intercepts.end(), beta0.data(), beta0.data() + m);
+
+    clusters.emplace_back(fit.getClusters());
+    alphas.emplace_back(fit.getAlpha());
+    deviances.emplace_back(fit.getDeviance());
+    primals.emplace_back(fit.getPrimals());
+    duals.emplace_back(fit.getDuals());
+    time.emplace_back(fit.getTime());
+    passes.emplace_back(fit.getPasses());
   }
 
   /**
@@ -56,11 +129,68 @@ public:
    * @param step the
    * @return The fit at step `step` of the path. A SlopeFit object.
    */
-  const SlopeFit& operator()(const size_t step) const
+  SlopeFit operator()(const size_t step) const
   {
-    assert(step < fits.size());
+    assert(step < alphas.size());
+
+    return { getInterceptMatrix().col(step),
+             getCoefView(step),
+             clusters[step],
+             alphas[step],
+             deviances[step],
+             primals[step],
+             duals[step],
+             time[step],
+             passes[step],
+             metadata };
+  }
 
-    return fits[step];
+  /**
+   * @brief Returns a view of the coefficients of the entire path
+   *
+   * @return A sparse p x (m * size()) matrix on the normalized scale, in which
+   * the m columns of step `i` start at column `i * m`. The view is only valid
+   * as long as the path is alive and not modified.
+   */
+  Eigen::Map<const PathCoefMatrix> getCoefMatrix() const
+  {
+    return { p,
+             m * static_cast<IndexType>(alphas.size()),
+             static_cast<IndexType>(coef_values.size()),
+             coef_outer.data(),
+             coef_inner.data(),
+             coef_values.data() };
+  }
+
+  /**
+   * @brief Returns a view of the coefficients at one step of the path
+   *
+   * @param step The step of the path
+   * @return A sparse p x m matrix of coefficients on the normalized scale. The
+   * view is only valid as long as the path is alive and not modified.
+   */
+  Eigen::Map<const PathCoefMatrix> getCoefView(const size_t step) const
+  {
+    assert(step < alphas.size());
+
+    const IndexType* outer = coef_outer.data() + step * m;
+
+    return { p,
+             m,
+             outer[m] - outer[0],
+             outer,
+             coef_inner.data(),
+             coef_values.data() };
+  }
+
+  /**
+   * @brief Returns a view of the intercepts of the entire path
+   *
+   * @return An m x size() matrix of intercepts on the normalized scale
+   */
+  Eigen::Map<const Eigen::MatrixXd> getInterceptMatrix() const
+  {
+    return { intercepts.data(), m, static_cast<int>(alphas.size()) };
   }
 
   /**
@@ -75,13 +205,22 @@ public:
   std::vector<Eigen::VectorXd> getIntercepts(
     const bool original_scale = true) const
   {
-    std::vector<Eigen::VectorXd> intercepts;
-
-    for (const auto& fit : fits) {
-      intercepts.emplace_back(fit.getIntercepts(original_scale));
+    std::vector<Eigen::VectorXd> out;
+
+    for (size_t i = 0; i < size(); i++) {
+      if (original_scale) {
+        auto [beta0, beta] = rescaleCoefficients(getInterceptMatrix().col(i),
+                                                 getCoefView(i),
+                                                 metadata->x_centers,
+                                                 metadata->x_scales,
+                                                 metadata->has_intercept);
+        out.emplace_back(beta0);
+      } else {
+        out.emplace_back(getInterceptMatrix().col(i));
+      }
     }
 
-    return intercepts;
+    return out;
   }
 
   /**
@@ -93,17 +232,28 @@ public:
    *
    * Each element in the returned vector is a sparse matrix containing the model
    * coefficients for a particular solution in the regularization path.
+   *
+   * @see getCoefMatrix() for a view that does not copy the coefficients
    */
   std::vector<Eigen::SparseMatrix<double>> getCoefs(
     const bool original_scale = true) const
   {
-    std::vector<Eigen::SparseMatrix<double>> coefs;
-
-    for (const auto& fit : fits) {
-      coefs.emplace_back(fit.getCoefs(original_scale));
+    std::vector<Eigen::SparseMatrix<double>> out;
+
+    for (size_t i = 0; i < size(); i++) {
+      if (original_scale) {
+        auto [beta0, beta] = rescaleCoefficients(getInterceptMatrix().col(i),
+                                                 getCoefView(i),
+                                                 metadata->x_centers,
+                                                 metadata->x_scales,
+                                                 metadata->has_intercept);
+        out.emplace_back(beta.sparseView());
+      } else {
+        out.emplace_back(getCoefView(i));
+      }
     }
 
-    return coefs;
+    return out;
   }
 
   /**
@@ -111,111 +261,61 @@ public:
    *
    * @return Vector of clusters
    */
-  std::vector<Clusters> getClusters() const
-  {
-    std::vector<Clusters> clusters;
-
-    for (const auto& fit : fits) {
-      clusters.emplace_back(fit.getClusters());
-    }
-
-    return clusters;
-  }
+  const std::vector<Clusters>& getClusters() const { return clusters; }
 
   /**
    * @brief Gets the alpha parameter sequence
    */
   Eigen::ArrayXd getAlpha() const
   {
-
-    Eigen::ArrayXd alphas(fits.size());
-
-    for (size_t i = 0; i < fits.size(); i++) {
-      alphas(i) = fits[i].getAlpha();
-    }
-
-    return alphas;
+    return Eigen::Map<const Eigen::ArrayXd>(alphas.data(), alphas.size());
   }
 
   /**
    * @brief Gets the lambda (regularization) weights
    */
-  const Eigen::ArrayXd& getLambda() const { return fits.front().getLambda(); }
+  const Eigen::ArrayXd& getLambda() const { return metadata->lambda; }
 
   /**
    * @brief Gets the deviance values for each solution
    */
-  std::vector<double> getDeviance() const
-  {
-    std::vector<double> deviances;
-
-    for (const auto& fit : fits) {
-      deviances.emplace_back(fit.getDeviance());
-    }
-
-    return deviances;
-  }
+  const std::vector<double>& getDeviance() const { return deviances; }
 
   /**
    * @brief Gets the null model deviance
    */
-  double getNullDeviance() const { return fits.front().getNullDeviance(); }
+  double getNullDeviance() const { return metadata->null_deviance; }
 
   /**
-   * @brief Gets the primal objective values during optimization
+   * @brief Gets the metadata shared by all the fits of the path
    */
-  std::vector<std::vector<double>> getPrimals() const
+  const std::shared_ptr<const PathMetadata>& getMetadata() const
   {
-    std::vector<std::vector<double>> primals;
-
-    for (const auto& fit : fits) {
-      primals.emplace_back(fit.getPrimals());
-    }
+    return metadata;
+  }
 
+  /**
+   * @brief Gets the primal objective values during optimization
+   */
+  const std::vector<std::vector<double>>& getPrimals() const
+  {
     return primals;
   }
 
   /**
    * @brief Gets the dual objective values during optimization
    */
-  std::vector<std::vector<double>> getDuals() const
-  {
-    std::vector<std::vector<double>> duals;
-
-    for (const auto& fit : fits) {
-      duals.emplace_back(fit.getDuals());
-    }
-
-    return duals;
-  }
+  const std::vector<std::vector<double>>& getDuals() const { return duals; }
 
   /**
    * @brief Gets the computation times for each solution
    */
-  std::vector<std::vector<double>> getTime() const
-  {
-    std::vector<std::vector<double>> time;
-
-    for (const auto& fit : fits) {
-      time.emplace_back(fit.getTime());
-    }
-
-    return time;
-  }
+  const std::vector<std::vector<double>>& getTime() const { return time; }
 
   /**
    * @brief Gets the number of iterations for each solution
    */
-  std::vector<int> getPasses() const
-  {
-    std::vector<int> passes;
-
-    for (const auto& fit : fits) {
-      passes.emplace_back(fit.getPasses());
-    }
-
-    return passes;
-  }
+  const std::vector<int>& getPasses() const { return passes; }
 
   /**
    * @brief Computes the deviance ratio (explained deviance) for each solution
@@ -226,8 +326,8 @@ public:
   {
     std::vector<double> ratios;
 
-    for (const auto& fit : fits) {
-      ratios.emplace_back(fit.getDevianceRatio());
+    for (const auto& dev : deviances) {
+      ratios.emplace_back(1.0 - dev / metadata->null_deviance);
     }
 
     return ratios;
@@ -242,18 +342,113 @@ public:
   {
     std::vector<std::vector<double>> gaps;
 
-    for (const auto& fit : fits) {
-      gaps.emplace_back(fit.getGaps());
+    for (size_t i = 0; i < primals.size(); i++) {
+      std::vector<double> gaps_i(primals[i].size());
+      for (size_t j = 0; j < primals[i].size(); j++) {
+        gaps_i[j] = primals[i][j] - duals[i][j];
+      }
+      gaps.emplace_back(std::move(gaps_i));
     }
 
     return gaps;
   }
 
+  /**
+   * @brief Predicts the response for all the steps of the path at once
+   *
+   * Equivalent to calling SlopeFit::predict() for each step, but the
+   * coefficients of the entire path are rescaled in a single pass and
+   * multiplied with x in one sparse product, so that only the columns of x
+   * that are active somewhere along the path are touched, and only once for
+   * every step that they are active in. Since the active sets of neighboring
+   * steps overlap almost entirely, this is much cheaper than rebuilding the
+   * (dense) coefficients and predicting one step at a time.
+   *
+   * @tparam T Type of input matrix (dense or sparse)
+   * @param x Input matrix of features
+   * @param type Type of prediction to return ("response" or "linear")
+   * @return A matrix with the predictions of all steps side by side. The
+   * linear predictors are an n x (m * size()) matrix, in which the m columns
+   * of step `i` start at column `i * m`, as in getCoefMatrix(). Responses are
+   * laid out in the same way, with as many columns per step as
+   * SlopeFit::predict() returns (one for the class labels of multinomial
+   * models).
+   */
+  template<typename T>
+  Eigen::MatrixXd predict(Eigen::EigenBase<T>& x,
+                          const std::string& type = "response") const
+  {
+    validateOption(type, { "response", "linear" }, "type");
+
+    const int n_cols = m * static_cast<int>(alphas.size());
+
+    if (n_cols == 0) {
+      return Eigen::MatrixXd(x.rows(), 0);
+    }
+
+    // Rescale the coefficients and intercepts of all steps to the original
+    // scale, as in rescaleCoefficients()
+    const Eigen::VectorXd& x_centers = metadata->x_centers;
+    const Eigen::VectorXd& x_scales = metadata->x_scales;
+    const bool centering = x_centers.size() > 0 && metadata->has_intercept;
+    const bool scaling = x_scales.size() > 0;
+
+    std::vector<double> values = coef_values;
+    Eigen::RowVectorXd beta0 = getInterceptMatrix().reshaped().transpose();
+
+    for (int k = 0; k < n_cols; ++k) {
+      for (IndexType ind = coef_outer[k]; ind < coef_outer[k + 1]; ++ind) {
+        const int j = coef_inner[ind];
+
+        if (scaling) {
+          values[ind] /= x_scales(j);
+        }
+        if (centering) {
+          beta0(k) -= x_centers(j) * values[ind];
+        }
+      }
+    }
+
+    Eigen::Map<const PathCoefMatrix> beta(p,
+                                          n_cols,
+                                          values.size(),
+                                          coef_outer.data(),
+                                          coef_inner.data(),
+                                          values.data());
+
+    Eigen::MatrixXd eta = x.derived() * beta;
+
+    if (metadata->has_intercept) {
+      eta.rowwise() += beta0;
+    }
+
+    if (type == "linear") {
+      return eta;
+    }
+
+    std::unique_ptr<Loss> loss = setupLoss(metadata->loss_type);
+
+    const int n_steps = alphas.size();
+    Eigen::MatrixXd out;
+
+    for (int i = 0; i < n_steps; ++i) {
+      Eigen::MatrixXd pred = loss->predict(eta.middleCols(i * m, m));
+
+      if (i == 0) {
+        out.resize(eta.rows(), pred.cols() * n_steps);
+      }
+
+      out.middleCols(i * pred.cols(), pred.cols()) = pred;
+    }
+
+    return out;
+  }
+
   /**
    * @brief Gets the number of solutions in the path
    * @return Size of the path (number of SlopeFit objects)
    */
-  std::size_t size() const { return fits.size(); }
+  std::size_t size() const { return alphas.size(); }
 };
 
 } // namespace slope
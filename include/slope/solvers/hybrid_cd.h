@@ -42,7 +42,7 @@ namespace slope {
 template<typename T>
 std::pair<double, double>
 computeGradientAndHessian(const T& x,
-                          const int ind,
+                          const IndexType ind,
                           const Eigen::MatrixXd& w,
                           const Eigen::MatrixXd& residual,
                           const Eigen::VectorXd& x_centers,
@@ -56,7 +56,7 @@ computeGradientAndHessian(const T& x,
 
   int p = x.cols();
 
-  auto [k, j] = std::div(ind, p);
+  auto [k, j] = splitIndex(ind, p);
 
   // TODO: Avoid these copies
   Eigen::VectorXd residual_v = residual.col(k);
@@ -126,7 +126,7 @@ computeGradientAndHessian(const T& x,
 template<typename T>
 std::pair<double, double>
 computeClusterGradientAndHessian(const Eigen::MatrixBase<T>& x,
-                                 const int c_ind,
+                                 const IndexType c_ind,
                                  const std::vector<int>& s,
                                  const Clusters& clusters,
                                  const Eigen::MatrixXd& w,
@@ -145,8 +145,8 @@ computeClusterGradientAndHessian(const Eigen::MatrixBase<T>& x,
   auto c_it = clusters.cbegin(c_ind);
 
   for (; c_it != clusters.cend(c_ind); ++c_it, ++s_it) {
-    int ind = *c_it;
-    auto [k, j] = std::div(ind, p);
+    IndexType ind = *c_it;
+    auto [k, j] = splitIndex(ind, p);
     double s = *s_it;
 
     switch (jit_normalization) {
@@ -206,7 +206,7 @@ computeClusterGradientAndHessian(const Eigen::MatrixBase<T>& x,
 template<typename T>
 std::pair<double, double>
 computeClusterGradientAndHessian(const Eigen::SparseMatrixBase<T>& x,
-                                 const int c_ind,
+                                 const IndexType c_ind,
                                  const std::vector<int>& s,
                                  const Clusters& clusters,
                                  const Eigen::MatrixXd& w,
@@ -228,8 +228,8 @@ computeClusterGradientAndHessian(const Eigen::SparseMatrixBase<T>& x,
   auto c_it = clusters.cbegin(c_ind);
 
   for (; c_it != clusters.cend(c_ind); ++c_it, ++s_it) {
-    int ind = *c_it;
-    auto [k, j] = std::div(ind, p);
+    IndexType ind = *c_it;
+    auto [k, j] = splitIndex(ind, p);
     double s_ind = *s_it;
 
     switch (jit_normalization) {
@@ -354,9 +354,9 @@ coordinateDescent(Eigen::VectorXd& beta0,
   double max_abs_gradient = 0;
 
   // Create a vector of indices to process
-  std::vector<int> indices;
+  std::vector<IndexType> indices;
   indices.reserve(clusters.size());
-  for (int i = 0; i < clusters.size(); ++i) {
+  for (IndexType i = 0; i < clusters.size(); ++i) {
     if (clusters.coeff(i) != 0) { // Skip zero cluster
       indices.push_back(i);
     }
@@ -366,7 +366,7 @@ coordinateDescent(Eigen::VectorXd& beta0,
     std::shuffle(indices.begin(), indices.end(), rng);
   }
 
-  for (int c_ind : indices) {
+  for (IndexType c_ind : indices) {
     // Skip if index is no longer valid due to cluster updates
     if (c_ind >= clusters.size()) {
       continue;
@@ -380,13 +380,13 @@ coordinateDescent(Eigen::VectorXd& beta0,
       continue;
     }
 
-    int cluster_size = clusters.cluster_size(c_ind);
+    IndexType cluster_size = clusters.cluster_size(c_ind);
     std::vector<int> s;
     s.reserve(cluster_size);
 
     for (auto c_it = clusters.cbegin(c_ind); c_it != clusters.cend(c_ind);
          ++c_it) {
-      int ind = *c_it;
+      IndexType ind = *c_it;
       assert(ind >= 0 && ind < beta.size() && "Invalid index in cluster");
       double s_ind = sign(beta(ind));
       s.emplace_back(s_ind);
@@ -397,7 +397,7 @@ coordinateDescent(Eigen::VectorXd& beta0,
     VectorXd x_s(n);
 
     if (cluster_size == 1) {
-      int ind = *clusters.cbegin(c_ind);
+      IndexType ind = *clusters.cbegin(c_ind);
       std::tie(grad, hess) = computeGradientAndHessian(
         x, ind, w, residual, x_centers, x_scales, s[0], jit_normalization, n);
     } else {
@@ -416,7 +416,7 @@ coordinateDescent(Eigen::VectorXd& beta0,
     max_abs_gradient = std::max(max_abs_gradient, std::abs(grad));
 
     double c_tilde;
-    int new_index;
+    IndexType new_index;
 
     std::tie(c_tilde, new_index) = slopeThreshold(
       c_old - grad / hess, c_ind, lambda_cumsum / hess, clusters);
@@ -430,8 +430,8 @@ coordinateDescent(Eigen::VectorXd& beta0,
       auto s_it = s.cbegin();
       auto c_it = clusters.cbegin(c_ind);
       for (; c_it != clusters.cend(c_ind); ++c_it, ++s_it) {
-        int ind = *c_it;
-        auto [k, j] = std::div(ind, p);
+        IndexType ind = *c_it;
+        auto [k, j] = splitIndex(ind, p);
         double s_ind = *s_it;
 
         // Update coefficient
@@ -45,61 +45,20 @@ public:
   {
   }
 
-  /// @copydoc SolverBase::run
-  void run(Eigen::VectorXd& beta0,
-           Eigen::VectorXd& beta,
-           Eigen::MatrixXd& eta,
-           const Eigen::ArrayXd& lambda,
-           const std::unique_ptr<Loss>& loss,
-           const SortedL1Norm& penalty,
-           const Eigen::VectorXd& gradient,
-           const std::vector<int>& working_set,
-           const Eigen::MatrixXd& x,
-           const Eigen::VectorXd& x_centers,
-           const Eigen::VectorXd& x_scales,
-           const Eigen::MatrixXd& y) override;
-
-  /// @copydoc SolverBase::run
-  void run(Eigen::VectorXd& beta0,
-           Eigen::VectorXd& beta,
-           Eigen::MatrixXd& eta,
-           const Eigen::ArrayXd& lambda,
-           const std::unique_ptr<Loss>& loss,
-           const SortedL1Norm& penalty,
-           const Eigen::VectorXd& gradient,
-           const std::vector<int>& working_set,
-           const Eigen::SparseMatrix<double>& x,
-           const Eigen::VectorXd& x_centers,
-           const Eigen::VectorXd& x_scales,
-           const Eigen::MatrixXd& y) override;
-
-  /// @copydoc SolverBase::run
-  void run(Eigen::VectorXd& beta0,
-           Eigen::VectorXd& beta,
-           Eigen::MatrixXd& eta,
-           const Eigen::ArrayXd& lambda,
-           const std::unique_ptr<Loss>& loss,
-           const SortedL1Norm& penalty,
-           const Eigen::VectorXd& gradient,
-           const std::vector<int>& working_set,
-           const Eigen::Map<Eigen::MatrixXd>& x,
-           const Eigen::VectorXd& x_centers,
-           const Eigen::VectorXd& x_scales,
-           const Eigen::MatrixXd& y) override;
-
-  /// @copydoc SolverBase::run
-  void run(Eigen::VectorXd& beta0,
-           Eigen::VectorXd& beta,
-           Eigen::MatrixXd& eta,
-           const Eigen::ArrayXd& lambda,
-           const std::unique_ptr<Loss>& loss,
-           const SortedL1Norm& penalty,
-           const Eigen::VectorXd& gradient,
-           const std::vector<int>& working_set,
-           const Eigen::Map<Eigen::SparseMatrix<double>>& x,
-           const Eigen::VectorXd& x_centers,
-           const Eigen::VectorXd& x_scales,
-           const Eigen::MatrixXd& y) override;
+protected:
+  /// @copydoc SolverBase::solve
+  void solve(Eigen::VectorXd& beta0,
+             Eigen::VectorXd& beta,
+             Eigen::MatrixXd& eta,
+             const Eigen::ArrayXd& lambda,
+             const std::unique_ptr<Loss>& loss,
+             const SortedL1Norm& penalty,
+             const Eigen::VectorXd& gradient,
+             const std::vector<IndexType>& working_set,
+             const DesignRef& x,
+             const Eigen::VectorXd& x_centers,
+             const Eigen::VectorXd& x_scales,
+             const Eigen::MatrixXd& y) override;
 
 private:
   template<typename MatrixType>
@@ -110,7 +69,7 @@ private:
                const std::unique_ptr<Loss>& loss,
                const SortedL1Norm& penalty,
                const Eigen::VectorXd& gradient,
-               const std::vector<int>& working_set,
+               const std::vector<IndexType>& working_set,
                const MatrixType& x,
                const Eigen::VectorXd& x_centers,
                const Eigen::VectorXd& x_scales,
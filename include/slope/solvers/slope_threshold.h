@@ -24,9 +24,9 @@ namespace slope {
  * @param clusters The clusters object.
  * @return A tuple containing the slope threshold and the index.
  */
-std::tuple<double, int>
+std::tuple<double, IndexType>
 slopeThreshold(const double x,
-               const int j,
+               const IndexType j,
                const Eigen::ArrayXd& lambda_cumsum,
                const Clusters& clusters);
 
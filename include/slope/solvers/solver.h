@@ -5,11 +5,11 @@
 
 #pragma once
 
+#include "../design_ref.h"
 #include "../jit_normalization.h"
 #include "../losses/loss.h"
 #include "../sorted_l1_norm.h"
 #include <Eigen/Core>
-#include <Eigen/SparseCore>
 #include <memory>
 
 namespace slope {
@@ -46,7 +46,12 @@ public:
   virtual ~SolverBase() = default;
 
   /**
-   * @brief Pure virtual function defining the solver's optimization routine
+   * @brief Runs the solver
+   *
+   * If `x` is a ColumnBlockMatrix, the columns of the working set are pinned
+   * in memory (see ColumnBlockMatrix::pin()), and the solver runs on them as
+   * a dense matrix, with the coefficients, gradient, centers, and scales
+   * restricted to them. Other matrices are passed on to solve() as they are.
    *
    * @param beta0 Intercept terms for each response
    * @param beta Coefficients (size p x m)
@@ -61,109 +66,63 @@ public:
    * @param x_scales Vector of feature scales for normalization
    * @param y Response matrix (n samples x m responses)
    */
-  virtual void run(Eigen::VectorXd& beta0,
-                   Eigen::VectorXd& beta,
-                   Eigen::MatrixXd& eta,
-                   const Eigen::ArrayXd& lambda,
-                   const std::unique_ptr<Loss>& loss,
-                   const SortedL1Norm& penalty,
-                   const Eigen::VectorXd& gradient,
-                   const std::vector<int>& working_set,
-                   const Eigen::MatrixXd& x,
-                   const Eigen::VectorXd& x_centers,
-                   const Eigen::VectorXd& x_scales,
-                   const Eigen::MatrixXd& y) = 0;
+  void run(Eigen::VectorXd& beta0,
+           Eigen::VectorXd& beta,
+           Eigen::MatrixXd& eta,
+           const Eigen::ArrayXd& lambda,
+           const std::unique_ptr<Loss>& loss,
+           const SortedL1Norm& penalty,
+           const Eigen::VectorXd& gradient,
+           const std::vector<IndexType>& working_set,
+           const DesignRef& x,
+           const Eigen::VectorXd& x_centers,
+           const Eigen::VectorXd& x_scales,
+           const Eigen::MatrixXd& y);
 
+protected:
   /**
    * @brief Pure virtual function defining the solver's optimization routine
    *
-   * @param beta0 Intercept terms for each response
-   * @param beta Coefficient vecttor (size p x m)
-   * @param eta Linear predictor matrix (n samples x m responses)
-   * @param lambda Vector of regularization parameters
-   * @param loss Pointer to loss function object
-   * @param penalty Sorted L1 norm object for proximal operations
-   * @param gradient Gradient matrix for loss function
-   * @param working_set Vector of indices for active predictors
-   * @param x Input feature matrix (n samples x p predictors)
-   * @param x_centers Vector of feature means for centering
-   * @param x_scales Vector of feature scales for normalization
-   * @param y Response matrix (n samples x m responses)
-   */
-  virtual void run(Eigen::VectorXd& beta0,
-                   Eigen::VectorXd& beta,
-                   Eigen::MatrixXd& eta,
-                   const Eigen::ArrayXd& lambda,
-                   const std::unique_ptr<Loss>& loss,
-                   const SortedL1Norm& penalty,
-                   const Eigen::VectorXd& gradient,
-                   const std::vector<int>& working_set,
-                   const Eigen::SparseMatrix<double>& x,
-                   const Eigen::VectorXd& x_centers,
-                   const Eigen::VectorXd& x_scales,
-                   const Eigen::MatrixXd& y) = 0;
-
-  /**
-   * @brief Pure virtual function defining the solver's optimization routine
+   * Implementations reach the concrete type of `x` through
+   * DesignRef::visitInMemory(). It is never a ColumnBlockMatrix.
    *
-   * @param beta0 Intercept terms for each response
-   * @param beta Coefficient vecttor (size p x m)
-   * @param eta Linear predictor matrix (n samples x m responses)
-   * @param lambda Vector of regularization parameters
-   * @param loss Pointer to loss function object
-   * @param penalty Sorted L1 norm object for proximal operations
-   * @param gradient Gradient matrix for loss function
-   * @param working_set Vector of indices for active predictors
-   * @param x Input feature matrix (n samples x p predictors)
-   * @param x_centers Vector of feature means for centering
-   * @param x_scales Vector of feature scales for normalization
-   * @param y Response matrix (n samples x m responses)
+   * @see run() for the description of the parameters
    */
-  virtual void run(Eigen::VectorXd& beta0,
-                   Eigen::VectorXd& beta,
-                   Eigen::MatrixXd& eta,
-                   const Eigen::ArrayXd& lambda,
-                   const std::unique_ptr<Loss>& loss,
-                   const SortedL1Norm& penalty,
-                   const Eigen::VectorXd& gradient,
-                   const std::vector<int>& working_set,
-                   const Eigen::Map<Eigen::MatrixXd>& x,
-                   const Eigen::VectorXd& x_centers,
-                   const Eigen::VectorXd& x_scales,
-                   const Eigen::MatrixXd& y) = 0;
+  virtual void solve(Eigen::VectorXd& beta0,
+                     Eigen::VectorXd& beta,
+                     Eigen::MatrixXd& eta,
+                     const Eigen::ArrayXd& lambda,
+                     const std::unique_ptr<Loss>& loss,
+                     const SortedL1Norm& penalty,
+                     const Eigen::VectorXd& gradient,
+                     const std::vector<IndexType>& working_set,
+                     const DesignRef& x,
+                     const Eigen::VectorXd& x_centers,
+                     const Eigen::VectorXd& x_scales,
+                     const Eigen::MatrixXd& y) = 0;
+
+  JitNormalization jit_normalization; ///< JIT feature normalization strategy
+  bool intercept;                     ///< If true, fits intercept term
 
+private:
   /**
-   * @brief Pure virtual function defining the solver's optimization routine
+   * @brief Pins the columns of the working set in memory and runs solve()
+   * on them
    *
-   * @param beta0 Intercept terms for each response
-   * @param beta Coefficient vecttor (size p x m)
-   * @param eta Linear predictor matrix (n samples x m responses)
-   * @param lambda Vector of regularization parameters
-   * @param loss Pointer to loss function object
-   * @param penalty Sorted L1 norm object for proximal operations
-   * @param gradient Gradient matrix for loss function
-   * @param working_set Vector of indices for active predictors
-   * @param x Input feature matrix (n samples x p predictors)
-   * @param x_centers Vector of feature means for centering
-   * @param x_scales Vector of feature scales for normalization
-   * @param y Response matrix (n samples x m responses)
+   * @see run() for the description of the parameters
    */
-  virtual void run(Eigen::VectorXd& beta0,
-                   Eigen::VectorXd& beta,
-                   Eigen::MatrixXd& eta,
-                   const Eigen::ArrayXd& lambda,
-                   const std::unique_ptr<Loss>& loss,
-                   const SortedL1Norm& penalty,
-                   const Eigen::VectorXd& gradient,
-                   const std::vector<int>& working_set,
-                   const Eigen::Map<Eigen::SparseMatrix<double>>& x,
-                   const Eigen::VectorXd& x_centers,
-                   const Eigen::VectorXd& x_scales,
-                   const Eigen::MatrixXd& y) = 0;
-
-protected:
-  JitNormalization jit_normalization; ///< JIT feature normalization strategy
-  bool intercept;                     ///< If true, fits intercept term
+  void runPinned(Eigen::VectorXd& beta0,
+                 Eigen::VectorXd& beta,
+                 Eigen::MatrixXd& eta,
+                 const Eigen::ArrayXd& lambda,
+                 const std::unique_ptr<Loss>& loss,
+                 const SortedL1Norm& penalty,
+                 const Eigen::VectorXd& gradient,
+                 const std::vector<IndexType>& working_set,
+                 const ColumnBlockMatrix& x,
+                 const Eigen::VectorXd& x_centers,
+                 const Eigen::VectorXd& x_scales,
+                 const Eigen::MatrixXd& y);
 };
 
 } // namespace slope
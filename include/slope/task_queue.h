@@ -0,0 +1,124 @@
+/**
+ * @file
+ * @brief Shared queue for running independent tasks of uneven cost in
+ * parallel
+ */
+
+#pragma once
+
+#include "threads.h"
+#include <atomic>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace slope {
+
+/**
+ * @brief Restores the global Eigen and OpenMP thread settings on scope exit
+ *
+ * Sets Eigen to run single-threaded, since the tasks are what is run in
+ * parallel, and allows one level of nested OpenMP parallelism, so that
+ * threads that have run out of tasks can help with the remaining ones. The
+ * previous settings are restored when the guard goes out of scope, also if an
+ * exception is thrown.
+ */
+class ThreadSettingsGuard
+{
+public:
+  ThreadSettingsGuard();
+  ~ThreadSettingsGuard();
+
+  ThreadSettingsGuard(const ThreadSettingsGuard&) = delete;
+  ThreadSettingsGuard& operator=(const ThreadSettingsGuard&) = delete;
+
+private:
+  int eigen_threads;
+  int max_active_levels;
+};
+
+/**
+ * @brief Runs independent tasks from a single shared queue
+ *
+ * Each thread takes the next task from the queue as soon as it is done with
+ * its previous one, so that a few expensive tasks do not hold up threads that
+ * are done with cheap ones. Ordering the tasks longest first (see
+ * longestFirst()) keeps the expensive tasks from being started last.
+ *
+ * Threads that find the queue empty do not leave the work to the threads
+ * that are still busy: a running task can call shareIdleThreads() to let the
+ * parallel regions it starts use an even share of the idle threads, which
+ * never oversubscribes the threads given to the queue.
+ */
+class TaskQueue
+{
+public:
+  /**
+   * @brief Constructs a queue
+   *
+   * @param n_threads Number of threads to run the tasks on
+   */
+  explicit TaskQueue(const int n_threads);
+
+  /**
+   * @brief Runs all tasks
+   *
+   * @tparam F Type of the task function
+   * @param order Indices of the tasks, in the order they should be started
+   * @param task Function that runs the task with the given index. It is
+   *   called concurrently from several threads and must not throw.
+   */
+  template<typename F>
+  void run(const std::vector<int>& order, F&& task)
+  {
+    const int n_tasks = order.size();
+
+    next = 0;
+    n_running = 0;
+    n_idle = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(n_threads)
+#endif
+    {
+      for (int i = next++; i < n_tasks; i = next++) {
+        n_running++;
+        task(order[i]);
+        n_running--;
+
+        Threads::setLocal(0);
+      }
+
+      n_idle++;
+    }
+  }
+
+  /**
+   * @brief Lets the calling task use its share of the idle threads
+   *
+   * Sets the number of threads (see Threads::setLocal()) of the calling
+   * thread to one plus an even share of the threads that have run out of
+   * tasks. Since threads only go idle over time, long tasks should call this
+   * repeatedly, for instance after each step of a path.
+   */
+  void shareIdleThreads() const;
+
+  /**
+   * @brief Orders tasks by decreasing cost
+   *
+   * @param costs Estimated cost of each task
+   * @return Indices of the tasks, most expensive first. Tasks of equal cost
+   *   keep their order.
+   */
+  static std::vector<int> longestFirst(const std::vector<double>& costs);
+
+private:
+  int n_threads;
+  std::atomic<int> next{ 0 };
+  std::atomic<int> n_running{ 0 };
+  std::atomic<int> n_idle{ 0 };
+};
+
+} // namespace slope
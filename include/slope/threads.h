@@ -53,11 +53,33 @@ public:
   /**
    * @brief Get the current number of threads
    *
-   * @return Current thread count
+   * @return Current thread count, which is the one set with setLocal() if
+   *   the calling thread has set one, and the one set with set() otherwise
    */
-  static int get() { return num_threads; }
+  static int get() { return local_threads > 0 ? local_threads : num_threads; }
+
+  /**
+   * @brief Set the number of threads to use for parallel computations
+   * started from the calling thread only
+   *
+   * This is used to let a thread that runs one of several concurrent tasks
+   * use a share of the threads that are not busy with other tasks.
+   *
+   * @param n Number of threads, or 0 to go back to the global setting
+   */
+  static void setLocal(const int n)
+  {
+    if (n < 0) {
+      throw std::invalid_argument("Number of threads must be non-negative");
+    }
+
+    local_threads = n;
+  }
 
 private:
+  /// Thread-local override of the number of threads, unused if zero
+  inline static thread_local int local_threads = 0;
+
 #ifdef _OPENMP
   /// Number of threads to use. Defaults to half of max threads (physical cores)
   inline static int num_threads = std::max(1, omp_get_max_threads() / 2);
@@ -0,0 +1,141 @@
+/**
+ * @file
+ * @brief SLOPE for ultrahigh-dimensional designs, with sparse coefficient
+ * and gradient storage
+ *
+ * Slope::path() stores the coefficients, the gradient, the lambda sequence,
+ * and the full set of indices as dense vectors with one element per
+ * coefficient, and sorts the gradient at each step. With hundreds of
+ * millions of features, of which only a few thousand ever enter the model,
+ * this dominates both the memory use and the run time. The functions here
+ * instead fit the path to the features that may enter the model, and find
+ * those by computing the full gradient one block of columns at a time and
+ * keeping only its largest values.
+ */
+
+#pragma once
+
+#include "slope.h"
+#include "slope_path.h"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <string>
+#include <vector>
+
+namespace slope {
+
+/**
+ * @brief A regularization path of a model that was fit to a subset of the
+ * features
+ */
+class UltrahighPath
+{
+public:
+  /**
+   * @brief Creates the path
+   *
+   * @param path_in The path that was fit to the selected features
+   * @param n_features_in Number of features of the full design
+   * @param columns_in The selected features, in increasing order
+   */
+  UltrahighPath(SlopePath path_in,
+                const int n_features_in,
+                std::vector<int> columns_in);
+
+  /// Number of fits along the path
+  size_t size() const { return path.size(); }
+
+  /// The path, as fit to the columns of the full design in getColumns()
+  const SlopePath& getPath() const { return path; }
+
+  /// The features that were selected during fitting, in increasing order,
+  /// which are the columns of the design of getPath()
+  const std::vector<int>& getColumns() const { return columns; }
+
+  /**
+   * @brief The coefficients of a fit, indexed by the features of the full
+   * design
+   *
+   * @param step The step along the path
+   * @return A p x m sparse matrix, with nonzero rows only for the selected
+   *   features
+   */
+  Eigen::SparseMatrix<double> getCoefs(const size_t step) const;
+
+  /**
+   * @brief Predicts the response from a dense full design
+   *
+   * @param x The design, with all of the features
+   * @param step The step along the path
+   * @param type Type of prediction, "response" or "linear"
+   */
+  Eigen::MatrixXd predict(const Eigen::MatrixXd& x,
+                          const size_t step,
+                          const std::string& type = "response") const;
+
+  /**
+   * @brief Predicts the response from a sparse full design
+   *
+   * @see predict() for dense designs
+   */
+  Eigen::MatrixXd predict(const Eigen::SparseMatrix<double>& x,
+                          const size_t step,
+                          const std::string& type = "response") const;
+
+private:
+  SlopePath path;
+  int n_features;
+  std::vector<int> columns;
+};
+
+/**
+ * @brief Fits a SLOPE path to an ultrahigh-dimensional design
+ *
+ * The model is fit to the columns of `x` that have been selected so far,
+ * with the first values of the lambda sequence of the full problem, which
+ * are generated by lambdaSequenceHead() without forming the rest. After each
+ * fit, the gradient of the full problem is computed in blocks of columns,
+ * each normalized on its own, and reduced on the fly to the gradients of the
+ * selected columns and the `n_candidates` largest of the others. The KKT
+ * conditions of the full problem are checked against these, step by step,
+ * and at the first step with violations the path is refit with the columns
+ * that violate them, until there are no violations. Steps that have passed
+ * the check are not checked again. The largest alpha of the path is that of
+ * the full problem, found the same way.
+ *
+ * Gradients below the smallest lambda value times alpha can never be part of
+ * a violation. Whenever the smallest of the candidates does not fall below
+ * it, the number of candidates is doubled and the gradient recomputed, so
+ * the fit is that of Slope::path() on all of `x`, with memory that scales
+ * with the number of selected columns and candidates rather than with the
+ * number of features.
+ *
+ * @param model The model, which sets the loss, lambda sequence,
+ *   normalization, and the other options of the path
+ * @param x The design
+ * @param y_in The response
+ * @param n_candidates The number of gradients outside of the selected
+ *   columns to keep at first
+ * @return The path, with coefficients indexed by the columns of `x`
+ * @throws std::invalid_argument If the model uses manual centering or
+ *   scaling, if `n_candidates` is not positive, or if the problem has more
+ *   coefficients than slope::IndexType can index
+ */
+UltrahighPath
+ultrahighPath(Slope model,
+              const Eigen::MatrixXd& x,
+              const Eigen::MatrixXd& y_in,
+              const int n_candidates = 1000);
+
+/**
+ * @brief Fits a SLOPE path to a sparse ultrahigh-dimensional design
+ *
+ * @see ultrahighPath() for dense designs
+ */
+UltrahighPath
+ultrahighPath(Slope model,
+              const Eigen::SparseMatrix<double>& x,
+              const Eigen::MatrixXd& y_in,
+              const int n_candidates = 1000);
+
+} // namespace slope
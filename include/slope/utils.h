@@ -6,6 +6,7 @@
 #pragma once
 
 #include "eigen_compat.h"
+#include "index_type.h"
 #include <Eigen/Core>
 #include <Eigen/SparseCore>
 #include <algorithm>
@@ -13,6 +14,7 @@
 #include <numeric>
 #include <set>
 #include <string>
+#include <type_traits>
 #include <unordered_set>
 #include <vector>
 
@@ -84,18 +86,19 @@ sort(T& v, const bool descending = false)
  * @tparam T Container type supporting size() and operator[] (e.g.,
  * std::vector<bool>, std::array<bool>)
  * @param x Input container with boolean-convertible values
- * @return std::vector<int> containing indices where x[i] evaluates to true
+ * @return std::vector<IndexType> containing indices where x[i] evaluates to
+ * true
  *
  * Example:
  *   std::vector<bool> v = {true, false, true, false, true};
  *   auto indices = which(v); // returns {0, 2, 4}
  */
 template<typename T>
-std::vector<int>
+std::vector<IndexType>
 which(const T& x)
 {
-  std::vector<int> out;
-  for (int i = 0; i < x.size(); i++) {
+  std::vector<IndexType> out;
+  for (IndexType i = 0; i < static_cast<IndexType>(x.size()); i++) {
     if (x[i]) {
       out.emplace_back(i);
     }
@@ -120,18 +123,22 @@ which(const T& x)
  * the input vector.
  */
 template<typename T>
-std::vector<int>
+std::vector<IndexType>
 sortIndex(T& v, const bool descending = false)
 {
   using namespace std;
 
-  vector<int> idx(v.size());
+  vector<IndexType> idx(v.size());
   iota(idx.begin(), idx.end(), 0);
 
   if (descending) {
-    sort(idx.begin(), idx.end(), [&v](int i, int j) { return v[i] > v[j]; });
+    sort(idx.begin(), idx.end(), [&v](IndexType i, IndexType j) {
+      return v[i] > v[j];
+    });
   } else {
-    sort(idx.begin(), idx.end(), [&v](int i, int j) { return v[i] < v[j]; });
+    sort(idx.begin(), idx.end(), [&v](IndexType i, IndexType j) {
+      return v[i] < v[j];
+    });
   }
 
   return idx;
@@ -145,12 +152,13 @@ sortIndex(T& v, const bool descending = false)
  * the container.
  *
  * @tparam T The type of the container.
+ * @tparam I The integer type of the indices.
  * @param values The container of values to be permuted.
  * @param ind The vector of indices specifying the new order of the elements.
  */
-template<typename T>
+template<typename T, typename I>
 void
-permute(T& values, const std::vector<int>& ind)
+permute(T& values, const std::vector<I>& ind)
 {
   /**
    * @brief The container to store the permuted values.
@@ -160,7 +168,7 @@ permute(T& values, const std::vector<int>& ind)
   /**
    * @brief Permute the values according to the given indices.
    */
-  for (int i = 0; i < values.size(); ++i)
+  for (I i = 0; i < static_cast<I>(values.size()); ++i)
     out[i] = std::move(values[ind[i]]);
 
   /**
@@ -179,16 +187,17 @@ permute(T& values, const std::vector<int>& ind)
  * indices.
  *
  * @tparam T The type of the container.
+ * @tparam I The integer type of the indices.
  * @param values The container of values to be permuted.
  * @param ind The vector of indices specifying the new order of the elements.
  */
-template<typename T>
+template<typename T, typename I>
 void
-inversePermute(T& values, const std::vector<int>& ind)
+inversePermute(T& values, const std::vector<I>& ind)
 {
   T out(values.size()); /**< The resulting container after permutation. */
 
-  for (int i = 0; i < values.size(); ++i)
+  for (I i = 0; i < static_cast<I>(values.size()); ++i)
     out[ind[i]] = std::move(values[i]);
 
   values = std::move(out);
@@ -208,7 +217,10 @@ inversePermute(T& values, const std::vector<int>& ind)
  */
 template<typename T>
 void
-move_elements(std::vector<T>& v, const int from, const int to, const int size)
+move_elements(std::vector<T>& v,
+              const IndexType from,
+              const IndexType to,
+              const IndexType size)
 {
   assert(from >= 0);
   assert(to >= 0);
@@ -216,10 +228,10 @@ move_elements(std::vector<T>& v, const int from, const int to, const int size)
   assert(from != to);
 
   if (from > to) {
-    assert(from + size <= static_cast<int>(v.size()));
+    assert(from + size <= static_cast<IndexType>(v.size()));
     std::rotate(v.begin() + to, v.begin() + from, v.begin() + from + size);
   } else {
-    assert(to + size <= static_cast<int>(v.size()));
+    assert(to + size <= static_cast<IndexType>(v.size()));
     std::rotate(
       v.begin() + from, v.begin() + from + size, v.begin() + to + size);
   }
@@ -242,6 +254,17 @@ validateOption(const std::string& value,
                const std::set<std::string>& valid_options,
                const std::string& parameter_name);
 
+/**
+ * @brief Validates observation weights
+ *
+ * @param w The weights
+ * @param n The number of observations
+ * @throws std::invalid_argument If the weights do not have length n, are not
+ *   finite and non-negative, or do not have a positive sum
+ */
+void
+validateWeights(const Eigen::VectorXd& w, const int n);
+
 /**
  * @brief Extract a subset of rows from an Eigen matrix
  *
@@ -298,12 +321,18 @@ subset(const Eigen::SparseMatrixBase<T>& x, const std::vector<int>& indices)
   std::vector<Eigen::Triplet<double>> triplets;
   triplets.reserve(slope::nonZeros(x.derived()));
 
+  // Position of the first occurrence of each row in indices, or -1
+  std::vector<int> new_rows(x.rows(), -1);
+
+  for (int i = indices.size() - 1; i >= 0; --i) {
+    new_rows[indices[i]] = i;
+  }
+
   for (int j = 0; j < x.cols(); ++j) {
     for (typename T::InnerIterator it(x.derived(), j); it; ++it) {
-      auto it_idx = std::find(indices.begin(), indices.end(), it.row());
+      int new_row = new_rows[it.row()];
 
-      if (it_idx != indices.end()) {
-        int new_row = std::distance(indices.begin(), it_idx);
+      if (new_row >= 0) {
         triplets.emplace_back(new_row, j, it.value());
       }
     }
@@ -433,4 +462,55 @@ isFinite(const Eigen::SparseMatrixBase<Derived>& x)
   return true;
 }
 
+/**
+ * @brief Calls `f(i, value)` for each stored entry of column `j` of a sparse
+ * matrix that lies in rows `[row_begin, row_end)`
+ *
+ * For compressed matrices, the first row of the range is found by binary
+ * search, so that entries in earlier rows are never visited.
+ *
+ * @tparam T The type of the sparse matrix
+ * @tparam F Callable with signature `void(int, double)`
+ * @param x The sparse matrix
+ * @param j The column
+ * @param row_begin First row of the range
+ * @param row_end One past the last row of the range
+ * @param f The function to call
+ */
+template<typename T, typename F>
+void
+forEachInRows(const Eigen::SparseMatrixBase<T>& x,
+              const int j,
+              const int row_begin,
+              const int row_end,
+              F&& f)
+{
+  const T& x_derived = x.derived();
+
+  if constexpr (std::is_base_of_v<Eigen::SparseCompressedBase<T>, T>) {
+    if (x_derived.isCompressed()) {
+      const auto* inner = x_derived.innerIndexPtr();
+      const auto* values = x_derived.valuePtr();
+      const auto* start = inner + x_derived.outerIndexPtr()[j];
+      const auto* end = inner + x_derived.outerIndexPtr()[j + 1];
+
+      for (auto* it = std::lower_bound(start, end, row_begin);
+           it != end && *it < row_end;
+           ++it) {
+        f(static_cast<int>(*it), values[it - inner]);
+      }
+      return;
+    }
+  }
+
+  for (typename T::InnerIterator it(x_derived, j); it; ++it) {
+    if (it.row() >= row_end) {
+      break;
+    }
+    if (it.row() >= row_begin) {
+      f(static_cast<int>(it.row()), it.value());
+    }
+  }
+}
+
 } // namespace slope
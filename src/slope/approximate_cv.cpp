@@ -0,0 +1,68 @@
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <slope/approximate_cv.h>
+
+namespace slope {
+namespace detail {
+
+Eigen::MatrixXd
+looCorrections(const Eigen::MatrixXd& x_reduced,
+               const bool intercept,
+               const Eigen::VectorXd& eta,
+               const Eigen::VectorXd& y,
+               const std::unique_ptr<Loss>& loss)
+{
+  const int n = x_reduced.rows();
+  const int k = x_reduced.cols();
+
+  Eigen::MatrixXd out = Eigen::MatrixXd::Zero(n, 2);
+
+  if (k == 0) {
+    // The null model without intercept does not depend on the data
+    return out;
+  }
+
+  Eigen::VectorXd w = loss->hessianDiagonal(eta).reshaped();
+  Eigen::VectorXd g = (loss->inverseLink(eta) - y).reshaped();
+
+  Eigen::MatrixXd hessian =
+    x_reduced.transpose() * w.asDiagonal() * x_reduced;
+
+  Eigen::CompleteOrthogonalDecomposition<Eigen::MatrixXd> decomposition(
+    hessian);
+
+  // At the fit, the mean gradient of the loss cancels the subgradient of the
+  // penalty, which stays fixed when the clusters do. Leaving out an
+  // observation removes its gradient and scales the mean of the others by
+  // n / (n - 1), so that the penalty is no longer balanced.
+  Eigen::VectorXd mean_gradient = x_reduced.transpose() * g / n;
+
+  Eigen::MatrixXd h = decomposition.solve(x_reduced.transpose());
+  Eigen::VectorXd h_mean = decomposition.solve(mean_gradient);
+
+  for (int i = 0; i < n; ++i) {
+    const double a = x_reduced.row(i).dot(h.col(i));
+    const double b = x_reduced.row(i).dot(h_mean);
+
+    // The leverage reaches one when the fit interpolates the observation, in
+    // which case the step is unbounded
+    const double denominator = std::max(
+      1.0 - a * w(i), std::sqrt(std::numeric_limits<double>::epsilon()));
+
+    out(i, 0) = (a * g(i) - b) / denominator;
+
+    if (intercept) {
+      // The step is the Hessian of the remaining observations times
+      // u x_i - X^T g / n, by the Sherman-Morrison formula
+      const double u = g(i) + w(i) * out(i, 0);
+      out(i, 1) = u * h(k - 1, i) - h_mean(k - 1);
+    }
+  }
+
+  return out;
+}
+
+} // namespace detail
+} // namespace slope
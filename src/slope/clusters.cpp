@@ -10,63 +10,63 @@ Clusters::Clusters(const Eigen::VectorXd& beta)
   update(beta);
 }
 
-std::vector<int>::const_iterator
-Clusters::cbegin(const int i) const
+std::vector<IndexType>::const_iterator
+Clusters::cbegin(const IndexType i) const
 {
   assert(i >= 0 && i < size());
   return c_ind.cbegin() + this->pointer(i);
 }
 
-std::vector<int>::const_iterator
-Clusters::cend(const int i) const
+std::vector<IndexType>::const_iterator
+Clusters::cend(const IndexType i) const
 {
   assert(i >= 0 && i < size());
   return c_ind.cbegin() + this->pointer(i + 1);
 }
 
-std::vector<int>::iterator
-Clusters::begin(const int i)
+std::vector<IndexType>::iterator
+Clusters::begin(const IndexType i)
 {
   assert(i >= 0 && i < size());
   return c_ind.begin() + this->pointer(i);
 }
 
-std::vector<int>::iterator
-Clusters::end(const int i)
+std::vector<IndexType>::iterator
+Clusters::end(const IndexType i)
 {
   assert(i >= 0 && i < size());
   return c_ind.begin() + this->pointer(i + 1);
 }
 
-int
-Clusters::cluster_size(const int i) const
+IndexType
+Clusters::cluster_size(const IndexType i) const
 {
   assert(i >= 0 && i < size());
   return this->pointer(i + 1) - this->pointer(i);
 }
 
-int
-Clusters::pointer(const int i) const
+IndexType
+Clusters::pointer(const IndexType i) const
 {
   assert(i >= 0 && i <= size());
   return c_ptr[i];
 }
 
-int
+IndexType
 Clusters::size() const
 {
   return c.size();
 }
 
 double
-Clusters::coeff(const int i) const
+Clusters::coeff(const IndexType i) const
 {
   assert(i >= 0 && i < size());
   return c[i];
 }
 
 void
-Clusters::setCoeff(const int i, const double x)
+Clusters::setCoeff(const IndexType i, const double x)
 {
   assert(i >= 0 && i < size());
   c[i] = x;
@@ -78,20 +78,22 @@ Clusters::coeffs() const
   return c;
 }
 
-const std::vector<int>&
+const std::vector<IndexType>&
 Clusters::indices() const
 {
   return c_ind;
 }
 
-const std::vector<int>&
+const std::vector<IndexType>&
 Clusters::pointers() const
 {
   return c_ptr;
 }
 
 void
-Clusters::update(const int old_index, const int new_index, const double c_new)
+Clusters::update(const IndexType old_index,
+                 const IndexType new_index,
+                 const double c_new)
 {
   assert(old_index < size());
   assert(new_index <= size());
@@ -133,7 +135,7 @@ Clusters::update(const int old_index, const int new_index, const double c_new)
 void
 Clusters::update(const Eigen::VectorXd& beta)
 {
-  using sort_pair = std::pair<double, int>;
+  using sort_pair = std::pair<double, IndexType>;
 
   p = beta.size();
 
@@ -144,7 +146,7 @@ Clusters::update(const Eigen::VectorXd& beta)
   std::vector<sort_pair> sorted;
   sorted.reserve(p);
 
-  for (int i = 0; i < beta.size(); ++i) {
+  for (IndexType i = 0; i < beta.size(); ++i) {
     double abs_val = std::abs(beta(i));
     if (abs_val > 0) {
       sorted.emplace_back(abs_val, i);
@@ -201,11 +203,12 @@ Clusters::update(const Eigen::VectorXd& beta)
 }
 
 void
-Clusters::reorder(const int old_index, const int new_index)
+Clusters::reorder(const IndexType old_index, const IndexType new_index)
 {
   auto c_size = cluster_size(old_index);
-  int old_ptr = pointer(old_index); // Save pointer for cluster being moved
-  int new_ptr = pointer(new_index); // Save destination pointer
+  // Save pointer for cluster being moved
+  IndexType old_ptr = pointer(old_index);
+  IndexType new_ptr = pointer(new_index); // Save destination pointer
 
   // update coefficients
   move_elements(c, old_index, new_index, 1);
@@ -222,7 +225,7 @@ Clusters::reorder(const int old_index, const int new_index)
 
     std::for_each(c_ptr.begin() + new_index + 1,
                   c_ptr.begin() + old_index + 2,
-                  [c_size](int& x) { x += c_size; });
+                  [c_size](IndexType& x) { x += c_size; });
 
     c_ptr[new_index + 1] = c_ptr[new_index] + c_size;
   } else {
@@ -234,13 +237,13 @@ Clusters::reorder(const int old_index, const int new_index)
 
     std::for_each(c_ptr.begin() + old_index,
                   c_ptr.begin() + new_index,
-                  [c_size](int& x) { x -= c_size; });
+                  [c_size](IndexType& x) { x -= c_size; });
     c_ptr[new_index] = c_ptr[new_index + 1] - c_size;
   }
 }
 
 void
-Clusters::merge(const int old_index, const int new_index)
+Clusters::merge(const IndexType old_index, const IndexType new_index)
 {
   assert(old_index >= 0 && "old_index must be non-negative");
   assert(new_index >= 0 && "new_index must be non-negative");
@@ -254,13 +257,13 @@ Clusters::merge(const int old_index, const int new_index)
   auto c_ind_begin = c_ind.begin();
 
   assert(pointer(old_index) >= 0 &&
-         pointer(old_index) <= static_cast<int>(c_ind.size()));
+         pointer(old_index) <= static_cast<IndexType>(c_ind.size()));
   assert(pointer(old_index + 1) >= 0 &&
-         pointer(old_index + 1) <= static_cast<int>(c_ind.size()));
+         pointer(old_index + 1) <= static_cast<IndexType>(c_ind.size()));
   assert(pointer(new_index) >= 0 &&
-         pointer(new_index) <= static_cast<int>(c_ind.size()));
+         pointer(new_index) <= static_cast<IndexType>(c_ind.size()));
   assert(pointer(new_index + 1) >= 0 &&
-         pointer(new_index + 1) <= static_cast<int>(c_ind.size()));
+         pointer(new_index + 1) <= static_cast<IndexType>(c_ind.size()));
 
   assert(c_ind_begin + pointer(old_index) >= c_ind.begin() &&
          c_ind_begin + pointer(old_index) <= c_ind.end());
@@ -271,33 +274,33 @@ Clusters::merge(const int old_index, const int new_index)
 
   // update pointers
   if (new_index < old_index) {
-    assert(pointer(new_index + 1) <= static_cast<int>(c_ind.size()));
+    assert(pointer(new_index + 1) <= static_cast<IndexType>(c_ind.size()));
     assert(pointer(old_index) < pointer(old_index + 1) &&
            "First two iterators must form a valid range");
     assert(pointer(old_index) <= pointer(old_index + 1) &&
            "Second iterator must be before or equal to third");
-    assert(pointer(new_index + 1) <= static_cast<int>(c_ind.size()));
+    assert(pointer(new_index + 1) <= static_cast<IndexType>(c_ind.size()));
 
     std::rotate(c_ind_begin + pointer(new_index),
                 c_ind_begin + pointer(old_index),
                 c_ind_begin + pointer(old_index + 1));
     std::for_each(c_ptr.begin() + new_index + 1,
                   c_ptr.begin() + old_index + 1,
-                  [c_size_old](int& x) { x += c_size_old; });
+                  [c_size_old](IndexType& x) { x += c_size_old; });
   } else {
-    assert(pointer(old_index + 1) <= static_cast<int>(c_ind.size()));
+    assert(pointer(old_index + 1) <= static_cast<IndexType>(c_ind.size()));
     assert(pointer(old_index) < pointer(old_index + 1) &&
            "First two iterators must form a valid range");
     assert(pointer(old_index + 1) <= pointer(new_index + 1) &&
            "Second iterator must be before or equal to third");
-    assert(pointer(old_index + 1) <= static_cast<int>(c_ind.size()));
+    assert(pointer(old_index + 1) <= static_cast<IndexType>(c_ind.size()));
 
     std::rotate(c_ind_begin + pointer(old_index),
                 c_ind_begin + pointer(old_index + 1),
                 c_ind_begin + pointer(new_index + 1));
     std::for_each(c_ptr.begin() + old_index + 1,
                   c_ptr.begin() + new_index + 1,
-                  [c_size_old](int& x) { x -= c_size_old; });
+                  [c_size_old](IndexType& x) { x -= c_size_old; });
   }
 
   c_ptr.erase(c_ptr.begin() + old_index + 1);
@@ -309,13 +312,13 @@ Clusters::merge(const int old_index, const int new_index)
          "Pointer array size mismatch after merge");
 }
 
-std::vector<std::vector<int>>
+std::vector<std::vector<IndexType>>
 Clusters::getClusters() const
 {
-  std::vector<std::vector<int>> clusters;
+  std::vector<std::vector<IndexType>> clusters;
   clusters.reserve(size());
 
-  for (int i = 0; i < size(); ++i) {
+  for (IndexType i = 0; i < size(); ++i) {
     clusters.emplace_back(cbegin(i), cend(i));
   }
 
@@ -338,9 +341,9 @@ patternMatrix(const Eigen::VectorXd& beta)
   std::vector<Eigen::Triplet<int>> triplets;
   triplets.reserve(p);
 
-  for (int k = 0; k < clusters.size(); ++k) {
+  for (IndexType k = 0; k < clusters.size(); ++k) {
     for (auto it = clusters.cbegin(k); it != clusters.cend(k); ++it) {
-      int ind = *it;
+      IndexType ind = *it;
       int s = std::copysign(1.0, beta(ind));
       triplets.emplace_back(ind, k, s);
     }
@@ -0,0 +1,417 @@
+#include <algorithm>
+#include <future>
+#include <numeric>
+#include <slope/column_block_matrix.h>
+#include <slope/mapped_matrix.h>
+#include <slope/math.h>
+#include <slope/normalize.h>
+#include <stdexcept>
+#include <utility>
+
+namespace slope {
+
+namespace {
+
+/**
+ * Coefficients of the active set that belong to the columns of a block,
+ * as indices into the coefficients of the block and of the full matrix
+ */
+struct BlockSet
+{
+  std::vector<IndexType> local;
+  std::vector<IndexType> global;
+};
+
+/**
+ * The columns of the coefficients in an active set, sorted by column, which
+ * lets each block find its coefficients by binary search
+ */
+struct ColumnIndex
+{
+  ColumnIndex(const std::vector<IndexType>& active_set, const int p)
+    : p(p)
+  {
+    entries.reserve(active_set.size());
+
+    for (IndexType ind : active_set) {
+      entries.emplace_back(ind % p, ind);
+    }
+
+    std::sort(entries.begin(), entries.end());
+
+    for (const auto& [j, ind] : entries) {
+      if (columns.empty() || columns.back() != j) {
+        columns.emplace_back(j);
+      }
+    }
+  }
+
+  BlockSet select(const std::vector<int>& block_columns) const
+  {
+    BlockSet out;
+
+    if (block_columns.empty()) {
+      return out;
+    }
+
+    const int b = block_columns.size();
+    const bool contiguous =
+      block_columns.back() - block_columns.front() == b - 1;
+
+    auto first =
+      std::lower_bound(entries.begin(),
+                       entries.end(),
+                       std::make_pair(block_columns.front(), IndexType(-1)));
+
+    for (auto it = first;
+         it != entries.end() && it->first <= block_columns.back();
+         ++it) {
+      const auto [j, ind] = *it;
+
+      int pos = j - block_columns.front();
+
+      if (!contiguous) {
+        auto col =
+          std::lower_bound(block_columns.begin(), block_columns.end(), j);
+
+        if (col == block_columns.end() || *col != j) {
+          continue;
+        }
+
+        pos = col - block_columns.begin();
+      }
+
+      out.local.emplace_back((ind / p) * b + pos);
+      out.global.emplace_back(ind);
+    }
+
+    return out;
+  }
+
+  int p;
+  std::vector<std::pair<int, IndexType>> entries;
+  std::vector<int> columns;
+};
+
+Eigen::VectorXd
+subsetOrEmpty(const Eigen::VectorXd& x, const std::vector<int>& indices)
+{
+  return x.size() > 0 ? Eigen::VectorXd(x(indices)) : Eigen::VectorXd();
+}
+
+} // namespace
+
+ColumnBlockMatrix::ColumnBlockMatrix(std::vector<std::string> files_in)
+  : files(std::move(files_in))
+{
+  block_starts.emplace_back(0);
+
+  std::vector<ColumnStatistics> block_stats;
+
+  for (const auto& file : files) {
+    MappedMatrix block(file);
+
+    if (block.isSparse()) {
+      throw std::invalid_argument("Blocks must be dense, but " + file +
+                                  " is sparse");
+    }
+
+    if (!block_stats.empty() && block.rows() != n_rows) {
+      throw std::invalid_argument(
+        "All blocks must have the same number of rows");
+    }
+
+    n_rows = block.rows();
+    block_starts.emplace_back(block_starts.back() + block.cols());
+    block_stats.emplace_back(block.statistics());
+  }
+
+  const int p = block_starts.back();
+
+  Eigen::VectorXd mean(p), m2(p), abs_sum(p), min(p), max(p);
+
+  for (size_t b = 0; b < block_stats.size(); ++b) {
+    const int start = block_starts[b];
+    const int size = block_starts[b + 1] - start;
+
+    mean.segment(start, size) = block_stats[b].getMeans();
+    m2.segment(start, size) = block_stats[b].getM2();
+    abs_sum.segment(start, size) = block_stats[b].getAbsSums();
+    min.segment(start, size) = block_stats[b].getMinima();
+    max.segment(start, size) = block_stats[b].getMaxima();
+  }
+
+  x_stats = ColumnStatistics(n_rows,
+                             static_cast<double>(n_rows),
+                             std::move(mean),
+                             std::move(m2),
+                             std::move(abs_sum),
+                             std::move(min),
+                             std::move(max));
+}
+
+std::shared_ptr<const Eigen::MatrixXd>
+ColumnBlockMatrix::readBlock(const int b) const
+{
+  MappedMatrix block(files[b]);
+
+  return std::make_shared<const Eigen::MatrixXd>(block.dense());
+}
+
+void
+ColumnBlockMatrix::forEachBlock(
+  const std::vector<int>& columns,
+  const std::function<void(const Eigen::MatrixXd&, const std::vector<int>&)>&
+    f) const
+{
+  if (columns.empty()) {
+    return;
+  }
+
+  if (std::includes(pinned_columns.begin(),
+                    pinned_columns.end(),
+                    columns.begin(),
+                    columns.end())) {
+    f(pinned, pinned_columns);
+    return;
+  }
+
+  std::vector<int> blocks;
+
+  for (int j : columns) {
+    const int b =
+      std::upper_bound(block_starts.begin(), block_starts.end(), j) -
+      block_starts.begin() - 1;
+
+    if (blocks.empty() || blocks.back() != b) {
+      blocks.emplace_back(b);
+    }
+  }
+
+  // Each block is read in the background while the previous one is used
+  auto next = std::async(std::launch::async, [this, b = blocks[0]] {
+    return readBlock(b);
+  });
+
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    std::shared_ptr<const Eigen::MatrixXd> block = next.get();
+
+    if (i + 1 < blocks.size()) {
+      next = std::async(std::launch::async, [this, b = blocks[i + 1]] {
+        return readBlock(b);
+      });
+    }
+
+    const int start = block_starts[blocks[i]];
+
+    std::vector<int> block_columns(block->cols());
+    std::iota(block_columns.begin(), block_columns.end(), start);
+
+    f(*block, block_columns);
+  }
+}
+
+const Eigen::MatrixXd&
+ColumnBlockMatrix::pin(const std::vector<int>& columns) const
+{
+  if (columns == pinned_columns) {
+    return pinned;
+  }
+
+  Eigen::MatrixXd new_pinned(n_rows, columns.size());
+  std::vector<int> missing;
+
+  for (size_t i = 0; i < columns.size(); ++i) {
+    auto it = std::lower_bound(
+      pinned_columns.begin(), pinned_columns.end(), columns[i]);
+
+    if (it != pinned_columns.end() && *it == columns[i]) {
+      new_pinned.col(i) = pinned.col(it - pinned_columns.begin());
+    } else {
+      missing.emplace_back(columns[i]);
+    }
+  }
+
+  // Release the old columns before reading the new ones
+  pinned_columns.clear();
+  pinned.resize(0, 0);
+
+  forEachBlock(missing,
+               [&](const Eigen::MatrixXd& block,
+                   const std::vector<int>& block_columns) {
+                 for (size_t i = 0; i < columns.size(); ++i) {
+                   const int j = columns[i];
+
+                   if (j >= block_columns.front() &&
+                       j <= block_columns.back()) {
+                     new_pinned.col(i) = block.col(j - block_columns.front());
+                   }
+                 }
+               });
+
+  pinned_columns = columns;
+  pinned = std::move(new_pinned);
+
+  return pinned;
+}
+
+std::vector<std::string>
+writeColumnBlocks(const std::string& prefix,
+                  const Eigen::MatrixXd& x,
+                  const int block_size)
+{
+  if (block_size < 1) {
+    throw std::invalid_argument("block_size must be positive");
+  }
+
+  std::vector<std::string> files;
+
+  for (int start = 0; start < x.cols(); start += block_size) {
+    const int size = std::min<int>(block_size, x.cols() - start);
+
+    files.emplace_back(prefix + std::to_string(files.size()) + ".bin");
+    writeMappedMatrix(files.back(), x.middleCols(start, size));
+  }
+
+  return files;
+}
+
+Eigen::MatrixXd
+linearPredictor(const ColumnBlockMatrix& x,
+                const std::vector<IndexType>& active_set,
+                const Eigen::VectorXd& beta0,
+                const Eigen::VectorXd& beta,
+                const Eigen::VectorXd& x_centers,
+                const Eigen::VectorXd& x_scales,
+                const JitNormalization jit_normalization,
+                const bool intercept)
+{
+  const int m = beta0.size();
+  const ColumnIndex index(active_set, x.cols());
+
+  Eigen::MatrixXd eta = Eigen::MatrixXd::Zero(x.rows(), m);
+
+  x.forEachBlock(
+    index.columns,
+    [&](const Eigen::MatrixXd& block, const std::vector<int>& block_columns) {
+      const BlockSet set = index.select(block_columns);
+
+      Eigen::VectorXd block_beta = Eigen::VectorXd::Zero(block.cols() * m);
+      block_beta(set.local) = beta(set.global);
+
+      eta += linearPredictor(block,
+                             set.local,
+                             Eigen::VectorXd::Zero(m),
+                             block_beta,
+                             subsetOrEmpty(x_centers, block_columns),
+                             subsetOrEmpty(x_scales, block_columns),
+                             jit_normalization,
+                             false);
+    });
+
+  if (intercept) {
+    eta.rowwise() += beta0.transpose();
+  }
+
+  return eta;
+}
+
+void
+updateGradient(Eigen::VectorXd& gradient,
+               const ColumnBlockMatrix& x,
+               const Eigen::MatrixXd& residual,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const Eigen::VectorXd& w,
+               const JitNormalization jit_normalization)
+{
+  const int m = residual.cols();
+  const ColumnIndex index(active_set, x.cols());
+
+  x.forEachBlock(
+    index.columns,
+    [&](const Eigen::MatrixXd& block, const std::vector<int>& block_columns) {
+      const BlockSet set = index.select(block_columns);
+
+      Eigen::VectorXd block_gradient(block.cols() * m);
+
+      updateGradient(block_gradient,
+                     block,
+                     residual,
+                     set.local,
+                     subsetOrEmpty(x_centers, block_columns),
+                     subsetOrEmpty(x_scales, block_columns),
+                     w,
+                     jit_normalization);
+
+      gradient(set.global) = block_gradient(set.local);
+    });
+}
+
+void
+offsetGradient(Eigen::VectorXd& gradient,
+               const ColumnBlockMatrix& x,
+               const Eigen::VectorXd& offset,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const JitNormalization jit_normalization,
+               const Eigen::VectorXd& w)
+{
+  const int m = offset.size();
+  const ColumnIndex index(active_set, x.cols());
+
+  x.forEachBlock(
+    index.columns,
+    [&](const Eigen::MatrixXd& block, const std::vector<int>& block_columns) {
+      const BlockSet set = index.select(block_columns);
+
+      Eigen::VectorXd block_gradient = Eigen::VectorXd::Zero(block.cols() * m);
+      block_gradient(set.local) = gradient(set.global);
+
+      offsetGradient(block_gradient,
+                     block,
+                     offset,
+                     set.local,
+                     subsetOrEmpty(x_centers, block_columns),
+                     subsetOrEmpty(x_scales, block_columns),
+                     jit_normalization,
+                     w);
+
+      gradient(set.global) = block_gradient(set.local);
+    });
+}
+
+JitNormalization
+normalize(ColumnBlockMatrix& x,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool)
+{
+  return normalize(
+    x.statistics(), x_centers, x_scales, centering_type, scaling_type);
+}
+
+JitNormalization
+normalize(ColumnBlockMatrix&,
+          const Eigen::VectorXd&,
+          Eigen::VectorXd&,
+          Eigen::VectorXd&,
+          const std::string&,
+          const std::string&,
+          const bool)
+{
+  throw std::invalid_argument(
+    "Observation weights are not supported for column block matrices");
+}
+
+bool
+isFinite(const ColumnBlockMatrix& x)
+{
+  return x.statistics().getMeans().allFinite();
+}
+
+} // namespace slope
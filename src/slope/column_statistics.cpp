@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <slope/column_statistics.h>
+#include <stdexcept>
+#include <utility>
+
+namespace slope {
+
+ColumnStatistics::ColumnStatistics(const int p)
+  : mean(Eigen::VectorXd::Zero(p))
+  , m2(Eigen::VectorXd::Zero(p))
+  , abs_sum(Eigen::VectorXd::Zero(p))
+  , min(Eigen::VectorXd::Constant(p, std::numeric_limits<double>::infinity()))
+  , max(Eigen::VectorXd::Constant(p, -std::numeric_limits<double>::infinity()))
+{
+}
+
+ColumnStatistics::ColumnStatistics(const int n,
+                                   const double w_sum,
+                                   Eigen::VectorXd mean,
+                                   Eigen::VectorXd m2,
+                                   Eigen::VectorXd abs_sum,
+                                   Eigen::VectorXd min,
+                                   Eigen::VectorXd max)
+  : n(n)
+  , w_sum(w_sum)
+  , mean(std::move(mean))
+  , m2(std::move(m2))
+  , abs_sum(std::move(abs_sum))
+  , min(std::move(min))
+  , max(std::move(max))
+{
+  const int p = this->mean.size();
+
+  if (this->m2.size() != p || this->abs_sum.size() != p ||
+      this->min.size() != p || this->max.size() != p) {
+    throw std::invalid_argument(
+      "All column statistics must have the same length");
+  }
+
+  if (n < 0 || w_sum < 0) {
+    throw std::invalid_argument(
+      "The number and weight of the rows must be non-negative");
+  }
+}
+
+void
+ColumnStatistics::checkDimensions(const int p, const int n_block) const
+{
+  if (p != mean.size()) {
+    throw std::invalid_argument(
+      "x must have the same number of columns as the statistics");
+  }
+
+  if (n_block < 0) {
+    throw std::invalid_argument("Invalid row range");
+  }
+}
+
+void
+ColumnStatistics::checkWeights(const Eigen::VectorXd& w, const int n_block)
+{
+  if (w.size() != n_block) {
+    throw std::invalid_argument(
+      "weights must have the same length as the number of rows");
+  }
+
+  if (!w.allFinite() || (w.array() < 0).any()) {
+    throw std::invalid_argument("weights must be finite and non-negative");
+  }
+}
+
+void
+ColumnStatistics::checkExtrema() const
+{
+  if (!has_extrema) {
+    throw std::runtime_error(
+      "Column minima and maxima are not available after removing rows");
+  }
+}
+
+void
+ColumnStatistics::merge(const int n_block,
+                        const double w_block,
+                        const Eigen::VectorXd& block_mean,
+                        const Eigen::VectorXd& block_m2,
+                        const Eigen::VectorXd& block_abs_sum,
+                        const Eigen::VectorXd& block_min,
+                        const Eigen::VectorXd& block_max)
+{
+  const double w_a = w_sum;
+  const double w_b = w_block;
+  const double w_ab = w_a + w_b;
+
+  Eigen::VectorXd delta = block_mean - mean;
+
+  mean += delta * (w_b / w_ab);
+  m2 += block_m2 + delta.cwiseAbs2() * (w_a * w_b / w_ab);
+  abs_sum += block_abs_sum;
+  min = min.cwiseMin(block_min);
+  max = max.cwiseMax(block_max);
+
+  n += n_block;
+  w_sum = w_ab;
+}
+
+void
+ColumnStatistics::remove(const ColumnStatistics& block)
+{
+  if (block.cols() != cols()) {
+    throw std::invalid_argument(
+      "block must have the same number of columns as the statistics");
+  }
+
+  if (block.n > n || block.w_sum > w_sum) {
+    throw std::invalid_argument("Cannot remove more rows than have been seen");
+  }
+
+  const double w_ab = w_sum;
+  const double w_b = block.w_sum;
+  const double w_a = w_ab - w_b;
+
+  if (w_a <= 0) {
+    mean.setZero();
+    m2.setZero();
+    abs_sum.setZero();
+  } else if (w_b > 0) {
+    // The update of merge(), solved for the statistics of the remaining rows
+    Eigen::VectorXd m2_ab = m2;
+
+    mean = (w_ab * mean - w_b * block.mean) / w_a;
+
+    Eigen::VectorXd delta = block.mean - mean;
+
+    m2 -= block.m2 + delta.cwiseAbs2() * (w_a * w_b / w_ab);
+    abs_sum -= block.abs_sum;
+
+    // Remove what is left of the cancellation error, in particular for
+    // columns that are constant in the remaining rows, whose scales must come
+    // out as exactly zero
+    const double tol = 64 * std::numeric_limits<double>::epsilon();
+
+    for (int j = 0; j < m2.size(); ++j) {
+      if (m2(j) <= tol * m2_ab(j)) {
+        m2(j) = 0.0;
+      }
+    }
+
+    abs_sum = abs_sum.cwiseMax(0.0);
+  }
+
+  n -= block.n;
+  w_sum = std::max(w_a, 0.0);
+  has_extrema = false;
+}
+
+void
+ColumnStatistics::centers(Eigen::VectorXd& x_centers,
+                          const std::string& type) const
+{
+  const int p = cols();
+
+  if (type == "manual") {
+    if (x_centers.size() != p) {
+      throw std::invalid_argument("Invalid dimensions in centers");
+    }
+
+    if (!x_centers.allFinite()) {
+      throw std::invalid_argument("Centers must be finite");
+    }
+  } else if (type == "mean") {
+    x_centers = mean;
+  } else if (type == "min") {
+    checkExtrema();
+    x_centers = min;
+  } else if (type != "none") {
+    throw std::invalid_argument("Invalid centering type");
+  }
+}
+
+void
+ColumnStatistics::scales(Eigen::VectorXd& x_scales,
+                         const std::string& type) const
+{
+  const int p = cols();
+
+  if (type == "manual") {
+    if (x_scales.size() != p) {
+      throw std::invalid_argument("Invalid dimensions in scales");
+    }
+    if (!x_scales.allFinite()) {
+      throw std::invalid_argument("Scales must be finite");
+    }
+  } else if (type == "sd") {
+    x_scales = (m2 / w_sum).cwiseSqrt();
+  } else if (type == "l1") {
+    x_scales = abs_sum;
+  } else if (type == "l2") {
+    x_scales = (m2 + w_sum * mean.cwiseAbs2()).cwiseSqrt();
+  } else if (type == "max_abs") {
+    checkExtrema();
+    x_scales = max.cwiseAbs().cwiseMax(min.cwiseAbs());
+  } else if (type == "range") {
+    checkExtrema();
+    x_scales = max - min;
+  } else if (type != "none") {
+    throw std::invalid_argument("Invalid scaling type");
+  }
+}
+
+} // namespace slope
@@ -1,3 +1,4 @@
+#include <cmath>
 #include <slope/cv.h>
 
 namespace slope {
@@ -36,6 +37,42 @@ createGrid(const std::map<std::string, std::vector<double>>& param_values)
   return grid;
 }
 
+bool
+hasDeteriorated(const CvContext& context, QGroup& group, const int step)
+{
+  bool deteriorated = true;
+
+  for (size_t k = 0; k < group.grid_points.size(); ++k) {
+    const Eigen::MatrixXd& scores = context.scores[group.grid_points[k]];
+    int& best_step = group.best_steps[k];
+
+    const double current = scores.col(step).mean();
+    const double best = scores.col(best_step).mean();
+
+    if (context.scorer->isWorse(best, current)) {
+      best_step = step;
+    }
+
+    if (!context.scorer->isWorse(current, best)) {
+      deteriorated = false;
+      continue;
+    }
+
+    // Standard error at the best step, as for GridResult::std_errors
+    const double std_error =
+      stdDevs(scores.col(best_step))(0) / std::sqrt(scores.rows());
+
+    const double threshold =
+      std_error + context.early_stopping_margin * std::abs(best);
+
+    if (std::abs(current - best) <= threshold) {
+      deteriorated = false;
+    }
+  }
+
+  return deteriorated;
+}
+
 void
 findBestParameters(CvResult& cv_result, const std::unique_ptr<Score>& scorer)
 {
@@ -45,6 +82,11 @@ findBestParameters(CvResult& cv_result, const std::unique_ptr<Score>& scorer)
   for (size_t i = 0; i < cv_result.results.size(); ++i) {
     auto result = cv_result.results[i];
     int best_alpha_ind = whichBest(result.mean_scores, comp);
+
+    if (best_alpha_ind < 0) {
+      continue;
+    }
+
     double current_score = result.mean_scores(best_alpha_ind);
 
     assert(best_alpha_ind >= 0 && best_alpha_ind < result.alphas.size());
@@ -0,0 +1,513 @@
+#include <cmath>
+#include <functional>
+#include <slope/deduplicated_matrix.h>
+#include <slope/normalize.h>
+#include <slope/threads.h>
+#include <slope/utils.h>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace slope {
+
+namespace {
+
+/**
+ * The center and scale of a column under a type of just-in-time
+ * normalization, with a center of zero or a scale of one if the column is
+ * not centered or scaled
+ */
+std::pair<double, double>
+centerAndScale(const int j,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const JitNormalization jit_normalization)
+{
+  const bool center = jit_normalization == JitNormalization::Both ||
+                      jit_normalization == JitNormalization::Center;
+  const bool scale = jit_normalization == JitNormalization::Both ||
+                     jit_normalization == JitNormalization::Scale;
+
+  return { center ? x_centers(j) : 0.0, scale ? x_scales(j) : 1.0 };
+}
+
+/**
+ * A hash of a centered column that has been scaled to unit norm, which is
+ * the same for the column and its negation. The values are rounded so that
+ * affine copies, which only agree up to rounding after the centering and
+ * scaling, still get the same hash, except in the rare case where a value
+ * straddles a rounding boundary, which only means that the copy is missed.
+ */
+size_t
+hashColumn(const Eigen::VectorXd& z)
+{
+  std::hash<long long> hasher;
+  size_t seed = 0;
+
+  for (int i = 0; i < z.size(); ++i) {
+    const long long v = std::llround(std::abs(z(i)) * (1 << 20));
+    seed ^= hasher(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  }
+
+  return seed;
+}
+
+/**
+ * Products of the distinct columns with the columns of `v` that the columns
+ * in `active_set` need, each computed once. The other entries are zero.
+ */
+Eigen::MatrixXd
+distinctProducts(const DeduplicatedMatrix& x,
+                 const std::vector<IndexType>& active_set,
+                 const Eigen::MatrixXd& v)
+{
+  const int p = x.cols();
+  const int n_distinct = x.getDistinct().cols();
+
+  std::vector<bool> needed(static_cast<size_t>(n_distinct) * v.cols(), false);
+  std::vector<std::pair<int, int>> products;
+
+  for (IndexType ind : active_set) {
+    const int k = ind / p;
+    const int r = x.getColumnMap()[ind % p];
+    const size_t key = static_cast<size_t>(k) * n_distinct + r;
+
+    if (!needed[key]) {
+      needed[key] = true;
+      products.emplace_back(r, k);
+    }
+  }
+
+  Eigen::MatrixXd out = Eigen::MatrixXd::Zero(n_distinct, v.cols());
+
+#ifdef _OPENMP
+  bool large_problem = products.size() > 100 &&
+                       static_cast<double>(x.rows()) * products.size() > 1e5;
+#pragma omp parallel for num_threads(Threads::get()) if (large_problem)
+#endif
+  for (int l = 0; l < static_cast<int>(products.size()); ++l) {
+    const auto [r, k] = products[l];
+    out(r, k) = x.getDistinct().col(r).dot(v.col(k));
+  }
+
+  return out;
+}
+
+} // namespace
+
+DeduplicatedMatrix::DeduplicatedMatrix(const Eigen::MatrixXd& x,
+                                       const double tol)
+{
+  if (!(tol >= 0)) {
+    throw std::invalid_argument("tol must be non-negative");
+  }
+
+  const int n = x.rows();
+  const int p = x.cols();
+
+  column_map.resize(p);
+  factors.resize(p);
+  offsets.resize(p);
+
+  std::vector<int> distinct_columns;
+  std::vector<double> distinct_means;
+  std::vector<double> distinct_squared_norms;
+  std::unordered_map<size_t, std::vector<int>> buckets;
+
+  for (int j = 0; j < p; ++j) {
+    const double mean = n > 0 ? x.col(j).mean() : 0.0;
+    const Eigen::VectorXd centered = x.col(j).array() - mean;
+    const double squared_norm = centered.dot(centered);
+
+    column_map[j] = distinct_columns.size();
+    factors(j) = 1.0;
+    offsets(j) = 0.0;
+
+    if (!(squared_norm > 0) || !std::isfinite(squared_norm)) {
+      distinct_columns.emplace_back(j);
+      distinct_means.emplace_back(mean);
+      distinct_squared_norms.emplace_back(squared_norm);
+      continue;
+    }
+
+    std::vector<int>& bucket =
+      buckets[hashColumn(centered / std::sqrt(squared_norm))];
+
+    const double max_error = tol * x.col(j).cwiseAbs().maxCoeff();
+    bool is_copy = false;
+
+    for (int r : bucket) {
+      const auto u = x.col(distinct_columns[r]);
+      const double u_mean = distinct_means[r];
+      const double u_squared_norm = distinct_squared_norms[r];
+
+      // The least squares fit of the column on the distinct column, which
+      // gives factors of exactly 1 and -1 for copies and negations
+      const double a =
+        centered.dot((u.array() - u_mean).matrix()) / u_squared_norm;
+      const double b = mean - a * u_mean;
+
+      if (((a * u.array() + b) - x.col(j).array()).abs().maxCoeff() <=
+          max_error) {
+        column_map[j] = r;
+        factors(j) = a;
+        offsets(j) = b;
+        is_copy = true;
+        break;
+      }
+    }
+
+    if (!is_copy) {
+      bucket.emplace_back(distinct_columns.size());
+      distinct_columns.emplace_back(j);
+      distinct_means.emplace_back(mean);
+      distinct_squared_norms.emplace_back(squared_norm);
+    }
+  }
+
+  distinct = x(Eigen::all, distinct_columns);
+
+  // The statistics of the columns as given, so that normalization is the
+  // same as for x
+  x_stats = ColumnStatistics(p);
+  x_stats.update(x);
+}
+
+std::vector<int>
+DeduplicatedMatrix::getMultiplicities() const
+{
+  std::vector<int> out(distinct.cols(), 0);
+
+  for (int r : column_map) {
+    out[r]++;
+  }
+
+  return out;
+}
+
+Eigen::VectorXd
+DeduplicatedMatrix::col(const Eigen::Index j) const
+{
+  return (factors(j) * distinct.col(column_map[j]).array() + offsets(j))
+    .matrix();
+}
+
+void
+DeduplicatedMatrix::addCombination(
+  const std::vector<std::pair<int, double>>& terms,
+  Eigen::Ref<Eigen::VectorXd> out) const
+{
+  std::unordered_map<int, double> weights;
+  double shift = 0;
+
+  for (const auto& [j, v] : terms) {
+    weights[column_map[j]] += factors(j) * v;
+    shift += offsets(j) * v;
+  }
+
+  for (const auto& [r, v] : weights) {
+    out += v * distinct.col(r);
+  }
+
+  out.array() += shift;
+}
+
+ColumnStatistics
+DeduplicatedMatrix::computeStatistics(const Eigen::VectorXd& w) const
+{
+  const int n = rows();
+  const int p = cols();
+  const bool weighted = w.size() > 0;
+
+  ColumnStatistics distinct_stats(distinct.cols());
+
+  if (weighted) {
+    distinct_stats.update(distinct, w);
+  } else {
+    distinct_stats.update(distinct);
+  }
+
+  Eigen::VectorXd mean(p), m2(p), abs_sum(p), min(p), max(p);
+
+  for (int j = 0; j < p; ++j) {
+    const int r = column_map[j];
+    const double a = factors(j);
+    const double b = offsets(j);
+
+    mean(j) = a * distinct_stats.getMeans()(r) + b;
+    m2(j) = a * a * distinct_stats.getM2()(r);
+
+    if (b == 0) {
+      abs_sum(j) = std::abs(a) * distinct_stats.getAbsSums()(r);
+    } else {
+      const Eigen::ArrayXd x_j = col(j).array().abs();
+      abs_sum(j) = weighted ? (x_j * w.array()).sum() : x_j.sum();
+    }
+
+    const double lo = a * distinct_stats.getMinima()(r) + b;
+    const double hi = a * distinct_stats.getMaxima()(r) + b;
+
+    min(j) = a >= 0 ? lo : hi;
+    max(j) = a >= 0 ? hi : lo;
+  }
+
+  return ColumnStatistics(n,
+                          weighted ? w.sum() : static_cast<double>(n),
+                          std::move(mean),
+                          std::move(m2),
+                          std::move(abs_sum),
+                          std::move(min),
+                          std::move(max));
+}
+
+Eigen::MatrixXd
+linearPredictor(const DeduplicatedMatrix& x,
+                const std::vector<IndexType>& active_set,
+                const Eigen::VectorXd& beta0,
+                const Eigen::VectorXd& beta,
+                const Eigen::VectorXd& x_centers,
+                const Eigen::VectorXd& x_scales,
+                const JitNormalization jit_normalization,
+                const bool intercept)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+  const int m = beta0.size();
+
+  Eigen::MatrixXd eta = Eigen::MatrixXd::Zero(n, m);
+  Eigen::ArrayXd shift = Eigen::ArrayXd::Zero(m);
+
+  std::vector<std::vector<std::pair<int, double>>> terms(m);
+
+  for (IndexType ind : active_set) {
+    const int k = ind / p;
+    const int j = ind % p;
+    auto [center, scale] =
+      centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+    const double b = beta(ind) / scale;
+
+    terms[k].emplace_back(j, b);
+    shift(k) += b * center;
+  }
+
+  for (int k = 0; k < m; ++k) {
+    x.addCombination(terms[k], eta.col(k));
+    eta.col(k).array() -= shift(k) - (intercept ? beta0(k) : 0.0);
+  }
+
+  return eta;
+}
+
+void
+updateGradient(Eigen::VectorXd& gradient,
+               const DeduplicatedMatrix& x,
+               const Eigen::MatrixXd& residual,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const Eigen::VectorXd& w,
+               const JitNormalization jit_normalization)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+
+  Eigen::MatrixXd weighted_residual = w.asDiagonal() * residual;
+  Eigen::VectorXd wr_sums = weighted_residual.colwise().sum();
+
+  Eigen::MatrixXd u_wr = distinctProducts(x, active_set, weighted_residual);
+
+  for (IndexType ind : active_set) {
+    const int k = ind / p;
+    const int j = ind % p;
+    auto [center, scale] =
+      centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+    const double x_wr = x.getFactors()(j) * u_wr(x.getColumnMap()[j], k) +
+                        x.getOffsets()(j) * wr_sums(k);
+
+    gradient(ind) = (x_wr - center * wr_sums(k)) / (scale * n);
+  }
+}
+
+void
+offsetGradient(Eigen::VectorXd& gradient,
+               const DeduplicatedMatrix& x,
+               const Eigen::VectorXd& offset,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const JitNormalization jit_normalization,
+               const Eigen::VectorXd& w)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+
+  const Eigen::VectorXd ones = Eigen::VectorXd::Ones(n);
+  const Eigen::VectorXd& weights = w.size() > 0 ? w : ones;
+  const double w_sum = weights.sum();
+
+  // The sums are the same for all responses
+  std::vector<IndexType> columns;
+  columns.reserve(active_set.size());
+
+  for (IndexType ind : active_set) {
+    columns.emplace_back(ind % p);
+  }
+
+  Eigen::MatrixXd u_w = distinctProducts(x, columns, weights);
+
+  for (IndexType ind : active_set) {
+    const int k = ind / p;
+    const int j = ind % p;
+    auto [center, scale] =
+      centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+    const double x_sum = x.getFactors()(j) * u_w(x.getColumnMap()[j], 0) +
+                         x.getOffsets()(j) * w_sum;
+
+    gradient(ind) -= offset(k) * (x_sum / n - center) / scale;
+  }
+}
+
+std::pair<double, double>
+computeGradientAndHessian(const DeduplicatedMatrix& x,
+                          const IndexType ind,
+                          const Eigen::MatrixXd& w,
+                          const Eigen::MatrixXd& residual,
+                          const Eigen::VectorXd& x_centers,
+                          const Eigen::VectorXd& x_scales,
+                          const double s,
+                          const JitNormalization jit_normalization,
+                          const int n)
+{
+  const int p = x.cols();
+  const int k = ind / p;
+  const int j = ind % p;
+  auto [center, scale] =
+    centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+  const auto u = x.getDistinct().col(x.getColumnMap()[j]);
+  const double a = x.getFactors()(j);
+  const double b = x.getOffsets()(j);
+
+  const double w_sum = w.col(k).sum();
+  const double wr_sum = w.col(k).dot(residual.col(k));
+  const double u_w = u.dot(w.col(k));
+
+  const double x_wr = a * u.dot(w.col(k).cwiseProduct(residual.col(k))) +
+                      b * wr_sum;
+  const double x_w = a * u_w + b * w_sum;
+  const double x2_w =
+    a * a * u.cwiseAbs2().dot(w.col(k)) + 2 * a * b * u_w + b * b * w_sum;
+
+  const double gradient = s * (x_wr - wr_sum * center) / (n * scale);
+  const double hessian =
+    (x2_w - 2 * center * x_w + center * center * w_sum) /
+    (scale * scale * n);
+
+  return { gradient, hessian };
+}
+
+std::pair<double, double>
+computeClusterGradientAndHessian(const DeduplicatedMatrix& x,
+                                 const IndexType c_ind,
+                                 const std::vector<int>& s,
+                                 const Clusters& clusters,
+                                 const Eigen::MatrixXd& w,
+                                 const Eigen::MatrixXd& residual,
+                                 const Eigen::VectorXd& x_centers,
+                                 const Eigen::VectorXd& x_scales,
+                                 const JitNormalization jit_normalization)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+  const int m = residual.cols();
+
+  Eigen::MatrixXd x_s = Eigen::MatrixXd::Zero(n, m);
+  Eigen::ArrayXd shift = Eigen::ArrayXd::Zero(m);
+
+  std::vector<std::vector<std::pair<int, double>>> terms(m);
+
+  auto s_it = s.cbegin();
+  auto c_it = clusters.cbegin(c_ind);
+
+  for (; c_it != clusters.cend(c_ind); ++c_it, ++s_it) {
+    const int k = *c_it / p;
+    const int j = *c_it % p;
+    auto [center, scale] =
+      centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+    const double v = *s_it / scale;
+
+    terms[k].emplace_back(j, v);
+    shift(k) += center * v;
+  }
+
+  double hess = 0;
+  double grad = 0;
+
+  for (int k = 0; k < m; ++k) {
+    x.addCombination(terms[k], x_s.col(k));
+    x_s.col(k).array() -= shift(k);
+
+    hess += x_s.col(k).cwiseAbs2().dot(w.col(k)) / n;
+    grad += x_s.col(k).cwiseProduct(w.col(k)).dot(residual.col(k)) / n;
+  }
+
+  return { hess, grad };
+}
+
+Eigen::MatrixXd
+operator*(const DeduplicatedMatrix& x, const Eigen::SparseMatrix<double>& b)
+{
+  Eigen::MatrixXd out = Eigen::MatrixXd::Zero(x.rows(), b.cols());
+
+  for (int k = 0; k < b.outerSize(); ++k) {
+    std::vector<std::pair<int, double>> terms;
+
+    for (Eigen::SparseMatrix<double>::InnerIterator it(b, k); it; ++it) {
+      terms.emplace_back(it.row(), it.value());
+    }
+
+    x.addCombination(terms, out.col(k));
+  }
+
+  return out;
+}
+
+JitNormalization
+normalize(DeduplicatedMatrix& x,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool)
+{
+  return normalize(
+    x.statistics(), x_centers, x_scales, centering_type, scaling_type);
+}
+
+JitNormalization
+normalize(DeduplicatedMatrix& x,
+          const Eigen::VectorXd& w,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool)
+{
+  return normalize(x.computeStatistics(w),
+                   x_centers,
+                   x_scales,
+                   centering_type,
+                   scaling_type);
+}
+
+bool
+isFinite(const DeduplicatedMatrix& x)
+{
+  return isFinite(x.getDistinct()) && x.getFactors().allFinite() &&
+         x.getOffsets().allFinite();
+}
+
+} // namespace slope
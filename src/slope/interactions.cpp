@@ -0,0 +1,368 @@
+#include "kkt_check.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <slope/interactions.h>
+#include <slope/math.h>
+#include <slope/regularization_sequence.h>
+#include <slope/sorted_l1_norm.h>
+#include <slope/utils.h>
+#include <stdexcept>
+
+namespace slope {
+
+namespace {
+
+/**
+ * Gradients of the interactions that are not in `pairs` but may have
+ * gradients of at least `threshold`, as computed from `residual`
+ */
+std::pair<std::vector<std::pair<int, int>>, std::vector<double>>
+outsideGradients(const Eigen::MatrixXd& x,
+                 const Eigen::VectorXd& residual,
+                 const std::vector<std::pair<int, int>>& pairs,
+                 const double threshold)
+{
+  const int n = x.rows();
+
+  std::vector<std::pair<int, int>> out_pairs;
+  std::vector<double> out_gradient;
+
+  for (const auto& [i, j] : screenInteractions(x, residual, n * threshold)) {
+    if (std::binary_search(pairs.begin(), pairs.end(), std::make_pair(i, j))) {
+      continue;
+    }
+
+    const double g = x.col(i).cwiseProduct(x.col(j)).dot(residual) / n;
+
+    if (std::abs(g) >= threshold) {
+      out_pairs.emplace_back(i, j);
+      out_gradient.emplace_back(g);
+    }
+  }
+
+  return { std::move(out_pairs), std::move(out_gradient) };
+}
+
+} // namespace
+
+InteractionMatrix::InteractionMatrix(const Eigen::MatrixXd& x_in,
+                                     std::vector<std::pair<int, int>> pairs_in)
+  : x(x_in)
+  , pairs(std::move(pairs_in))
+{
+  const int q = x.cols();
+
+  for (const auto& [i, j] : pairs) {
+    if (i < 0 || i >= j || j >= q) {
+      throw std::invalid_argument(
+        "Interactions must be pairs (i, j) of base features with i < j");
+    }
+  }
+}
+
+double
+InteractionMatrix::colDot(const int j,
+                          const Eigen::Ref<const Eigen::VectorXd>& v) const
+{
+  if (j < x.cols()) {
+    return x.col(j).dot(v);
+  }
+
+  const auto [a, b] = pairs[j - x.cols()];
+
+  return x.col(a).cwiseProduct(x.col(b)).dot(v);
+}
+
+void
+InteractionMatrix::colAxpy(const int j,
+                           const double a,
+                           Eigen::Ref<Eigen::VectorXd> v) const
+{
+  if (j < x.cols()) {
+    v += a * x.col(j);
+    return;
+  }
+
+  const auto [k, l] = pairs[j - x.cols()];
+
+  v += a * x.col(k).cwiseProduct(x.col(l));
+}
+
+double
+InteractionMatrix::colSquaredNorm(
+  const int j,
+  const Eigen::Ref<const Eigen::VectorXd>& w) const
+{
+  if (j < x.cols()) {
+    return x.col(j).cwiseAbs2().dot(w);
+  }
+
+  const auto [a, b] = pairs[j - x.cols()];
+
+  return x.col(a).cwiseProduct(x.col(b)).cwiseAbs2().dot(w);
+}
+
+double
+InteractionMatrix::colSum(const int j) const
+{
+  if (j < x.cols()) {
+    return x.col(j).sum();
+  }
+
+  const auto [a, b] = pairs[j - x.cols()];
+
+  return x.col(a).dot(x.col(b));
+}
+
+std::vector<std::pair<int, int>>
+screenInteractions(const Eigen::MatrixXd& x,
+                   const Eigen::VectorXd& v,
+                   const double threshold)
+{
+  Eigen::VectorXd a =
+    (x.array().colwise() * v.array()).matrix().colwise().norm();
+  Eigen::VectorXd b = x.colwise().norm();
+
+  std::vector<IndexType> a_ord = sortIndex(a, true);
+  std::vector<IndexType> b_ord = sortIndex(b, true);
+
+  std::vector<std::pair<int, int>> out;
+
+  if (b_ord.empty()) {
+    return out;
+  }
+
+  // Each pair that passes both bounds is reached from both of its features,
+  // and kept from the one with the smaller index
+  for (int i : a_ord) {
+    if (a(i) * b(b_ord.front()) < threshold) {
+      break;
+    }
+
+    for (int j : b_ord) {
+      if (a(i) * b(j) < threshold) {
+        break;
+      }
+
+      if (i < j && a(j) * b(i) >= threshold) {
+        out.emplace_back(i, j);
+      }
+    }
+  }
+
+  std::sort(out.begin(), out.end());
+
+  return out;
+}
+
+InteractionPath::InteractionPath(SlopePath path_in,
+                                 const int n_features_in,
+                                 std::vector<std::pair<int, int>> pairs_in)
+  : path(std::move(path_in))
+  , n_features(n_features_in)
+  , pairs(std::move(pairs_in))
+{
+}
+
+Eigen::SparseMatrix<double>
+InteractionPath::getCoefs(const size_t step) const
+{
+  Eigen::SparseMatrix<double> beta = path(step).getCoefs();
+
+  std::vector<Eigen::Triplet<double>> triplets;
+  triplets.reserve(beta.nonZeros());
+
+  for (Eigen::SparseMatrix<double>::InnerIterator it(beta, 0); it; ++it) {
+    const int j = it.row();
+
+    if (j < n_features) {
+      triplets.emplace_back(j, j, it.value());
+    } else {
+      const auto [a, b] = pairs[j - n_features];
+      triplets.emplace_back(a, b, it.value());
+    }
+  }
+
+  Eigen::SparseMatrix<double> out(n_features, n_features);
+  out.setFromTriplets(triplets.begin(), triplets.end());
+
+  return out;
+}
+
+Eigen::MatrixXd
+InteractionPath::predict(const Eigen::MatrixXd& x,
+                         const size_t step,
+                         const std::string& type) const
+{
+  if (x.cols() != n_features) {
+    throw std::invalid_argument(
+      "x must have as many columns as there are base features");
+  }
+
+  InteractionMatrix x_int(x, pairs);
+
+  return path(step).predict(x_int, type);
+}
+
+InteractionPath
+interactionPath(Slope model,
+                const Eigen::MatrixXd& x,
+                const Eigen::MatrixXd& y_in)
+{
+  if (model.getCenteringType() != "none" || model.getScalingType() != "none") {
+    throw std::invalid_argument(
+      "Interaction paths require centering and scaling to be \"none\"");
+  }
+
+  auto loss = setupLoss(model.getLossType());
+
+  const Eigen::MatrixXd y = loss->preprocessResponse(y_in);
+
+  if (y.cols() > 1) {
+    throw std::invalid_argument(
+      "Interaction paths require a single-response loss");
+  }
+
+  const int n = x.rows();
+  const int q = x.cols();
+
+  const double n_coefs = q + 0.5 * q * (q - 1.0);
+
+  if (n_coefs > std::numeric_limits<int>::max()) {
+    throw std::invalid_argument("Too many interactions to index");
+  }
+
+  const int p = static_cast<int>(n_coefs);
+
+  auto lambdaHead = [&](const int length) {
+    auto [theta1, theta2] = model.getOscarParameters();
+
+    return lambdaSequenceHead(length,
+                              p,
+                              model.getQ(),
+                              model.getLambdaType(),
+                              n,
+                              theta1,
+                              theta2);
+  };
+
+  const double lambda_min = lambdaSequenceMin(
+    model.getQ(), model.getLambdaType(), model.getOscarParameters().first);
+
+  SortedL1Norm sl1_norm;
+
+  // Start with the interactions that the largest alpha of the full problem,
+  // the dual norm of the gradient of the null model, depends on. Those with
+  // gradients below the dual norm of the base features times the smallest
+  // lambda cannot raise it.
+  std::vector<std::pair<int, int>> pairs;
+
+  {
+    Eigen::MatrixXd eta = Eigen::MatrixXd::Zero(n, 1);
+
+    if (model.getFitIntercept()) {
+      eta.setConstant(loss->link(y.colwise().mean())(0, 0));
+    }
+
+    const Eigen::VectorXd residual = loss->residual(eta, y);
+    const Eigen::VectorXd gradient_base = x.transpose() * residual / n;
+
+    const double dual_norm_base =
+      sl1_norm.dualNorm(gradient_base, lambdaHead(q));
+
+    auto [outside, gradient_outside] =
+      outsideGradients(x, residual, pairs, dual_norm_base * lambda_min);
+
+    const int k = q + outside.size();
+
+    Eigen::ArrayXd abs_gradient(k);
+    abs_gradient << gradient_base.cwiseAbs().array(),
+      Eigen::Map<Eigen::VectorXd>(gradient_outside.data(), outside.size())
+        .cwiseAbs()
+        .array();
+
+    std::vector<IndexType> ord = sortIndex(abs_gradient, true);
+    permute(abs_gradient, ord);
+
+    Eigen::ArrayXd ratios =
+      cumSum(abs_gradient) / cumSum(Eigen::ArrayXd(lambdaHead(k)));
+
+    int k_max = 0;
+    ratios.maxCoeff(&k_max);
+
+    for (int r = 0; r <= k_max; ++r) {
+      if (ord[r] >= q) {
+        pairs.emplace_back(outside[ord[r] - q]);
+      }
+    }
+
+    std::sort(pairs.begin(), pairs.end());
+  }
+
+  if (model.getAlphaMinRatio() < 0) {
+    model.setAlphaMinRatio(n > p ? 1e-4 : 1e-2);
+  }
+
+  while (true) {
+    InteractionMatrix x_int(x, pairs);
+
+    const int p_int = x_int.cols();
+
+    SlopePath path =
+      model.path(x_int, y_in, Eigen::ArrayXd(), lambdaHead(p_int));
+
+    std::vector<std::pair<int, int>> violations;
+
+    for (size_t step = 0; step < path.size(); ++step) {
+      const SlopeFit fit = path(step);
+      const double alpha = fit.getAlpha();
+
+      const Eigen::VectorXd residual =
+        loss->residual(fit.predict(x_int, "linear"), y);
+
+      auto [outside, gradient_outside] =
+        outsideGradients(x, residual, pairs, alpha * lambda_min);
+
+      if (outside.empty()) {
+        continue;
+      }
+
+      const int k = p_int + outside.size();
+
+      Eigen::VectorXd gradient(k);
+      Eigen::VectorXd beta = Eigen::VectorXd::Zero(k);
+
+      for (int j = 0; j < p_int; ++j) {
+        gradient(j) = x_int.colDot(j, residual) / n;
+      }
+
+      for (size_t l = 0; l < outside.size(); ++l) {
+        gradient(p_int + l) = gradient_outside[l];
+      }
+
+      beta.head(p_int) = Eigen::VectorXd(fit.getCoefs());
+
+      std::vector<IndexType> indices(k);
+      std::iota(indices.begin(), indices.end(), 0);
+
+      for (IndexType ind :
+           kktCheck(gradient, beta, alpha * lambdaHead(k), indices)) {
+        if (ind >= p_int) {
+          violations.emplace_back(outside[ind - p_int]);
+        }
+      }
+    }
+
+    if (violations.empty()) {
+      return InteractionPath(std::move(path), q, std::move(pairs));
+    }
+
+    pairs.insert(pairs.end(), violations.begin(), violations.end());
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+  }
+}
+
+} // namespace slope
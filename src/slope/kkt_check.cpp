@@ -5,17 +5,17 @@
 
 namespace slope {
 
-std::vector<int>
+std::vector<IndexType>
 kktCheck(const Eigen::VectorXd& gradient,
          const Eigen::VectorXd& beta,
          const Eigen::ArrayXd& lambda,
-         const std::vector<int>& indices)
+         const std::vector<IndexType>& indices)
 {
   using namespace Eigen;
 
-  std::vector<int> out;
+  std::vector<IndexType> out;
 
-  int pm = beta.size();
+  IndexType pm = beta.size();
 
   if (pm == 0) {
     return out;
@@ -29,9 +29,9 @@ kktCheck(const Eigen::VectorXd& gradient,
   ArrayXb tmp = cumSum(diff) >= 0.0;
 
   // Find the last position where cumulative sum is non-negative
-  int k = 0;
+  IndexType k = 0;
   if (tmp.size() > 0) {
-    for (int i = tmp.size() - 1; i >= 0; --i) {
+    for (IndexType i = tmp.size() - 1; i >= 0; --i) {
       if (tmp[i]) {
         k = i + 1;
         break;
@@ -40,7 +40,7 @@ kktCheck(const Eigen::VectorXd& gradient,
   }
 
   out.reserve(k);
-  for (int i = 0; i < k; ++i) {
+  for (IndexType i = 0; i < k; ++i) {
     out.emplace_back(indices[ord[i]]);
   }
 
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <Eigen/Core>
+#include <slope/index_type.h>
+#include <vector>
 
 namespace slope {
 
@@ -25,15 +27,15 @@ using ArrayXXb = Eigen::Array<bool, Eigen::Dynamic, Eigen::Dynamic>;
  * @param beta The current coefficients
  * @param lambda Vector of regularization parameters
  * @param strong_set Vector of indices in the strong set
- * @return std::vector<int> Indices where KKT conditions are violated
+ * @return std::vector<IndexType> Indices where KKT conditions are violated
  *
  * Verifies if the current solution satisfies the KKT optimality conditions
  * for the SLOPE optimization problem. Returns indices where violations occur.
  */
-std::vector<int>
+std::vector<IndexType>
 kktCheck(const Eigen::VectorXd& gradient,
          const Eigen::VectorXd& beta,
          const Eigen::ArrayXd& lambda,
-         const std::vector<int>& strong_set);
+         const std::vector<IndexType>& strong_set);
 
 } // namespace slope
@@ -0,0 +1,329 @@
+#include <slope/linear_operator.h>
+#include <slope/normalize.h>
+
+namespace slope {
+
+namespace {
+
+/**
+ * The center and scale of a column under a type of just-in-time
+ * normalization, with a center of zero or a scale of one if the column is
+ * not centered or scaled
+ */
+std::pair<double, double>
+centerAndScale(const int j,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const JitNormalization jit_normalization)
+{
+  const bool center = jit_normalization == JitNormalization::Both ||
+                      jit_normalization == JitNormalization::Center;
+  const bool scale = jit_normalization == JitNormalization::Both ||
+                     jit_normalization == JitNormalization::Scale;
+
+  return { center ? x_centers(j) : 0.0, scale ? x_scales(j) : 1.0 };
+}
+
+} // namespace
+
+double
+LinearOperator::colSquaredNorm(const int j,
+                               const Eigen::Ref<const Eigen::VectorXd>& w) const
+{
+  return col(j).cwiseAbs2().dot(w);
+}
+
+double
+LinearOperator::colSum(const int j) const
+{
+  return col(j).sum();
+}
+
+ColumnStatistics
+LinearOperator::computeStatistics(const Eigen::VectorXd& w) const
+{
+  const int n = rows();
+  const int p = cols();
+  const bool weighted = w.size() > 0;
+
+  Eigen::VectorXd mean(p), m2(p), abs_sum(p), min(p), max(p);
+
+  // One column at a time, to avoid forming the whole matrix
+  for (int j = 0; j < p; ++j) {
+    ColumnStatistics col_stats(1);
+    Eigen::MatrixXd x_j = col(j);
+
+    if (weighted) {
+      col_stats.update(x_j, w);
+    } else {
+      col_stats.update(x_j);
+    }
+
+    mean(j) = col_stats.getMeans()(0);
+    m2(j) = col_stats.getM2()(0);
+    abs_sum(j) = col_stats.getAbsSums()(0);
+    min(j) = col_stats.getMinima()(0);
+    max(j) = col_stats.getMaxima()(0);
+  }
+
+  return ColumnStatistics(n,
+                          weighted ? w.sum() : static_cast<double>(n),
+                          std::move(mean),
+                          std::move(m2),
+                          std::move(abs_sum),
+                          std::move(min),
+                          std::move(max));
+}
+
+bool
+LinearOperator::allFinite() const
+{
+  const ColumnStatistics& stats = statistics();
+
+  return stats.getMeans().allFinite() && stats.getM2().allFinite();
+}
+
+Eigen::VectorXd
+LinearOperator::col(const Eigen::Index j) const
+{
+  Eigen::VectorXd out = Eigen::VectorXd::Zero(rows());
+  colAxpy(j, 1.0, out);
+
+  return out;
+}
+
+const ColumnStatistics&
+LinearOperator::statistics() const
+{
+  if (!has_stats) {
+    x_stats = computeStatistics(Eigen::VectorXd());
+    has_stats = true;
+  }
+
+  return x_stats;
+}
+
+Eigen::MatrixXd
+linearPredictor(const LinearOperator& x,
+                const std::vector<IndexType>& active_set,
+                const Eigen::VectorXd& beta0,
+                const Eigen::VectorXd& beta,
+                const Eigen::VectorXd& x_centers,
+                const Eigen::VectorXd& x_scales,
+                const JitNormalization jit_normalization,
+                const bool intercept)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+  const int m = beta0.size();
+
+  Eigen::MatrixXd eta = Eigen::MatrixXd::Zero(n, m);
+  Eigen::ArrayXd shift = Eigen::ArrayXd::Zero(m);
+
+  for (IndexType ind : active_set) {
+    auto [k, j] = splitIndex(ind, p);
+    auto [center, scale] =
+      centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+    const double b = beta(ind) / scale;
+
+    x.colAxpy(j, b, eta.col(k));
+    shift(k) += b * center;
+  }
+
+  for (int k = 0; k < m; ++k) {
+    eta.col(k).array() -= shift(k) - (intercept ? beta0(k) : 0.0);
+  }
+
+  return eta;
+}
+
+void
+updateGradient(Eigen::VectorXd& gradient,
+               const LinearOperator& x,
+               const Eigen::MatrixXd& residual,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const Eigen::VectorXd& w,
+               const JitNormalization jit_normalization)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+
+  Eigen::MatrixXd weighted_residual = w.asDiagonal() * residual;
+  Eigen::VectorXd wr_sums = weighted_residual.colwise().sum();
+
+  for (IndexType ind : active_set) {
+    auto [k, j] = splitIndex(ind, p);
+    auto [center, scale] =
+      centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+    const double x_wr = x.colDot(j, weighted_residual.col(k));
+
+    gradient(ind) = (x_wr - center * wr_sums(k)) / (scale * n);
+  }
+}
+
+void
+offsetGradient(Eigen::VectorXd& gradient,
+               const LinearOperator& x,
+               const Eigen::VectorXd& offset,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const JitNormalization jit_normalization,
+               const Eigen::VectorXd& w)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+
+  for (IndexType ind : active_set) {
+    auto [k, j] = splitIndex(ind, p);
+    auto [center, scale] =
+      centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+    const double x_sum = w.size() > 0 ? x.colDot(j, w) : x.colSum(j);
+
+    gradient(ind) -= offset(k) * (x_sum / n - center) / scale;
+  }
+}
+
+std::pair<double, double>
+computeGradientAndHessian(const LinearOperator& x,
+                          const IndexType ind,
+                          const Eigen::MatrixXd& w,
+                          const Eigen::MatrixXd& residual,
+                          const Eigen::VectorXd& x_centers,
+                          const Eigen::VectorXd& x_scales,
+                          const double s,
+                          const JitNormalization jit_normalization,
+                          const int n)
+{
+  auto [k, j] = splitIndex(ind, static_cast<int>(x.cols()));
+  auto [center, scale] =
+    centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+  const Eigen::VectorXd w_k = w.col(k);
+  const Eigen::VectorXd wr_k = w_k.cwiseProduct(residual.col(k));
+
+  const double gradient =
+    s * (x.colDot(j, wr_k) - wr_k.sum() * center) / (n * scale);
+  const double hessian =
+    (x.colSquaredNorm(j, w_k) - 2 * center * x.colDot(j, w_k) +
+     center * center * w_k.sum()) /
+    (scale * scale * n);
+
+  return { gradient, hessian };
+}
+
+std::pair<double, double>
+computeClusterGradientAndHessian(const LinearOperator& x,
+                                 const IndexType c_ind,
+                                 const std::vector<int>& s,
+                                 const Clusters& clusters,
+                                 const Eigen::MatrixXd& w,
+                                 const Eigen::MatrixXd& residual,
+                                 const Eigen::VectorXd& x_centers,
+                                 const Eigen::VectorXd& x_scales,
+                                 const JitNormalization jit_normalization)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+  const int m = residual.cols();
+
+  Eigen::MatrixXd x_s = Eigen::MatrixXd::Zero(n, m);
+  Eigen::ArrayXd shift = Eigen::ArrayXd::Zero(m);
+
+  auto s_it = s.cbegin();
+  auto c_it = clusters.cbegin(c_ind);
+
+  for (; c_it != clusters.cend(c_ind); ++c_it, ++s_it) {
+    auto [k, j] = splitIndex(*c_it, p);
+    auto [center, scale] =
+      centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+    const double v = *s_it / scale;
+
+    x.colAxpy(j, v, x_s.col(k));
+    shift(k) += center * v;
+  }
+
+  double hess = 0;
+  double grad = 0;
+
+  for (int k = 0; k < m; ++k) {
+    x_s.col(k).array() -= shift(k);
+
+    hess += x_s.col(k).cwiseAbs2().dot(w.col(k)) / n;
+    grad += x_s.col(k).cwiseProduct(w.col(k)).dot(residual.col(k)) / n;
+  }
+
+  return { hess, grad };
+}
+
+Eigen::MatrixXd
+operator*(const LinearOperator& x, const Eigen::SparseMatrix<double>& b)
+{
+  Eigen::MatrixXd out = Eigen::MatrixXd::Zero(x.rows(), b.cols());
+
+  for (int k = 0; k < b.outerSize(); ++k) {
+    for (Eigen::SparseMatrix<double>::InnerIterator it(b, k); it; ++it) {
+      x.colAxpy(it.row(), it.value(), out.col(k));
+    }
+  }
+
+  return out;
+}
+
+JitNormalization
+normalize(LinearOperator& x,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool)
+{
+  if (!usesColumnStatistics(centering_type, scaling_type)) {
+    return normalize(ColumnStatistics(x.cols()),
+                     x_centers,
+                     x_scales,
+                     centering_type,
+                     scaling_type);
+  }
+
+  return normalize(
+    x.statistics(), x_centers, x_scales, centering_type, scaling_type);
+}
+
+JitNormalization
+normalize(LinearOperator& x,
+          const Eigen::VectorXd& w,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool)
+{
+  if (!usesColumnStatistics(centering_type, scaling_type)) {
+    return normalize(ColumnStatistics(x.cols()),
+                     x_centers,
+                     x_scales,
+                     centering_type,
+                     scaling_type);
+  }
+
+  return normalize(x.computeStatistics(w),
+                   x_centers,
+                   x_scales,
+                   centering_type,
+                   scaling_type);
+}
+
+bool
+isFinite(const LinearOperator& x)
+{
+  return x.allFinite();
+}
+
+} // namespace slope
@@ -7,21 +7,38 @@ namespace slope {
 double
 Logistic::loss(const Eigen::MatrixXd& eta, const Eigen::MatrixXd& y)
 {
-  double loss =
-    eta.array().exp().log1p().sum() - y.reshaped().dot(eta.reshaped());
-  return loss / y.rows();
+  if (weights.size() == 0) {
+    double loss =
+      eta.array().exp().log1p().sum() - y.reshaped().dot(eta.reshaped());
+    return loss / y.rows();
+  }
+
+  return weightedMean(
+    (eta.array().exp().log1p() - y.array() * eta.array()).rowwise().sum(),
+    weights);
 }
 
 double
 Logistic::dual(const Eigen::MatrixXd& theta,
                const Eigen::MatrixXd& y,
-               const Eigen::VectorXd&)
+               const Eigen::VectorXd& w)
 {
   int n = y.rows();
 
-  Eigen::VectorXd eta = link(theta + y);
+  if (w.size() == 0) {
+    Eigen::VectorXd eta = link(theta + y);
+
+    double loss =
+      eta.array().exp().log1p().sum() - y.reshaped().dot(eta.reshaped());
+
+    return loss / n - theta.reshaped().dot(eta) / n;
+  }
+
+  const Eigen::MatrixXd u = unweighted(theta, w);
+  const Eigen::ArrayXXd eta = link(u + y);
 
-  return loss(eta, y) - theta.reshaped().dot(eta) / n;
+  return weightedMean(
+    (eta.exp().log1p() - (y.array() + u.array()) * eta).rowwise().sum(), w);
 }
 
 Eigen::MatrixXd
@@ -11,12 +11,42 @@ Loss::updateWeightsAndWorkingResponse(Eigen::MatrixXd& w,
 {
   w = hessianDiagonal(eta);
   z = eta.array() + (y.array() - inverseLink(eta).array()) / w.array();
+
+  if (weights.size() > 0) {
+    w = weights.asDiagonal() * w;
+  }
 }
 
 Eigen::MatrixXd
 Loss::residual(const Eigen::MatrixXd& eta, const Eigen::MatrixXd& y)
 {
+  if (weights.size() > 0) {
+    return weights.asDiagonal() * (inverseLink(eta) - y);
+  }
+
   return inverseLink(eta) - y;
 }
 
+double
+Loss::weightedMean(const Eigen::ArrayXd& values, const Eigen::VectorXd& w)
+{
+  if (w.size() == 0) {
+    return values.mean();
+  }
+
+  return (w.array() > 0).select(w.array() * values, 0.0).sum() / values.size();
+}
+
+Eigen::MatrixXd
+Loss::unweighted(const Eigen::MatrixXd& theta, const Eigen::VectorXd& w)
+{
+  if (w.size() == 0) {
+    return theta;
+  }
+
+  Eigen::VectorXd w_inv = (w.array() > 0).select(w.cwiseInverse(), 0.0);
+
+  return w_inv.asDiagonal() * theta;
+}
+
 } // namespace slope
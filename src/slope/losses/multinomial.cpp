@@ -12,9 +12,16 @@ Multinomial::loss(const Eigen::MatrixXd& eta, const Eigen::MatrixXd& y)
 {
   int n = y.rows();
 
+  assert(eta.allFinite());
+
+  if (weights.size() > 0) {
+    return weightedMean(logSumExp(eta).array() -
+                          (y.array() * eta.array()).rowwise().sum(),
+                        weights);
+  }
+
   double out = logSumExp(eta).mean();
 
-  assert(eta.allFinite());
   assert(out == out && "Loss is NaN");
 
   out -= (y.array() * eta.array()).sum() / n;
@@ -25,10 +32,18 @@ Multinomial::loss(const Eigen::MatrixXd& eta, const Eigen::MatrixXd& y)
 double
 Multinomial::dual(const Eigen::MatrixXd& theta,
                   const Eigen::MatrixXd& y,
-                  const Eigen::VectorXd&)
+                  const Eigen::VectorXd& w)
 {
   int n = y.rows();
-  int p = y.cols();
+
+  if (w.size() > 0) {
+    const Eigen::MatrixXd u = unweighted(theta, w);
+    const Eigen::ArrayXXd eta = link(u + y);
+
+    return weightedMean(logSumExp(eta).array() -
+                          (eta * (y.array() + u.array())).rowwise().sum(),
+                        w);
+  }
 
   Eigen::ArrayXXd eta = link(theta + y);
 
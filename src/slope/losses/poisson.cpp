@@ -7,19 +7,31 @@ namespace slope {
 double
 Poisson::loss(const Eigen::MatrixXd& eta, const Eigen::MatrixXd& y)
 {
-  return (eta.array().exp() - y.array() * eta.array()).mean();
+  if (weights.size() == 0) {
+    return (eta.array().exp() - y.array() * eta.array()).mean();
+  }
+
+  return weightedMean(
+    (eta.array().exp() - y.array() * eta.array()).rowwise().sum(), weights);
 }
 
 double
 Poisson::dual(const Eigen::MatrixXd& theta,
               const Eigen::MatrixXd& y,
-              const Eigen::VectorXd&)
+              const Eigen::VectorXd& w)
 {
-  const Eigen::ArrayXd e = theta + y;
-
   assert(theta.allFinite() && "theta is not finite");
 
-  return (e * (1.0 - e.max(constants::P_MIN).log())).mean();
+  if (w.size() == 0) {
+    const Eigen::ArrayXd e = theta + y;
+
+    return (e * (1.0 - e.max(constants::P_MIN).log())).mean();
+  }
+
+  const Eigen::ArrayXXd e = unweighted(theta, w) + y;
+
+  return weightedMean(
+    (e * (1.0 - e.max(constants::P_MIN).log())).rowwise().sum(), w);
 }
 
 Eigen::MatrixXd
@@ -45,7 +57,7 @@ Poisson::updateIntercept(Eigen::VectorXd& beta0,
 {
   Eigen::VectorXd residual = this->residual(eta, y);
   double grad = residual.mean();
-  double hess = eta.array().exp().mean();
+  double hess = weightedMean(eta.col(0).array().exp(), weights);
 
   beta0(0) -= grad / hess;
 }
@@ -5,17 +5,30 @@ namespace slope {
 double
 Quadratic::loss(const Eigen::MatrixXd& eta, const Eigen::MatrixXd& y)
 {
-  return (eta - y).squaredNorm() / (2.0 * y.rows());
+  if (weights.size() == 0) {
+    return (eta - y).squaredNorm() / (2.0 * y.rows());
+  }
+
+  return weightedMean(0.5 * (eta - y).rowwise().squaredNorm().array(),
+                      weights);
 }
 
 double
 Quadratic::dual(const Eigen::MatrixXd& theta,
                 const Eigen::MatrixXd& y,
-                const Eigen::VectorXd&)
+                const Eigen::VectorXd& w)
 {
   const int n = y.rows();
 
-  return (y.squaredNorm() - (theta + y).squaredNorm()) / (2.0 * n);
+  if (w.size() == 0) {
+    return (y.squaredNorm() - (theta + y).squaredNorm()) / (2.0 * n);
+  }
+
+  const Eigen::MatrixXd u = unweighted(theta, w);
+
+  return weightedMean(
+    0.5 * (y.rowwise().squaredNorm() - (u + y).rowwise().squaredNorm()).array(),
+    w);
 }
 
 Eigen::MatrixXd
@@ -36,7 +49,11 @@ Quadratic::updateWeightsAndWorkingResponse(Eigen::MatrixXd& w,
                                            const Eigen::MatrixXd&,
                                            const Eigen::MatrixXd& y)
 {
-  // Do nothing since weights are already one and working response is y.
+  // The working response is y, and the weights are the observation weights,
+  // which are already one in the unweighted case.
+  if (weights.size() > 0) {
+    w = weights.replicate(1, w.cols());
+  }
 }
 
 Eigen::MatrixXd
@@ -0,0 +1,469 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <slope/mapped_matrix.h>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace slope {
+
+namespace {
+
+constexpr char magic[8] = { 'S', 'L', 'O', 'P', 'E', 'M', 'A', 'T' };
+constexpr std::uint32_t version = 1;
+constexpr std::uint32_t byte_order_mark = 0x01020304;
+constexpr std::size_t alignment = 64;
+constexpr std::size_t header_size = 64;
+
+struct Header
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byte_order_mark;
+  std::uint32_t storage;
+  std::uint32_t index_bytes;
+  std::int64_t rows;
+  std::int64_t cols;
+  std::int64_t nnz;
+  char reserved[16];
+};
+
+static_assert(sizeof(Header) == header_size, "Unexpected header size");
+
+std::size_t
+aligned(const std::size_t offset)
+{
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+/// Offsets of the sections of a file, in bytes
+struct Layout
+{
+  std::size_t stats;
+  std::size_t matrix;
+  std::size_t inner;
+  std::size_t values;
+  std::size_t end;
+};
+
+Layout
+layout(const std::int64_t rows,
+       const std::int64_t cols,
+       const std::int64_t nnz,
+       const int index_bytes)
+{
+  Layout out;
+
+  out.stats = header_size;
+
+  std::size_t offset = out.stats;
+
+  for (int k = 0; k < 5; ++k) {
+    offset = aligned(offset + cols * sizeof(double));
+  }
+
+  out.matrix = offset;
+
+  if (index_bytes == 0) {
+    out.inner = out.values = out.matrix;
+    out.end = out.matrix + rows * cols * sizeof(double);
+  } else {
+    out.inner = aligned(out.matrix + (cols + 1) * index_bytes);
+    out.values = aligned(out.inner + nnz * index_bytes);
+    out.end = out.values + nnz * sizeof(double);
+  }
+
+  return out;
+}
+
+class Writer
+{
+public:
+  explicit Writer(const std::string& file)
+    : out(file, std::ios::binary | std::ios::trunc)
+  {
+    if (!out) {
+      throw std::runtime_error("Could not open " + file + " for writing");
+    }
+  }
+
+  void write(const void* data, const std::size_t bytes)
+  {
+    out.write(static_cast<const char*>(data), bytes);
+    offset += bytes;
+  }
+
+  void padTo(const std::size_t target)
+  {
+    const std::vector<char> zeros(target - offset, 0);
+    write(zeros.data(), zeros.size());
+  }
+
+  void finish(const std::string& file)
+  {
+    out.close();
+
+    if (!out) {
+      throw std::runtime_error("Could not write " + file);
+    }
+  }
+
+private:
+  std::ofstream out;
+  std::size_t offset = 0;
+};
+
+void
+writeHeaderAndStatistics(Writer& writer,
+                         const Layout& sections,
+                         const std::int64_t rows,
+                         const std::int64_t cols,
+                         const std::int64_t nnz,
+                         const int index_bytes,
+                         const ColumnStatistics& x_stats)
+{
+  Header header{};
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = version;
+  header.byte_order_mark = byte_order_mark;
+  header.storage = index_bytes > 0 ? 1 : 0;
+  header.index_bytes = index_bytes;
+  header.rows = rows;
+  header.cols = cols;
+  header.nnz = nnz;
+
+  writer.write(&header, sizeof(header));
+
+  std::size_t offset = sections.stats;
+
+  for (const Eigen::VectorXd* stat : { &x_stats.getMeans(),
+                                       &x_stats.getM2(),
+                                       &x_stats.getAbsSums(),
+                                       &x_stats.getMinima(),
+                                       &x_stats.getMaxima() }) {
+    writer.padTo(offset);
+    writer.write(stat->data(), cols * sizeof(double));
+    offset = aligned(offset + cols * sizeof(double));
+  }
+
+  writer.padTo(sections.matrix);
+}
+
+} // namespace
+
+MappedMatrix::MappedMatrix(const std::string& file)
+{
+#ifdef _WIN32
+  HANDLE handle = CreateFileA(file.c_str(),
+                              GENERIC_READ,
+                              FILE_SHARE_READ,
+                              nullptr,
+                              OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+
+  if (handle == INVALID_HANDLE_VALUE) {
+    throw std::runtime_error("Could not open " + file);
+  }
+
+  LARGE_INTEGER file_size;
+
+  if (!GetFileSizeEx(handle, &file_size)) {
+    CloseHandle(handle);
+    throw std::runtime_error("Could not determine the size of " + file);
+  }
+
+  size = static_cast<std::size_t>(file_size.QuadPart);
+
+  HANDLE mapping =
+    size > 0
+      ? CreateFileMappingA(handle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr)
+      : nullptr;
+
+  CloseHandle(handle);
+
+  if (mapping == nullptr) {
+    throw std::runtime_error("Could not map " + file);
+  }
+
+  data = static_cast<char*>(MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0));
+
+  CloseHandle(mapping);
+
+  if (data == nullptr) {
+    throw std::runtime_error("Could not map " + file);
+  }
+#else
+  const int fd = open(file.c_str(), O_RDONLY);
+
+  if (fd < 0) {
+    throw std::runtime_error("Could not open " + file);
+  }
+
+  struct stat file_stat;
+
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    throw std::runtime_error("Could not determine the size of " + file);
+  }
+
+  size = static_cast<std::size_t>(file_stat.st_size);
+
+  // Private mappings are copy-on-write, which allows the matrix to be
+  // modified even though the file is only opened for reading
+  void* mapped =
+    size > 0
+      ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0)
+      : MAP_FAILED;
+
+  close(fd);
+
+  if (mapped == MAP_FAILED) {
+    throw std::runtime_error("Could not map " + file);
+  }
+
+  data = static_cast<char*>(mapped);
+#endif
+
+  try {
+    if (size < header_size) {
+      throw std::runtime_error(file + " is not a matrix file");
+    }
+
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0) {
+      throw std::runtime_error(file + " is not a matrix file");
+    }
+
+    if (header.byte_order_mark != byte_order_mark) {
+      throw std::runtime_error(file + " was written with another byte order");
+    }
+
+    if (header.version != version) {
+      throw std::runtime_error(file + " has an unsupported format version");
+    }
+
+    const bool valid_storage =
+      (header.storage == 0 && header.index_bytes == 0) ||
+      (header.storage == 1 && header.index_bytes == sizeof(int));
+
+    if (!valid_storage || header.rows < 0 || header.cols < 0 ||
+        header.nnz < 0) {
+      throw std::runtime_error(file + " has an invalid header");
+    }
+
+    if (header.storage == 1 &&
+        std::max({ header.rows, header.cols, header.nnz }) >
+          std::numeric_limits<int>::max()) {
+      throw std::runtime_error(file + " is too large for 32-bit indices");
+    }
+
+    n_rows = header.rows;
+    n_cols = header.cols;
+    nnz = header.nnz;
+    index_bytes = header.index_bytes;
+
+    const Layout sections = layout(n_rows, n_cols, nnz, index_bytes);
+
+    if (size < sections.end) {
+      throw std::runtime_error(file + " is truncated");
+    }
+
+    matrix_offset = sections.matrix;
+
+    if (isSparse()) {
+      checkSparseIndices(file);
+    }
+
+    std::vector<Eigen::VectorXd> stats;
+    std::size_t offset = sections.stats;
+
+    for (int k = 0; k < 5; ++k) {
+      stats.emplace_back(Eigen::Map<const Eigen::VectorXd>(
+        reinterpret_cast<const double*>(data + offset), n_cols));
+      offset = aligned(offset + n_cols * sizeof(double));
+    }
+
+    x_stats = ColumnStatistics(static_cast<int>(n_rows),
+                               static_cast<double>(n_rows),
+                               std::move(stats[0]),
+                               std::move(stats[1]),
+                               std::move(stats[2]),
+                               std::move(stats[3]),
+                               std::move(stats[4]));
+  } catch (...) {
+    unmap();
+    throw;
+  }
+}
+
+MappedMatrix::~MappedMatrix()
+{
+  unmap();
+}
+
+MappedMatrix::MappedMatrix(MappedMatrix&& other) noexcept
+  : data(std::exchange(other.data, nullptr))
+  , size(std::exchange(other.size, 0))
+  , n_rows(other.n_rows)
+  , n_cols(other.n_cols)
+  , nnz(other.nnz)
+  , index_bytes(other.index_bytes)
+  , matrix_offset(other.matrix_offset)
+  , x_stats(std::move(other.x_stats))
+{
+}
+
+MappedMatrix&
+MappedMatrix::operator=(MappedMatrix&& other) noexcept
+{
+  if (this != &other) {
+    unmap();
+
+    data = std::exchange(other.data, nullptr);
+    size = std::exchange(other.size, 0);
+    n_rows = other.n_rows;
+    n_cols = other.n_cols;
+    nnz = other.nnz;
+    index_bytes = other.index_bytes;
+    matrix_offset = other.matrix_offset;
+    x_stats = std::move(other.x_stats);
+  }
+
+  return *this;
+}
+
+void
+MappedMatrix::unmap() noexcept
+{
+  if (data == nullptr) {
+    return;
+  }
+
+#ifdef _WIN32
+  UnmapViewOfFile(data);
+#else
+  munmap(data, size);
+#endif
+
+  data = nullptr;
+  size = 0;
+}
+
+Eigen::Map<Eigen::MatrixXd>
+MappedMatrix::dense()
+{
+  if (isSparse()) {
+    throw std::runtime_error("The mapped matrix is sparse");
+  }
+
+  return { reinterpret_cast<double*>(data + matrix_offset), n_rows, n_cols };
+}
+
+void
+MappedMatrix::checkSparseIndices(const std::string& file) const
+{
+  const Layout sections = layout(n_rows, n_cols, nnz, index_bytes);
+
+  const int* outer = reinterpret_cast<const int*>(data + sections.matrix);
+  const int* inner = reinterpret_cast<const int*>(data + sections.inner);
+
+  if (outer[0] != 0 || outer[n_cols] != nnz) {
+    throw std::runtime_error(file + " has invalid column offsets");
+  }
+
+  for (Eigen::Index j = 0; j < n_cols; ++j) {
+    if (outer[j + 1] < outer[j]) {
+      throw std::runtime_error(file + " has invalid column offsets");
+    }
+
+    // Strictly increasing within each column, as Eigen expects
+    for (int k = outer[j]; k < outer[j + 1]; ++k) {
+      if (inner[k] < 0 || inner[k] >= n_rows ||
+          (k > outer[j] && inner[k] <= inner[k - 1])) {
+        throw std::runtime_error(file + " has invalid row indices");
+      }
+    }
+  }
+}
+
+Eigen::Map<Eigen::SparseMatrix<double>>
+MappedMatrix::sparse()
+{
+  if (!isSparse()) {
+    throw std::runtime_error("The mapped matrix is dense");
+  }
+
+  const Layout sections = layout(n_rows, n_cols, nnz, index_bytes);
+
+  return { n_rows,
+           n_cols,
+           static_cast<Eigen::Index>(nnz),
+           reinterpret_cast<int*>(data + sections.matrix),
+           reinterpret_cast<int*>(data + sections.inner),
+           reinterpret_cast<double*>(data + sections.values) };
+}
+
+void
+writeMappedMatrix(const std::string& file, const Eigen::MatrixXd& x)
+{
+  const Layout sections = layout(x.rows(), x.cols(), x.size(), 0);
+
+  ColumnStatistics x_stats(x.cols());
+  x_stats.update(x);
+
+  Writer writer(file);
+
+  writeHeaderAndStatistics(
+    writer, sections, x.rows(), x.cols(), x.size(), 0, x_stats);
+
+  writer.write(x.data(), x.size() * sizeof(double));
+
+  writer.finish(file);
+}
+
+void
+writeMappedMatrix(const std::string& file,
+                  const Eigen::SparseMatrix<double>& x_in)
+{
+  Eigen::SparseMatrix<double> x = x_in;
+  x.makeCompressed();
+
+  const std::int64_t nnz = x.nonZeros();
+  const int index_bytes = sizeof(int);
+  const Layout sections = layout(x.rows(), x.cols(), nnz, index_bytes);
+
+  ColumnStatistics x_stats(x.cols());
+  x_stats.update(x);
+
+  Writer writer(file);
+
+  writeHeaderAndStatistics(
+    writer, sections, x.rows(), x.cols(), nnz, index_bytes, x_stats);
+
+  writer.write(x.outerIndexPtr(), (x.cols() + 1) * index_bytes);
+  writer.padTo(sections.inner);
+  writer.write(x.innerIndexPtr(), nnz * index_bytes);
+  writer.padTo(sections.values);
+  writer.write(x.valuePtr(), nnz * sizeof(double));
+
+  writer.finish(file);
+}
+
+} // namespace slope
@@ -30,30 +30,30 @@ softmax(const Eigen::MatrixXd& eta)
     .min(constants::P_MAX);
 }
 
-std::vector<int>
-setUnion(const std::vector<int>& a, const std::vector<int>& b)
+std::vector<IndexType>
+setUnion(const std::vector<IndexType>& a, const std::vector<IndexType>& b)
 {
   assert(std::is_sorted(a.begin(), a.end()) &&
          "First argument to setUnion must be sorted");
   assert(std::is_sorted(b.begin(), b.end()) &&
          "Second argument to setUnion must be sorted");
 
-  std::vector<int> out;
+  std::vector<IndexType> out;
   std::set_union(
     a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
 
   return out;
 }
 
-std::vector<int>
-setDiff(const std::vector<int>& a, const std::vector<int>& b)
+std::vector<IndexType>
+setDiff(const std::vector<IndexType>& a, const std::vector<IndexType>& b)
 {
   assert(std::is_sorted(a.begin(), a.end()) &&
          "First argument to setDiff must be sorted");
   assert(std::is_sorted(b.begin(), b.end()) &&
          "Second argument to setDiff must be sorted");
 
-  std::vector<int> out;
+  std::vector<IndexType> out;
   std::set_difference(
     a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
 
@@ -2,6 +2,51 @@
 
 namespace slope {
 
+bool
+usesColumnStatistics(const std::string& centering_type,
+                     const std::string& scaling_type)
+{
+  auto given = [](const std::string& type) {
+    return type == "none" || type == "manual";
+  };
+
+  return !given(centering_type) || !given(scaling_type);
+}
+
+JitNormalization
+normalize(const ColumnStatistics& x_stats,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type)
+{
+  x_stats.centers(x_centers, centering_type);
+  x_stats.scales(x_scales, scaling_type);
+
+  // Handle zero-variance columns by setting their scale to 1.0
+  // to avoid division by zero during normalization
+  if (scaling_type != "none" && scaling_type != "manual") {
+    for (int j = 0; j < x_scales.size(); ++j) {
+      if (std::abs(x_scales(j)) == 0.0) {
+        x_scales(j) = 1.0;
+      }
+    }
+  }
+
+  bool center = centering_type != "none";
+  bool scale = scaling_type != "none";
+
+  if (center && scale) {
+    return JitNormalization::Both;
+  } else if (center) {
+    return JitNormalization::Center;
+  } else if (scale) {
+    return JitNormalization::Scale;
+  }
+
+  return JitNormalization::None;
+}
+
 std::tuple<Eigen::VectorXd, Eigen::MatrixXd>
 rescaleCoefficients(const Eigen::VectorXd& beta0,
                     const Eigen::SparseMatrix<double>& beta,
@@ -42,4 +87,28 @@ rescaleCoefficients(const Eigen::VectorXd& beta0,
   return { beta0_out, beta_out };
 }
 
+std::tuple<Eigen::VectorXd, Eigen::MatrixXd>
+normalizeCoefficients(const Eigen::VectorXd& beta0,
+                      const Eigen::MatrixXd& beta,
+                      const Eigen::VectorXd& x_centers,
+                      const Eigen::VectorXd& x_scales,
+                      const bool intercept)
+{
+  bool centering = x_centers.size() > 0;
+  bool scaling = x_scales.size() > 0;
+
+  Eigen::VectorXd beta0_out = beta0;
+  Eigen::MatrixXd beta_out = beta;
+
+  if (intercept && centering) {
+    beta0_out += beta.transpose() * x_centers;
+  }
+
+  if (scaling) {
+    beta_out.array().colwise() *= x_scales.array();
+  }
+
+  return { beta0_out, beta_out };
+}
+
 } // namespace slope
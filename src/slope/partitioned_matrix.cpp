@@ -0,0 +1,425 @@
+#include <algorithm>
+#include <slope/normalize.h>
+#include <slope/partitioned_matrix.h>
+#include <slope/threads.h>
+#include <slope/utils.h>
+#include <stdexcept>
+#include <tuple>
+
+namespace slope {
+
+namespace {
+
+/**
+ * The center and scale of a column under a type of just-in-time
+ * normalization, with a center of zero or a scale of one if the column is
+ * not centered or scaled
+ */
+std::pair<double, double>
+centerAndScale(const int j,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const JitNormalization jit_normalization)
+{
+  const bool center = jit_normalization == JitNormalization::Both ||
+                      jit_normalization == JitNormalization::Center;
+  const bool scale = jit_normalization == JitNormalization::Both ||
+                     jit_normalization == JitNormalization::Scale;
+
+  return { center ? x_centers(j) : 0.0, scale ? x_scales(j) : 1.0 };
+}
+
+void
+checkDensity(const double max_sparse_density)
+{
+  if (!(max_sparse_density >= 0 && max_sparse_density <= 1)) {
+    throw std::invalid_argument("max_sparse_density must be in [0, 1]");
+  }
+}
+
+Eigen::SparseMatrix<double>
+selectColumns(const Eigen::SparseMatrix<double>& x,
+              const std::vector<int>& columns)
+{
+  std::vector<Eigen::Triplet<double>> triplets;
+
+  for (size_t i = 0; i < columns.size(); ++i) {
+    for (Eigen::SparseMatrix<double>::InnerIterator it(x, columns[i]); it;
+         ++it) {
+      triplets.emplace_back(it.row(), i, it.value());
+    }
+  }
+
+  Eigen::SparseMatrix<double> out(x.rows(), columns.size());
+  out.setFromTriplets(triplets.begin(), triplets.end());
+
+  return out;
+}
+
+} // namespace
+
+PartitionedMatrix::PartitionedMatrix(Eigen::MatrixXd dense_in,
+                                     Eigen::SparseMatrix<double> sparse_in)
+  : dense(std::move(dense_in))
+  , sparse(std::move(sparse_in))
+{
+  // A part without columns takes the number of rows of the other one
+  if (dense.cols() == 0) {
+    dense.resize(sparse.rows(), 0);
+  } else if (sparse.cols() == 0) {
+    sparse.resize(dense.rows(), 0);
+  }
+
+  if (dense.rows() != sparse.rows()) {
+    throw std::invalid_argument(
+      "The dense and sparse parts must have the same number of rows");
+  }
+
+  sparse.makeCompressed();
+
+  std::vector<bool> dense_mask(dense.cols() + sparse.cols(), false);
+  std::fill(dense_mask.begin(), dense_mask.begin() + dense.cols(), true);
+
+  setColumns(dense_mask);
+  x_stats = computeStatistics(Eigen::VectorXd());
+}
+
+PartitionedMatrix::PartitionedMatrix(const Eigen::SparseMatrix<double>& x,
+                                     const double max_sparse_density)
+{
+  checkDensity(max_sparse_density);
+
+  const int n = x.rows();
+  const int p = x.cols();
+
+  std::vector<bool> dense_mask(p);
+
+  for (int j = 0; j < p; ++j) {
+    const int nnz = x.outerIndexPtr()[j + 1] - x.outerIndexPtr()[j];
+    dense_mask[j] = n > 0 && nnz > max_sparse_density * n;
+  }
+
+  setColumns(dense_mask);
+
+  dense.resize(n, dense_columns.size());
+
+  for (size_t i = 0; i < dense_columns.size(); ++i) {
+    dense.col(i) = x.col(dense_columns[i]);
+  }
+
+  sparse = selectColumns(x, sparse_columns);
+  x_stats = computeStatistics(Eigen::VectorXd());
+}
+
+PartitionedMatrix::PartitionedMatrix(const Eigen::MatrixXd& x,
+                                     const double max_sparse_density)
+{
+  checkDensity(max_sparse_density);
+
+  const int n = x.rows();
+  const int p = x.cols();
+
+  std::vector<bool> dense_mask(p);
+
+  for (int j = 0; j < p; ++j) {
+    const int nnz = (x.col(j).array() != 0).count();
+    dense_mask[j] = n > 0 && nnz > max_sparse_density * n;
+  }
+
+  setColumns(dense_mask);
+
+  dense = x(Eigen::all, dense_columns);
+  sparse = x(Eigen::all, sparse_columns).sparseView();
+  sparse.makeCompressed();
+  x_stats = computeStatistics(Eigen::VectorXd());
+}
+
+void
+PartitionedMatrix::setColumns(const std::vector<bool>& dense_mask)
+{
+  is_dense = dense_mask;
+  local_indices.resize(dense_mask.size());
+
+  for (size_t j = 0; j < dense_mask.size(); ++j) {
+    std::vector<int>& part = dense_mask[j] ? dense_columns : sparse_columns;
+
+    local_indices[j] = part.size();
+    part.emplace_back(j);
+  }
+}
+
+Eigen::VectorXd
+PartitionedMatrix::col(const Eigen::Index j) const
+{
+  return withColumn(j, [](const auto& x_j) { return Eigen::VectorXd(x_j); });
+}
+
+ColumnStatistics
+PartitionedMatrix::computeStatistics(const Eigen::VectorXd& w) const
+{
+  const int n = rows();
+  const int p = cols();
+  const bool weighted = w.size() > 0;
+
+  ColumnStatistics dense_stats(dense.cols());
+  ColumnStatistics sparse_stats(sparse.cols());
+
+  if (weighted) {
+    dense_stats.update(dense, w);
+    sparse_stats.update(sparse, w);
+  } else {
+    dense_stats.update(dense);
+    sparse_stats.update(sparse);
+  }
+
+  Eigen::VectorXd mean(p), m2(p), abs_sum(p), min(p), max(p);
+
+  auto scatter = [&](const ColumnStatistics& stats,
+                     const std::vector<int>& columns) {
+    mean(columns) = stats.getMeans();
+    m2(columns) = stats.getM2();
+    abs_sum(columns) = stats.getAbsSums();
+    min(columns) = stats.getMinima();
+    max(columns) = stats.getMaxima();
+  };
+
+  scatter(dense_stats, dense_columns);
+  scatter(sparse_stats, sparse_columns);
+
+  return ColumnStatistics(n,
+                          weighted ? w.sum() : static_cast<double>(n),
+                          std::move(mean),
+                          std::move(m2),
+                          std::move(abs_sum),
+                          std::move(min),
+                          std::move(max));
+}
+
+Eigen::MatrixXd
+linearPredictor(const PartitionedMatrix& x,
+                const std::vector<IndexType>& active_set,
+                const Eigen::VectorXd& beta0,
+                const Eigen::VectorXd& beta,
+                const Eigen::VectorXd& x_centers,
+                const Eigen::VectorXd& x_scales,
+                const JitNormalization jit_normalization,
+                const bool intercept)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+  const int m = beta0.size();
+
+  Eigen::MatrixXd eta = Eigen::MatrixXd::Zero(n, m);
+  Eigen::ArrayXd shift = Eigen::ArrayXd::Zero(m);
+
+  for (IndexType ind : active_set) {
+    const int k = ind / p;
+    const int j = ind % p;
+    auto [center, scale] =
+      centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+    const double b = beta(ind) / scale;
+
+    x.withColumn(j, [&](const auto& x_j) { eta.col(k) += x_j * b; });
+    shift(k) += b * center;
+  }
+
+  for (int k = 0; k < m; ++k) {
+    eta.col(k).array() -= shift(k) - (intercept ? beta0(k) : 0.0);
+  }
+
+  return eta;
+}
+
+void
+updateGradient(Eigen::VectorXd& gradient,
+               const PartitionedMatrix& x,
+               const Eigen::MatrixXd& residual,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const Eigen::VectorXd& w,
+               const JitNormalization jit_normalization)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+
+  Eigen::MatrixXd weighted_residual = w.asDiagonal() * residual;
+  Eigen::VectorXd wr_sums = weighted_residual.colwise().sum();
+
+#ifdef _OPENMP
+  bool large_problem =
+    active_set.size() > 100 && static_cast<double>(n) * p > 1e5;
+#pragma omp parallel for num_threads(Threads::get()) if (large_problem)
+#endif
+  for (IndexType a = 0; a < static_cast<IndexType>(active_set.size()); ++a) {
+    const IndexType ind = active_set[a];
+    const int k = ind / p;
+    const int j = ind % p;
+    auto [center, scale] =
+      centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+    const double x_wr = x.withColumn(j, [&](const auto& x_j) {
+      return x_j.dot(weighted_residual.col(k));
+    });
+
+    gradient(ind) = (x_wr - center * wr_sums(k)) / (scale * n);
+  }
+}
+
+void
+offsetGradient(Eigen::VectorXd& gradient,
+               const PartitionedMatrix& x,
+               const Eigen::VectorXd& offset,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const JitNormalization jit_normalization,
+               const Eigen::VectorXd& w)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+
+  for (IndexType ind : active_set) {
+    const int k = ind / p;
+    const int j = ind % p;
+    auto [center, scale] =
+      centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+    const double x_sum = x.withColumn(j, [&](const auto& x_j) {
+      return w.size() > 0 ? x_j.dot(w) : x_j.sum();
+    });
+
+    gradient(ind) -= offset(k) * (x_sum / n - center) / scale;
+  }
+}
+
+std::pair<double, double>
+computeGradientAndHessian(const PartitionedMatrix& x,
+                          const IndexType ind,
+                          const Eigen::MatrixXd& w,
+                          const Eigen::MatrixXd& residual,
+                          const Eigen::VectorXd& x_centers,
+                          const Eigen::VectorXd& x_scales,
+                          const double s,
+                          const JitNormalization jit_normalization,
+                          const int n)
+{
+  const int p = x.cols();
+  const int k = ind / p;
+  const int j = ind % p;
+  auto [center, scale] =
+    centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+  auto [x_wr, x_w, x2_w] = x.withColumn(j, [&](const auto& x_j) {
+    return std::make_tuple(
+      x_j.dot(w.col(k).cwiseProduct(residual.col(k))),
+      x_j.dot(w.col(k)),
+      x_j.cwiseAbs2().dot(w.col(k)));
+  });
+
+  const double gradient =
+    s * (x_wr - w.col(k).dot(residual.col(k)) * center) / (n * scale);
+  const double hessian =
+    (x2_w - 2 * center * x_w + center * center * w.col(k).sum()) /
+    (scale * scale * n);
+
+  return { gradient, hessian };
+}
+
+std::pair<double, double>
+computeClusterGradientAndHessian(const PartitionedMatrix& x,
+                                 const IndexType c_ind,
+                                 const std::vector<int>& s,
+                                 const Clusters& clusters,
+                                 const Eigen::MatrixXd& w,
+                                 const Eigen::MatrixXd& residual,
+                                 const Eigen::VectorXd& x_centers,
+                                 const Eigen::VectorXd& x_scales,
+                                 const JitNormalization jit_normalization)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+  const int m = residual.cols();
+
+  Eigen::MatrixXd x_s = Eigen::MatrixXd::Zero(n, m);
+  Eigen::ArrayXd shift = Eigen::ArrayXd::Zero(m);
+
+  auto s_it = s.cbegin();
+  auto c_it = clusters.cbegin(c_ind);
+
+  for (; c_it != clusters.cend(c_ind); ++c_it, ++s_it) {
+    const int k = *c_it / p;
+    const int j = *c_it % p;
+    auto [center, scale] =
+      centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+    const double v = *s_it / scale;
+
+    x.withColumn(j, [&](const auto& x_j) { x_s.col(k) += x_j * v; });
+    shift(k) += center * v;
+  }
+
+  double hess = 0;
+  double grad = 0;
+
+  for (int k = 0; k < m; ++k) {
+    x_s.col(k).array() -= shift(k);
+
+    hess += x_s.col(k).cwiseAbs2().dot(w.col(k)) / n;
+    grad += x_s.col(k).cwiseProduct(w.col(k)).dot(residual.col(k)) / n;
+  }
+
+  return { hess, grad };
+}
+
+Eigen::MatrixXd
+operator*(const PartitionedMatrix& x, const Eigen::SparseMatrix<double>& b)
+{
+  Eigen::MatrixXd out = Eigen::MatrixXd::Zero(x.rows(), b.cols());
+
+  for (int k = 0; k < b.outerSize(); ++k) {
+    for (Eigen::SparseMatrix<double>::InnerIterator it(b, k); it; ++it) {
+      const double v = it.value();
+      x.withColumn(it.row(), [&](const auto& x_j) { out.col(k) += x_j * v; });
+    }
+  }
+
+  return out;
+}
+
+JitNormalization
+normalize(PartitionedMatrix& x,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool)
+{
+  return normalize(
+    x.statistics(), x_centers, x_scales, centering_type, scaling_type);
+}
+
+JitNormalization
+normalize(PartitionedMatrix& x,
+          const Eigen::VectorXd& w,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool)
+{
+  return normalize(x.computeStatistics(w),
+                   x_centers,
+                   x_scales,
+                   centering_type,
+                   scaling_type);
+}
+
+bool
+isFinite(const PartitionedMatrix& x)
+{
+  return isFinite(x.getDense()) && isFinite(x.getSparse());
+}
+
+} // namespace slope
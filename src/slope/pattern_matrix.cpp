@@ -0,0 +1,386 @@
+#include <slope/normalize.h>
+#include <slope/pattern_matrix.h>
+#include <slope/threads.h>
+#include <stdexcept>
+
+namespace slope {
+
+namespace {
+
+/**
+ * The center and scale of a column under a type of just-in-time
+ * normalization, with a center of zero or a scale of one if the column is
+ * not centered or scaled
+ */
+std::pair<double, double>
+centerAndScale(const int j,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const JitNormalization jit_normalization)
+{
+  const bool center = jit_normalization == JitNormalization::Both ||
+                      jit_normalization == JitNormalization::Center;
+  const bool scale = jit_normalization == JitNormalization::Both ||
+                     jit_normalization == JitNormalization::Scale;
+
+  return { center ? x_centers(j) : 0.0, scale ? x_scales(j) : 1.0 };
+}
+
+/**
+ * Statistics of the columns of a pattern matrix, which follow from the
+ * (weighted) number of ones in each column, with frequency weights as in
+ * ColumnStatistics. An empty vector means unit weights.
+ */
+ColumnStatistics
+patternStatistics(const PatternMatrix& x, const Eigen::VectorXd& w)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+  const bool weighted = w.size() > 0;
+
+  const double w_sum = weighted ? w.sum() : n;
+  const int n_included = weighted ? (w.array() > 0).count() : n;
+
+  Eigen::VectorXd mean(p), m2(p), abs_sum(p), min(p), max(p);
+
+  for (int j = 0; j < p; ++j) {
+    double ones = 0;
+    int ones_included = 0;
+
+    x.forEachRow(j, [&](const int i) {
+      const double w_i = weighted ? w(i) : 1.0;
+      ones += w_i;
+      ones_included += w_i > 0;
+    });
+
+    mean(j) = w_sum > 0 ? ones / w_sum : 0.0;
+    m2(j) = ones * (1 - mean(j)) * (1 - mean(j)) +
+            (w_sum - ones) * mean(j) * mean(j);
+    abs_sum(j) = ones;
+    min(j) = ones_included < n_included ? 0.0 : 1.0;
+    max(j) = ones_included > 0 ? 1.0 : 0.0;
+  }
+
+  return ColumnStatistics(n,
+                          w_sum,
+                          std::move(mean),
+                          std::move(m2),
+                          std::move(abs_sum),
+                          std::move(min),
+                          std::move(max));
+}
+
+} // namespace
+
+PatternMatrix::PatternMatrix(const Eigen::SparseMatrix<double>& x)
+  : n_rows(x.rows())
+{
+  outer_starts.reserve(x.cols() + 1);
+  inner_indices.reserve(x.nonZeros());
+
+  outer_starts.emplace_back(0);
+
+  for (int j = 0; j < x.outerSize(); ++j) {
+    for (Eigen::SparseMatrix<double>::InnerIterator it(x, j); it; ++it) {
+      if (it.value() == 1) {
+        inner_indices.emplace_back(it.row());
+      } else if (it.value() != 0) {
+        throw std::invalid_argument(
+          "All stored values of x must be zero or one");
+      }
+    }
+
+    outer_starts.emplace_back(inner_indices.size());
+  }
+
+  computeStatistics();
+}
+
+PatternMatrix::PatternMatrix(const int n,
+                             const int p,
+                             std::vector<int> outer_starts_in,
+                             std::vector<int> inner_indices_in)
+  : n_rows(n)
+  , outer_starts(std::move(outer_starts_in))
+  , inner_indices(std::move(inner_indices_in))
+{
+  if (n < 0 || p < 0) {
+    throw std::invalid_argument("The dimensions must be non-negative");
+  }
+
+  if (static_cast<int>(outer_starts.size()) != p + 1 ||
+      outer_starts.front() != 0 ||
+      outer_starts.back() != static_cast<int>(inner_indices.size())) {
+    throw std::invalid_argument(
+      "outer_starts must have p + 1 elements, from 0 to the number of ones");
+  }
+
+  for (int j = 0; j < p; ++j) {
+    if (outer_starts[j + 1] < outer_starts[j]) {
+      throw std::invalid_argument("outer_starts must be non-decreasing");
+    }
+  }
+
+  for (int i : inner_indices) {
+    if (i < 0 || i >= n) {
+      throw std::invalid_argument("inner_indices must be rows of the matrix");
+    }
+  }
+
+  computeStatistics();
+}
+
+Eigen::SparseVector<double>
+PatternMatrix::col(const Eigen::Index j) const
+{
+  Eigen::SparseVector<double> out(n_rows);
+  out.reserve(outer_starts[j + 1] - outer_starts[j]);
+
+  forEachRow(j, [&](const int i) { out.insert(i) = 1.0; });
+
+  return out;
+}
+
+Eigen::SparseMatrix<double>
+PatternMatrix::toSparse() const
+{
+  std::vector<Eigen::Triplet<double>> triplets;
+  triplets.reserve(nonZeros());
+
+  for (int j = 0; j < cols(); ++j) {
+    forEachRow(j, [&](const int i) { triplets.emplace_back(i, j, 1.0); });
+  }
+
+  Eigen::SparseMatrix<double> out(rows(), cols());
+  out.setFromTriplets(triplets.begin(), triplets.end());
+
+  return out;
+}
+
+void
+PatternMatrix::computeStatistics()
+{
+  x_stats = patternStatistics(*this, Eigen::VectorXd());
+}
+
+Eigen::MatrixXd
+linearPredictor(const PatternMatrix& x,
+                const std::vector<IndexType>& active_set,
+                const Eigen::VectorXd& beta0,
+                const Eigen::VectorXd& beta,
+                const Eigen::VectorXd& x_centers,
+                const Eigen::VectorXd& x_scales,
+                const JitNormalization jit_normalization,
+                const bool intercept)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+  const int m = beta0.size();
+
+  Eigen::MatrixXd eta = Eigen::MatrixXd::Zero(n, m);
+  Eigen::ArrayXd shift = Eigen::ArrayXd::Zero(m);
+
+  for (IndexType ind : active_set) {
+    auto [k, j] = splitIndex(ind, p);
+    auto [center, scale] =
+      centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+    const double b = beta(ind) / scale;
+
+    x.forEachRow(j, [&](const int i) { eta(i, k) += b; });
+    shift(k) += b * center;
+  }
+
+  for (int k = 0; k < m; ++k) {
+    eta.col(k).array() -= shift(k) - (intercept ? beta0(k) : 0.0);
+  }
+
+  return eta;
+}
+
+void
+updateGradient(Eigen::VectorXd& gradient,
+               const PatternMatrix& x,
+               const Eigen::MatrixXd& residual,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const Eigen::VectorXd& w,
+               const JitNormalization jit_normalization)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+
+  Eigen::MatrixXd weighted_residual = w.asDiagonal() * residual;
+  Eigen::VectorXd wr_sums = weighted_residual.colwise().sum();
+
+#ifdef _OPENMP
+  bool large_problem = active_set.size() > 100 && x.nonZeros() > 1e5;
+#pragma omp parallel for num_threads(Threads::get()) if (large_problem)
+#endif
+  for (IndexType a = 0; a < static_cast<IndexType>(active_set.size()); ++a) {
+    IndexType ind = active_set[a];
+    auto [k, j] = splitIndex(ind, p);
+    auto [center, scale] =
+      centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+    double sum = 0;
+    x.forEachRow(j, [&](const int i) { sum += weighted_residual(i, k); });
+
+    gradient(ind) = (sum - center * wr_sums(k)) / (scale * n);
+  }
+}
+
+void
+offsetGradient(Eigen::VectorXd& gradient,
+               const PatternMatrix& x,
+               const Eigen::VectorXd& offset,
+               const std::vector<IndexType>& active_set,
+               const Eigen::VectorXd& x_centers,
+               const Eigen::VectorXd& x_scales,
+               const JitNormalization jit_normalization,
+               const Eigen::VectorXd& w)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+
+  for (IndexType ind : active_set) {
+    auto [k, j] = splitIndex(ind, p);
+    auto [center, scale] =
+      centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+    double ones = 0;
+    x.forEachRow(j, [&](const int i) { ones += w.size() > 0 ? w(i) : 1.0; });
+
+    gradient(ind) -= offset(k) * (ones / n - center) / scale;
+  }
+}
+
+std::pair<double, double>
+computeGradientAndHessian(const PatternMatrix& x,
+                          const IndexType ind,
+                          const Eigen::MatrixXd& w,
+                          const Eigen::MatrixXd& residual,
+                          const Eigen::VectorXd& x_centers,
+                          const Eigen::VectorXd& x_scales,
+                          const double s,
+                          const JitNormalization jit_normalization,
+                          const int n)
+{
+  auto [k, j] = splitIndex(ind, static_cast<int>(x.cols()));
+  auto [center, scale] =
+    centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+  // Since the values are one, x^T w r and x^T w are sums, and x^2 = x
+  double wr_ones = 0;
+  double w_ones = 0;
+
+  x.forEachRow(j, [&](const int i) {
+    wr_ones += w(i, k) * residual(i, k);
+    w_ones += w(i, k);
+  });
+
+  const double gradient =
+    s * (wr_ones - w.col(k).dot(residual.col(k)) * center) / (n * scale);
+  const double hessian =
+    (w_ones - 2 * center * w_ones + center * center * w.col(k).sum()) /
+    (scale * scale * n);
+
+  return { gradient, hessian };
+}
+
+std::pair<double, double>
+computeClusterGradientAndHessian(const PatternMatrix& x,
+                                 const IndexType c_ind,
+                                 const std::vector<int>& s,
+                                 const Clusters& clusters,
+                                 const Eigen::MatrixXd& w,
+                                 const Eigen::MatrixXd& residual,
+                                 const Eigen::VectorXd& x_centers,
+                                 const Eigen::VectorXd& x_scales,
+                                 const JitNormalization jit_normalization)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+  const int m = residual.cols();
+
+  Eigen::MatrixXd x_s = Eigen::MatrixXd::Zero(n, m);
+  Eigen::ArrayXd shift = Eigen::ArrayXd::Zero(m);
+
+  auto s_it = s.cbegin();
+  auto c_it = clusters.cbegin(c_ind);
+
+  for (; c_it != clusters.cend(c_ind); ++c_it, ++s_it) {
+    auto [k, j] = splitIndex(*c_it, p);
+    auto [center, scale] =
+      centerAndScale(j, x_centers, x_scales, jit_normalization);
+
+    const double v = *s_it / scale;
+
+    x.forEachRow(j, [&, k = k](const int i) { x_s(i, k) += v; });
+    shift(k) += center * v;
+  }
+
+  double hess = 0;
+  double grad = 0;
+
+  for (int k = 0; k < m; ++k) {
+    x_s.col(k).array() -= shift(k);
+
+    hess += x_s.col(k).cwiseAbs2().dot(w.col(k)) / n;
+    grad += x_s.col(k).cwiseProduct(w.col(k)).dot(residual.col(k)) / n;
+  }
+
+  return { hess, grad };
+}
+
+Eigen::MatrixXd
+operator*(const PatternMatrix& x, const Eigen::SparseMatrix<double>& b)
+{
+  Eigen::MatrixXd out = Eigen::MatrixXd::Zero(x.rows(), b.cols());
+
+  for (int k = 0; k < b.outerSize(); ++k) {
+    for (Eigen::SparseMatrix<double>::InnerIterator it(b, k); it; ++it) {
+      const double v = it.value();
+      x.forEachRow(it.row(), [&](const int i) { out(i, k) += v; });
+    }
+  }
+
+  return out;
+}
+
+JitNormalization
+normalize(PatternMatrix& x,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool)
+{
+  return normalize(
+    x.statistics(), x_centers, x_scales, centering_type, scaling_type);
+}
+
+JitNormalization
+normalize(PatternMatrix& x,
+          const Eigen::VectorXd& w,
+          Eigen::VectorXd& x_centers,
+          Eigen::VectorXd& x_scales,
+          const std::string& centering_type,
+          const std::string& scaling_type,
+          const bool)
+{
+  return normalize(patternStatistics(x, w),
+                   x_centers,
+                   x_scales,
+                   centering_type,
+                   scaling_type);
+}
+
+bool
+isFinite(const PatternMatrix&)
+{
+  return true;
+}
+
+} // namespace slope
@@ -1,5 +1,7 @@
 #include "qnorm.h"
 #include <cassert>
+#include <cmath>
+#include <slope/constants.h>
 #include <slope/math.h>
 #include <slope/regularization_sequence.h>
 #include <slope/utils.h>
@@ -7,14 +9,30 @@
 namespace slope {
 
 Eigen::ArrayXd
-lambdaSequence(const int p,
+lambdaSequence(const IndexType p,
                const double q,
                const std::string& type,
                const int n,
                const double theta1,
                const double theta2)
 {
-  Eigen::ArrayXd lambda(p);
+  return lambdaSequenceHead(p, p, q, type, n, theta1, theta2);
+}
+
+Eigen::ArrayXd
+lambdaSequenceHead(const Eigen::Index length,
+                   const IndexType p,
+                   const double q,
+                   const std::string& type,
+                   const int n,
+                   const double theta1,
+                   const double theta2)
+{
+  if (length < 0 || length > p) {
+    throw std::invalid_argument("length must be between 0 and p");
+  }
+
+  Eigen::ArrayXd lambda(length);
 
   validateOption(type, { "bh", "gaussian", "oscar", "lasso" }, "type");
 
@@ -23,11 +41,11 @@ lambdaSequence(const int p,
       throw std::invalid_argument("q must be between 0 and 1");
     }
 
-    for (int j = 0; j < p; ++j) {
+    for (Eigen::Index j = 0; j < length; ++j) {
       lambda(j) = normalQuantile(1.0 - (j + 1.0) * q / (2.0 * p));
     }
 
-    if (type == "gaussian" && p > 1) {
+    if (type == "gaussian" && length > 1) {
       if (n <= 0) {
         throw std::invalid_argument(
           "n must be provided (and be positive) for type 'gaussian'");
@@ -35,7 +53,7 @@ lambdaSequence(const int p,
 
       double sum_sq = 0.0;
 
-      for (int i = 1; i < p; ++i) {
+      for (Eigen::Index i = 1; i < length; ++i) {
         sum_sq += std::pow(lambda(i - 1), 2);
         double w = 1.0 / std::max(1.0, static_cast<double>(n - i - 1.0));
 
@@ -43,7 +61,7 @@ lambdaSequence(const int p,
       }
 
       // Ensure non-increasing lambda
-      for (int i = 1; i < p; ++i) {
+      for (Eigen::Index i = 1; i < length; ++i) {
         if (lambda(i) > lambda(i - 1)) {
           lambda(i) = lambda(i - 1);
         }
@@ -56,18 +74,38 @@ lambdaSequence(const int p,
     if (theta2 < 0) {
       throw std::invalid_argument("theta2 must be non-negative");
     }
-    lambda = theta1 + theta2 * (p - Eigen::ArrayXd::LinSpaced(p, 1, p));
+    lambda = theta1 + theta2 * (static_cast<double>(p) -
+                                Eigen::ArrayXd::LinSpaced(length, 1, length));
   } else if (type == "lasso") {
     lambda.setOnes();
   }
 
-  assert(lambda.minCoeff() > 0 && "lambda must be positive");
+  assert((length == 0 || lambda.minCoeff() > 0) && "lambda must be positive");
   assert(lambda.allFinite() && "lambda must be finite");
-  assert(lambda.size() == p && "lambda sequence is of right size");
+  assert(lambda.size() == length && "lambda sequence is of right size");
 
   return lambda;
 }
 
+double
+lambdaSequenceMin(const double q, const std::string& type, const double theta1)
+{
+  validateOption(type, { "bh", "gaussian", "oscar", "lasso" }, "type");
+
+  if (type == "bh" || type == "gaussian") {
+    if (q <= 0 || q >= 1) {
+      throw std::invalid_argument("q must be between 0 and 1");
+    }
+
+    // The last value of the bh sequence, whatever its length
+    return normalQuantile(1.0 - q / 2.0);
+  } else if (type == "oscar") {
+    return theta1;
+  }
+
+  return 1.0;
+}
+
 Eigen::ArrayXd
 regularizationPath(const Eigen::ArrayXd& alpha_in,
                    const int path_length,
@@ -92,4 +130,66 @@ regularizationPath(const Eigen::ArrayXd& alpha_in,
   return alpha;
 }
 
+std::vector<int>
+alignPaths(const Eigen::ArrayXd& alpha,
+           const Eigen::ArrayXd& alpha_prev,
+           const double alpha_max)
+{
+  const int n_steps = alpha.size();
+  const int n_prev = alpha_prev.size();
+
+  std::vector<int> out(n_steps, -1);
+
+  if (n_prev == 0) {
+    return out;
+  }
+
+  const double tol = 1e-8;
+  const int n_common = std::min(n_steps, n_prev);
+
+  bool proportional = true;
+
+  for (int k = 0; k < n_common; ++k) {
+    double a = alpha(k) * alpha_prev(0);
+    double b = alpha_prev(k) * alpha(0);
+
+    if (std::abs(a - b) > tol * std::max(std::abs(a), std::abs(b))) {
+      proportional = false;
+      break;
+    }
+  }
+
+  double alpha_from = alpha_max;
+
+  for (int k = 0; k < n_steps; ++k) {
+    if (proportional && k < n_prev) {
+      out[k] = k;
+    } else if (alpha(k) > 0) {
+      double best_dist = constants::POS_INF;
+
+      for (int i = 0; i < n_prev; ++i) {
+        if (alpha_prev(i) > 0) {
+          double dist = std::abs(std::log(alpha_prev(i) / alpha(k)));
+          if (dist < best_dist) {
+            best_dist = dist;
+            out[k] = i;
+          }
+        }
+      }
+
+      double continuation_dist = alpha_from > 0
+                                   ? std::abs(std::log(alpha_from / alpha(k)))
+                                   : constants::POS_INF;
+
+      if (best_dist >= continuation_dist) {
+        out[k] = -1;
+      }
+    }
+
+    alpha_from = alpha(k);
+  }
+
+  return out;
+}
+
 } // namespace slope
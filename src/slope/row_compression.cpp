@@ -0,0 +1,66 @@
+#include <slope/row_compression.h>
+#include <unordered_map>
+
+namespace slope {
+namespace detail {
+
+void
+groupRows(const std::vector<std::size_t>& hashes,
+          const std::function<bool(int, int)>& equal,
+          std::vector<int>& unique_rows,
+          std::vector<int>& row_map,
+          Eigen::VectorXd& counts)
+{
+  const int n = hashes.size();
+
+  // Unique rows (indices into unique_rows) for each hash value, of which
+  // there is usually only one
+  std::unordered_map<std::size_t, std::vector<int>> buckets;
+  std::vector<int> row_counts;
+
+  unique_rows.clear();
+  row_map.resize(n);
+
+  for (int i = 0; i < n; ++i) {
+    std::vector<int>& bucket = buckets[hashes[i]];
+
+    int k = -1;
+
+    for (int candidate : bucket) {
+      if (equal(unique_rows[candidate], i)) {
+        k = candidate;
+        break;
+      }
+    }
+
+    if (k < 0) {
+      k = unique_rows.size();
+      bucket.emplace_back(k);
+      unique_rows.emplace_back(i);
+      row_counts.emplace_back(0);
+    }
+
+    row_counts[k]++;
+    row_map[i] = k;
+  }
+
+  counts = Eigen::Map<Eigen::VectorXi>(row_counts.data(), row_counts.size())
+             .cast<double>();
+}
+
+std::vector<std::size_t>
+hashRows(const Eigen::MatrixXd& y)
+{
+  std::vector<std::size_t> hashes(y.rows(), 0);
+
+  for (int k = 0; k < y.cols(); ++k) {
+    for (int i = 0; i < y.rows(); ++i) {
+      hashCombine(hashes[i], hashValue(y(i, k)));
+    }
+  }
+
+  return hashes;
+}
+
+} // namespace detail
+} // namespace slope
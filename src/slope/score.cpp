@@ -1,5 +1,7 @@
 #include <Eigen/Core>
+#include <algorithm>
 #include <memory>
+#include <numeric>
 #include <slope/constants.h>
 #include <slope/score.h>
 #include <vector>
@@ -99,6 +101,23 @@ Score::getComparator() const
   return [this](double a, double b) { return this->isWorse(a, b); };
 }
 
+Eigen::VectorXd
+Score::evalPath(const Eigen::MatrixXd& eta,
+                const Eigen::MatrixXd& y,
+                const std::unique_ptr<Loss>& loss) const
+{
+  const int m = y.cols();
+  const int n_steps = eta.cols() / m;
+
+  Eigen::VectorXd scores(n_steps);
+
+  for (int i = 0; i < n_steps; ++i) {
+    scores(i) = eval(eta.middleCols(i * m, m), y, loss);
+  }
+
+  return scores;
+}
+
 bool
 MinimizeScore::isWorse(double a, double b) const
 {
@@ -169,6 +188,26 @@ Deviance::eval(const Eigen::MatrixXd& eta,
   return loss->deviance(eta, y);
 }
 
+Eigen::VectorXd
+Deviance::evalPath(const Eigen::MatrixXd& eta,
+                   const Eigen::MatrixXd& y,
+                   const std::unique_ptr<Loss>& loss) const
+{
+  const int m = y.cols();
+  const int n_steps = eta.cols() / m;
+
+  const double saturated_loss = loss->loss(loss->link(y), y);
+
+  Eigen::VectorXd scores(n_steps);
+
+  for (int i = 0; i < n_steps; ++i) {
+    const double fitted_loss = loss->loss(eta.middleCols(i * m, m), y);
+    scores(i) = 2.0 * (fitted_loss - saturated_loss);
+  }
+
+  return scores;
+}
+
 double
 AUC::eval(const Eigen::MatrixXd& eta,
           const Eigen::MatrixXd& y,
@@ -178,6 +217,71 @@ AUC::eval(const Eigen::MatrixXd& eta,
   return rocAuc(probs, y);
 }
 
+Eigen::VectorXd
+AUC::evalPath(const Eigen::MatrixXd& eta,
+              const Eigen::MatrixXd& y,
+              const std::unique_ptr<Loss>& loss) const
+{
+  if (y.cols() > 1) {
+    return Score::evalPath(eta, y, loss);
+  }
+
+  const int n = y.rows();
+  const int n_steps = eta.cols();
+
+  const double pos_count = (y.array() > 0.5).count();
+  const double neg_count = n - pos_count;
+
+  if (pos_count == 0 || neg_count == 0) {
+    return Eigen::VectorXd::Constant(n_steps, 0.5);
+  }
+
+  // All steps in one pass, as a single column since the inverse link of a
+  // single-response loss is element-wise
+  const Eigen::MatrixXd probs_all = loss->inverseLink(eta.reshaped());
+  const auto probs = probs_all.reshaped(n, n_steps);
+
+  Eigen::VectorXd scores(n_steps);
+  std::vector<int> ord(n);
+
+  // The area under the ROC curve (with ties contributing half) is the
+  // Mann-Whitney U statistic: the rank sum of the positives, with ties given
+  // their average rank
+  for (int k = 0; k < n_steps; ++k) {
+    auto col = probs.col(k);
+
+    std::iota(ord.begin(), ord.end(), 0);
+    std::sort(ord.begin(), ord.end(), [&col](int a, int b) {
+      return col(a) < col(b);
+    });
+
+    double rank_sum = 0.0;
+
+    for (int i = 0; i < n;) {
+      int j = i;
+
+      while (j < n && col(ord[j]) == col(ord[i])) {
+        j++;
+      }
+
+      const double mid_rank = 0.5 * (i + j + 1);
+
+      for (int l = i; l < j; ++l) {
+        if (y(ord[l], 0) > 0.5) {
+          rank_sum += mid_rank;
+        }
+      }
+
+      i = j;
+    }
+
+    scores(k) = (rank_sum - 0.5 * pos_count * (pos_count + 1)) /
+                (pos_count * neg_count);
+  }
+
+  return scores;
+}
+
 std::unique_ptr<Score>
 Score::create(const std::string& metric)
 {
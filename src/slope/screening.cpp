@@ -16,7 +16,7 @@ namespace slope {
 typedef Eigen::Array<bool, Eigen::Dynamic, 1> ArrayXb;
 typedef Eigen::Array<bool, Eigen::Dynamic, Eigen::Dynamic> ArrayXXb;
 
-std::vector<int>
+std::vector<IndexType>
 activeSet(const Eigen::VectorXd& beta)
 {
   ArrayXb active = beta.array() != 0.0;
@@ -24,7 +24,7 @@ activeSet(const Eigen::VectorXd& beta)
   return which(active);
 }
 
-std::vector<int>
+std::vector<IndexType>
 strongSet(const Eigen::VectorXd& gradient_prev,
           const Eigen::ArrayXd& lambda,
           const Eigen::ArrayXd& lambda_prev)
@@ -32,7 +32,7 @@ strongSet(const Eigen::VectorXd& gradient_prev,
   using Eigen::VectorXd;
   using Eigen::VectorXi;
 
-  int pm = gradient_prev.size();
+  IndexType pm = gradient_prev.size();
 
   assert(lambda_prev.size() == lambda.size() &&
          "lambda_prev and lambda must have the same length");
@@ -40,15 +40,15 @@ strongSet(const Eigen::VectorXd& gradient_prev,
          "New lambda values must be smaller than or equal to previous values");
 
   const VectorXd abs_grad = gradient_prev.reshaped().cwiseAbs();
-  std::vector<int> ord = sortIndex(abs_grad, true);
+  std::vector<IndexType> ord = sortIndex(abs_grad, true);
 
   assert(abs_grad.size() == lambda.size());
 
   const VectorXd tmp =
     abs_grad(ord).array().eval() + lambda_prev - 2.0 * lambda;
 
-  int i = 0;
-  int k = 0;
+  IndexType i = 0;
+  IndexType k = 0;
 
   double s = 0;
 
@@ -74,18 +74,18 @@ strongSet(const Eigen::VectorXd& gradient_prev,
 }
 
 // NoScreening implementation
-std::vector<int>
-NoScreening::initialize(const std::vector<int>& full_set, int)
+std::vector<IndexType>
+NoScreening::initialize(const std::vector<IndexType>& full_set, IndexType)
 {
   return full_set;
 }
 
-std::vector<int>
+std::vector<IndexType>
 NoScreening::screen(Eigen::VectorXd&,
                     const Eigen::ArrayXd&,
                     const Eigen::ArrayXd&,
                     const Eigen::VectorXd&,
-                    const std::vector<int>& full_set)
+                    const std::vector<IndexType>& full_set)
 {
   // No screening - use all variables
   return full_set;
@@ -95,58 +95,13 @@ bool
 NoScreening::checkKktViolations(Eigen::VectorXd&,
                                 const Eigen::VectorXd&,
                                 const Eigen::ArrayXd&,
-                                std::vector<int>&,
-                                const Eigen::MatrixXd&,
-                                const Eigen::MatrixXd&,
-                                const Eigen::VectorXd&,
-                                const Eigen::VectorXd&,
-                                JitNormalization,
-                                const std::vector<int>&)
-{
-  return true;
-}
-
-bool
-NoScreening::checkKktViolations(Eigen::VectorXd&,
-                                const Eigen::VectorXd&,
-                                const Eigen::ArrayXd&,
-                                std::vector<int>&,
-                                const Eigen::SparseMatrix<double>&,
-                                const Eigen::MatrixXd&,
-                                const Eigen::VectorXd&,
-                                const Eigen::VectorXd&,
-                                JitNormalization,
-                                const std::vector<int>&)
-{
-  return true;
-}
-
-bool
-NoScreening::checkKktViolations(Eigen::VectorXd&,
-                                const Eigen::VectorXd&,
-                                const Eigen::ArrayXd&,
-                                std::vector<int>&,
-                                const Eigen::Map<Eigen::MatrixXd>&,
-                                const Eigen::MatrixXd&,
-                                const Eigen::VectorXd&,
-                                const Eigen::VectorXd&,
-                                JitNormalization,
-                                const std::vector<int>&)
-{
-  return true;
-}
-
-bool
-NoScreening::checkKktViolations(Eigen::VectorXd&,
-                                const Eigen::VectorXd&,
-                                const Eigen::ArrayXd&,
-                                std::vector<int>&,
-                                const Eigen::Map<Eigen::SparseMatrix<double>>&,
+                                std::vector<IndexType>&,
+                                const DesignRef&,
                                 const Eigen::MatrixXd&,
                                 const Eigen::VectorXd&,
                                 const Eigen::VectorXd&,
                                 JitNormalization,
-                                const std::vector<int>&)
+                                const std::vector<IndexType>&)
 {
   return true;
 }
@@ -158,18 +113,19 @@ NoScreening::toString() const
 }
 
 // StrongScreening implementation
-std::vector<int>
-StrongScreening::initialize(const std::vector<int>&, int alpha_max_ind)
+std::vector<IndexType>
+StrongScreening::initialize(const std::vector<IndexType>&,
+                            IndexType alpha_max_ind)
 {
   return { alpha_max_ind };
 }
 
-std::vector<int>
+std::vector<IndexType>
 StrongScreening::screen(Eigen::VectorXd& gradient,
                         const Eigen::ArrayXd& lambda_curr,
                         const Eigen::ArrayXd& lambda_prev,
                         const Eigen::VectorXd& beta,
-                        const std::vector<int>& full_set)
+                        const std::vector<IndexType>& full_set)
 {
 
   if (lambda_curr(0) == 0.0) {
@@ -177,7 +133,7 @@ StrongScreening::screen(Eigen::VectorXd& gradient,
     return full_set;
   }
 
-  std::vector<int> active_set = activeSet(beta);
+  std::vector<IndexType> active_set = activeSet(beta);
   strong_set = strongSet(gradient, lambda_curr, lambda_prev);
   strong_set = setUnion(strong_set, active_set);
 
@@ -190,13 +146,13 @@ bool
 StrongScreening::checkKktViolationsImpl(Eigen::VectorXd& gradient,
                                         const Eigen::VectorXd& beta,
                                         const Eigen::ArrayXd& lambda_curr,
-                                        std::vector<int>& working_set,
+                                        std::vector<IndexType>& working_set,
                                         const MatrixType& x,
                                         const Eigen::MatrixXd& residual,
                                         const Eigen::VectorXd& x_centers,
                                         const Eigen::VectorXd& x_scales,
                                         JitNormalization jit_normalization,
-                                        const std::vector<int>& full_set)
+                                        const std::vector<IndexType>& full_set)
 {
   // First check for violations in the strong set
   updateGradient(gradient,
@@ -239,97 +195,26 @@ bool
 StrongScreening::checkKktViolations(Eigen::VectorXd& gradient,
                                     const Eigen::VectorXd& beta,
                                     const Eigen::ArrayXd& lambda_curr,
-                                    std::vector<int>& working_set,
-                                    const Eigen::MatrixXd& x,
-                                    const Eigen::MatrixXd& residual,
-                                    const Eigen::VectorXd& x_centers,
-                                    const Eigen::VectorXd& x_scales,
-                                    JitNormalization jit_normalization,
-                                    const std::vector<int>& full_set)
-{
-  return checkKktViolationsImpl(gradient,
-                                beta,
-                                lambda_curr,
-                                working_set,
-                                x,
-                                residual,
-                                x_centers,
-                                x_scales,
-                                jit_normalization,
-                                full_set);
-}
-
-bool
-StrongScreening::checkKktViolations(Eigen::VectorXd& gradient,
-                                    const Eigen::VectorXd& beta,
-                                    const Eigen::ArrayXd& lambda_curr,
-                                    std::vector<int>& working_set,
-                                    const Eigen::SparseMatrix<double>& x,
+                                    std::vector<IndexType>& working_set,
+                                    const DesignRef& x_ref,
                                     const Eigen::MatrixXd& residual,
                                     const Eigen::VectorXd& x_centers,
                                     const Eigen::VectorXd& x_scales,
                                     JitNormalization jit_normalization,
-                                    const std::vector<int>& full_set)
-{
-  return checkKktViolationsImpl(gradient,
-                                beta,
-                                lambda_curr,
-                                working_set,
-                                x,
-                                residual,
-                                x_centers,
-                                x_scales,
-                                jit_normalization,
-                                full_set);
-}
-
-bool
-StrongScreening::checkKktViolations(Eigen::VectorXd& gradient,
-                                    const Eigen::VectorXd& beta,
-                                    const Eigen::ArrayXd& lambda_curr,
-                                    std::vector<int>& working_set,
-                                    const Eigen::Map<Eigen::MatrixXd>& x,
-                                    const Eigen::MatrixXd& residual,
-                                    const Eigen::VectorXd& x_centers,
-                                    const Eigen::VectorXd& x_scales,
-                                    JitNormalization jit_normalization,
-                                    const std::vector<int>& full_set)
-{
-  return checkKktViolationsImpl(gradient,
-                                beta,
-                                lambda_curr,
-                                working_set,
-                                x,
-                                residual,
-                                x_centers,
-                                x_scales,
-                                jit_normalization,
-                                full_set);
-}
-
-bool
-StrongScreening::checkKktViolations(
-  Eigen::VectorXd& gradient,
-  const Eigen::VectorXd& beta,
-  const Eigen::ArrayXd& lambda_curr,
-  std::vector<int>& working_set,
-  const Eigen::Map<Eigen::SparseMatrix<double>>& x,
-  const Eigen::MatrixXd& residual,
-  const Eigen::VectorXd& x_centers,
-  const Eigen::VectorXd& x_scales,
-  JitNormalization jit_normalization,
-  const std::vector<int>& full_set)
-{
-  return checkKktViolationsImpl(gradient,
-                                beta,
-                                lambda_curr,
-                                working_set,
-                                x,
-                                residual,
-                                x_centers,
-                                x_scales,
-                                jit_normalization,
-                                full_set);
+                                    const std::vector<IndexType>& full_set)
+{
+  return x_ref.visit([&](const auto& x) {
+    return checkKktViolationsImpl(gradient,
+                                  beta,
+                                  lambda_curr,
+                                  working_set,
+                                  x,
+                                  residual,
+                                  x_centers,
+                                  x_scales,
+                                  jit_normalization,
+                                  full_set);
+  });
 }
 
 std::string
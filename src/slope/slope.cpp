@@ -168,6 +168,12 @@ Slope::setRelaxMaxInnerIterations(int max_it)
   this->max_it_inner_relax = max_it;
 }
 
+void
+Slope::setRelaxWarmStarts(const bool relax_warm_starts)
+{
+  this->relax_warm_starts = relax_warm_starts;
+}
+
 void
 Slope::setMaxIterations(int max_it)
 {
@@ -330,4 +336,89 @@ Slope::getLossType()
   return loss_type;
 }
 
+const std::string&
+Slope::getCenteringType() const
+{
+  return centering_type;
+}
+
+const std::string&
+Slope::getScalingType() const
+{
+  return scaling_type;
+}
+
+const std::string&
+Slope::getLambdaType() const
+{
+  return lambda_type;
+}
+
+double
+Slope::getQ() const
+{
+  return q;
+}
+
+std::pair<double, double>
+Slope::getOscarParameters() const
+{
+  return { theta1, theta2 };
+}
+
+double
+Slope::getAlphaMinRatio() const
+{
+  return alpha_min_ratio;
+}
+
+void
+Slope::resetPartialFit()
+{
+  partial_fit_state = PartialFitState{};
+}
+
+SlopeFit
+Slope::blendRelaxed(const SlopeFit& fit,
+                    const SlopeFit& relaxed,
+                    const double gamma)
+{
+  if (gamma < 0 || gamma > 1) {
+    throw std::invalid_argument("gamma must be between 0 and 1");
+  }
+
+  Eigen::SparseMatrix<double> coefs =
+    (1 - gamma) * relaxed.getCoefs(false) + gamma * fit.getCoefs(false);
+
+  return SlopeFit{ relaxed.getIntercepts(false),
+                   coefs,
+                   relaxed.getClusters(),
+                   relaxed.getAlpha(),
+                   relaxed.getDeviance(),
+                   relaxed.getPrimals(),
+                   relaxed.getDuals(),
+                   relaxed.getTime(),
+                   relaxed.getPasses(),
+                   relaxed.getMetadata() };
+}
+
+SlopePath
+Slope::blendRelaxed(const SlopePath& path,
+                    const SlopePath& relaxed,
+                    const double gamma)
+{
+  if (relaxed.size() != path.size()) {
+    throw std::invalid_argument(
+      "relaxed path must have the same number of steps as the path");
+  }
+
+  SlopePath blended;
+
+  for (size_t i = 0; i < path.size(); ++i) {
+    blended.addFit(blendRelaxed(path(i), relaxed(i), gamma));
+  }
+
+  return blended;
+}
+
 } // namespace slope
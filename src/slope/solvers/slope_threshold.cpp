@@ -4,9 +4,9 @@
 
 namespace slope {
 
-std::tuple<double, int>
+std::tuple<double, IndexType>
 slopeThreshold(const double x,
-               const int j,
+               const IndexType j,
                const Eigen::ArrayXd& lambda_cumsum,
                const Clusters& clusters)
 {
@@ -24,7 +24,7 @@ slopeThreshold(const double x,
   };
 
   // Determine whether the update moves upward.
-  int ptr_j = clusters.pointer(j);
+  IndexType ptr_j = clusters.pointer(j);
   const bool direction_up =
     abs_x - getLambdaSum(ptr_j, cluster_size) > clusters.coeff(j);
 
@@ -32,7 +32,7 @@ slopeThreshold(const double x,
     size_t start = clusters.pointer(j);
     double lo = getLambdaSum(start, cluster_size);
 
-    for (int k = j - 1; k >= 0; --k) {
+    for (IndexType k = j - 1; k >= 0; --k) {
       double c_k = clusters.coeff(k);
 
       if (abs_x - lo < c_k && k < j) {
@@ -52,10 +52,10 @@ slopeThreshold(const double x,
     return { x - sign_x * lo, 0 };
   } else {
     // Moving down in the cluster ordering
-    int end = clusters.pointer(j + 1);
+    IndexType end = clusters.pointer(j + 1);
     double hi = getLambdaSum(end - cluster_size, cluster_size);
 
-    for (int k = j + 1; k < clusters.size(); ++k) {
+    for (IndexType k = j + 1; k < clusters.size(); ++k) {
       end = clusters.pointer(k + 1);
 
       double c_k = clusters.coeff(k);
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <slope/column_block_matrix.h>
+#include <slope/solvers/solver.h>
+
+namespace slope {
+
+void
+SolverBase::run(Eigen::VectorXd& beta0,
+                Eigen::VectorXd& beta,
+                Eigen::MatrixXd& eta,
+                const Eigen::ArrayXd& lambda,
+                const std::unique_ptr<Loss>& loss,
+                const SortedL1Norm& penalty,
+                const Eigen::VectorXd& gradient,
+                const std::vector<IndexType>& working_set,
+                const DesignRef& x,
+                const Eigen::VectorXd& x_centers,
+                const Eigen::VectorXd& x_scales,
+                const Eigen::MatrixXd& y)
+{
+  if (const ColumnBlockMatrix* x_blocks = x.getIf<ColumnBlockMatrix>()) {
+    runPinned(beta0,
+              beta,
+              eta,
+              lambda,
+              loss,
+              penalty,
+              gradient,
+              working_set,
+              *x_blocks,
+              x_centers,
+              x_scales,
+              y);
+  } else {
+    solve(beta0,
+          beta,
+          eta,
+          lambda,
+          loss,
+          penalty,
+          gradient,
+          working_set,
+          x,
+          x_centers,
+          x_scales,
+          y);
+  }
+}
+
+void
+SolverBase::runPinned(Eigen::VectorXd& beta0,
+                      Eigen::VectorXd& beta,
+                      Eigen::MatrixXd& eta,
+                      const Eigen::ArrayXd& lambda,
+                      const std::unique_ptr<Loss>& loss,
+                      const SortedL1Norm& penalty,
+                      const Eigen::VectorXd& gradient,
+                      const std::vector<IndexType>& working_set,
+                      const ColumnBlockMatrix& x,
+                      const Eigen::VectorXd& x_centers,
+                      const Eigen::VectorXd& x_scales,
+                      const Eigen::MatrixXd& y)
+{
+  const int p = x.cols();
+  const int m = eta.cols();
+
+  std::vector<int> columns;
+
+  for (IndexType ind : working_set) {
+    columns.emplace_back(ind % p);
+  }
+
+  std::sort(columns.begin(), columns.end());
+  columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+
+  const Eigen::MatrixXd& x_pinned = x.pin(columns);
+  const int p_pinned = columns.size();
+
+  // Indices of the coefficients of the pinned columns in the full problem
+  std::vector<IndexType> pinned_set(static_cast<IndexType>(p_pinned) * m);
+
+  for (int k = 0; k < m; ++k) {
+    for (int i = 0; i < p_pinned; ++i) {
+      pinned_set[static_cast<IndexType>(k) * p_pinned + i] =
+        static_cast<IndexType>(k) * p + columns[i];
+    }
+  }
+
+  std::vector<IndexType> pinned_working_set;
+
+  for (IndexType ind : working_set) {
+    const int pos =
+      std::lower_bound(columns.begin(), columns.end(), ind % p) -
+      columns.begin();
+
+    pinned_working_set.emplace_back((ind / p) * p_pinned + pos);
+  }
+
+  Eigen::VectorXd beta_pinned = beta(pinned_set);
+  Eigen::VectorXd gradient_pinned = gradient(pinned_set);
+
+  solve(beta0,
+        beta_pinned,
+        eta,
+        lambda,
+        loss,
+        penalty,
+        gradient_pinned,
+        pinned_working_set,
+        x_pinned,
+        x_centers.size() > 0 ? Eigen::VectorXd(x_centers(columns))
+                             : Eigen::VectorXd(),
+        x_scales.size() > 0 ? Eigen::VectorXd(x_scales(columns))
+                            : Eigen::VectorXd(),
+        y);
+
+  beta(pinned_set) = beta_pinned;
+}
+
+} // namespace slope
@@ -0,0 +1,57 @@
+#include <Eigen/Core>
+#include <algorithm>
+#include <numeric>
+#include <slope/task_queue.h>
+
+namespace slope {
+
+ThreadSettingsGuard::ThreadSettingsGuard()
+  : eigen_threads(Eigen::nbThreads())
+  , max_active_levels(1)
+{
+#ifdef _OPENMP
+  max_active_levels = omp_get_max_active_levels();
+
+  Eigen::setNbThreads(1);
+  omp_set_max_active_levels(2);
+#endif
+}
+
+ThreadSettingsGuard::~ThreadSettingsGuard()
+{
+#ifdef _OPENMP
+  Eigen::setNbThreads(eigen_threads);
+  omp_set_max_active_levels(max_active_levels);
+#endif
+}
+
+TaskQueue::TaskQueue(const int n_threads)
+  : n_threads(n_threads)
+{
+  if (n_threads < 1) {
+    throw std::invalid_argument("Number of threads must be positive");
+  }
+}
+
+void
+TaskQueue::shareIdleThreads() const
+{
+  const int running = std::max(1, n_running.load());
+
+  Threads::setLocal(1 + n_idle.load() / running);
+}
+
+std::vector<int>
+TaskQueue::longestFirst(const std::vector<double>& costs)
+{
+  std::vector<int> order(costs.size());
+  std::iota(order.begin(), order.end(), 0);
+
+  std::stable_sort(order.begin(), order.end(), [&costs](int a, int b) {
+    return costs[a] > costs[b];
+  });
+
+  return order;
+}
+
+} // namespace slope
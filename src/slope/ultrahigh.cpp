@@ -0,0 +1,380 @@
+#include "kkt_check.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <slope/math.h>
+#include <slope/normalize.h>
+#include <slope/regularization_sequence.h>
+#include <slope/ultrahigh.h>
+#include <slope/utils.h>
+#include <stdexcept>
+
+namespace slope {
+
+namespace {
+
+/// Number of columns whose gradients are computed at once
+const int BLOCK_SIZE = 1024;
+
+/// A coefficient of the full problem and its gradient
+using Candidate = std::pair<IndexType, double>;
+
+/**
+ * Computes the gradient of the full problem one block of columns at a time,
+ * with each block normalized as Slope::path() would normalize it, which is
+ * column by column. The gradients of the coefficients of `columns` are
+ * stored in `inside`, in the order of the coefficients of the design of
+ * these columns, and only the `n_keep` largest of the others, in absolute
+ * value, are kept and returned in decreasing order.
+ */
+template<typename T>
+std::vector<Candidate>
+reduceGradient(Eigen::VectorXd& inside,
+               const T& x,
+               const Eigen::MatrixXd& residual,
+               const std::vector<int>& columns,
+               const size_t n_keep,
+               const std::string& centering_type,
+               const std::string& scaling_type)
+{
+  const int n = x.rows();
+  const int p = x.cols();
+  const int m = residual.cols();
+  const int p_in = columns.size();
+
+  inside.resize(static_cast<IndexType>(p_in) * m);
+
+  // Kept as a heap with the smallest gradient on top
+  auto larger = [](const Candidate& a, const Candidate& b) {
+    return std::abs(a.second) > std::abs(b.second);
+  };
+
+  std::vector<Candidate> out;
+  out.reserve(std::min(n_keep, static_cast<size_t>(p) * m));
+
+  const Eigen::VectorXd ones = Eigen::VectorXd::Ones(n);
+
+  for (int start = 0; start < p; start += BLOCK_SIZE) {
+    const int len = std::min(BLOCK_SIZE, p - start);
+
+    T block = x.middleCols(start, len);
+    Eigen::VectorXd centers;
+    Eigen::VectorXd scales;
+
+    JitNormalization jit_normalization =
+      normalize(block, centers, scales, centering_type, scaling_type, false);
+
+    std::vector<IndexType> block_set(static_cast<IndexType>(len) * m);
+    std::iota(block_set.begin(), block_set.end(), 0);
+
+    Eigen::VectorXd gradient(block_set.size());
+
+    updateGradient(gradient,
+                   block,
+                   residual,
+                   block_set,
+                   centers,
+                   scales,
+                   ones,
+                   jit_normalization);
+
+    auto col_it = std::lower_bound(columns.begin(), columns.end(), start);
+
+    for (int j = 0; j < len; ++j) {
+      const int col = start + j;
+
+      while (col_it != columns.end() && *col_it < col) {
+        ++col_it;
+      }
+
+      const bool selected = col_it != columns.end() && *col_it == col;
+      const int pos = col_it - columns.begin();
+
+      for (int k = 0; k < m; ++k) {
+        const double g = gradient(static_cast<IndexType>(k) * len + j);
+
+        if (selected) {
+          inside(static_cast<IndexType>(k) * p_in + pos) = g;
+        } else if (out.size() < n_keep) {
+          out.emplace_back(static_cast<IndexType>(k) * p + col, g);
+          std::push_heap(out.begin(), out.end(), larger);
+        } else if (std::abs(g) > std::abs(out.front().second)) {
+          std::pop_heap(out.begin(), out.end(), larger);
+          out.back() = { static_cast<IndexType>(k) * p + col, g };
+          std::push_heap(out.begin(), out.end(), larger);
+        }
+      }
+    }
+  }
+
+  std::sort_heap(out.begin(), out.end(), larger);
+
+  return out;
+}
+
+template<typename T>
+UltrahighPath
+ultrahighPathImpl(Slope model,
+                  const T& x,
+                  const Eigen::MatrixXd& y_in,
+                  const int n_candidates)
+{
+  const std::string centering_type = model.getCenteringType();
+  const std::string scaling_type = model.getScalingType();
+
+  if (centering_type == "manual" || scaling_type == "manual") {
+    throw std::invalid_argument(
+      "Ultrahigh-dimensional paths do not support manual normalization");
+  }
+
+  if (n_candidates < 1) {
+    throw std::invalid_argument("n_candidates must be positive");
+  }
+
+  if (x.rows() != y_in.rows()) {
+    throw std::invalid_argument("x and y_in must have the same number of rows");
+  }
+
+  if (!isFinite(x)) {
+    throw std::invalid_argument("x must not contain NA, NaN, or Inf values");
+  }
+
+  auto loss = setupLoss(model.getLossType());
+
+  const Eigen::MatrixXd y = loss->preprocessResponse(y_in);
+
+  const int n = x.rows();
+  const int p = x.cols();
+  const int m = y.cols();
+
+  if (static_cast<double>(p) * m > std::numeric_limits<IndexType>::max()) {
+    throw std::invalid_argument("Too many coefficients to index");
+  }
+
+  const IndexType pm = static_cast<IndexType>(p) * m;
+
+  auto lambdaHead = [&](const int length) {
+    auto [theta1, theta2] = model.getOscarParameters();
+
+    return lambdaSequenceHead(length,
+                              pm,
+                              model.getQ(),
+                              model.getLambdaType(),
+                              n,
+                              theta1,
+                              theta2);
+  };
+
+  const double lambda_min = lambdaSequenceMin(
+    model.getQ(), model.getLambdaType(), model.getOscarParameters().first);
+
+  std::vector<int> columns;
+  Eigen::VectorXd inside;
+
+  // Start with the columns that the largest alpha of the full problem, the
+  // dual norm of the gradient of the null model, depends on. Gradients below
+  // the dual norm of the candidates times the smallest lambda cannot raise
+  // it.
+  {
+    Eigen::MatrixXd eta = Eigen::MatrixXd::Zero(n, m);
+
+    if (model.getFitIntercept()) {
+      Eigen::VectorXd y_mean = y.colwise().mean();
+      eta.rowwise() = loss->link(y_mean.transpose()).row(0);
+    }
+
+    const Eigen::MatrixXd residual = loss->residual(eta, y);
+
+    for (size_t n_keep = n_candidates;; n_keep *= 2) {
+      std::vector<Candidate> candidates = reduceGradient(
+        inside, x, residual, columns, n_keep, centering_type, scaling_type);
+
+      const int k = candidates.size();
+
+      Eigen::ArrayXd abs_gradient(k);
+
+      for (int r = 0; r < k; ++r) {
+        abs_gradient(r) = std::abs(candidates[r].second);
+      }
+
+      Eigen::ArrayXd ratios =
+        cumSum(abs_gradient) / cumSum(Eigen::ArrayXd(lambdaHead(k)));
+
+      int k_max = 0;
+      const double alpha_max = k > 0 ? ratios.maxCoeff(&k_max) : 0.0;
+
+      if (candidates.size() < n_keep ||
+          abs_gradient(k - 1) <= alpha_max * lambda_min) {
+        for (int r = 0; r <= k_max && r < k; ++r) {
+          columns.emplace_back(candidates[r].first % p);
+        }
+
+        break;
+      }
+    }
+
+    std::sort(columns.begin(), columns.end());
+    columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+  }
+
+  if (model.getAlphaMinRatio() < 0) {
+    model.setAlphaMinRatio(n > pm ? 1e-4 : 1e-2);
+  }
+
+  // Steps that have passed the check keep their fits when columns are
+  // added, since these are zero at the solution of the full problem
+  size_t n_checked = 0;
+
+  while (true) {
+    T x_sub = subsetCols(x, columns);
+
+    const int p_sub = columns.size();
+    const IndexType pm_sub = static_cast<IndexType>(p_sub) * m;
+
+    SlopePath path =
+      model.path(x_sub, y_in, Eigen::ArrayXd(), lambdaHead(pm_sub));
+
+    std::vector<int> violations;
+
+    for (; n_checked < path.size(); ++n_checked) {
+      const SlopeFit fit = path(n_checked);
+      const double alpha = fit.getAlpha();
+
+      const Eigen::MatrixXd residual =
+        loss->residual(fit.predict(x_sub, "linear"), y);
+
+      std::vector<Candidate> outside;
+
+      for (size_t n_keep = n_candidates;; n_keep *= 2) {
+        outside = reduceGradient(
+          inside, x, residual, columns, n_keep, centering_type, scaling_type);
+
+        if (outside.size() < n_keep ||
+            std::abs(outside.back().second) < alpha * lambda_min) {
+          break;
+        }
+      }
+
+      if (outside.empty()) {
+        continue;
+      }
+
+      const IndexType k = pm_sub + outside.size();
+
+      Eigen::VectorXd gradient(k);
+      Eigen::VectorXd beta = Eigen::VectorXd::Zero(k);
+
+      gradient.head(pm_sub) = inside;
+
+      for (size_t l = 0; l < outside.size(); ++l) {
+        gradient(pm_sub + l) = outside[l].second;
+      }
+
+      beta.head(pm_sub) = Eigen::MatrixXd(fit.getCoefs()).reshaped();
+
+      std::vector<IndexType> indices(k);
+      std::iota(indices.begin(), indices.end(), 0);
+
+      for (IndexType ind :
+           kktCheck(gradient, beta, alpha * lambdaHead(k), indices)) {
+        if (ind >= pm_sub) {
+          violations.emplace_back(outside[ind - pm_sub].first % p);
+        }
+      }
+
+      if (!violations.empty()) {
+        break;
+      }
+    }
+
+    if (violations.empty()) {
+      return UltrahighPath(std::move(path), p, std::move(columns));
+    }
+
+    columns.insert(columns.end(), violations.begin(), violations.end());
+    std::sort(columns.begin(), columns.end());
+    columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+  }
+}
+
+} // namespace
+
+UltrahighPath::UltrahighPath(SlopePath path_in,
+                             const int n_features_in,
+                             std::vector<int> columns_in)
+  : path(std::move(path_in))
+  , n_features(n_features_in)
+  , columns(std::move(columns_in))
+{
+}
+
+Eigen::SparseMatrix<double>
+UltrahighPath::getCoefs(const size_t step) const
+{
+  Eigen::SparseMatrix<double> beta = path(step).getCoefs();
+
+  std::vector<Eigen::Triplet<double>> triplets;
+  triplets.reserve(beta.nonZeros());
+
+  for (int k = 0; k < beta.outerSize(); ++k) {
+    for (Eigen::SparseMatrix<double>::InnerIterator it(beta, k); it; ++it) {
+      triplets.emplace_back(columns[it.row()], k, it.value());
+    }
+  }
+
+  Eigen::SparseMatrix<double> out(n_features, beta.cols());
+  out.setFromTriplets(triplets.begin(), triplets.end());
+
+  return out;
+}
+
+Eigen::MatrixXd
+UltrahighPath::predict(const Eigen::MatrixXd& x,
+                       const size_t step,
+                       const std::string& type) const
+{
+  if (x.cols() != n_features) {
+    throw std::invalid_argument(
+      "x must have as many columns as the design of the path");
+  }
+
+  Eigen::MatrixXd x_sub = subsetCols(x, columns);
+
+  return path(step).predict(x_sub, type);
+}
+
+Eigen::MatrixXd
+UltrahighPath::predict(const Eigen::SparseMatrix<double>& x,
+                       const size_t step,
+                       const std::string& type) const
+{
+  if (x.cols() != n_features) {
+    throw std::invalid_argument(
+      "x must have as many columns as the design of the path");
+  }
+
+  Eigen::SparseMatrix<double> x_sub = subsetCols(x, columns);
+
+  return path(step).predict(x_sub, type);
+}
+
+UltrahighPath
+ultrahighPath(Slope model,
+              const Eigen::MatrixXd& x,
+              const Eigen::MatrixXd& y_in,
+              const int n_candidates)
+{
+  return ultrahighPathImpl(std::move(model), x, y_in, n_candidates);
+}
+
+UltrahighPath
+ultrahighPath(Slope model,
+              const Eigen::SparseMatrix<double>& x,
+              const Eigen::MatrixXd& y_in,
+              const int n_candidates)
+{
+  return ultrahighPathImpl(std::move(model), x, y_in, n_candidates);
+}
+
+} // namespace slope
@@ -22,4 +22,25 @@ validateOption(const std::string& value,
   }
 }
 
+void
+validateWeights(const Eigen::VectorXd& w, const int n)
+{
+  if (w.size() != n) {
+    throw std::invalid_argument(
+      "weights must have the same length as the number of observations");
+  }
+
+  if (!w.allFinite()) {
+    throw std::invalid_argument("weights must be finite");
+  }
+
+  if ((w.array() < 0).any()) {
+    throw std::invalid_argument("weights must be non-negative");
+  }
+
+  if (w.sum() <= 0) {
+    throw std::invalid_argument("weights must have a positive sum");
+  }
+}
+
 } // namespace slope
@@ -0,0 +1,57 @@
+#include "generate_data.hpp"
+#include "test_helpers.hpp"
+#include <Eigen/Core>
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <slope/column_block_matrix.h>
+#include <slope/slope.h>
+
+TEST_CASE("Design matrices stored in column blocks", "[column_block_matrix]")
+{
+  const std::string prefix =
+    (std::filesystem::temp_directory_path() / "slope_column_block_").string();
+
+  for (const std::string loss : { "quadratic", "logistic", "poisson" }) {
+    INFO("loss " << loss);
+
+    auto data = generateData(300, 20, loss, 1, 1.0, 0.3, 17);
+
+    auto files = slope::writeColumnBlocks(prefix, data.x, 3);
+
+    REQUIRE(files.size() == 7);
+
+    slope::ColumnBlockMatrix x(files);
+
+    REQUIRE(x.rows() == data.x.rows());
+    REQUIRE(x.cols() == data.x.cols());
+    REQUIRE(x.numBlocks() == 7);
+
+    Eigen::VectorXd means = data.x.colwise().mean();
+    REQUIRE_THAT(x.statistics().getMeans(), VectorApproxEqual(means));
+
+    slope::Slope model;
+    model.setLoss(loss);
+    model.setTol(1e-10);
+    model.setPathLength(20);
+
+    auto path = model.path(x, data.y);
+    auto path_ref = model.path(data.x, data.y);
+
+    REQUIRE(path.size() == path_ref.size());
+
+    for (size_t i = 0; i < path.size(); ++i) {
+      INFO("step " << i);
+      Eigen::VectorXd coefs = path(i).getCoefs().toDense().reshaped();
+      Eigen::VectorXd coefs_ref = path_ref(i).getCoefs().toDense().reshaped();
+
+      REQUIRE_THAT(coefs, VectorApproxEqual(coefs_ref, 1e-6));
+    }
+
+    Eigen::VectorXd weights = Eigen::VectorXd::Ones(x.rows());
+    REQUIRE_THROWS_AS(model.path(x, data.y, weights), std::invalid_argument);
+
+    for (const auto& file : files) {
+      std::filesystem::remove(file);
+    }
+  }
+}
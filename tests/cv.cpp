@@ -4,6 +4,7 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <slope/approximate_cv.h>
 #include <slope/cv.h>
 #include <slope/slope.h>
 
@@ -183,8 +184,33 @@ TEST_CASE("Cross-validation: do not copy x", "[cv][user_folds]")
 
   auto res_view = crossValidate(model, data.x, data.y, cv_config);
 
+  // The hybrid solver stops once the duality gap is small, which pins down
+  // the objective much more tightly than the coefficients, so the fits to
+  // copies and to weighted views only agree to about 1e-9. Proximal gradient
+  // descent takes the same steps on both.
   REQUIRE_THAT(res_copy.results.front().score(0, 0),
-               WithinAbs(res_view.results.front().score(0, 0), 1e-10));
+               WithinAbs(res_view.results.front().score(0, 0), 1e-8));
+
+  slope::Slope model_pgd = model;
+  model_pgd.setSolver("pgd");
+
+  auto res_view_pgd = crossValidate(model_pgd, data.x, data.y, cv_config);
+
+  cv_config.copy_x = true;
+
+  auto res_copy_pgd = crossValidate(model_pgd, data.x, data.y, cv_config);
+
+  REQUIRE_THAT(res_copy_pgd.results.front().score(0, 0),
+               WithinAbs(res_view_pgd.results.front().score(0, 0), 1e-10));
+
+  cv_config.copy_x = false;
+
+  Eigen::SparseMatrix<double> x_sparse = data.x.sparseView();
+
+  auto res_sparse = crossValidate(model, x_sparse, data.y, cv_config);
+
+  REQUIRE_THAT(res_sparse.results.front().mean_scores.matrix(),
+               VectorApproxEqual(res_view.results.front().mean_scores, 1e-6));
 }
 
 TEST_CASE("Best alpha index is within bounds", "[cv][alpha_index]")
@@ -256,3 +282,195 @@ TEST_CASE("Best alpha index is within bounds", "[cv][alpha_index]")
   INFO("Actual best alpha index: " << actual_best_idx);
   INFO("Best alpha value: " << best_alpha);
 }
+
+TEST_CASE("Cross-validation: alpha grid", "[cv][alpha]")
+{
+  auto data = generateData(100, 20);
+
+  slope::Slope model;
+
+  auto path = model.path(data.x, data.y);
+  Eigen::ArrayXd alpha_path = path.getAlpha();
+  Eigen::ArrayXd alpha_grid = model.alphaGrid(data.x, data.y);
+
+  // The path stops before the end of the grid
+  REQUIRE(alpha_grid.size() > alpha_path.size());
+  REQUIRE_THAT(alpha_grid.head(alpha_path.size()),
+               VectorApproxEqual(alpha_path, 1e-12));
+
+  auto cv_config = slope::CvConfig();
+  cv_config.n_folds = 3;
+
+  auto res = crossValidate(model, data.x, data.y, cv_config);
+
+  REQUIRE_THAT(res.results.front().alphas, VectorApproxEqual(alpha_path));
+  REQUIRE(res.results.front().score.cols() == alpha_path.size());
+}
+
+TEST_CASE("Cross-validation: shared task queue", "[cv][threads]")
+{
+  SECTION("Tasks are run once each, longest first")
+  {
+    std::vector<double> costs = { 2, 5, 1, 5, 3 };
+    auto order = slope::TaskQueue::longestFirst(costs);
+
+    REQUIRE(order == std::vector<int>{ 1, 3, 4, 0, 2 });
+
+    std::vector<int> runs(costs.size(), 0);
+    slope::TaskQueue queue(3);
+
+    queue.run(order, [&](int task) {
+      queue.shareIdleThreads();
+      runs[task]++;
+    });
+
+    REQUIRE(runs == std::vector<int>(costs.size(), 1));
+    REQUIRE(slope::Threads::get() > 0);
+  }
+
+  SECTION("Grid points fit together give the same results as one by one")
+  {
+    auto data = generateData(100, 10);
+
+    slope::Slope model;
+    model.setTol(1e-10);
+
+    auto config = slope::CvConfig();
+    config.n_folds = 4;
+    config.hyperparams["q"] = { 0.1, 0.3 };
+    config.hyperparams["gamma"] = { 0.0, 0.5 };
+
+    const int eigen_threads = Eigen::nbThreads();
+
+    auto res = crossValidate(model, data.x, data.y, config);
+
+    REQUIRE(Eigen::nbThreads() == eigen_threads);
+    REQUIRE(res.results.size() == 4);
+
+    for (const auto& result : res.results) {
+      auto config_single = config;
+      config_single.hyperparams["q"] = { result.params.at("q") };
+      config_single.hyperparams["gamma"] = { result.params.at("gamma") };
+
+      auto res_single = crossValidate(model, data.x, data.y, config_single);
+
+      // Up to the tolerance of the solver, since the paths for different q
+      // are warm started from each other
+      REQUIRE(result.mean_scores.size() ==
+              res_single.results.front().mean_scores.size());
+      REQUIRE_THAT(
+        result.mean_scores,
+        VectorApproxEqual(res_single.results.front().mean_scores, 1e-6));
+    }
+  }
+}
+
+TEST_CASE("Cross-validation: early stopping", "[cv][early_stopping]")
+{
+  auto data = generateData(200, 100, "quadratic", 1, 0.3, 0.05);
+
+  slope::Slope model;
+
+  auto config = slope::CvConfig();
+  config.n_folds = 5;
+  config.hyperparams["gamma"] = { 0.0, 0.5 };
+
+  auto res_full = crossValidate(model, data.x, data.y, config);
+
+  config.early_stopping = true;
+
+  auto res = crossValidate(model, data.x, data.y, config);
+
+  REQUIRE(res.results.size() == res_full.results.size());
+
+  const Eigen::MatrixXd& score = res.results[res.best_ind].score;
+  const Eigen::MatrixXd& score_full = res_full.results[res.best_ind].score;
+
+  // The grid is cut off, and the scores before the cutoff are the same
+  REQUIRE(score.cols() < score_full.cols());
+  REQUIRE(score.rows() == score_full.rows());
+  REQUIRE_FALSE(score.array().isNaN().any());
+
+  for (int i = 0; i < score.rows(); ++i) {
+    for (int j = 0; j < score.cols(); ++j) {
+      REQUIRE_THAT(score(i, j),
+                   Catch::Matchers::WithinRel(score_full(i, j), 1e-6));
+    }
+  }
+
+  REQUIRE(res.best_ind == res_full.best_ind);
+  REQUIRE(res.best_alpha_ind == res_full.best_alpha_ind);
+
+  // The cutoff does not depend on the order in which the folds are fit
+  const int n_threads = slope::Threads::get();
+
+  for (int threads : { 1, 3 }) {
+    slope::Threads::set(threads);
+
+    auto res_threads = crossValidate(model, data.x, data.y, config);
+
+    REQUIRE(res_threads.results[res.best_ind].alphas.size() ==
+            res.results[res.best_ind].alphas.size());
+    REQUIRE(res_threads.best_alpha_ind == res.best_alpha_ind);
+  }
+
+  slope::Threads::set(n_threads);
+}
+
+TEST_CASE("Approximate leave-one-out cross-validation", "[cv][approximate]")
+{
+  using Catch::Matchers::WithinRel;
+
+  auto data = generateData(80, 6, "quadratic", 1, 1.0, 0.5, 3);
+
+  slope::Slope model;
+  model.setTol(1e-12);
+  model.setRelaxTol(1e-12);
+
+  // Normalization that depends on the data differs between the folds
+  model.setNormalization("none");
+
+  auto config = slope::CvConfig();
+  config.n_folds = data.x.rows();
+  config.hyperparams["gamma"] = { 0.0, 0.5 };
+
+  auto res_loo = crossValidate(model, data.x, data.y, config);
+  auto res = approximateCv(model, data.x, data.y, config);
+
+  REQUIRE(res.results.size() == res_loo.results.size());
+
+  for (size_t g = 0; g < res.results.size(); ++g) {
+    INFO("grid point " << g);
+
+    const auto& result = res.results[g];
+    const auto& result_loo = res_loo.results[g];
+
+    REQUIRE(result.params == result_loo.params);
+    REQUIRE(result.score.rows() == 1);
+    REQUIRE(result.alphas.size() == result_loo.alphas.size());
+    REQUIRE((result.std_errors == 0).all());
+
+    // For the quadratic loss, the approximation is exact wherever leaving
+    // out an observation does not change the clusters
+    int n_exact = 0;
+
+    for (int i = 0; i < result.mean_scores.size(); ++i) {
+      const double score = result.mean_scores(i);
+      const double score_loo = result_loo.mean_scores(i);
+
+      REQUIRE_THAT(score, WithinRel(score_loo, 0.2));
+      n_exact += std::abs(score - score_loo) <= 1e-6 * score_loo;
+    }
+
+    REQUIRE(n_exact > result.mean_scores.size() / 4);
+  }
+
+  SECTION("Multinomial models are not supported")
+  {
+    auto data_multi = generateData(50, 4, "multinomial", 3);
+    model.setLoss("multinomial");
+
+    REQUIRE_THROWS_AS(approximateCv(model, data_multi.x, data_multi.y),
+                      std::invalid_argument);
+  }
+}
@@ -0,0 +1,184 @@
+#include "test_helpers.hpp"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <random>
+#include <slope/deduplicated_matrix.h>
+#include <slope/slope.h>
+
+namespace {
+
+/// A design with exact, negated, and affine copies of some of its columns
+Eigen::MatrixXd
+duplicatedDesign(const int n, const int p_distinct, const unsigned int seed)
+{
+  std::mt19937 rng(seed);
+  std::normal_distribution<double> normal;
+
+  Eigen::MatrixXd base = Eigen::MatrixXd::NullaryExpr(
+    n, p_distinct, [&]() { return normal(rng); });
+
+  Eigen::MatrixXd x(n, p_distinct + 6);
+  x << base, base.col(0), base.col(0), -base.col(1), base.col(2),
+    -base.col(0), 2 * base.col(3).array() + 1;
+
+  return x;
+}
+
+} // namespace
+
+TEST_CASE("Deduplicated matrices", "[deduplicated_matrix]")
+{
+  const int n = 30;
+  const int p = 8;
+
+  Eigen::MatrixXd x_dense = duplicatedDesign(n, p, 1);
+
+  SECTION("Exact copies")
+  {
+    slope::DeduplicatedMatrix x(x_dense);
+
+    REQUIRE(x.rows() == n);
+    REQUIRE(x.cols() == p + 6);
+    REQUIRE(x.getDistinct().cols() <= p + 1);
+    REQUIRE(x.getDistinct().cols() >= p);
+
+    std::vector<int> multiplicities = x.getMultiplicities();
+    REQUIRE(multiplicities[0] == 4);
+    REQUIRE(multiplicities[1] == 2);
+    REQUIRE(multiplicities[2] == 2);
+
+    REQUIRE(x.getColumnMap()[p + 2] == x.getColumnMap()[1]);
+    REQUIRE(x.getFactors()(p + 2) == -1);
+
+    // Every column is reproduced exactly
+    for (int j = 0; j < x.cols(); ++j) {
+      INFO("column " << j);
+      REQUIRE((x.col(j) - x_dense.col(j)).cwiseAbs().maxCoeff() == 0);
+    }
+
+    Eigen::VectorXd w = Eigen::VectorXd::LinSpaced(n, 0.5, 2);
+
+    slope::ColumnStatistics stats = x.computeStatistics(w);
+    slope::ColumnStatistics stats_ref(x_dense.cols());
+    stats_ref.update(x_dense, w);
+
+    REQUIRE_THAT(stats.getMeans(), VectorApproxEqual(stats_ref.getMeans()));
+    REQUIRE_THAT(stats.getM2(), VectorApproxEqual(stats_ref.getM2()));
+    REQUIRE_THAT(stats.getAbsSums(),
+                 VectorApproxEqual(stats_ref.getAbsSums()));
+    REQUIRE_THAT(stats.getMinima(), VectorApproxEqual(stats_ref.getMinima()));
+    REQUIRE_THAT(stats.getMaxima(), VectorApproxEqual(stats_ref.getMaxima()));
+
+    REQUIRE(slope::isFinite(x));
+  }
+
+  SECTION("Affine copies up to rounding")
+  {
+    slope::DeduplicatedMatrix x(x_dense, 1e-12);
+
+    REQUIRE(x.getDistinct().cols() == p);
+    REQUIRE(x.getColumnMap()[p + 5] == x.getColumnMap()[3]);
+
+    Eigen::VectorXd x_last = x_dense.col(p + 5);
+    REQUIRE_THAT(x.col(p + 5), VectorApproxEqual(x_last, 1e-10));
+  }
+
+  SECTION("Constant columns")
+  {
+    Eigen::MatrixXd x_const = Eigen::MatrixXd::Ones(n, 3);
+    x_const.col(2).setZero();
+
+    slope::DeduplicatedMatrix x(x_const);
+
+    REQUIRE(x.getDistinct().cols() == 3);
+  }
+
+  REQUIRE_THROWS_AS(slope::DeduplicatedMatrix(x_dense, -1),
+                    std::invalid_argument);
+}
+
+TEST_CASE("Paths on deduplicated matrices", "[deduplicated_matrix]")
+{
+  std::mt19937 rng(2);
+  std::normal_distribution<double> normal;
+  std::uniform_real_distribution<double> unif;
+
+  const int n = 100;
+
+  Eigen::MatrixXd x_dense = duplicatedDesign(n, 20, 3);
+  slope::DeduplicatedMatrix x(x_dense);
+
+  const int p = x.cols();
+
+  Eigen::VectorXd beta = Eigen::VectorXd::Zero(p);
+  beta.head(4) << 1, -1, 0.5, -0.5;
+
+  Eigen::VectorXd eta = x_dense * beta;
+
+  for (const std::string loss : { "quadratic", "logistic" }) {
+    for (const std::string solver : { "hybrid", "pgd" }) {
+      INFO("loss " << loss << ", solver " << solver);
+
+      Eigen::VectorXd y(n);
+
+      for (int i = 0; i < n; ++i) {
+        y(i) = loss == "quadratic"
+                 ? eta(i) + normal(rng)
+                 : static_cast<double>(unif(rng) < 1 / (1 + std::exp(-eta(i))));
+      }
+
+      slope::Slope model;
+      model.setLoss(loss);
+      model.setSolver(solver);
+      model.setTol(1e-10);
+      model.setPathLength(20);
+
+      auto path = model.path(x, y);
+      auto path_ref = model.path(x_dense, y);
+
+      REQUIRE(path.size() == path_ref.size());
+
+      for (size_t i = 0; i < path.size(); ++i) {
+        INFO("step " << i);
+        Eigen::VectorXd coefs = path(i).getCoefs().toDense().reshaped();
+        Eigen::VectorXd coefs_ref =
+          path_ref(i).getCoefs().toDense().reshaped();
+
+        REQUIRE_THAT(coefs, VectorApproxEqual(coefs_ref, 1e-6));
+      }
+
+      Eigen::VectorXd pred = path(path.size() - 1).predict(x, "linear");
+      Eigen::VectorXd pred_ref =
+        path_ref(path.size() - 1).predict(x_dense, "linear");
+
+      REQUIRE_THAT(pred, VectorApproxEqual(pred_ref, 1e-6));
+    }
+  }
+
+  SECTION("Weights")
+  {
+    Eigen::VectorXd y = eta + Eigen::VectorXd::Ones(n);
+    Eigen::VectorXd weights = Eigen::VectorXd::Ones(n);
+    weights.head(20).setZero();
+    weights.tail(30) *= 3;
+
+    slope::Slope model;
+    model.setTol(1e-10);
+    model.setPathLength(20);
+
+    auto path = model.path(x, y, weights);
+    auto path_ref = model.path(x_dense, y, weights);
+
+    REQUIRE(path.size() == path_ref.size());
+
+    for (size_t i = 0; i < path.size(); ++i) {
+      INFO("step " << i);
+      Eigen::VectorXd coefs = path(i).getCoefs().toDense().reshaped();
+      Eigen::VectorXd coefs_ref = path_ref(i).getCoefs().toDense().reshaped();
+
+      REQUIRE_THAT(coefs, VectorApproxEqual(coefs_ref, 1e-6));
+    }
+  }
+}
@@ -0,0 +1,93 @@
+#include "generate_data.hpp"
+#include "test_helpers.hpp"
+#include <Eigen/Core>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <cstdint>
+#include <limits>
+#include <slope/index_type.h>
+#include <slope/regularization_sequence.h>
+#include <slope/slope.h>
+#include <type_traits>
+
+TEST_CASE("Coefficient index type", "[index_type]")
+{
+#ifdef SLOPE_64BIT_INDEX
+  STATIC_REQUIRE(std::is_same_v<slope::IndexType, std::int64_t>);
+#else
+  STATIC_REQUIRE(std::is_same_v<slope::IndexType, int>);
+#endif
+
+  STATIC_REQUIRE(
+    std::is_same_v<slope::PathCoefMatrix::StorageIndex, slope::IndexType>);
+
+#ifdef SLOPE_64BIT_INDEX
+  SECTION("Indices past the range of int")
+  {
+    const int p = 100000;
+    const int m = 30000;
+    const slope::IndexType pm = static_cast<slope::IndexType>(p) * m;
+
+    REQUIRE(pm > std::numeric_limits<int>::max());
+
+    auto [k, j] = slope::splitIndex(pm - 1, p);
+
+    REQUIRE(k == m - 1);
+    REQUIRE(j == p - 1);
+
+    Eigen::ArrayXd lambda_head = slope::lambdaSequenceHead(3, pm, 0.1, "bh");
+
+    REQUIRE(lambda_head.size() == 3);
+    REQUIRE(lambda_head.allFinite());
+    REQUIRE(lambda_head(0) > lambda_head(2));
+  }
+#endif
+}
+
+TEST_CASE("Paths with the configured index type", "[index_type][path]")
+{
+  auto data = generateData(100, 10, "multinomial", 3, 0.5, 0.5, 9);
+
+  slope::Slope model;
+  model.setLoss("multinomial");
+  model.setPathLength(10);
+
+  auto path = model.path(data.x, data.y);
+
+  REQUIRE(path.size() > 1);
+
+  const int m = path(0).getCoefs().cols();
+
+  auto coef_matrix = path.getCoefMatrix();
+
+  REQUIRE(coef_matrix.rows() == 10);
+  REQUIRE(coef_matrix.cols() == m * static_cast<int>(path.size()));
+
+  Eigen::MatrixXd pred = path.predict(data.x, "linear");
+
+  for (size_t i = 0; i < path.size(); ++i) {
+    Eigen::MatrixXd coefs = path(i).getCoefs(false);
+    Eigen::MatrixXd block = Eigen::MatrixXd(coef_matrix).middleCols(i * m, m);
+
+    REQUIRE(block.isApprox(coefs));
+
+    Eigen::VectorXd pred_step = path(i).predict(data.x, "linear").reshaped();
+    Eigen::VectorXd pred_block = pred.middleCols(i * m, m).reshaped();
+
+    REQUIRE_THAT(pred_block, VectorApproxEqual(pred_step, 1e-10));
+  }
+
+  // A path warm started from it gives the same fits
+  auto path_warm = model.path(data.x, data.y, path);
+
+  REQUIRE(path_warm.size() == path.size());
+
+  for (size_t i = 0; i < path.size(); ++i) {
+    Eigen::VectorXd coefs = Eigen::MatrixXd(path(i).getCoefs()).reshaped();
+    Eigen::VectorXd coefs_warm =
+      Eigen::MatrixXd(path_warm(i).getCoefs()).reshaped();
+
+    REQUIRE_THAT(coefs_warm, VectorApproxEqual(coefs, 1e-4));
+  }
+}
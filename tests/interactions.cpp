@@ -0,0 +1,178 @@
+#include "test_helpers.hpp"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <random>
+#include <slope/interactions.h>
+#include <slope/slope.h>
+
+namespace {
+
+Eigen::MatrixXd
+randomNormal(const int n, const int p, std::mt19937& rng)
+{
+  std::normal_distribution<double> normal;
+
+  return Eigen::MatrixXd::NullaryExpr(n, p, [&]() { return normal(rng); });
+}
+
+/// The base features followed by all of their pairwise interactions
+Eigen::MatrixXd
+allInteractions(const Eigen::MatrixXd& x)
+{
+  const int q = x.cols();
+
+  Eigen::MatrixXd out(x.rows(), q + q * (q - 1) / 2);
+  out.leftCols(q) = x;
+
+  int col = q;
+
+  for (int i = 0; i < q; ++i) {
+    for (int j = i + 1; j < q; ++j) {
+      out.col(col++) = x.col(i).cwiseProduct(x.col(j));
+    }
+  }
+
+  return out;
+}
+
+} // namespace
+
+TEST_CASE("Interaction screening", "[interactions]")
+{
+  std::mt19937 rng(1);
+
+  const int n = 50;
+  const int q = 15;
+
+  Eigen::MatrixXd x = randomNormal(n, q, rng);
+  Eigen::VectorXd v = randomNormal(n, 1, rng);
+
+  Eigen::MatrixXd x_full = allInteractions(x);
+
+  for (double threshold : { 0.0, 5.0, 10.0, 20.0, 1e3 }) {
+    INFO("threshold " << threshold);
+
+    auto candidates = slope::screenInteractions(x, v, threshold);
+
+    REQUIRE(std::is_sorted(candidates.begin(), candidates.end()));
+
+    int col = q;
+
+    for (int i = 0; i < q; ++i) {
+      for (int j = i + 1; j < q; ++j, ++col) {
+        if (std::abs(x_full.col(col).dot(v)) >= threshold) {
+          INFO("pair " << i << ", " << j);
+          REQUIRE(std::binary_search(
+            candidates.begin(), candidates.end(), std::make_pair(i, j)));
+        }
+      }
+    }
+
+    if (threshold == 0) {
+      REQUIRE(candidates.size() == q * (q - 1) / 2);
+    }
+
+    if (threshold == 1e3) {
+      REQUIRE(candidates.empty());
+    }
+  }
+
+  slope::InteractionMatrix x_int(x, { { 0, 3 }, { 2, 14 } });
+
+  REQUIRE(x_int.cols() == q + 2);
+
+  Eigen::VectorXd x_03 = x.col(0).cwiseProduct(x.col(3));
+  REQUIRE_THAT(x_int.col(q), VectorApproxEqual(x_03));
+
+  REQUIRE_THROWS_AS(slope::InteractionMatrix(x, { { 3, 3 } }),
+                    std::invalid_argument);
+  REQUIRE_THROWS_AS(slope::InteractionMatrix(x, { { 2, 15 } }),
+                    std::invalid_argument);
+}
+
+TEST_CASE("Interaction paths", "[interactions]")
+{
+  std::mt19937 rng(2);
+  std::normal_distribution<double> noise;
+  std::uniform_real_distribution<double> unif;
+
+  const int n = 200;
+  const int q = 12;
+
+  Eigen::MatrixXd x = randomNormal(n, q, rng);
+  Eigen::MatrixXd x_full = allInteractions(x);
+
+  // Two main effects, and the interactions (0, 1) and (4, 7)
+  Eigen::VectorXd eta = x.col(0) - x.col(1) +
+                        1.5 * x.col(0).cwiseProduct(x.col(1)) -
+                        x.col(4).cwiseProduct(x.col(7));
+
+  for (const std::string loss : { "quadratic", "logistic" }) {
+    INFO("loss " << loss);
+
+    Eigen::VectorXd y(n);
+
+    for (int i = 0; i < n; ++i) {
+      y(i) = loss == "quadratic"
+               ? eta(i) + noise(rng)
+               : static_cast<double>(unif(rng) < 1 / (1 + std::exp(-eta(i))));
+    }
+
+    slope::Slope model;
+    model.setLoss(loss);
+    model.setCentering("none");
+    model.setScaling("none");
+    model.setTol(1e-10);
+    model.setPathLength(20);
+    model.setAlphaMinRatio(0.05);
+
+    auto path = slope::interactionPath(model, x, y);
+    auto path_ref = model.path(x_full, y);
+
+    REQUIRE(path.size() == path_ref.size());
+
+    // Only part of the interactions are formed on a short path
+    REQUIRE(path.getPairs().size() < q * (q - 1) / 2);
+
+    for (size_t step = 0; step < path.size(); ++step) {
+      INFO("step " << step);
+
+      Eigen::SparseMatrix<double> coefs_ref_full = path_ref(step).getCoefs();
+      Eigen::MatrixXd coefs_ref = Eigen::MatrixXd::Zero(q, q);
+
+      coefs_ref.diagonal() = coefs_ref_full.toDense().topRows(q);
+
+      int col = q;
+
+      for (int i = 0; i < q; ++i) {
+        for (int j = i + 1; j < q; ++j) {
+          coefs_ref(i, j) = coefs_ref_full.coeff(col++, 0);
+        }
+      }
+
+      Eigen::VectorXd coefs = Eigen::MatrixXd(path.getCoefs(step)).reshaped();
+
+      REQUIRE_THAT(coefs,
+                   VectorApproxEqual(Eigen::VectorXd(coefs_ref.reshaped()),
+                                     1e-6));
+    }
+
+    const size_t last = path.size() - 1;
+
+    Eigen::MatrixXd coefs = path.getCoefs(last);
+    REQUIRE(coefs(0, 1) != 0);
+    REQUIRE(coefs(4, 7) != 0);
+
+    Eigen::VectorXd pred = path.predict(x, last);
+    Eigen::VectorXd pred_ref = path_ref(last).predict(x_full);
+
+    REQUIRE_THAT(pred, VectorApproxEqual(pred_ref, 1e-6));
+  }
+
+  slope::Slope model;
+  REQUIRE_THROWS_AS(slope::interactionPath(model, x, eta),
+                    std::invalid_argument);
+}
@@ -2,6 +2,7 @@
 #include <Eigen/Core>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
 #include <slope/regularization_sequence.h>
 
 TEST_CASE("Test that regularization sequence generation works",
@@ -68,6 +69,22 @@ TEST_CASE("Test that regularization sequence generation works",
     REQUIRE_THAT(l3, VectorApproxEqual(std::vector<double>(4, 1.0), tol));
   }
 
+  SECTION("Smallest value")
+  {
+    for (const std::string type : { "bh", "oscar", "lasso" }) {
+      INFO("type " << type);
+
+      Eigen::ArrayXd lambda = slope::lambdaSequence(p, q, type, n, 2.0, 0.1);
+
+      REQUIRE_THAT(slope::lambdaSequenceMin(q, type, 2.0),
+                   Catch::Matchers::WithinAbs(lambda(p - 1), tol));
+    }
+
+    Eigen::ArrayXd lambda = slope::lambdaSequence(p, q, "gaussian", n);
+
+    REQUIRE(slope::lambdaSequenceMin(q, "gaussian") <= lambda(p - 1));
+  }
+
   SECTION("Assertions")
   {
     REQUIRE_THROWS(slope::lambdaSequence(p, q, "gaussian", -5));
@@ -0,0 +1,208 @@
+#include "test_helpers.hpp"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <cmath>
+#include <random>
+#include <slope/linear_operator.h>
+#include <slope/slope.h>
+
+namespace {
+
+/// The Kronecker product of two matrices, which is never formed
+class Kronecker : public slope::LinearOperator
+{
+public:
+  Kronecker(Eigen::MatrixXd a_in, Eigen::MatrixXd b_in)
+    : a(std::move(a_in))
+    , b(std::move(b_in))
+  {
+  }
+
+  Eigen::Index rows() const override { return a.rows() * b.rows(); }
+
+  Eigen::Index cols() const override { return a.cols() * b.cols(); }
+
+  double colDot(const int j,
+                const Eigen::Ref<const Eigen::VectorXd>& v) const override
+  {
+    const int n_b = b.rows();
+    const int i = j / b.cols();
+    const int l = j % b.cols();
+
+    double out = 0;
+
+    for (int r = 0; r < a.rows(); ++r) {
+      out += a(r, i) * b.col(l).dot(v.segment(r * n_b, n_b));
+    }
+
+    return out;
+  }
+
+  void colAxpy(const int j,
+               const double alpha,
+               Eigen::Ref<Eigen::VectorXd> v) const override
+  {
+    const int n_b = b.rows();
+    const int i = j / b.cols();
+    const int l = j % b.cols();
+
+    for (int r = 0; r < a.rows(); ++r) {
+      v.segment(r * n_b, n_b) += alpha * a(r, i) * b.col(l);
+    }
+  }
+
+  Eigen::MatrixXd toDense() const
+  {
+    Eigen::MatrixXd out(rows(), cols());
+
+    for (int r = 0; r < a.rows(); ++r) {
+      for (int i = 0; i < a.cols(); ++i) {
+        out.block(r * b.rows(), i * b.cols(), b.rows(), b.cols()) =
+          a(r, i) * b;
+      }
+    }
+
+    return out;
+  }
+
+private:
+  Eigen::MatrixXd a;
+  Eigen::MatrixXd b;
+};
+
+} // namespace
+
+TEST_CASE("Linear operators", "[linear_operator]")
+{
+  std::mt19937 rng(1);
+  std::normal_distribution<double> normal;
+
+  auto random = [&](const int n, const int p) {
+    return Eigen::MatrixXd(
+      Eigen::MatrixXd::NullaryExpr(n, p, [&]() { return normal(rng); }));
+  };
+
+  Kronecker x(random(4, 2), random(5, 3));
+  Eigen::MatrixXd x_dense = x.toDense();
+
+  REQUIRE(x.rows() == 20);
+  REQUIRE(x.cols() == 6);
+
+  Eigen::VectorXd v = random(20, 1);
+  Eigen::VectorXd w = random(20, 1).cwiseAbs();
+
+  for (int j = 0; j < 6; ++j) {
+    INFO("column " << j);
+    Eigen::VectorXd x_j = x_dense.col(j);
+
+    REQUIRE_THAT(x.col(j), VectorApproxEqual(x_j));
+    REQUIRE_THAT(x.colDot(j, v),
+                 Catch::Matchers::WithinAbs(x_j.dot(v), 1e-10));
+    REQUIRE_THAT(x.colSquaredNorm(j, w),
+                 Catch::Matchers::WithinAbs(x_j.cwiseAbs2().dot(w), 1e-10));
+    REQUIRE_THAT(x.colSum(j), Catch::Matchers::WithinAbs(x_j.sum(), 1e-10));
+  }
+
+  Eigen::VectorXd means = x_dense.colwise().mean();
+  Eigen::VectorXd sds =
+    ((x_dense.rowwise() - means.transpose()).colwise().squaredNorm() / 20)
+      .cwiseSqrt();
+
+  Eigen::VectorXd x_centers, x_scales;
+  slope::normalize(x, x_centers, x_scales, "mean", "sd", false);
+
+  REQUIRE_THAT(x_centers, VectorApproxEqual(means));
+  REQUIRE_THAT(x_scales, VectorApproxEqual(sds));
+  REQUIRE(slope::isFinite(x));
+}
+
+TEST_CASE("Paths on linear operators", "[linear_operator]")
+{
+  std::mt19937 rng(2);
+  std::normal_distribution<double> normal;
+  std::uniform_real_distribution<double> unif;
+
+  auto random = [&](const int n, const int p) {
+    return Eigen::MatrixXd(
+      Eigen::MatrixXd::NullaryExpr(n, p, [&]() { return normal(rng); }));
+  };
+
+  Kronecker x(random(20, 4), random(10, 5));
+  Eigen::MatrixXd x_dense = x.toDense();
+  Eigen::SparseMatrix<double> x_sparse = x_dense.sparseView();
+
+  const int n = x.rows();
+  const int p = x.cols();
+
+  Eigen::VectorXd beta = Eigen::VectorXd::Zero(p);
+  beta.head(4) << 1, -1, 0.5, -0.5;
+
+  Eigen::VectorXd eta = x_dense * beta;
+
+  for (const std::string loss : { "quadratic", "logistic" }) {
+    for (const std::string solver : { "hybrid", "pgd" }) {
+      INFO("loss " << loss << ", solver " << solver);
+
+      Eigen::VectorXd y(n);
+
+      for (int i = 0; i < n; ++i) {
+        y(i) = loss == "quadratic"
+                 ? eta(i) + normal(rng)
+                 : static_cast<double>(unif(rng) < 1 / (1 + std::exp(-eta(i))));
+      }
+
+      slope::Slope model;
+      model.setLoss(loss);
+      model.setSolver(solver);
+      model.setTol(1e-10);
+      model.setPathLength(20);
+
+      auto path = model.path(x, y);
+      auto path_ref = model.path(x_sparse, y);
+
+      REQUIRE(path.size() == path_ref.size());
+
+      for (size_t i = 0; i < path.size(); ++i) {
+        INFO("step " << i);
+        Eigen::VectorXd coefs = path(i).getCoefs().toDense().reshaped();
+        Eigen::VectorXd coefs_ref =
+          path_ref(i).getCoefs().toDense().reshaped();
+
+        REQUIRE_THAT(coefs, VectorApproxEqual(coefs_ref, 1e-6));
+      }
+
+      Eigen::VectorXd pred = path(path.size() - 1).predict(x, "linear");
+      Eigen::VectorXd pred_ref =
+        path_ref(path.size() - 1).predict(x_dense, "linear");
+
+      REQUIRE_THAT(pred, VectorApproxEqual(pred_ref, 1e-6));
+    }
+  }
+
+  SECTION("Weights")
+  {
+    Eigen::VectorXd y = eta + Eigen::VectorXd::Ones(n);
+    Eigen::VectorXd weights = Eigen::VectorXd::Ones(n);
+    weights.head(40).setZero();
+    weights.tail(60) *= 3;
+
+    slope::Slope model;
+    model.setTol(1e-10);
+    model.setPathLength(20);
+
+    auto path = model.path(x, y, weights);
+    auto path_ref = model.path(x_sparse, y, weights);
+
+    REQUIRE(path.size() == path_ref.size());
+
+    for (size_t i = 0; i < path.size(); ++i) {
+      INFO("step " << i);
+      Eigen::VectorXd coefs = path(i).getCoefs().toDense().reshaped();
+      Eigen::VectorXd coefs_ref = path_ref(i).getCoefs().toDense().reshaped();
+
+      REQUIRE_THAT(coefs, VectorApproxEqual(coefs_ref, 1e-6));
+    }
+  }
+}
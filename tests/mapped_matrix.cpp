@@ -0,0 +1,154 @@
+#include "generate_data.hpp"
+#include "test_helpers.hpp"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <slope/mapped_matrix.h>
+#include <slope/slope.h>
+
+TEST_CASE("Memory-mapped design matrices", "[mapped_matrix]")
+{
+  using Catch::Matchers::WithinAbs;
+
+  auto data = generateData(100, 10, "quadratic", 1, 0.4, 0.5, 42);
+  Eigen::SparseMatrix<double> x_sparse = data.x.sparseView();
+
+  const std::string file =
+    (std::filesystem::temp_directory_path() / "slope_mapped_matrix.bin")
+      .string();
+
+  slope::Slope model;
+  model.setTol(1e-10);
+
+  SECTION("Dense")
+  {
+    slope::writeMappedMatrix(file, data.x);
+
+    slope::MappedMatrix mapped(file);
+
+    REQUIRE_FALSE(mapped.isSparse());
+    REQUIRE(mapped.rows() == data.x.rows());
+    REQUIRE(mapped.cols() == data.x.cols());
+    REQUIRE_THROWS_AS(mapped.sparse(), std::runtime_error);
+
+    auto x = mapped.dense();
+
+    REQUIRE(x == data.x);
+
+    // Aligned for vectorization
+    REQUIRE(reinterpret_cast<std::uintptr_t>(x.data()) % 64 == 0);
+
+    const slope::ColumnStatistics& x_stats = mapped.statistics();
+
+    REQUIRE(x_stats.rows() == data.x.rows());
+    Eigen::VectorXd means = data.x.colwise().mean();
+    Eigen::VectorXd maxima = data.x.colwise().maxCoeff();
+
+    REQUIRE_THAT(x_stats.getMeans(), VectorApproxEqual(means));
+    REQUIRE_THAT(x_stats.getMaxima(), VectorApproxEqual(maxima));
+
+    auto path = model.path(x, data.y, x_stats);
+    auto path_ref = model.path(data.x, data.y);
+
+    REQUIRE(path.size() == path_ref.size());
+
+    for (size_t i = 0; i < path.size(); ++i) {
+      INFO("step " << i);
+      Eigen::VectorXd coefs = path(i).getCoefs().toDense().reshaped();
+      Eigen::VectorXd coefs_ref = path_ref(i).getCoefs().toDense().reshaped();
+
+      REQUIRE_THAT(coefs, VectorApproxEqual(coefs_ref, 1e-8));
+    }
+
+    // Modifying the matrix does not modify the file
+    x(0, 0) += 1;
+
+    slope::MappedMatrix remapped(file);
+    REQUIRE(remapped.dense()(0, 0) == data.x(0, 0));
+  }
+
+  SECTION("Sparse")
+  {
+    slope::writeMappedMatrix(file, x_sparse);
+
+    slope::MappedMatrix mapped(file);
+
+    REQUIRE(mapped.isSparse());
+    REQUIRE(mapped.indexBytes() == 4);
+    REQUIRE_THROWS_AS(mapped.dense(), std::runtime_error);
+
+    auto x = mapped.sparse();
+
+    REQUIRE(x.nonZeros() == x_sparse.nonZeros());
+    REQUIRE(Eigen::MatrixXd(x) == data.x);
+
+    auto path = model.path(x, data.y, mapped.statistics());
+    auto path_ref = model.path(x_sparse, data.y);
+
+    REQUIRE(path.size() == path_ref.size());
+
+    for (size_t i = 0; i < path.size(); ++i) {
+      INFO("step " << i);
+      Eigen::VectorXd coefs = path(i).getCoefs().toDense().reshaped();
+      Eigen::VectorXd coefs_ref = path_ref(i).getCoefs().toDense().reshaped();
+
+      REQUIRE_THAT(coefs, VectorApproxEqual(coefs_ref, 1e-8));
+    }
+  }
+
+  SECTION("Invalid files")
+  {
+    {
+      std::ofstream out(file, std::ios::binary);
+      out << "not a matrix file, but long enough to hold a header of 64 bytes";
+    }
+
+    REQUIRE_THROWS_AS(slope::MappedMatrix(file), std::runtime_error);
+
+    slope::writeMappedMatrix(file, data.x);
+    std::filesystem::resize_file(file, 1000);
+
+    REQUIRE_THROWS_AS(slope::MappedMatrix(file), std::runtime_error);
+
+    REQUIRE_THROWS_AS(slope::MappedMatrix(file + ".missing"),
+                      std::runtime_error);
+
+    // Sparse matrices with corrupted indices, at the offsets of the format
+    auto aligned = [](std::size_t offset) { return (offset + 63) / 64 * 64; };
+
+    const int p = x_sparse.cols();
+    const int nnz = x_sparse.nonZeros();
+    const std::size_t outer = 64 + 5 * aligned(p * sizeof(double));
+    const std::size_t inner = aligned(outer + (p + 1) * sizeof(int));
+
+    auto corrupt = [&](const std::size_t offset, const int value) {
+      slope::writeMappedMatrix(file, x_sparse);
+
+      std::fstream out(file, std::ios::binary | std::ios::in | std::ios::out);
+      out.seekp(offset);
+      out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+
+    corrupt(outer, 1);
+    REQUIRE_THROWS_AS(slope::MappedMatrix(file), std::runtime_error);
+
+    corrupt(outer + sizeof(int), nnz);
+    REQUIRE_THROWS_AS(slope::MappedMatrix(file), std::runtime_error);
+
+    corrupt(outer + p * sizeof(int), nnz - 1);
+    REQUIRE_THROWS_AS(slope::MappedMatrix(file), std::runtime_error);
+
+    corrupt(inner, x_sparse.rows());
+    REQUIRE_THROWS_AS(slope::MappedMatrix(file), std::runtime_error);
+
+    corrupt(inner, -1);
+    REQUIRE_THROWS_AS(slope::MappedMatrix(file), std::runtime_error);
+  }
+
+  std::filesystem::remove(file);
+}
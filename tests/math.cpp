@@ -718,4 +718,21 @@ TEST_CASE("whichBest function works correctly", "[score][math]")
     int best_idx = slope::whichBest(single_score, comp);
     REQUIRE(best_idx == 0);
   }
+
+  SECTION("NaN elements are ignored")
+  {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    Eigen::ArrayXd scores(4);
+    scores << nan, 3.0, nan, 4.0;
+
+    auto scorer = slope::Score::create("mse");
+    auto comp = scorer->getComparator();
+
+    REQUIRE(slope::whichBest(scores, comp) == 1);
+
+    scores.setConstant(nan);
+
+    REQUIRE(slope::whichBest(scores, comp) == -1);
+  }
 }
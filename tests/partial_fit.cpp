@@ -0,0 +1,186 @@
+#include "generate_data.hpp"
+#include "test_helpers.hpp"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <slope/column_statistics.h>
+#include <slope/normalize.h>
+#include <slope/slope.h>
+
+TEST_CASE("Running column statistics", "[normalization][partial_fit]")
+{
+  using namespace Catch::Matchers;
+
+  auto data = generateData(100, 8);
+  Eigen::SparseMatrix<double> x_sparse = data.x.sparseView();
+
+  slope::ColumnStatistics stats_dense(data.x.cols());
+  slope::ColumnStatistics stats_sparse(data.x.cols());
+
+  for (int row : { 0, 13, 50, 51, 100 }) {
+    stats_dense.update(data.x, stats_dense.rows(), row);
+    stats_sparse.update(x_sparse, stats_sparse.rows(), row);
+  }
+
+  REQUIRE(stats_dense.rows() == 100);
+
+  for (const std::string type : { "mean", "min" }) {
+    Eigen::VectorXd expected, dense, sparse;
+    slope::computeCenters(expected, data.x, type);
+    stats_dense.centers(dense, type);
+    stats_sparse.centers(sparse, type);
+
+    REQUIRE_THAT(dense, VectorApproxEqual(expected, 1e-10));
+    REQUIRE_THAT(sparse, VectorApproxEqual(expected, 1e-10));
+  }
+
+  for (const std::string type : { "sd", "l1", "l2", "max_abs", "range" }) {
+    Eigen::VectorXd expected, dense, sparse;
+    slope::computeScales(expected, data.x, type);
+    stats_dense.scales(dense, type);
+    stats_sparse.scales(sparse, type);
+
+    REQUIRE_THAT(dense, VectorApproxEqual(expected, 1e-10));
+    REQUIRE_THAT(sparse, VectorApproxEqual(expected, 1e-10));
+  }
+
+  REQUIRE_THROWS_AS(stats_dense.update(data.x.leftCols(3), 0, 10),
+                    std::invalid_argument);
+}
+
+TEST_CASE("Removing rows from column statistics",
+          "[normalization][partial_fit]")
+{
+  using namespace Catch::Matchers;
+
+  auto data = generateData(100, 8);
+
+  // A column that is constant in the remaining rows
+  data.x.col(2).setConstant(1.5);
+  data.x(7, 2) = 4.0;
+
+  Eigen::SparseMatrix<double> x_sparse = data.x.sparseView();
+
+  std::vector<int> removed = { 3, 7, 20, 21, 64, 99 };
+  std::vector<int> kept;
+
+  for (int i = 0; i < 100; ++i) {
+    if (std::find(removed.begin(), removed.end(), i) == removed.end()) {
+      kept.emplace_back(i);
+    }
+  }
+
+  Eigen::MatrixXd x_kept = slope::subset(data.x, kept);
+
+  slope::ColumnStatistics stats_dense(8);
+  slope::ColumnStatistics stats_sparse(8);
+
+  stats_dense.update(data.x);
+  stats_sparse.update(x_sparse);
+
+  stats_dense.remove(slope::subset(data.x, removed));
+  stats_sparse.remove(slope::subset(x_sparse, removed));
+
+  REQUIRE(stats_dense.rows() == 94);
+  REQUIRE(stats_sparse.rows() == 94);
+
+  Eigen::VectorXd expected, dense, sparse;
+
+  slope::computeCenters(expected, x_kept, "mean");
+  stats_dense.centers(dense, "mean");
+  stats_sparse.centers(sparse, "mean");
+
+  REQUIRE_THAT(dense, VectorApproxEqual(expected, 1e-10));
+  REQUIRE_THAT(sparse, VectorApproxEqual(expected, 1e-10));
+
+  for (const std::string type : { "sd", "l1", "l2" }) {
+    slope::computeScales(expected, x_kept, type);
+    stats_dense.scales(dense, type);
+    stats_sparse.scales(sparse, type);
+
+    REQUIRE_THAT(dense, VectorApproxEqual(expected, 1e-10));
+    REQUIRE_THAT(sparse, VectorApproxEqual(expected, 1e-10));
+  }
+
+  stats_dense.scales(dense, "sd");
+  REQUIRE(dense(2) == 0.0);
+
+  REQUIRE_FALSE(stats_dense.hasExtrema());
+  REQUIRE_THROWS_AS(stats_dense.centers(dense, "min"), std::runtime_error);
+  REQUIRE_THROWS_AS(stats_dense.scales(dense, "range"), std::runtime_error);
+
+  slope::ColumnStatistics small(8);
+  small.update(data.x, 0, 3);
+  REQUIRE_THROWS_AS(small.remove(data.x), std::invalid_argument);
+}
+
+TEST_CASE("Partial fit", "[path][partial_fit]")
+{
+  using namespace Catch::Matchers;
+
+  const double alpha = 0.02;
+
+  slope::Slope model;
+  model.setTol(1e-9);
+
+  SECTION("Quadratic, dense")
+  {
+    auto data = generateData(300, 20);
+
+    Eigen::MatrixXd x_100 = data.x.topRows(100);
+    Eigen::MatrixXd x_200 = data.x.topRows(200);
+
+    model.partialFit(x_100, data.y.head(100), alpha);
+    model.partialFit(x_200, data.y.head(200));
+    auto fit_partial = model.partialFit(data.x, data.y);
+
+    auto fit_full = model.fit(data.x, data.y, alpha);
+
+    Eigen::VectorXd coefs_partial = fit_partial.getCoefs();
+    Eigen::VectorXd coefs_full = fit_full.getCoefs();
+
+    REQUIRE(fit_partial.getAlpha() == alpha);
+    REQUIRE_THAT(coefs_partial, VectorApproxEqual(coefs_full, 1e-5));
+    REQUIRE_THAT(fit_partial.getIntercepts()(0),
+                 WithinAbs(fit_full.getIntercepts()(0), 1e-5));
+  }
+
+  SECTION("Logistic, sparse")
+  {
+    auto data = generateData(300, 20, "logistic");
+    Eigen::SparseMatrix<double> x = data.x.sparseView();
+
+    model.setLoss("logistic");
+
+    Eigen::SparseMatrix<double> x_head = x.topRows(150);
+    model.partialFit(x_head, data.y.head(150), alpha);
+    auto fit_partial = model.partialFit(x, data.y);
+
+    auto fit_full = model.fit(x, data.y, alpha);
+
+    Eigen::VectorXd coefs_partial = fit_partial.getCoefs();
+    Eigen::VectorXd coefs_full = fit_full.getCoefs();
+
+    REQUIRE_THAT(coefs_partial, VectorApproxEqual(coefs_full, 1e-4));
+  }
+
+  SECTION("Reset and invalid input")
+  {
+    auto data = generateData(100, 10);
+
+    model.partialFit(data.x, data.y, alpha);
+
+    Eigen::MatrixXd x_short = data.x.topRows(50);
+    Eigen::VectorXd y_short = data.y.head(50);
+
+    REQUIRE_THROWS_AS(model.partialFit(x_short, y_short),
+                      std::invalid_argument);
+
+    model.resetPartialFit();
+
+    REQUIRE_NOTHROW(model.partialFit(x_short, y_short, alpha));
+  }
+}
@@ -0,0 +1,165 @@
+#include "test_helpers.hpp"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <random>
+#include <slope/partitioned_matrix.h>
+#include <slope/slope.h>
+
+namespace {
+
+/// A matrix with `p_dense` normal columns followed by `p_sparse` columns
+/// with about one nonzero value in ten
+Eigen::MatrixXd
+mixedDesign(const int n, const int p_dense, const int p_sparse, const int seed)
+{
+  std::mt19937 rng(seed);
+  std::normal_distribution<double> normal;
+  std::bernoulli_distribution nonzero(0.1);
+
+  Eigen::MatrixXd x = Eigen::MatrixXd::Zero(n, p_dense + p_sparse);
+
+  for (int j = 0; j < x.cols(); ++j) {
+    for (int i = 0; i < n; ++i) {
+      if (j < p_dense || nonzero(rng)) {
+        x(i, j) = normal(rng);
+      }
+    }
+  }
+
+  return x;
+}
+
+} // namespace
+
+TEST_CASE("Partitioned matrices", "[partitioned_matrix]")
+{
+  Eigen::MatrixXd x_dense = mixedDesign(50, 3, 5, 1);
+  Eigen::SparseMatrix<double> x_sparse = x_dense.sparseView();
+
+  slope::PartitionedMatrix x(x_sparse);
+  slope::PartitionedMatrix x_from_dense(x_dense);
+
+  REQUIRE(x.rows() == 50);
+  REQUIRE(x.cols() == 8);
+  REQUIRE(x.getDenseColumns() == std::vector<int>{ 0, 1, 2 });
+  REQUIRE(x.getSparseColumns() == std::vector<int>{ 3, 4, 5, 6, 7 });
+  REQUIRE(x_from_dense.getDenseColumns() == x.getDenseColumns());
+
+  for (int j = 0; j < 8; ++j) {
+    INFO("column " << j);
+    Eigen::VectorXd x_j = x_dense.col(j);
+
+    REQUIRE_THAT(x.col(j), VectorApproxEqual(x_j));
+    REQUIRE_THAT(x_from_dense.col(j), VectorApproxEqual(x_j));
+  }
+
+  // All columns are stored as dense or as sparse at the extremes
+  REQUIRE(slope::PartitionedMatrix(x_sparse, 0.0).getSparse().cols() == 0);
+  REQUIRE(slope::PartitionedMatrix(x_sparse, 1.0).getDense().cols() == 0);
+
+  Eigen::VectorXd means = x_dense.colwise().mean();
+  Eigen::VectorXd sds =
+    ((x_dense.rowwise() - means.transpose()).colwise().squaredNorm() / 50)
+      .cwiseSqrt();
+
+  Eigen::VectorXd x_centers, x_scales;
+  slope::normalize(x, x_centers, x_scales, "mean", "sd", false);
+
+  REQUIRE_THAT(x_centers, VectorApproxEqual(means));
+  REQUIRE_THAT(x_scales, VectorApproxEqual(sds));
+
+  REQUIRE_THROWS_AS(slope::PartitionedMatrix(x_sparse, 1.5),
+                    std::invalid_argument);
+  REQUIRE_THROWS_AS(slope::PartitionedMatrix(Eigen::MatrixXd::Ones(3, 2),
+                                             Eigen::SparseMatrix<double>(4, 2)),
+                    std::invalid_argument);
+}
+
+TEST_CASE("Paths on partitioned matrices", "[partitioned_matrix]")
+{
+  const int n = 200;
+  const int p = 30;
+
+  Eigen::MatrixXd x_dense = mixedDesign(n, 5, p - 5, 2);
+  Eigen::SparseMatrix<double> x_sparse = x_dense.sparseView();
+  slope::PartitionedMatrix x(x_sparse);
+
+  REQUIRE(x.getDense().cols() == 5);
+
+  // Signal in both the dense and the sparse columns
+  Eigen::VectorXd beta = Eigen::VectorXd::Zero(p);
+  beta.head(8) << 1, -1, 0.5, 0, 0, 2, -2, 1.5;
+
+  std::mt19937 rng(3);
+  std::normal_distribution<double> noise;
+  std::uniform_real_distribution<double> unif;
+
+  Eigen::VectorXd eta = x_sparse * beta;
+
+  for (const std::string loss : { "quadratic", "logistic" }) {
+    for (const std::string solver : { "hybrid", "pgd" }) {
+      INFO("loss " << loss << ", solver " << solver);
+
+      Eigen::VectorXd y(n);
+
+      for (int i = 0; i < n; ++i) {
+        y(i) = loss == "quadratic"
+                 ? eta(i) + noise(rng)
+                 : static_cast<double>(unif(rng) < 1 / (1 + std::exp(-eta(i))));
+      }
+
+      slope::Slope model;
+      model.setLoss(loss);
+      model.setSolver(solver);
+      model.setTol(1e-10);
+      model.setPathLength(20);
+
+      auto path = model.path(x, y);
+      auto path_ref = model.path(x_sparse, y);
+
+      REQUIRE(path.size() == path_ref.size());
+
+      for (size_t i = 0; i < path.size(); ++i) {
+        INFO("step " << i);
+        Eigen::VectorXd coefs = path(i).getCoefs().toDense().reshaped();
+        Eigen::VectorXd coefs_ref =
+          path_ref(i).getCoefs().toDense().reshaped();
+
+        REQUIRE_THAT(coefs, VectorApproxEqual(coefs_ref, 1e-6));
+      }
+
+      Eigen::VectorXd pred = path(path.size() - 1).predict(x, "linear");
+      Eigen::VectorXd pred_ref =
+        path_ref(path.size() - 1).predict(x_sparse, "linear");
+
+      REQUIRE_THAT(pred, VectorApproxEqual(pred_ref, 1e-6));
+    }
+  }
+
+  SECTION("Weights")
+  {
+    Eigen::VectorXd y = eta + Eigen::VectorXd::Ones(n);
+    Eigen::VectorXd weights = Eigen::VectorXd::Ones(n);
+    weights.head(40).setZero();
+    weights.tail(60) *= 3;
+
+    slope::Slope model;
+    model.setTol(1e-10);
+    model.setPathLength(20);
+
+    auto path = model.path(x, y, weights);
+    auto path_ref = model.path(x_sparse, y, weights);
+
+    REQUIRE(path.size() == path_ref.size());
+
+    for (size_t i = 0; i < path.size(); ++i) {
+      INFO("step " << i);
+      Eigen::VectorXd coefs = path(i).getCoefs().toDense().reshaped();
+      Eigen::VectorXd coefs_ref = path_ref(i).getCoefs().toDense().reshaped();
+
+      REQUIRE_THAT(coefs, VectorApproxEqual(coefs_ref, 1e-6));
+    }
+  }
+}
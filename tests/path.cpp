@@ -156,3 +156,84 @@ TEST_CASE("Path fitting", "[path][quadratic][alpha]")
     REQUIRE(path.getClusters().size() > 0);
   }
 }
+
+TEST_CASE("Streaming path", "[path][callback]")
+{
+  using namespace Catch::Matchers;
+
+  auto data = generateData(100, 20);
+
+  slope::Slope model;
+  model.setPathLength(20);
+
+  auto path = model.path(data.x, data.y);
+
+  SECTION("Callback sees the same fits as path()")
+  {
+    std::vector<double> alphas;
+    std::vector<Eigen::VectorXd> coefs;
+
+    model.path(data.x, data.y, [&](const slope::SlopeFit& fit) {
+      alphas.emplace_back(fit.getAlpha());
+      coefs.emplace_back(fit.getCoefs());
+      return true;
+    });
+
+    REQUIRE(alphas.size() == path.size());
+
+    for (size_t i = 0; i < path.size(); ++i) {
+      Eigen::VectorXd coef = path(i).getCoefs();
+      REQUIRE_THAT(alphas[i], WithinAbs(path(i).getAlpha(), 1e-12));
+      REQUIRE_THAT(coefs[i], VectorApproxEqual(coef, 1e-8));
+    }
+  }
+
+  SECTION("Consumer can stop the path early")
+  {
+    int n_steps = 0;
+
+    model.path(data.x, data.y, [&](const slope::SlopeFit&) {
+      n_steps++;
+      return n_steps < 3;
+    });
+
+    REQUIRE(n_steps == 3);
+  }
+}
+
+TEST_CASE("Compact path storage", "[path][multinomial]")
+{
+  using namespace Catch::Matchers;
+
+  auto data = generateData(100, 10, "multinomial", 3);
+
+  slope::Slope model;
+  model.setLoss("multinomial");
+  model.setPathLength(10);
+
+  auto path = model.path(data.x, data.y);
+
+  const int p = 10;
+  const int m = path(0).getCoefs().cols();
+
+  auto coef_matrix = path.getCoefMatrix();
+
+  REQUIRE(coef_matrix.rows() == p);
+  REQUIRE(coef_matrix.cols() == m * static_cast<int>(path.size()));
+
+  auto coefs = path.getCoefs(false);
+
+  for (size_t i = 0; i < path.size(); ++i) {
+    Eigen::MatrixXd view = path.getCoefView(i);
+    Eigen::MatrixXd coef = coefs[i];
+    Eigen::MatrixXd block = Eigen::MatrixXd(coef_matrix).middleCols(i * m, m);
+
+    REQUIRE(view.isApprox(coef));
+    REQUIRE(block.isApprox(coef));
+  }
+
+  // Metadata is shared, not copied, between the fits
+  REQUIRE(path(0).getMetadata() == path(1).getMetadata());
+  REQUIRE(path(0).getMetadata() == path.getMetadata());
+  REQUIRE(path(0).getLossType() == "multinomial");
+}
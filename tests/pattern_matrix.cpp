@@ -0,0 +1,150 @@
+#include "generate_data.hpp"
+#include "test_helpers.hpp"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <random>
+#include <slope/pattern_matrix.h>
+#include <slope/slope.h>
+
+namespace {
+
+Eigen::SparseMatrix<double>
+indicators(const int n, const int p, const double density, const int seed)
+{
+  std::mt19937 rng(seed);
+  std::bernoulli_distribution one(density);
+
+  std::vector<Eigen::Triplet<double>> triplets;
+
+  for (int j = 0; j < p; ++j) {
+    for (int i = 0; i < n; ++i) {
+      if (one(rng)) {
+        triplets.emplace_back(i, j, 1.0);
+      }
+    }
+  }
+
+  Eigen::SparseMatrix<double> x(n, p);
+  x.setFromTriplets(triplets.begin(), triplets.end());
+
+  return x;
+}
+
+} // namespace
+
+TEST_CASE("Pattern matrices", "[pattern_matrix]")
+{
+  Eigen::SparseMatrix<double> x_sparse = indicators(50, 8, 0.3, 1);
+
+  slope::PatternMatrix x(x_sparse);
+
+  REQUIRE(x.rows() == 50);
+  REQUIRE(x.cols() == 8);
+  REQUIRE(x.nonZeros() == x_sparse.nonZeros());
+  REQUIRE(Eigen::MatrixXd(x.toSparse()) == Eigen::MatrixXd(x_sparse));
+
+  Eigen::MatrixXd x_dense = x_sparse;
+  Eigen::VectorXd means = x_dense.colwise().mean();
+  Eigen::VectorXd sds =
+    ((x_dense.rowwise() - means.transpose()).colwise().squaredNorm() / 50)
+      .cwiseSqrt();
+
+  Eigen::VectorXd x_centers, x_scales;
+  slope::normalize(x, x_centers, x_scales, "mean", "sd", false);
+
+  REQUIRE_THAT(x_centers, VectorApproxEqual(means));
+  REQUIRE_THAT(x_scales, VectorApproxEqual(sds));
+
+  Eigen::SparseMatrix<double> x_twos = 2 * x_sparse;
+  REQUIRE_THROWS_AS(slope::PatternMatrix(x_twos), std::invalid_argument);
+
+  REQUIRE_THROWS_AS(slope::PatternMatrix(3, 2, { 0, 1 }, { 0 }),
+                    std::invalid_argument);
+  REQUIRE_THROWS_AS(slope::PatternMatrix(3, 1, { 0, 1 }, { 3 }),
+                    std::invalid_argument);
+}
+
+TEST_CASE("Paths on pattern matrices", "[pattern_matrix]")
+{
+  const int n = 200;
+  const int p = 30;
+
+  Eigen::SparseMatrix<double> x_sparse = indicators(n, p, 0.2, 2);
+  slope::PatternMatrix x(x_sparse);
+
+  Eigen::VectorXd beta = Eigen::VectorXd::Zero(p);
+  beta.head(5) << 2, -2, 1.5, 1, -1;
+
+  std::mt19937 rng(3);
+  std::normal_distribution<double> noise;
+  std::uniform_real_distribution<double> unif;
+
+  Eigen::VectorXd eta = x_sparse * beta;
+
+  for (const std::string loss : { "quadratic", "logistic" }) {
+    for (const std::string solver : { "hybrid", "pgd" }) {
+      INFO("loss " << loss << ", solver " << solver);
+
+      Eigen::VectorXd y(n);
+
+      for (int i = 0; i < n; ++i) {
+        y(i) = loss == "quadratic"
+                 ? eta(i) + noise(rng)
+                 : static_cast<double>(unif(rng) < 1 / (1 + std::exp(-eta(i))));
+      }
+
+      slope::Slope model;
+      model.setLoss(loss);
+      model.setSolver(solver);
+      model.setTol(1e-10);
+      model.setPathLength(20);
+
+      auto path = model.path(x, y);
+      auto path_ref = model.path(x_sparse, y);
+
+      REQUIRE(path.size() == path_ref.size());
+
+      for (size_t i = 0; i < path.size(); ++i) {
+        INFO("step " << i);
+        Eigen::VectorXd coefs = path(i).getCoefs().toDense().reshaped();
+        Eigen::VectorXd coefs_ref =
+          path_ref(i).getCoefs().toDense().reshaped();
+
+        REQUIRE_THAT(coefs, VectorApproxEqual(coefs_ref, 1e-6));
+      }
+
+      Eigen::VectorXd pred = path(path.size() - 1).predict(x, "linear");
+      Eigen::VectorXd pred_ref =
+        path_ref(path.size() - 1).predict(x_sparse, "linear");
+
+      REQUIRE_THAT(pred, VectorApproxEqual(pred_ref, 1e-6));
+    }
+  }
+
+  SECTION("Weights")
+  {
+    Eigen::VectorXd y = eta + Eigen::VectorXd::Ones(n);
+    Eigen::VectorXd weights = Eigen::VectorXd::Ones(n);
+    weights.head(40).setZero();
+    weights.tail(60) *= 3;
+
+    slope::Slope model;
+    model.setTol(1e-10);
+    model.setPathLength(20);
+
+    auto path = model.path(x, y, weights);
+    auto path_ref = model.path(x_sparse, y, weights);
+
+    REQUIRE(path.size() == path_ref.size());
+
+    for (size_t i = 0; i < path.size(); ++i) {
+      INFO("step " << i);
+      Eigen::VectorXd coefs = path(i).getCoefs().toDense().reshaped();
+      Eigen::VectorXd coefs_ref = path_ref(i).getCoefs().toDense().reshaped();
+
+      REQUIRE_THAT(coefs, VectorApproxEqual(coefs_ref, 1e-6));
+    }
+  }
+}
@@ -24,3 +24,49 @@ TEST_CASE("Predictions", "[predict]")
 
   REQUIRE(pred.rows() == 20);
 }
+
+TEST_CASE("Path predictions", "[predict]")
+{
+  using namespace Catch::Matchers;
+
+  for (std::string loss_type :
+       { "quadratic", "logistic", "poisson", "multinomial" }) {
+    INFO("loss: " << loss_type);
+
+    auto data = generateData(100, 10, loss_type);
+    auto new_data = generateData(20, 10, loss_type, 3, 0.3, 0.2, 42);
+
+    Eigen::SparseMatrix<double> x_sparse = new_data.x.sparseView();
+
+    slope::Slope model;
+    model.setLoss(loss_type);
+    model.setPathLength(10);
+
+    auto path = model.path(data.x, data.y);
+
+    const int m = path.getInterceptMatrix().rows();
+
+    for (std::string type : { "linear", "response" }) {
+      Eigen::MatrixXd pred = path.predict(new_data.x, type);
+
+      // Multinomial class labels have one column per step
+      const int k = loss_type == "multinomial" && type == "response" ? 1 : m;
+
+      REQUIRE(pred.rows() == 20);
+      REQUIRE(pred.cols() == k * static_cast<int>(path.size()));
+
+      for (size_t i = 0; i < path.size(); ++i) {
+        Eigen::VectorXd expected =
+          path(i).predict(new_data.x, type).reshaped();
+        Eigen::VectorXd observed = pred.middleCols(i * k, k).reshaped();
+
+        REQUIRE_THAT(observed, VectorApproxEqual(expected));
+      }
+
+      Eigen::VectorXd pred_dense = pred.reshaped();
+      Eigen::VectorXd pred_sparse = path.predict(x_sparse, type).reshaped();
+
+      REQUIRE_THAT(pred_sparse, VectorApproxEqual(pred_dense));
+    }
+  }
+}
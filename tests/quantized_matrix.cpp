@@ -0,0 +1,118 @@
+#include "generate_data.hpp"
+#include "test_helpers.hpp"
+#include <Eigen/Core>
+#include <catch2/catch_test_macros.hpp>
+#include <slope/quantized_matrix.h>
+#include <slope/slope.h>
+
+TEST_CASE("Quantization of design matrices", "[quantized_matrix]")
+{
+  auto data = generateData(100, 10, "quadratic", 1, 1.0, 0.5, 11);
+
+  // Counts, which are stored exactly
+  data.x.col(0) = (data.x.col(0).array().abs() * 10).round();
+
+  slope::QuantizedMatrix8 x8(data.x);
+  slope::QuantizedMatrix16 x16(data.x);
+
+  REQUIRE(x8.rows() == data.x.rows());
+  REQUIRE(x8.cols() == data.x.cols());
+
+  Eigen::MatrixXd x8_values = x8.dequantize();
+  Eigen::MatrixXd x16_values = x16.dequantize();
+
+  REQUIRE(x8_values.col(0) == data.x.col(0));
+
+  for (int j = 1; j < data.x.cols(); ++j) {
+    INFO("column " << j);
+
+    double error8 = (x8_values.col(j) - data.x.col(j)).cwiseAbs().maxCoeff();
+    double error16 = (x16_values.col(j) - data.x.col(j)).cwiseAbs().maxCoeff();
+
+    REQUIRE(error8 <= 0.5 * x8.getSteps()(j) * (1 + 1e-12));
+    REQUIRE(error16 <= 0.5 * x16.getSteps()(j) * (1 + 1e-12));
+  }
+
+  Eigen::VectorXd means = x8_values.colwise().mean();
+  REQUIRE_THAT(x8.statistics().getMeans(), VectorApproxEqual(means));
+
+  slope::QuantizedMatrix8::Codes codes = x8.getCodes();
+  Eigen::VectorXd offsets = x8.getOffsets();
+  Eigen::VectorXd steps = x8.getSteps();
+
+  REQUIRE_THROWS_AS(slope::QuantizedMatrix8(codes, offsets, steps.head(2)),
+                    std::invalid_argument);
+
+  steps(1) = 0;
+  REQUIRE_THROWS_AS(slope::QuantizedMatrix8(codes, offsets, steps),
+                    std::invalid_argument);
+}
+
+TEST_CASE("Paths on quantized design matrices", "[quantized_matrix]")
+{
+  for (const std::string loss : { "quadratic", "logistic", "poisson" }) {
+    for (const std::string solver : { "hybrid", "pgd" }) {
+      INFO("loss " << loss << ", solver " << solver);
+
+      auto data = generateData(200, 20, loss, 1, 1.0, 0.3, 7);
+
+      slope::QuantizedMatrix8 x(data.x);
+      Eigen::MatrixXd x_values = x.dequantize();
+
+      slope::Slope model;
+      model.setLoss(loss);
+      model.setSolver(solver);
+      model.setTol(1e-10);
+      model.setPathLength(20);
+
+      auto path = model.path(x, data.y);
+      auto path_ref = model.path(x_values, data.y);
+
+      REQUIRE(path.size() == path_ref.size());
+
+      for (size_t i = 0; i < path.size(); ++i) {
+        INFO("step " << i);
+        Eigen::VectorXd coefs = path(i).getCoefs().toDense().reshaped();
+        Eigen::VectorXd coefs_ref =
+          path_ref(i).getCoefs().toDense().reshaped();
+
+        REQUIRE_THAT(coefs, VectorApproxEqual(coefs_ref, 1e-6));
+      }
+
+      Eigen::VectorXd eta = path(path.size() - 1).predict(x, "linear");
+      Eigen::VectorXd eta_ref =
+        path_ref(path.size() - 1).predict(x_values, "linear");
+
+      REQUIRE_THAT(eta, VectorApproxEqual(eta_ref, 1e-6));
+    }
+  }
+
+  SECTION("Weights and 16-bit codes")
+  {
+    auto data = generateData(200, 20, "quadratic", 1, 1.0, 0.3, 3);
+
+    slope::QuantizedMatrix16 x(data.x);
+    Eigen::MatrixXd x_values = x.dequantize();
+
+    Eigen::VectorXd weights = Eigen::VectorXd::Ones(x.rows());
+    weights.head(50).setZero();
+    weights.tail(50) *= 2;
+
+    slope::Slope model;
+    model.setTol(1e-10);
+    model.setPathLength(20);
+
+    auto path = model.path(x, data.y, weights);
+    auto path_ref = model.path(x_values, data.y, weights);
+
+    REQUIRE(path.size() == path_ref.size());
+
+    for (size_t i = 0; i < path.size(); ++i) {
+      INFO("step " << i);
+      Eigen::VectorXd coefs = path(i).getCoefs().toDense().reshaped();
+      Eigen::VectorXd coefs_ref = path_ref(i).getCoefs().toDense().reshaped();
+
+      REQUIRE_THAT(coefs, VectorApproxEqual(coefs_ref, 1e-6));
+    }
+  }
+}
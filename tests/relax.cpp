@@ -4,6 +4,7 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <numeric>
 #include <slope/clusters.h>
 #include <slope/losses/quadratic.h>
 #include <slope/ols.h>
@@ -237,3 +238,75 @@ TEST_CASE("Relaxed path", "[relax]")
 
   REQUIRE(relaxed_path.size() == path.size());
 }
+
+TEST_CASE("Relaxed path warm starts", "[relax][warm_start]")
+{
+  for (const std::string loss_type : { "quadratic", "logistic" }) {
+    slope::Slope model;
+
+    model.setPathLength(20);
+    model.setRelaxTol(1e-10);
+    model.setLoss(loss_type);
+
+    auto data = generateData(200, 10, loss_type);
+
+    auto path = model.path(data.x, data.y);
+
+    model.setRelaxWarmStarts(true);
+    auto relaxed_warm = model.relax(path, data.x, data.y);
+
+    model.setRelaxWarmStarts(false);
+    auto relaxed_cold = model.relax(path, data.x, data.y);
+
+    REQUIRE(relaxed_warm.size() == path.size());
+    REQUIRE(relaxed_cold.size() == path.size());
+
+    for (size_t i = 0; i < path.size(); ++i) {
+      Eigen::VectorXd coefs_warm = relaxed_warm(i).getCoefs();
+      Eigen::VectorXd coefs_cold = relaxed_cold(i).getCoefs();
+
+      REQUIRE_THAT(coefs_warm, VectorApproxEqual(coefs_cold, 1e-4));
+    }
+
+    if (loss_type == "logistic") {
+      auto passes_warm = relaxed_warm.getPasses();
+      auto passes_cold = relaxed_cold.getPasses();
+
+      REQUIRE(std::accumulate(passes_warm.begin(), passes_warm.end(), 0) <
+              std::accumulate(passes_cold.begin(), passes_cold.end(), 0));
+    }
+  }
+}
+
+TEST_CASE("Blending a relaxed path", "[relax]")
+{
+  slope::Slope model;
+
+  model.setPathLength(10);
+  model.setLoss("logistic");
+
+  auto data = generateData(200, 10, "logistic");
+
+  auto path = model.path(data.x, data.y);
+  auto relaxed = model.relax(path, data.x, data.y);
+
+  for (double gamma : { 0.25, 0.5 }) {
+    auto relaxed_gamma = model.relax(path, data.x, data.y, gamma);
+    auto blended = slope::Slope::blendRelaxed(path, relaxed, gamma);
+
+    REQUIRE(blended.size() == path.size());
+
+    for (size_t i = 0; i < path.size(); ++i) {
+      Eigen::VectorXd coefs_gamma = relaxed_gamma(i).getCoefs();
+      Eigen::VectorXd coefs_blended = blended(i).getCoefs();
+
+      REQUIRE_THAT(coefs_blended, VectorApproxEqual(coefs_gamma, 1e-10));
+      REQUIRE_THAT(
+        blended(i).getIntercepts()(0),
+        Catch::Matchers::WithinAbs(relaxed_gamma(i).getIntercepts()(0), 1e-10));
+    }
+  }
+
+  REQUIRE_THROWS_AS(slope::Slope::blendRelaxed(path, relaxed, 1.5),
+                    std::invalid_argument);
+}
@@ -0,0 +1,80 @@
+#include "generate_data.hpp"
+#include "test_helpers.hpp"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <slope/row_compression.h>
+#include <slope/slope.h>
+
+TEST_CASE("Row compression", "[weights][row_compression]")
+{
+  using namespace Catch::Matchers;
+
+  // 40 distinct rows, repeated in a scrambled order to get 300 rows
+  auto data = generateData(40, 8, "logistic", 1, 1.0);
+
+  std::vector<int> ind(300);
+  for (int i = 0; i < 300; ++i) {
+    ind[i] = (i * 7) % 40;
+  }
+
+  Eigen::MatrixXd x = slope::subset(data.x, ind);
+  Eigen::VectorXd y = data.y(ind);
+  Eigen::SparseMatrix<double> x_sparse = x.sparseView();
+
+  auto compressed = slope::compressRows(x, y);
+  auto compressed_sparse = slope::compressRows(x_sparse, y);
+
+  REQUIRE(compressed.x.rows() == 40);
+  REQUIRE(compressed.counts.sum() == 300);
+  REQUIRE_THAT(compressed.compressionRatio(), WithinAbs(7.5, 1e-12));
+
+  REQUIRE(compressed_sparse.row_map == compressed.row_map);
+  REQUIRE_THAT(compressed_sparse.counts, VectorApproxEqual(compressed.counts));
+  REQUIRE_THAT(Eigen::MatrixXd(compressed_sparse.x).reshaped(),
+               VectorApproxEqual(compressed.x.reshaped()));
+
+  for (int i = 0; i < 300; ++i) {
+    REQUIRE(compressed.x.row(compressed.row_map[i]) == x.row(i));
+  }
+
+  SECTION("Rows that differ only in the response are kept apart")
+  {
+    Eigen::VectorXd y_flipped = y;
+    y_flipped(0) = 1 - y_flipped(0);
+
+    auto compressed_flipped = slope::compressRows(x, y_flipped);
+
+    REQUIRE(compressed_flipped.x.rows() == 41);
+  }
+
+  SECTION("Compressed fits are identical")
+  {
+    slope::Slope model;
+    model.setLoss("logistic");
+    model.setTol(1e-10);
+    model.setPathLength(10);
+
+    auto path = model.path(x, y);
+    auto path_compressed =
+      model.path(compressed.x, compressed.y, compressed.counts);
+    auto path_sparse = model.path(
+      compressed_sparse.x, compressed_sparse.y, compressed_sparse.counts);
+
+    REQUIRE_THAT(path_compressed.getAlpha(),
+                 VectorApproxEqual(path.getAlpha(), 1e-10));
+    REQUIRE_THAT(path_compressed.getDeviance(),
+                 VectorApproxEqual(path.getDeviance(), 1e-6));
+
+    int k = path.size() - 1;
+
+    Eigen::VectorXd coefs = path(k).getCoefs();
+    Eigen::VectorXd coefs_compressed = path_compressed(k).getCoefs();
+    Eigen::VectorXd coefs_sparse = path_sparse(k).getCoefs();
+
+    REQUIRE_THAT(coefs_compressed, VectorApproxEqual(coefs, 1e-6));
+    REQUIRE_THAT(coefs_sparse, VectorApproxEqual(coefs, 1e-6));
+  }
+}
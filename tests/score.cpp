@@ -4,6 +4,7 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <random>
 #include <slope/losses/logistic.h>
 #include <slope/score.h>
 
@@ -240,3 +241,82 @@ TEST_CASE("Deviance score", "[score][deviance]")
   score = deviance->eval(perfect_eta, truth, loss);
   REQUIRE_THAT(score, WithinAbs(0.0, 1e-10));
 }
+
+TEST_CASE("Scoring whole paths", "[score]")
+{
+  using Catch::Matchers::WithinAbs;
+  using namespace slope;
+
+  std::mt19937 rng(42);
+  std::normal_distribution<double> dist;
+  std::bernoulli_distribution coin;
+
+  const int n = 30;
+  const int n_steps = 6;
+
+  SECTION("Single response")
+  {
+    Eigen::MatrixXd eta(n, n_steps);
+    Eigen::MatrixXd y(n, 1);
+
+    for (int i = 0; i < n; ++i) {
+      y(i) = coin(rng);
+
+      for (int k = 0; k < n_steps; ++k) {
+        // Rounded to produce ties
+        eta(i, k) = std::round(2 * dist(rng)) / 2;
+      }
+    }
+
+    eta.col(0).setZero();
+
+    auto loss = setupLoss("logistic");
+
+    for (std::string metric : { "auc", "deviance", "mse", "misclass" }) {
+      INFO("metric: " << metric);
+
+      auto scorer = Score::create(metric);
+      Eigen::VectorXd scores = scorer->evalPath(eta, y, loss);
+
+      REQUIRE(scores.size() == n_steps);
+
+      for (int k = 0; k < n_steps; ++k) {
+        REQUIRE_THAT(scores(k),
+                     WithinAbs(scorer->eval(eta.col(k), y, loss), 1e-10));
+      }
+    }
+  }
+
+  SECTION("Multiple responses")
+  {
+    const int m = 3;
+
+    Eigen::MatrixXd eta(n, m * n_steps);
+    Eigen::MatrixXd y = Eigen::MatrixXd::Zero(n, m);
+
+    for (int i = 0; i < n; ++i) {
+      y(i, i % m) = 1;
+
+      for (int k = 0; k < m * n_steps; ++k) {
+        eta(i, k) = dist(rng);
+      }
+    }
+
+    auto loss = setupLoss("multinomial");
+
+    for (std::string metric : { "auc", "deviance" }) {
+      INFO("metric: " << metric);
+
+      auto scorer = Score::create(metric);
+      Eigen::VectorXd scores = scorer->evalPath(eta, y, loss);
+
+      REQUIRE(scores.size() == n_steps);
+
+      for (int k = 0; k < n_steps; ++k) {
+        Eigen::MatrixXd eta_k = eta.middleCols(k * m, m);
+        REQUIRE_THAT(scores(k),
+                     WithinAbs(scorer->eval(eta_k, y, loss), 1e-10));
+      }
+    }
+  }
+}
@@ -0,0 +1,133 @@
+#include "test_helpers.hpp"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <random>
+#include <slope/slope.h>
+#include <slope/ultrahigh.h>
+
+namespace {
+
+/// Checks an ultrahigh-dimensional path against the path of the full design
+template<typename T>
+void
+requireSamePath(const slope::UltrahighPath& path,
+                const slope::SlopePath& path_ref,
+                T& x)
+{
+  REQUIRE(path.size() == path_ref.size());
+
+  for (size_t step = 0; step < path.size(); ++step) {
+    INFO("step " << step);
+
+    Eigen::VectorXd coefs = Eigen::MatrixXd(path.getCoefs(step)).reshaped();
+    Eigen::VectorXd coefs_ref =
+      Eigen::MatrixXd(path_ref(step).getCoefs()).reshaped();
+
+    REQUIRE_THAT(coefs, VectorApproxEqual(coefs_ref, 1e-6));
+  }
+
+  const size_t last = path.size() - 1;
+
+  Eigen::VectorXd pred = path.predict(x, last).reshaped();
+  Eigen::VectorXd pred_ref = path_ref(last).predict(x).reshaped();
+
+  REQUIRE_THAT(pred, VectorApproxEqual(pred_ref, 1e-6));
+}
+
+} // namespace
+
+TEST_CASE("Ultrahigh-dimensional paths", "[ultrahigh]")
+{
+  std::mt19937 rng(3);
+  std::normal_distribution<double> normal;
+  std::uniform_real_distribution<double> unif;
+
+  const int n = 60;
+  const int p = 2500;
+
+  Eigen::MatrixXd x =
+    Eigen::MatrixXd::NullaryExpr(n, p, [&]() { return normal(rng); });
+
+  // Signals in different blocks of columns
+  Eigen::VectorXd eta = 2 * x.col(3) - 1.5 * x.col(1500) + x.col(2400);
+
+  for (const std::string loss : { "quadratic", "logistic" }) {
+    INFO("loss " << loss);
+
+    Eigen::VectorXd y(n);
+
+    for (int i = 0; i < n; ++i) {
+      y(i) = loss == "quadratic"
+               ? eta(i) + normal(rng)
+               : static_cast<double>(unif(rng) < 1 / (1 + std::exp(-eta(i))));
+    }
+
+    slope::Slope model;
+    model.setLoss(loss);
+    model.setTol(1e-10);
+    model.setPathLength(20);
+    model.setAlphaMinRatio(0.05);
+
+    // Few candidates, so that they run out and are extended
+    auto path = slope::ultrahighPath(model, x, y, 5);
+    auto path_ref = model.path(x, y);
+
+    // Only a fraction of the features are ever part of the fits
+    REQUIRE(path.getColumns().size() < p / 10);
+
+    requireSamePath(path, path_ref, x);
+  }
+
+  slope::Slope model;
+  Eigen::VectorXd y = eta;
+
+  REQUIRE_THROWS_AS(slope::ultrahighPath(model, x, y, 0),
+                    std::invalid_argument);
+
+  model.setCentering(Eigen::VectorXd::Zero(p));
+  REQUIRE_THROWS_AS(slope::ultrahighPath(model, x, y), std::invalid_argument);
+}
+
+TEST_CASE("Sparse multi-response ultrahigh-dimensional paths", "[ultrahigh]")
+{
+  std::mt19937 rng(4);
+  std::normal_distribution<double> normal;
+  std::bernoulli_distribution nonzero(0.1);
+
+  const int n = 80;
+  const int p = 1500;
+
+  Eigen::MatrixXd x_dense = Eigen::MatrixXd::NullaryExpr(
+    n, p, [&]() { return nonzero(rng) ? normal(rng) : 0.0; });
+  Eigen::SparseMatrix<double> x = x_dense.sparseView();
+
+  Eigen::MatrixXd beta = Eigen::MatrixXd::Zero(p, 3);
+  beta(10, 0) = 4;
+  beta(1100, 1) = -4;
+  beta(1400, 2) = 3;
+
+  Eigen::MatrixXd eta = x_dense * beta;
+  Eigen::VectorXd y(n);
+
+  for (int i = 0; i < n; ++i) {
+    int cls;
+    (eta.row(i) + Eigen::RowVector3d::NullaryExpr([&]() {
+       return normal(rng);
+     })).maxCoeff(&cls);
+    y(i) = cls;
+  }
+
+  slope::Slope model;
+  model.setLoss("multinomial");
+  model.setTol(1e-10);
+  model.setPathLength(10);
+
+  auto path = slope::ultrahighPath(model, x, y, 20);
+  auto path_ref = model.path(x, y);
+
+  REQUIRE(path.getCoefs(0).cols() == 2);
+
+  requireSamePath(path, path_ref, x);
+}
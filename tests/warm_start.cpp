@@ -0,0 +1,95 @@
+#include "generate_data.hpp"
+#include "test_helpers.hpp"
+#include <Eigen/Core>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <numeric>
+#include <slope/slope.h>
+
+TEST_CASE("Warm starts", "[path][warm_start]")
+{
+  using namespace Catch::Matchers;
+
+  auto data = generateData(200, 50);
+
+  Eigen::VectorXd y_new =
+    data.y + 0.01 * Eigen::VectorXd::LinSpaced(data.y.size(), -1, 1);
+
+  slope::Slope model;
+  model.setPathLength(20);
+  model.setTol(1e-8);
+
+  SECTION("Path")
+  {
+    auto path_prev = model.path(data.x, data.y);
+    auto path_cold = model.path(data.x, y_new);
+    auto path_warm = model.path(data.x, y_new, path_prev);
+
+    REQUIRE(path_warm.size() == path_cold.size());
+
+    auto coefs_cold = path_cold.getCoefs();
+    auto coefs_warm = path_warm.getCoefs();
+
+    for (size_t i = 0; i < path_cold.size(); ++i) {
+      Eigen::VectorXd coef_cold = coefs_cold[i];
+      Eigen::VectorXd coef_warm = coefs_warm[i];
+      REQUIRE_THAT(coef_warm, VectorApproxEqual(coef_cold, 1e-4));
+    }
+
+    auto passes_cold = path_cold.getPasses();
+    auto passes_warm = path_warm.getPasses();
+
+    REQUIRE(std::accumulate(passes_warm.begin(), passes_warm.end(), 0) <
+            std::accumulate(passes_cold.begin(), passes_cold.end(), 0));
+  }
+
+  SECTION("Fit")
+  {
+    double alpha = 0.01;
+
+    auto fit_prev = model.fit(data.x, data.y, alpha);
+    auto fit_cold = model.fit(data.x, y_new, alpha);
+    auto fit_warm = model.fit(data.x, y_new, fit_prev);
+
+    Eigen::VectorXd coef_cold = fit_cold.getCoefs();
+    Eigen::VectorXd coef_warm = fit_warm.getCoefs();
+
+    REQUIRE(fit_warm.getAlpha() == alpha);
+    REQUIRE_THAT(coef_warm, VectorApproxEqual(coef_cold, 1e-4));
+    REQUIRE(fit_warm.getPasses() < fit_cold.getPasses());
+  }
+
+  SECTION("Mismatched dimensions")
+  {
+    auto fit_prev = model.fit(data.x, data.y);
+
+    Eigen::MatrixXd x_sub = data.x.leftCols(10);
+
+    REQUIRE_THROWS_AS(model.fit(x_sub, data.y, fit_prev),
+                      std::invalid_argument);
+  }
+}
+
+TEST_CASE("Path alignment", "[path][warm_start]")
+{
+  Eigen::ArrayXd alpha(4);
+  alpha << 1.0, 0.5, 0.25, 0.125;
+
+  SECTION("Proportional sequences are matched by position")
+  {
+    Eigen::ArrayXd alpha_prev = 1.1 * alpha;
+    auto steps = slope::alignPaths(alpha, alpha_prev, 1.0);
+
+    REQUIRE(steps == std::vector<int>{ 0, 1, 2, 3 });
+  }
+
+  SECTION("Other sequences are matched by the closest alpha")
+  {
+    Eigen::ArrayXd alpha_prev(2);
+    alpha_prev << 0.26, 0.12;
+    auto steps = slope::alignPaths(alpha, alpha_prev, 1.0);
+
+    REQUIRE(steps == std::vector<int>{ -1, 0, 0, 1 });
+  }
+}
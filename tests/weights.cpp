@@ -0,0 +1,184 @@
+#include "generate_data.hpp"
+#include "test_helpers.hpp"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <slope/slope.h>
+#include <slope/utils.h>
+
+TEST_CASE("Zero weights are equivalent to dropping rows", "[weights]")
+{
+  using namespace Catch::Matchers;
+
+  std::vector<int> subset_ind;
+
+  for (int i = 0; i < 200; ++i) {
+    if (i % 3 != 0) {
+      subset_ind.emplace_back(i);
+    }
+  }
+
+  Eigen::VectorXd w = Eigen::VectorXd::Zero(200);
+  w(subset_ind).setOnes();
+
+  for (const std::string loss_type :
+       { "quadratic", "logistic", "poisson", "multinomial" }) {
+    auto data = generateData(200, 10, loss_type, 3);
+
+    Eigen::MatrixXd x_subset = slope::subset(data.x, subset_ind);
+    Eigen::VectorXd y_subset = data.y(subset_ind);
+
+    slope::Slope model;
+    model.setLoss(loss_type);
+    model.setTol(1e-10);
+    model.setPathLength(10);
+
+    auto path_subset = model.path(x_subset, y_subset);
+    auto path_weighted =
+      model.path(data.x, data.y, w, path_subset.getAlpha());
+
+    INFO("loss: " << loss_type);
+
+    REQUIRE(path_weighted.size() == path_subset.size());
+
+    const int n_steps = path_subset.size();
+
+    for (int k : { 0, n_steps / 2, n_steps - 1 }) {
+      Eigen::VectorXd coefs_subset =
+        Eigen::MatrixXd(path_subset(k).getCoefs()).reshaped();
+      Eigen::VectorXd coefs_weighted =
+        Eigen::MatrixXd(path_weighted(k).getCoefs()).reshaped();
+
+      REQUIRE_THAT(coefs_weighted, VectorApproxEqual(coefs_subset, 1e-5));
+      REQUIRE_THAT(path_weighted(k).getDeviance(),
+                   WithinRel(path_subset(k).getDeviance(), 1e-6));
+    }
+  }
+}
+
+TEST_CASE("Integer weights are equivalent to repeating rows", "[weights]")
+{
+  using namespace Catch::Matchers;
+
+  auto data = generateData(100, 10);
+  Eigen::SparseMatrix<double> x_sparse = data.x.sparseView();
+
+  Eigen::VectorXd w(100);
+  std::vector<int> repeated_ind;
+
+  for (int i = 0; i < 100; ++i) {
+    w(i) = i % 3;
+
+    for (int r = 0; r < w(i); ++r) {
+      repeated_ind.emplace_back(i);
+    }
+  }
+
+  Eigen::MatrixXd x_repeated = slope::subset(data.x, repeated_ind);
+  Eigen::VectorXd y_repeated = data.y(repeated_ind);
+
+  slope::Slope model;
+  model.setTol(1e-10);
+  model.setPathLength(10);
+
+  auto path_repeated = model.path(x_repeated, y_repeated);
+  auto path_dense = model.path(data.x, data.y, w);
+  auto path_sparse = model.path(x_sparse, data.y, w);
+
+  REQUIRE_THAT(path_dense.getAlpha(),
+               VectorApproxEqual(path_repeated.getAlpha(), 1e-8));
+
+  int k = path_repeated.size() - 1;
+
+  Eigen::VectorXd coefs_repeated = path_repeated(k).getCoefs();
+  Eigen::VectorXd coefs_dense = path_dense(k).getCoefs();
+  Eigen::VectorXd coefs_sparse = path_sparse(k).getCoefs();
+
+  REQUIRE_THAT(coefs_dense, VectorApproxEqual(coefs_repeated, 1e-5));
+  REQUIRE_THAT(coefs_sparse, VectorApproxEqual(coefs_repeated, 1e-5));
+
+  // The relaxed fit is a weighted least squares problem
+  auto relaxed_repeated =
+    model.relax(path_repeated(k), x_repeated, y_repeated);
+  auto relaxed_weighted = model.relax(path_dense(k),
+                                      data.x,
+                                      data.y,
+                                      0.0,
+                                      Eigen::VectorXd(0),
+                                      Eigen::VectorXd(0),
+                                      w);
+
+  Eigen::VectorXd relaxed_coefs_repeated = relaxed_repeated.getCoefs();
+  Eigen::VectorXd relaxed_coefs_weighted = relaxed_weighted.getCoefs();
+
+  REQUIRE_THAT(relaxed_coefs_weighted,
+               VectorApproxEqual(relaxed_coefs_repeated, 1e-6));
+  REQUIRE_THAT(relaxed_weighted.getIntercepts()(0),
+               WithinAbs(relaxed_repeated.getIntercepts()(0), 1e-6));
+}
+
+TEST_CASE("Invalid weights", "[weights][input_validation]")
+{
+  auto data = generateData(20, 3);
+
+  slope::Slope model;
+
+  Eigen::VectorXd w_short = Eigen::VectorXd::Ones(10);
+  Eigen::VectorXd w_negative = Eigen::VectorXd::Ones(20);
+  Eigen::VectorXd w_zero = Eigen::VectorXd::Zero(20);
+  Eigen::VectorXd w_nan = Eigen::VectorXd::Ones(20);
+
+  w_negative(3) = -1;
+  w_nan(5) = std::numeric_limits<double>::quiet_NaN();
+
+  for (const auto& w : { w_short, w_negative, w_zero, w_nan }) {
+    REQUIRE_THROWS_AS(model.path(data.x, data.y, w), std::invalid_argument);
+  }
+}
+
+TEST_CASE("Weighted fits", "[weights]")
+{
+  using namespace Catch::Matchers;
+
+  SECTION("Unit weights give the unweighted fit")
+  {
+    auto data = generateData(100, 10, "logistic");
+    Eigen::VectorXd w = Eigen::VectorXd::Ones(100);
+
+    slope::Slope model;
+    model.setLoss("logistic");
+    model.setTol(1e-10);
+
+    auto fit = model.fit(data.x, data.y, 0.01);
+    auto fit_weighted = model.fit(data.x, data.y, w, 0.01);
+
+    Eigen::VectorXd coefs = fit.getCoefs();
+    Eigen::VectorXd coefs_weighted = fit_weighted.getCoefs();
+
+    REQUIRE_THAT(coefs_weighted, VectorApproxEqual(coefs, 1e-8));
+    REQUIRE_THAT(fit_weighted.getDeviance(),
+                 WithinRel(fit.getDeviance(), 1e-8));
+  }
+
+  SECTION("Only relative weights matter for a given alpha")
+  {
+    auto data = generateData(100, 10, "poisson");
+    Eigen::VectorXd w = Eigen::VectorXd::LinSpaced(100, 0.1, 2.0);
+
+    slope::Slope model;
+    model.setLoss("poisson");
+    model.setTol(1e-10);
+
+    auto fit = model.fit(data.x, data.y, w, 0.01);
+    auto fit_scaled = model.fit(data.x, data.y, (0.37 * w).eval(), 0.01);
+
+    Eigen::VectorXd coefs = fit.getCoefs();
+    Eigen::VectorXd coefs_scaled = fit_scaled.getCoefs();
+
+    REQUIRE_THAT(coefs_scaled, VectorApproxEqual(coefs, 1e-8));
+    REQUIRE_THAT(fit_scaled.getIntercepts()(0),
+                 WithinAbs(fit.getIntercepts()(0), 1e-8));
+  }
+}